@@ -12,6 +12,8 @@
 #include <gio/gunixinputstream.h>
 #endif
 
+gboolean	 fwupd_client_get_connected		(FwupdClient	*self);
+
 #ifdef HAVE_GIO_UNIX
 void		 fwupd_client_get_details_stream_async	(FwupdClient	*self,
 							 GUnixInputStream *istr,
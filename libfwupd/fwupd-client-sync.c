@@ -96,6 +96,10 @@ fwupd_client_connect (FwupdClient *self, GCancellable *cancellable, GError **err
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	/* nothing to do */
+	if (fwupd_client_get_connected (self))
+		return TRUE;
+
 	/* call async version and run loop until complete */
 	helper = fwupd_client_helper_new (self);
 	fwupd_client_connect_async (self, cancellable, fwupd_client_connect_cb, helper);
@@ -152,6 +156,52 @@ fwupd_client_get_devices (FwupdClient *self, GCancellable *cancellable, GError *
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_load_cache_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->ret = fwupd_client_load_cache_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_load_cache:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the devices and remotes from the daemon, and then keeps them up to
+ * date using the signals from the daemon.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fwupd_client_load_cache (FwupdClient *self, GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return FALSE;
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_load_cache_async (self, cancellable,
+				       fwupd_client_load_cache_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (!helper->ret) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static void
 fwupd_client_get_plugins_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -386,6 +436,108 @@ fwupd_client_get_upgrades (FwupdClient *self, const gchar *device_id,
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_get_releases_batch_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->array = fwupd_client_get_releases_batch_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_releases_batch:
+ * @self: A #FwupdClient
+ * @device_ids: (element-type utf8): the device IDs
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the releases for multiple devices, using one round-trip to the
+ * daemon for all of the devices.
+ *
+ * Returns: (element-type GPtrArray) (transfer container): an array of
+ * releases for each device ID, which is empty if the device has no releases
+ * or the daemon returned an error for it
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_releases_batch (FwupdClient *self, GPtrArray *device_ids,
+				 GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (device_ids != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until all complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_get_releases_batch_async (self, device_ids, cancellable,
+					       fwupd_client_get_releases_batch_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (helper->array == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->array);
+}
+
+static void
+fwupd_client_get_upgrades_batch_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->array = fwupd_client_get_upgrades_batch_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_upgrades_batch:
+ * @self: A #FwupdClient
+ * @device_ids: (element-type utf8): the device IDs
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the upgrades for multiple devices, using one round-trip to the
+ * daemon for all of the devices.
+ *
+ * Returns: (element-type GPtrArray) (transfer container): an array of
+ * releases for each device ID, which is empty if the device has no upgrades
+ * or the daemon returned an error for it
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_upgrades_batch (FwupdClient *self, GPtrArray *device_ids,
+				 GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (device_ids != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until all complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_get_upgrades_batch_async (self, device_ids, cancellable,
+					       fwupd_client_get_upgrades_batch_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (helper->array == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->array);
+}
+
 static void
 fwupd_client_get_details_bytes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -1393,6 +1545,56 @@ fwupd_client_refresh_remote (FwupdClient *self,
 	return TRUE;
 }
 
+static void
+fwupd_client_refresh_remotes_cb (GObject *source,
+				 GAsyncResult *res,
+				 gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->ret = fwupd_client_refresh_remotes_finish (FWUPD_CLIENT (source),
+							   res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_refresh_remotes:
+ * @self: A #FwupdClient
+ * @remotes: (element-type FwupdRemote): remotes to refresh
+ * @cancellable: A #GCancellable, or %NULL
+ * @error: A #GError, or %NULL
+ *
+ * Refreshes multiple remotes at the same time by downloading new metadata.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fwupd_client_refresh_remotes (FwupdClient *self,
+			      GPtrArray *remotes,
+			      GCancellable *cancellable,
+			      GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (remotes != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_refresh_remotes_async (self, remotes, cancellable,
+					    fwupd_client_refresh_remotes_cb,
+					    helper);
+	g_main_loop_run (helper->loop);
+	if (!helper->ret) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static void
 fwupd_client_modify_remote_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -2038,6 +2240,14 @@ fwupd_client_download_bytes (FwupdClient *self,
 	return g_steal_pointer (&helper->bytes);
 }
 
+static void
+fwupd_client_download_file_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->ret = fwupd_client_download_file_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
 /**
  * fwupd_client_download_file:
  * @self: A #FwupdClient
@@ -2062,9 +2272,7 @@ fwupd_client_download_file (FwupdClient *self,
 			    GCancellable *cancellable,
 			    GError **error)
 {
-	gssize size;
-	g_autoptr(GBytes) bytes = NULL;
-	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(FwupdClientHelper) helper = NULL;
 
 	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
 	g_return_val_if_fail (url != NULL, FALSE);
@@ -2073,19 +2281,19 @@ fwupd_client_download_file (FwupdClient *self,
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 	g_return_val_if_fail (fwupd_client_get_user_agent (self) != NULL, FALSE);
 
-	/* download then write */
-	bytes = fwupd_client_download_bytes (self, url, flags, cancellable, error);
-	if (bytes == NULL)
-		return FALSE;
-	ostream = G_OUTPUT_STREAM (g_file_replace (file, NULL, FALSE,
-				   G_FILE_CREATE_NONE, NULL, error));
-	if (ostream == NULL)
-		return FALSE;
-	size = g_output_stream_write_bytes (ostream, bytes, NULL, error);
-	if (size < 0)
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
 		return FALSE;
 
-	/* success */
+	/* call async version and run loop until complete */
+	helper = fwupd_client_helper_new (self);
+	fwupd_client_download_file_async (self, url, file, flags, cancellable,
+					  fwupd_client_download_file_cb, helper);
+	g_main_loop_run (helper->loop);
+	if (!helper->ret) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return FALSE;
+	}
 	return TRUE;
 }
 
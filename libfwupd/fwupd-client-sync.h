@@ -14,6 +14,9 @@ gboolean	 fwupd_client_connect			(FwupdClient	*self,
 GPtrArray	*fwupd_client_get_devices		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error);
+gboolean	 fwupd_client_load_cache		(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_plugins		(FwupdClient	*self,
 							 GCancellable	*cancellable,
 							 GError		**error);
@@ -32,6 +35,14 @@ GPtrArray	*fwupd_client_get_upgrades		(FwupdClient	*self,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
 							 GError		**error);
+GPtrArray	*fwupd_client_get_releases_batch	(FwupdClient	*self,
+							 GPtrArray	*device_ids,
+							 GCancellable	*cancellable,
+							 GError		**error);
+GPtrArray	*fwupd_client_get_upgrades_batch	(FwupdClient	*self,
+							 GPtrArray	*device_ids,
+							 GCancellable	*cancellable,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_details		(FwupdClient	*self,
 							 const gchar	*filename,
 							 GCancellable	*cancellable,
@@ -114,6 +125,10 @@ gboolean	 fwupd_client_refresh_remote		(FwupdClient	*self,
 							 FwupdRemote	*remote,
 							 GCancellable	*cancellable,
 							 GError		**error);
+gboolean	 fwupd_client_refresh_remotes		(FwupdClient	*self,
+							 GPtrArray	*remotes,
+							 GCancellable	*cancellable,
+							 GError		**error);
 gboolean	 fwupd_client_modify_remote		(FwupdClient	*self,
 							 const gchar	*remote_id,
 							 const gchar	*key,
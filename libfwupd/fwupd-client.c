@@ -7,17 +7,21 @@
 #include "config.h"
 
 #include <glib-object.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #include <gmodule.h>
 #include <curl/curl.h>
 #ifdef HAVE_GIO_UNIX
+#include <gio/gfiledescriptorbased.h>
 #include <gio/gunixfdlist.h>
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "fwupd-client-private.h"
 #include "fwupd-client-sync.h"
@@ -33,6 +37,8 @@
 
 typedef GObject		*(*FwupdClientObjectNewFunc)	(void);
 
+#define FWUPD_CLIENT_FIRMWARE_CACHE_SIZE_MAX	(512 * 1024 * 1024)	/* bytes */
+
 /**
  * SECTION:fwupd-client
  * @short_description: a way of interfacing with the daemon
@@ -43,6 +49,21 @@ typedef GObject		*(*FwupdClientObjectNewFunc)	(void);
  */
 
 static void fwupd_client_finalize	 (GObject *object);
+static void fwupd_client_download_bytes_full_async (FwupdClient *self,
+						    const gchar *url,
+						    FwupdClientDownloadFlags flags,
+						    guint64 mtime,
+						    GCancellable *cancellable,
+						    GAsyncReadyCallback callback,
+						    gpointer callback_data);
+static void fwupd_client_download_file_full_async (FwupdClient *self,
+						   const gchar *url,
+						   GFile *file,
+						   const gchar *checksum_expected,
+						   FwupdClientDownloadFlags flags,
+						   GCancellable *cancellable,
+						   GAsyncReadyCallback callback,
+						   gpointer callback_data);
 
 typedef struct {
 	GMainContext			*main_ctx;
@@ -57,6 +78,14 @@ typedef struct {
 	GDBusConnection			*conn;
 	GDBusProxy			*proxy;
 	gchar				*user_agent;
+	GPtrArray			*cached_devices;	/* (nullable) (element-type FwupdDevice) */
+	GPtrArray			*cached_remotes;	/* (nullable) (element-type FwupdRemote) */
+	GPtrArray			*loading_devices;	/* (nullable): received while loading the cache */
+	GPtrArray			*loading_remotes;	/* (nullable): received while loading the cache */
+	gboolean			 loading_remotes_stale;
+	gboolean			 reply_fd_unsupported;
+	GMutex				 transfers_mutex;
+	GPtrArray			*transfers;	/* (element-type FwupdCurlHelper) (not owned) */
 #ifdef SOUP_SESSION_COMPAT
 	GObject				*soup_session;
 	GModule				*soup_module;	/* we leak this */
@@ -64,11 +93,14 @@ typedef struct {
 } FwupdClientPrivate;
 
 typedef struct {
+	FwupdClient			*self;
+	GMainContext			*context;	/* of the caller */
 	CURL				*curl;
 #ifdef HAVE_LIBCURL_7_56_0
 	curl_mime			*mime;
 #endif
 	struct curl_slist		*headers;
+	guint				 percentage;
 } FwupdCurlHelper;
 
 enum {
@@ -103,22 +135,6 @@ G_DEFINE_TYPE_WITH_PRIVATE (FwupdClient, fwupd_client, G_TYPE_OBJECT)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(CURLU, curl_url_cleanup)
 #endif
 
-static void
-fwupd_client_curl_helper_free (FwupdCurlHelper *helper)
-{
-	if (helper->curl != NULL)
-		curl_easy_cleanup (helper->curl);
-#ifdef HAVE_LIBCURL_7_56_0
-	if (helper->mime != NULL)
-		curl_mime_free (helper->mime);
-#endif
-	if (helper->headers != NULL)
-		curl_slist_free_all (helper->headers);
-	g_free (helper);
-}
-
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdCurlHelper, fwupd_client_curl_helper_free)
-
 static void
 fwupd_client_set_host_product (FwupdClient *self, const gchar *host_product)
 {
@@ -178,6 +194,86 @@ fwupd_client_set_percentage (FwupdClient *self, guint percentage)
 	g_object_notify (G_OBJECT (self), "percentage");
 }
 
+typedef struct {
+	FwupdClient	*self;
+	FwupdStatus	 status;
+	guint		 percentage;
+} FwupdClientProgressHelper;
+
+static void
+fwupd_client_progress_helper_free (FwupdClientProgressHelper *helper)
+{
+	g_object_unref (helper->self);
+	g_free (helper);
+}
+
+static gboolean
+fwupd_client_progress_idle_cb (gpointer user_data)
+{
+	FwupdClientProgressHelper *helper = (FwupdClientProgressHelper *) user_data;
+	if (helper->status != FWUPD_STATUS_UNKNOWN)
+		fwupd_client_set_status (helper->self, helper->status);
+	else
+		fwupd_client_set_percentage (helper->self, helper->percentage);
+	return G_SOURCE_REMOVE;
+}
+
+/* transfers run in worker threads, but signals and notifications have to be
+ * emitted in the context of the caller; a status of %FWUPD_STATUS_UNKNOWN
+ * sets just the percentage */
+static void
+fwupd_client_progress_invoke (FwupdCurlHelper *helper, FwupdStatus status, guint percentage)
+{
+	FwupdClientProgressHelper *progress = g_new0 (FwupdClientProgressHelper, 1);
+	g_autoptr(GSource) source = g_idle_source_new ();
+
+	progress->self = g_object_ref (helper->self);
+	progress->status = status;
+	progress->percentage = percentage;
+	g_source_set_priority (source, G_PRIORITY_DEFAULT);
+	g_source_set_callback (source, fwupd_client_progress_idle_cb, progress,
+			       (GDestroyNotify) fwupd_client_progress_helper_free);
+	g_source_attach (source, helper->context);
+}
+
+/* called from the worker thread, and the client is only set back to idle when
+ * the last of any concurrent transfers is complete */
+static void
+fwupd_client_curl_helper_finished (FwupdCurlHelper *helper)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (helper->self);
+	gboolean idle;
+
+	g_mutex_lock (&priv->transfers_mutex);
+	if (!g_ptr_array_remove (priv->transfers, helper)) {
+		g_mutex_unlock (&priv->transfers_mutex);
+		return;
+	}
+	idle = priv->transfers->len == 0;
+	g_mutex_unlock (&priv->transfers_mutex);
+	if (idle)
+		fwupd_client_progress_invoke (helper, FWUPD_STATUS_IDLE, 0);
+}
+
+static void
+fwupd_client_curl_helper_free (FwupdCurlHelper *helper)
+{
+	fwupd_client_curl_helper_finished (helper);
+	if (helper->curl != NULL)
+		curl_easy_cleanup (helper->curl);
+#ifdef HAVE_LIBCURL_7_56_0
+	if (helper->mime != NULL)
+		curl_mime_free (helper->mime);
+#endif
+	if (helper->headers != NULL)
+		curl_slist_free_all (helper->headers);
+	g_main_context_unref (helper->context);
+	g_object_unref (helper->self);
+	g_free (helper);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdCurlHelper, fwupd_client_curl_helper_free)
+
 static void
 fwupd_client_properties_changed_cb (GDBusProxy *proxy,
 				    GVariant *changed_properties,
@@ -243,6 +339,68 @@ fwupd_client_properties_changed_cb (GDBusProxy *proxy,
 	}
 }
 
+static gint
+fwupd_client_cached_devices_find (GPtrArray *devices, FwupdDevice *dev)
+{
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev_tmp = g_ptr_array_index (devices, i);
+		if (g_strcmp0 (fwupd_device_get_id (dev_tmp), fwupd_device_get_id (dev)) == 0)
+			return (gint) i;
+	}
+	return -1;
+}
+
+/* keep the device model current without calling GetDevices again; signals
+ * that arrive before the GetDevices reply are already included in it, but
+ * the ones after it have to be applied even if GetRemotes is still pending */
+static void
+fwupd_client_cached_devices_update (FwupdClient *self,
+				    FwupdDevice *dev,
+				    gboolean removed)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	GPtrArray *devices = priv->cached_devices;
+	gint idx;
+
+	if (devices == NULL)
+		devices = priv->loading_devices;
+	if (devices == NULL)
+		return;
+	idx = fwupd_client_cached_devices_find (devices, dev);
+	if (removed) {
+		if (idx >= 0)
+			g_ptr_array_remove_index (devices, (guint) idx);
+		return;
+	}
+	if (idx >= 0) {
+		g_object_unref (g_ptr_array_index (devices, idx));
+		devices->pdata[idx] = g_object_ref (dev);
+		return;
+	}
+	g_ptr_array_add (devices, g_object_ref (dev));
+}
+
+static void
+fwupd_client_cached_remotes_cb (GObject *source,
+				GAsyncResult *res,
+				gpointer user_data)
+{
+	FwupdClient *self = FWUPD_CLIENT (source);
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) remotes = NULL;
+
+	remotes = fwupd_client_get_remotes_finish (self, res, &error);
+	if (remotes == NULL) {
+		g_debug ("failed to refresh cached remotes: %s", error->message);
+		return;
+	}
+	if (priv->cached_remotes != NULL) {
+		g_ptr_array_unref (priv->cached_remotes);
+		priv->cached_remotes = g_steal_pointer (&remotes);
+	}
+}
+
 static void
 fwupd_client_signal_cb (GDBusProxy *proxy,
 			const gchar *sender_name,
@@ -250,14 +408,24 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 			GVariant *parameters,
 			FwupdClient *self)
 {
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
 	g_autoptr(FwupdDevice) dev = NULL;
 	if (g_strcmp0 (signal_name, "Changed") == 0) {
+		/* there is no signal for each remote, but there are only a few */
+		if (priv->cached_remotes != NULL) {
+			fwupd_client_get_remotes_async (self, NULL,
+							fwupd_client_cached_remotes_cb,
+							NULL);
+		} else if (priv->loading_remotes != NULL) {
+			priv->loading_remotes_stale = TRUE;
+		}
 		g_debug ("Emitting ::changed()");
 		g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
 		return;
 	}
 	if (g_strcmp0 (signal_name, "DeviceAdded") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cached_devices_update (self, dev, FALSE);
 		g_debug ("Emitting ::device-added(%s)",
 			 fwupd_device_get_id (dev));
 		g_signal_emit (self, signals[SIGNAL_DEVICE_ADDED], 0, dev);
@@ -265,6 +433,7 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	}
 	if (g_strcmp0 (signal_name, "DeviceRemoved") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cached_devices_update (self, dev, TRUE);
 		g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, dev);
 		g_debug ("Emitting ::device-removed(%s)",
 			 fwupd_device_get_id (dev));
@@ -272,6 +441,7 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	}
 	if (g_strcmp0 (signal_name, "DeviceChanged") == 0) {
 		dev = fwupd_device_from_variant (parameters);
+		fwupd_client_cached_devices_update (self, dev, FALSE);
 		g_signal_emit (self, signals[SIGNAL_DEVICE_CHANGED], 0, dev);
 		g_debug ("Emitting ::device-changed(%s)",
 			 fwupd_device_get_id (dev));
@@ -280,6 +450,233 @@ fwupd_client_signal_cb (GDBusProxy *proxy,
 	g_debug ("Unknown signal name '%s' from %s", signal_name, sender_name);
 }
 
+typedef struct {
+	GPtrArray	*devices;
+	GPtrArray	*remotes;
+	GError		*error;
+	guint		 pending;
+} FwupdClientLoadCacheData;
+
+static void
+fwupd_client_load_cache_data_free (FwupdClientLoadCacheData *data)
+{
+	if (data->devices != NULL)
+		g_ptr_array_unref (data->devices);
+	if (data->remotes != NULL)
+		g_ptr_array_unref (data->remotes);
+	if (data->error != NULL)
+		g_error_free (data->error);
+	g_free (data);
+}
+
+static void
+fwupd_client_load_cache_done (GTask *task)
+{
+	FwupdClientLoadCacheData *data = g_task_get_task_data (task);
+	FwupdClient *self = g_task_get_source_object (task);
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+
+	if (--data->pending > 0)
+		return;
+	g_clear_pointer (&priv->loading_devices, g_ptr_array_unref);
+	g_clear_pointer (&priv->loading_remotes, g_ptr_array_unref);
+	if (data->error != NULL) {
+		priv->loading_remotes_stale = FALSE;
+		g_task_return_error (task, g_steal_pointer (&data->error));
+		return;
+	}
+
+	/* from now on the signals keep these up to date */
+	g_clear_pointer (&priv->cached_devices, g_ptr_array_unref);
+	g_clear_pointer (&priv->cached_remotes, g_ptr_array_unref);
+	priv->cached_devices = g_steal_pointer (&data->devices);
+	priv->cached_remotes = g_steal_pointer (&data->remotes);
+
+	/* the remotes changed after they were loaded */
+	if (priv->loading_remotes_stale) {
+		priv->loading_remotes_stale = FALSE;
+		fwupd_client_get_remotes_async (self, NULL,
+						fwupd_client_cached_remotes_cb,
+						NULL);
+	}
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+fwupd_client_load_cache_devices_cb (GObject *source,
+				    GAsyncResult *res,
+				    gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientLoadCacheData *data = g_task_get_task_data (task);
+	g_autoptr(GError) error = NULL;
+
+	data->devices = fwupd_client_get_devices_finish (FWUPD_CLIENT (source), res, &error);
+	if (data->devices == NULL && data->error == NULL)
+		data->error = g_steal_pointer (&error);
+	if (data->devices != NULL) {
+		FwupdClientPrivate *priv = GET_PRIVATE (FWUPD_CLIENT (source));
+		g_clear_pointer (&priv->loading_devices, g_ptr_array_unref);
+		priv->loading_devices = g_ptr_array_ref (data->devices);
+	}
+	fwupd_client_load_cache_done (task);
+}
+
+static void
+fwupd_client_load_cache_remotes_cb (GObject *source,
+				    GAsyncResult *res,
+				    gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientLoadCacheData *data = g_task_get_task_data (task);
+	g_autoptr(GError) error = NULL;
+
+	data->remotes = fwupd_client_get_remotes_finish (FWUPD_CLIENT (source), res, &error);
+	if (data->remotes == NULL && data->error == NULL)
+		data->error = g_steal_pointer (&error);
+	if (data->remotes != NULL) {
+		FwupdClientPrivate *priv = GET_PRIVATE (FWUPD_CLIENT (source));
+		g_clear_pointer (&priv->loading_remotes, g_ptr_array_unref);
+		priv->loading_remotes = g_ptr_array_ref (data->remotes);
+	}
+	fwupd_client_load_cache_done (task);
+}
+
+/**
+ * fwupd_client_load_cache_async:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the devices and remotes from the daemon, and then keeps them up to
+ * date using the signals from the daemon. This allows long-running clients to
+ * use fwupd_client_get_cached_devices() and fwupd_client_get_cached_remotes()
+ * rather than calling into the daemon each time.
+ *
+ * Any signals received while the cache is loading are also applied, although
+ * the #FwupdClient::device-added, #FwupdClient::device-removed and
+ * #FwupdClient::device-changed signals are emitted before the cache is
+ * available.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_client_load_cache_async (FwupdClient *self,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientLoadCacheData *data;
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* both requests are in flight at the same time */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	data = g_new0 (FwupdClientLoadCacheData, 1);
+	data->pending = 2;
+	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_load_cache_data_free);
+	fwupd_client_get_devices_async (self, cancellable,
+					fwupd_client_load_cache_devices_cb,
+					g_object_ref (task));
+	fwupd_client_get_remotes_async (self, cancellable,
+					fwupd_client_load_cache_remotes_cb,
+					g_object_ref (task));
+}
+
+/**
+ * fwupd_client_load_cache_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_load_cache_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fwupd_client_load_cache_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean (G_TASK(res), error);
+}
+
+/**
+ * fwupd_client_get_cached_devices:
+ * @self: A #FwupdClient
+ *
+ * Gets the devices from the cache populated by fwupd_client_load_cache_async().
+ *
+ * Returns: (element-type FwupdDevice) (transfer none) (nullable): devices, or
+ * %NULL if the cache has not been loaded
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_cached_devices (FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	return priv->cached_devices;
+}
+
+/**
+ * fwupd_client_get_cached_device_by_id:
+ * @self: A #FwupdClient
+ * @device_id: the device ID, e.g. `usb:00:01:03:03`
+ *
+ * Gets a device from the cache populated by fwupd_client_load_cache_async().
+ *
+ * Returns: (transfer none) (nullable): a #FwupdDevice, or %NULL if not found
+ *
+ * Since: 1.5.5
+ **/
+FwupdDevice *
+fwupd_client_get_cached_device_by_id (FwupdClient *self, const gchar *device_id)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (device_id != NULL, NULL);
+	if (priv->cached_devices == NULL)
+		return NULL;
+	for (guint i = 0; i < priv->cached_devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (priv->cached_devices, i);
+		if (g_strcmp0 (fwupd_device_get_id (dev), device_id) == 0)
+			return dev;
+	}
+	return NULL;
+}
+
+/**
+ * fwupd_client_get_cached_remotes:
+ * @self: A #FwupdClient
+ *
+ * Gets the remotes from the cache populated by fwupd_client_load_cache_async().
+ *
+ * Returns: (element-type FwupdRemote) (transfer none) (nullable): remotes, or
+ * %NULL if the cache has not been loaded
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_cached_remotes (FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	return priv->cached_remotes;
+}
+
 /**
  * fwupd_client_get_main_context:
  * @self: A #FwupdClient
@@ -368,19 +765,36 @@ fwupd_client_progress_callback_cb (void *clientp,
 				   curl_off_t ultotal,
 				   curl_off_t ulnow)
 {
-	FwupdClient *self = FWUPD_CLIENT (clientp);
+	FwupdCurlHelper *helper = (FwupdCurlHelper *) clientp;
+	FwupdClientPrivate *priv = GET_PRIVATE (helper->self);
+	guint percentage;
+	guint total = 0;
 
 	/* calculate percentage */
 	if (dltotal > 0 && dlnow >= 0 && dlnow <= dltotal) {
-		guint percentage = (guint) ((100 * dlnow) / dltotal);
-		g_debug ("download progress: %u%%", percentage);
-		fwupd_client_set_percentage (self, percentage);
+		percentage = (guint) ((100 * dlnow) / dltotal);
 	} else if (ultotal > 0 && ulnow >= 0 && ulnow <= ultotal) {
-		guint percentage = (guint) ((100 * ulnow) / ultotal);
-		g_debug ("upload progress: %u%%", percentage);
-		fwupd_client_set_percentage (self, percentage);
+		percentage = (guint) ((100 * ulnow) / ultotal);
+	} else {
+		return 0;
 	}
 
+	/* use the average of all the concurrent transfers */
+	g_mutex_lock (&priv->transfers_mutex);
+	if (helper->percentage == percentage) {
+		g_mutex_unlock (&priv->transfers_mutex);
+		return 0;
+	}
+	helper->percentage = percentage;
+	for (guint i = 0; i < priv->transfers->len; i++) {
+		FwupdCurlHelper *helper_tmp = g_ptr_array_index (priv->transfers, i);
+		total += helper_tmp->percentage;
+	}
+	if (priv->transfers->len > 0)
+		percentage = total / priv->transfers->len;
+	g_mutex_unlock (&priv->transfers_mutex);
+	g_debug ("transfer progress: %u%%", percentage);
+	fwupd_client_progress_invoke (helper, FWUPD_STATUS_UNKNOWN, percentage);
 	return 0;
 }
 
@@ -391,6 +805,10 @@ fwupd_client_curl_new (FwupdClient *self, GError **error)
 	const gchar *http_proxy;
 	g_autoptr(FwupdCurlHelper) helper = g_new0 (FwupdCurlHelper, 1);
 
+	/* progress is reported in the context the transfer was started from */
+	helper->self = g_object_ref (self);
+	helper->context = g_main_context_ref_thread_default ();
+
 	/* check the user agent is sane */
 	if (!fwupd_client_ensure_networking (self, error))
 		return NULL;
@@ -406,8 +824,9 @@ fwupd_client_curl_new (FwupdClient *self, GError **error)
 	}
 	if (g_getenv ("FWUPD_CURL_VERBOSE") != NULL)
 		curl_easy_setopt (helper->curl, CURLOPT_VERBOSE, 1L);
+	curl_easy_setopt (helper->curl, CURLOPT_NOPROGRESS, 0L);
 	curl_easy_setopt (helper->curl, CURLOPT_XFERINFOFUNCTION, fwupd_client_progress_callback_cb);
-	curl_easy_setopt (helper->curl, CURLOPT_XFERINFODATA, self);
+	curl_easy_setopt (helper->curl, CURLOPT_XFERINFODATA, helper);
 	curl_easy_setopt (helper->curl, CURLOPT_USERAGENT, priv->user_agent);
 	curl_easy_setopt (helper->curl, CURLOPT_CONNECTTIMEOUT, 60L);
 
@@ -428,6 +847,11 @@ fwupd_client_curl_new (FwupdClient *self, GError **error)
 
 	/* this disables the double-compression of the firmware.xml.gz file */
 	curl_easy_setopt (helper->curl, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+
+	/* included in the progress until finished */
+	g_mutex_lock (&priv->transfers_mutex);
+	g_ptr_array_add (priv->transfers, helper);
+	g_mutex_unlock (&priv->transfers_mutex);
 	return g_steal_pointer (&helper);
 }
 
@@ -502,6 +926,15 @@ fwupd_client_connect_get_bus_cb (GObject *source,
 			  g_object_ref (task));
 }
 
+/* private, used by the sync wrappers to avoid running a loop for no reason */
+gboolean
+fwupd_client_get_connected (FwupdClient *self)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	return priv->proxy != NULL;
+}
+
 /**
  * fwupd_client_connect_async:
  * @self: A #FwupdClient
@@ -691,7 +1124,274 @@ fwupd_report_metadata_hash_from_variant (GVariant *value)
 		g_variant_get (data, "{&s&s}", &key, &val);
 		g_hash_table_insert (hash, g_strdup (key), g_strdup (val));
 	}
-	return hash;
+	return hash;
+}
+
+typedef struct {
+	gchar			*method_name;
+	GVariant		*parameters;	/* (nullable) */
+#ifdef HAVE_GIO_UNIX
+	GUnixFDList		*fd_list;	/* (nullable) */
+#endif
+	GVariantType		*reply_type;
+	gint			 timeout_msec;
+} FwupdClientCallFdData;
+
+static void
+fwupd_client_call_fd_data_free (FwupdClientCallFdData *data)
+{
+	if (data->parameters != NULL)
+		g_variant_unref (data->parameters);
+#ifdef HAVE_GIO_UNIX
+	if (data->fd_list != NULL)
+		g_object_unref (data->fd_list);
+#endif
+	g_variant_type_free (data->reply_type);
+	g_free (data->method_name);
+	g_free (data);
+}
+
+static void
+fwupd_client_call_fd_fallback_cb (GObject *source,
+				  GAsyncResult *res,
+				  gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	GVariant *val;
+
+#ifdef HAVE_GIO_UNIX
+	val = g_dbus_proxy_call_with_unix_fd_list_finish (G_DBUS_PROXY (source),
+							  NULL, res, &error);
+#else
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+#endif
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	g_task_return_pointer (task, val, (GDestroyNotify) g_variant_unref);
+}
+
+static void
+fwupd_client_call_fd_fallback (GTask *task)
+{
+	FwupdClient *self = g_task_get_source_object (task);
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientCallFdData *data = g_task_get_task_data (task);
+
+#ifdef HAVE_GIO_UNIX
+	g_dbus_proxy_call_with_unix_fd_list (priv->proxy, data->method_name,
+					     data->parameters,
+					     G_DBUS_CALL_FLAGS_NONE,
+					     data->timeout_msec,
+					     data->fd_list,
+					     g_task_get_cancellable (task),
+					     fwupd_client_call_fd_fallback_cb,
+					     g_object_ref (task));
+#else
+	g_dbus_proxy_call (priv->proxy, data->method_name,
+			   data->parameters,
+			   G_DBUS_CALL_FLAGS_NONE,
+			   data->timeout_msec,
+			   g_task_get_cancellable (task),
+			   fwupd_client_call_fd_fallback_cb,
+			   g_object_ref (task));
+#endif
+}
+
+#ifdef HAVE_GIO_UNIX
+/* maps the sealed memfd and deserializes the reply from it */
+static GVariant *
+fwupd_client_call_fd_parse (GVariant *val,
+			    GUnixFDList *fd_list,
+			    const GVariantType *reply_type,
+			    GError **error)
+{
+	gint fd;
+	gint32 idx = 0;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GMappedFile) mapped = NULL;
+
+	g_variant_get (val, "(h)", &idx);
+	if (fd_list == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "no file descriptors in reply");
+		return NULL;
+	}
+	fd = g_unix_fd_list_get (fd_list, idx, &error_local);
+	if (fd < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid file descriptor in reply: %s",
+			     error_local->message);
+		return NULL;
+	}
+#ifdef F_GET_SEALS
+	/* the mapping is only safe if the file cannot be changed under us */
+	if ((fcntl (fd, F_GET_SEALS) & (F_SEAL_SHRINK | F_SEAL_WRITE)) !=
+	    (F_SEAL_SHRINK | F_SEAL_WRITE)) {
+		close (fd);
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "file descriptor in reply is not sealed");
+		return NULL;
+	}
+#endif
+	mapped = g_mapped_file_new_from_fd (fd, FALSE, &error_local);
+	close (fd);
+	if (mapped == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to map reply: %s",
+			     error_local->message);
+		return NULL;
+	}
+	bytes = g_mapped_file_get_bytes (mapped);
+	return g_variant_ref_sink (g_variant_new_from_bytes (reply_type, bytes, FALSE));
+}
+
+static void
+fwupd_client_call_fd_cb (GObject *source,
+			 GAsyncResult *res,
+			 gpointer user_data)
+{
+	FwupdClientCallFdData *data;
+	FwupdClient *self;
+	FwupdClientPrivate *priv;
+	GVariant *val_fd;
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GUnixFDList) fd_list = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	data = g_task_get_task_data (task);
+	self = g_task_get_source_object (task);
+	priv = GET_PRIVATE (self);
+	val = g_dbus_proxy_call_with_unix_fd_list_finish (G_DBUS_PROXY (source),
+							  &fd_list, res, &error);
+	if (val == NULL) {
+		/* older daemon, so do not try again */
+		if (g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD)) {
+			g_debug ("%sFd not supported, falling back: %s",
+				 data->method_name, error->message);
+			priv->reply_fd_unsupported = TRUE;
+			fwupd_client_call_fd_fallback (task);
+			return;
+		}
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	val_fd = fwupd_client_call_fd_parse (val, fd_list, data->reply_type, &error);
+	if (val_fd == NULL) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	g_task_return_pointer (task, val_fd, (GDestroyNotify) g_variant_unref);
+}
+#endif
+
+static GTask *
+fwupd_client_call_fd_task_new (FwupdClient *self,
+			       const gchar *method_name,
+			       GVariant *parameters,
+			       const gchar *reply_type,
+			       gint timeout_msec,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data)
+{
+	FwupdClientCallFdData *data = g_new0 (FwupdClientCallFdData, 1);
+	GTask *task = g_task_new (self, cancellable, callback, callback_data);
+
+	data->method_name = g_strdup (method_name);
+	if (parameters != NULL)
+		data->parameters = g_variant_ref_sink (parameters);
+	data->reply_type = g_variant_type_new (reply_type);
+	data->timeout_msec = timeout_msec;
+	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_call_fd_data_free);
+	return task;
+}
+
+/* calls the method variant that returns the reply in a memfd if the daemon
+ * supports it, so that large replies are not copied by the bus */
+static void
+fwupd_client_call_fd_task_run (GTask *task)
+{
+#ifdef HAVE_GIO_UNIX
+	FwupdClient *self = g_task_get_source_object (task);
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientCallFdData *data = g_task_get_task_data (task);
+
+	if (!priv->reply_fd_unsupported) {
+		g_autofree gchar *method_name_fd = g_strdup_printf ("%sFd", data->method_name);
+		g_dbus_proxy_call_with_unix_fd_list (priv->proxy, method_name_fd,
+						     data->parameters,
+						     G_DBUS_CALL_FLAGS_NONE,
+						     data->timeout_msec,
+						     data->fd_list,
+						     g_task_get_cancellable (task),
+						     fwupd_client_call_fd_cb,
+						     task);
+		return;
+	}
+#endif
+	fwupd_client_call_fd_fallback (task);
+	g_object_unref (task);
+}
+
+static void
+fwupd_client_call_fd_async (FwupdClient *self,
+			    const gchar *method_name,
+			    GVariant *parameters,
+			    const gchar *reply_type,
+			    gint timeout_msec,
+			    GCancellable *cancellable,
+			    GAsyncReadyCallback callback,
+			    gpointer callback_data)
+{
+	GTask *task = fwupd_client_call_fd_task_new (self, method_name, parameters,
+						     reply_type, timeout_msec,
+						     cancellable, callback,
+						     callback_data);
+	fwupd_client_call_fd_task_run (task);
+}
+
+#ifdef HAVE_GIO_UNIX
+static void
+fwupd_client_call_fd_with_unix_fd_list_async (FwupdClient *self,
+					      const gchar *method_name,
+					      GVariant *parameters,
+					      GUnixFDList *fd_list,
+					      const gchar *reply_type,
+					      gint timeout_msec,
+					      GCancellable *cancellable,
+					      GAsyncReadyCallback callback,
+					      gpointer callback_data)
+{
+	FwupdClientCallFdData *data;
+	GTask *task = fwupd_client_call_fd_task_new (self, method_name, parameters,
+						     reply_type, timeout_msec,
+						     cancellable, callback,
+						     callback_data);
+	data = g_task_get_task_data (task);
+	data->fd_list = g_object_ref (fd_list);
+	fwupd_client_call_fd_task_run (task);
+}
+#endif
+
+static GVariant *
+fwupd_client_call_fd_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
 static void
@@ -703,9 +1403,8 @@ fwupd_client_get_report_metadata_cb (GObject *source,
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GVariant) val = NULL;
 
-	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	val = fwupd_client_call_fd_finish (FWUPD_CLIENT (source), res, &error);
 	if (val == NULL) {
-		fwupd_client_fixup_dbus_error (error);
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
@@ -745,12 +1444,11 @@ fwupd_client_get_report_metadata_async (FwupdClient *self,
 
 	/* call into daemon */
 	task = g_task_new (self, cancellable, callback, callback_data);
-	g_dbus_proxy_call (priv->proxy, "GetReportMetadata",
-			   NULL,
-			   G_DBUS_CALL_FLAGS_NONE,
-			   -1, cancellable,
-			   fwupd_client_get_report_metadata_cb,
-			   g_steal_pointer (&task));
+	fwupd_client_call_fd_async (self, "GetReportMetadata",
+				    NULL, "(a{ss})",
+				    -1, cancellable,
+				    fwupd_client_get_report_metadata_cb,
+				    g_steal_pointer (&task));
 }
 
 /**
@@ -937,9 +1635,8 @@ fwupd_client_get_history_cb (GObject *source,
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GVariant) val = NULL;
 
-	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	val = fwupd_client_call_fd_finish (FWUPD_CLIENT (source), res, &error);
 	if (val == NULL) {
-		fwupd_client_fixup_dbus_error (error);
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
@@ -977,11 +1674,11 @@ fwupd_client_get_history_async (FwupdClient *self, GCancellable *cancellable,
 
 	/* call into daemon */
 	task = g_task_new (self, cancellable, callback, callback_data);
-	g_dbus_proxy_call (priv->proxy, "GetHistory",
-			   NULL, G_DBUS_CALL_FLAGS_NONE,
-			   -1, cancellable,
-			   fwupd_client_get_history_cb,
-			   g_steal_pointer (&task));
+	fwupd_client_call_fd_async (self, "GetHistory",
+				    NULL, "(aa{sv})",
+				    -1, cancellable,
+				    fwupd_client_get_history_cb,
+				    g_steal_pointer (&task));
 }
 
 /**
@@ -1206,9 +1903,8 @@ fwupd_client_get_releases_cb (GObject *source,
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GVariant) val = NULL;
 
-	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	val = fwupd_client_call_fd_finish (FWUPD_CLIENT (source), res, &error);
 	if (val == NULL) {
-		fwupd_client_fixup_dbus_error (error);
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
@@ -1250,12 +1946,12 @@ fwupd_client_get_releases_async (FwupdClient *self, const gchar *device_id,
 
 	/* call into daemon */
 	task = g_task_new (self, cancellable, callback, callback_data);
-	g_dbus_proxy_call (priv->proxy, "GetReleases",
-			   g_variant_new ("(s)", device_id),
-			   G_DBUS_CALL_FLAGS_NONE,
-			   -1, cancellable,
-			   fwupd_client_get_releases_cb,
-			   g_steal_pointer (&task));
+	fwupd_client_call_fd_async (self, "GetReleases",
+				    g_variant_new ("(s)", device_id),
+				    "(aa{sv})",
+				    -1, cancellable,
+				    fwupd_client_get_releases_cb,
+				    g_steal_pointer (&task));
 }
 
 /**
@@ -1443,6 +2139,242 @@ fwupd_client_get_upgrades_finish (FwupdClient *self, GAsyncResult *res, GError *
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+typedef struct {
+	GPtrArray	*results;	/* (element-type GVariant) (nullable) */
+	GError		*error;
+	guint		 pending;
+} FwupdClientBatchData;
+
+typedef struct {
+	GTask		*task;
+	guint		 idx;
+} FwupdClientBatchItem;
+
+static void
+fwupd_client_batch_data_free (FwupdClientBatchData *data)
+{
+	if (data->error != NULL)
+		g_error_free (data->error);
+	g_ptr_array_unref (data->results);
+	g_free (data);
+}
+
+static void
+fwupd_client_batch_call_cb (GObject *source,
+			    GAsyncResult *res,
+			    gpointer user_data)
+{
+	FwupdClientBatchItem *item = (FwupdClientBatchItem *) user_data;
+	g_autoptr(GTask) task = item->task;
+	FwupdClientBatchData *data = g_task_get_task_data (task);
+	g_autoptr(GError) error = NULL;
+	GVariant *val;
+
+	/* an error from the daemon only applies to that device, e.g. if it has
+	 * no releases or was removed while the batch was in progress -- but a
+	 * local error such as being cancelled fails the batch as a whole */
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		gboolean is_remote = g_dbus_error_is_remote_error (error);
+		fwupd_client_fixup_dbus_error (error);
+		if (is_remote) {
+			g_debug ("ignoring batch result %u: %s", item->idx, error->message);
+		} else if (data->error == NULL) {
+			data->error = g_steal_pointer (&error);
+		}
+	} else {
+		g_ptr_array_index (data->results, item->idx) = val;
+	}
+	g_free (item);
+
+	/* wait for all the calls to complete */
+	if (--data->pending > 0)
+		return;
+	if (data->error != NULL) {
+		g_task_return_error (task, g_steal_pointer (&data->error));
+		return;
+	}
+	g_task_return_pointer (task,
+			       g_ptr_array_ref (data->results),
+			       (GDestroyNotify) g_ptr_array_unref);
+}
+
+/* sends the method call for each ID without waiting for the previous reply,
+ * so that the daemon can process the requests back-to-back */
+static void
+fwupd_client_batch_call_async (FwupdClient *self,
+			       const gchar *method,
+			       GPtrArray *ids,
+			       GCancellable *cancellable,
+			       GAsyncReadyCallback callback,
+			       gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	FwupdClientBatchData *data;
+	g_autoptr(GTask) task = NULL;
+
+	task = g_task_new (self, cancellable, callback, callback_data);
+	data = g_new0 (FwupdClientBatchData, 1);
+	data->results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_variant_unref);
+	g_ptr_array_set_size (data->results, ids->len);
+	data->pending = ids->len;
+	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_batch_data_free);
+	if (ids->len == 0) {
+		g_task_return_pointer (task,
+				       g_ptr_array_ref (data->results),
+				       (GDestroyNotify) g_ptr_array_unref);
+		return;
+	}
+	for (guint i = 0; i < ids->len; i++) {
+		const gchar *id = g_ptr_array_index (ids, i);
+		FwupdClientBatchItem *item = g_new0 (FwupdClientBatchItem, 1);
+		item->task = g_object_ref (task);
+		item->idx = i;
+		g_dbus_proxy_call (priv->proxy, method,
+				   g_variant_new ("(s)", id),
+				   G_DBUS_CALL_FLAGS_NONE,
+				   -1, cancellable,
+				   fwupd_client_batch_call_cb,
+				   item);
+	}
+}
+
+/* converts each reply into an array of releases, which may be empty */
+static GPtrArray *
+fwupd_client_batch_releases_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	GPtrArray *array;
+	g_autoptr(GPtrArray) results = NULL;
+
+	results = g_task_propagate_pointer (G_TASK(res), error);
+	if (results == NULL)
+		return NULL;
+	array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_ptr_array_unref);
+	for (guint i = 0; i < results->len; i++) {
+		GVariant *val = g_ptr_array_index (results, i);
+		if (val == NULL) {
+			g_ptr_array_add (array, g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref));
+			continue;
+		}
+		g_ptr_array_add (array, fwupd_release_array_from_variant (val));
+	}
+	return array;
+}
+
+/**
+ * fwupd_client_get_releases_batch_async:
+ * @self: A #FwupdClient
+ * @device_ids: (element-type utf8): the device IDs
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the releases for multiple devices. All the requests are sent to the
+ * daemon at the same time, rather than waiting for each reply in turn.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_client_get_releases_batch_async (FwupdClient *self,
+				       GPtrArray *device_ids,
+				       GCancellable *cancellable,
+				       GAsyncReadyCallback callback,
+				       gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (device_ids != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	fwupd_client_batch_call_async (self, "GetReleases", device_ids,
+				       cancellable, callback, callback_data);
+}
+
+/**
+ * fwupd_client_get_releases_batch_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_releases_batch_async().
+ *
+ * Returns: (element-type GPtrArray) (transfer container): an array of
+ * releases for each device ID, in the same order, which is empty if the
+ * device has no releases or the daemon returned an error for it
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_releases_batch_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return fwupd_client_batch_releases_finish (self, res, error);
+}
+
+/**
+ * fwupd_client_get_upgrades_batch_async:
+ * @self: A #FwupdClient
+ * @device_ids: (element-type utf8): the device IDs
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the upgrades for multiple devices. All the requests are sent to the
+ * daemon at the same time, rather than waiting for each reply in turn.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_client_get_upgrades_batch_async (FwupdClient *self,
+				       GPtrArray *device_ids,
+				       GCancellable *cancellable,
+				       GAsyncReadyCallback callback,
+				       gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (device_ids != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	fwupd_client_batch_call_async (self, "GetUpgrades", device_ids,
+				       cancellable, callback, callback_data);
+}
+
+/**
+ * fwupd_client_get_upgrades_batch_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_upgrades_batch_async().
+ *
+ * Returns: (element-type GPtrArray) (transfer container): an array of
+ * releases for each device ID, in the same order, which is empty if the
+ * device has no upgrades or the daemon returned an error for it
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fwupd_client_get_upgrades_batch_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return fwupd_client_batch_releases_finish (self, res, error);
+}
+
 static void
 fwupd_client_modify_config_cb (GObject *source,
 			       GAsyncResult *res,
@@ -2255,86 +3187,381 @@ fwupd_client_install_finish (FwupdClient *self, GAsyncResult *res, GError **erro
 typedef struct {
 	FwupdDevice		*device;
 	FwupdRelease		*release;
+	GFile			*file;		/* (nullable) */
+	gchar			*url;		/* (nullable) */
+	gchar			*checksum_expected; /* (nullable) */
+	gboolean		 downloaded;
 	FwupdInstallFlags	 install_flags;
 } FwupdClientInstallReleaseData;
 
 static void
-fwupd_client_install_release_data_free (FwupdClientInstallReleaseData *data)
-{
-	g_object_unref (data->device);
-	g_object_unref (data->release);
-	g_free (data);
-}
+fwupd_client_install_release_data_free (FwupdClientInstallReleaseData *data)
+{
+	g_object_unref (data->device);
+	g_object_unref (data->release);
+	if (data->file != NULL)
+		g_object_unref (data->file);
+	g_free (data->url);
+	g_free (data->checksum_expected);
+	g_free (data);
+}
+
+static void
+fwupd_client_install_release_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK (user_data);
+
+	if (!fwupd_client_install_release_finish (FWUPD_CLIENT (source), res, &error)) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_boolean (task, TRUE);
+}
+
+/* shared by all users if the administrator has made it writable */
+static gchar *
+fwupd_client_get_firmware_cache_dir (void)
+{
+	const gchar *root = g_get_user_cache_dir ();
+	g_autofree gchar *cachedir_system = NULL;
+
+	cachedir_system = g_build_filename (FWUPD_LOCALSTATEDIR, "cache", "fwupd", "firmware", NULL);
+	if (g_access (cachedir_system, W_OK) == 0)
+		return g_steal_pointer (&cachedir_system);
+
+	/* if run from a systemd unit, use the cache directory set there */
+	if (g_getenv ("CACHE_DIRECTORY") != NULL)
+		root = g_getenv ("CACHE_DIRECTORY");
+	return g_build_filename (root, "fwupd", "firmware", NULL);
+}
+
+#ifdef HAVE_GIO_UNIX
+static void
+fwupd_client_install_release_file_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK (user_data);
+
+	if (!fwupd_client_install_finish (FWUPD_CLIENT (source), res, &error)) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_boolean (task, TRUE);
+}
+
+/* the modification time is used as the last-used time */
+static void
+fwupd_client_firmware_cache_touch (GFile *file)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (!g_file_set_attribute_uint64 (file,
+					  G_FILE_ATTRIBUTE_TIME_MODIFIED,
+					  (guint64) (g_get_real_time () / G_USEC_PER_SEC),
+					  G_FILE_QUERY_INFO_NONE,
+					  NULL, &error_local))
+		g_debug ("failed to update mtime: %s", error_local->message);
+}
+
+static gint
+fwupd_client_firmware_cache_sort_cb (gconstpointer a, gconstpointer b)
+{
+	GFileInfo *info1 = *((GFileInfo **) a);
+	GFileInfo *info2 = *((GFileInfo **) b);
+	guint64 mtime1 = g_file_info_get_attribute_uint64 (info1, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	guint64 mtime2 = g_file_info_get_attribute_uint64 (info2, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	if (mtime1 < mtime2)
+		return -1;
+	if (mtime1 > mtime2)
+		return 1;
+	return 0;
+}
+
+/* remove the least recently used firmware until the cache is small enough */
+static void
+fwupd_client_firmware_cache_prune (GFile *file_keep)
+{
+	GFileInfo *info_tmp;
+	guint64 total = 0;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFile) dir = g_file_get_parent (file_keep);
+	g_autoptr(GFileEnumerator) enumerator = NULL;
+	g_autofree gchar *basename_keep = g_file_get_basename (file_keep);
+	g_autoptr(GPtrArray) infos = NULL;
+
+	enumerator = g_file_enumerate_children (dir,
+						G_FILE_ATTRIBUTE_STANDARD_NAME ","
+						G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+						G_FILE_ATTRIBUTE_TIME_MODIFIED,
+						G_FILE_QUERY_INFO_NONE,
+						NULL, &error_local);
+	if (enumerator == NULL) {
+		g_debug ("failed to prune cache: %s", error_local->message);
+		return;
+	}
+	infos = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	while ((info_tmp = g_file_enumerator_next_file (enumerator, NULL, NULL)) != NULL) {
+		if (!g_str_has_suffix (g_file_info_get_name (info_tmp), ".cab")) {
+			g_object_unref (info_tmp);
+			continue;
+		}
+		total += g_file_info_get_size (info_tmp);
+		g_ptr_array_add (infos, info_tmp);
+	}
+	g_ptr_array_sort (infos, fwupd_client_firmware_cache_sort_cb);
+	for (guint i = 0; i < infos->len && total > FWUPD_CLIENT_FIRMWARE_CACHE_SIZE_MAX; i++) {
+		GFileInfo *info = g_ptr_array_index (infos, i);
+		const gchar *basename = g_file_info_get_name (info);
+		g_autoptr(GFile) file = NULL;
+		g_autoptr(GError) error_delete = NULL;
+		if (g_strcmp0 (basename, basename_keep) == 0)
+			continue;
+		file = g_file_get_child (dir, basename);
+		if (!g_file_delete (file, NULL, &error_delete)) {
+			g_debug ("failed to delete %s: %s", basename, error_delete->message);
+			continue;
+		}
+		g_debug ("removed %s from the firmware cache", basename);
+		total -= g_file_info_get_size (info);
+	}
+}
+
+static void
+fwupd_client_install_release_stream (FwupdClient *self,
+				     GUnixInputStream *istr,
+				     GTask *task_in)
+{
+	g_autoptr(GTask) task = task_in;
+	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
+	GCancellable *cancellable = g_task_get_cancellable (task);
+
+	/* if the device specifies ONLY_OFFLINE automatically set this flag */
+	if (fwupd_device_has_flag (data->device, FWUPD_DEVICE_FLAG_ONLY_OFFLINE))
+		data->install_flags |= FWUPD_INSTALL_FLAG_OFFLINE;
+
+	/* pass the same file descriptor that was verified to the daemon */
+	fwupd_client_install_stream_async (self,
+					   fwupd_device_get_id (data->device),
+					   istr, NULL,
+					   data->install_flags,
+					   cancellable,
+					   fwupd_client_install_release_file_cb,
+					   g_steal_pointer (&task));
+}
+
+/* returns %FALSE with no error set if the checksum did not match */
+static gboolean
+fwupd_client_firmware_cache_verify (GUnixInputStream *istr,
+				    const gchar *checksum_expected,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	gsize bufsz = 32 * 1024;
+	const gchar *checksum_actual;
+	g_autofree guint8 *buf = NULL;
+	g_autoptr(GChecksum) checksum = NULL;
+
+	buf = g_malloc (bufsz);
+	checksum = g_checksum_new (fwupd_checksum_guess_kind (checksum_expected));
+	for (;;) {
+		gssize sz = g_input_stream_read (G_INPUT_STREAM (istr), buf, bufsz,
+						 cancellable, error);
+		if (sz < 0)
+			return FALSE;
+		if (sz == 0)
+			break;
+		g_checksum_update (checksum, buf, (gsize) sz);
+	}
+	checksum_actual = g_checksum_get_string (checksum);
+	if (g_strcmp0 (checksum_expected, checksum_actual) != 0) {
+		g_debug ("expected %s got %s", checksum_expected, checksum_actual);
+		return FALSE;
+	}
+
+	/* the daemon reads the file descriptor from the current offset */
+	if (lseek (g_unix_input_stream_get_fd (istr), 0, SEEK_SET) < 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to rewind: %s",
+			     g_strerror (errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* opens the cached file once, so the file that was hashed is the file that
+ * is sent to the daemon even if the path is replaced in the meantime */
+static void
+fwupd_client_install_release_cache_thread_cb (GTask *task,
+					      gpointer source_object,
+					      gpointer task_data,
+					      GCancellable *cancellable)
+{
+	GTask *task_parent = G_TASK (task_data);
+	FwupdClientInstallReleaseData *data = g_task_get_task_data (task_parent);
+	gint fd;
+	g_autofree gchar *fn = g_file_get_path (data->file);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GUnixInputStream) istr = NULL;
+
+	fd = g_open (fn, O_RDONLY, 0);
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			g_task_return_pointer (task, NULL, NULL);
+			return;
+		}
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "failed to open %s: %s",
+					 fn, g_strerror (errno));
+		return;
+	}
+	istr = G_UNIX_INPUT_STREAM (g_unix_input_stream_new (fd, TRUE));
+	if (!fwupd_client_firmware_cache_verify (istr, data->checksum_expected,
+						 cancellable, &error)) {
+		if (error != NULL) {
+			g_task_return_error (task, g_steal_pointer (&error));
+			return;
+		}
+		g_warning ("%s is corrupt, removing", fn);
+		if (!g_file_delete (data->file, NULL, &error)) {
+			g_task_return_error (task, g_steal_pointer (&error));
+			return;
+		}
+		g_task_return_pointer (task, NULL, NULL);
+		return;
+	}
+	fwupd_client_firmware_cache_touch (data->file);
+	g_task_return_pointer (task, g_steal_pointer (&istr), (GDestroyNotify) g_object_unref);
+}
+
+static void
+fwupd_client_install_release_download_cb (GObject *source, GAsyncResult *res, gpointer user_data);
 
 static void
-fwupd_client_install_release_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+fwupd_client_install_release_cache_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
+	FwupdClient *self = FWUPD_CLIENT (source);
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GUnixInputStream) istr = NULL;
+	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
+	GCancellable *cancellable = g_task_get_cancellable (task);
 
-	if (!fwupd_client_install_release_finish (FWUPD_CLIENT (source), res, &error)) {
+	/* already downloaded by this or another client, and verified */
+	istr = g_task_propagate_pointer (G_TASK (res), &error);
+	if (istr != NULL) {
+		g_autofree gchar *fn = g_file_get_path (data->file);
+		g_debug ("using %s from the firmware cache", fn);
+		fwupd_client_install_release_stream (self, istr, g_steal_pointer (&task));
+		return;
+	}
+	if (error != NULL) {
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
 
-	/* success */
-	g_task_return_boolean (task, TRUE);
+	/* the file was replaced after it was downloaded */
+	if (data->downloaded) {
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "checksum of downloaded file did not match %s",
+					 data->checksum_expected);
+		return;
+	}
+	fwupd_client_download_file_full_async (self, data->url, data->file,
+					       data->checksum_expected,
+					       FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME,
+					       cancellable,
+					       fwupd_client_install_release_download_cb,
+					       g_steal_pointer (&task));
+}
+
+static void
+fwupd_client_install_release_cache (FwupdClient *self, GTask *task_in)
+{
+	g_autoptr(GTask) task_verify = NULL;
+	GCancellable *cancellable = g_task_get_cancellable (task_in);
+
+	/* the cache directory may be shared and writable by other users, so
+	 * the contents are always verified rather than trusting the filename */
+	task_verify = g_task_new (self, cancellable,
+				  fwupd_client_install_release_cache_cb,
+				  task_in);
+	g_task_set_task_data (task_verify, task_in, NULL);
+	g_task_run_in_thread (task_verify, fwupd_client_install_release_cache_thread_cb);
 }
 
 static void
-fwupd_client_install_release_bytes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+fwupd_client_install_release_download_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
 
-	if (!fwupd_client_install_bytes_finish (FWUPD_CLIENT (source), res, &error)) {
+	if (!fwupd_client_download_file_finish (FWUPD_CLIENT (source), res, &error)) {
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
+	fwupd_client_firmware_cache_prune (data->file);
 
-	/* success */
-	g_task_return_boolean (task, TRUE);
+	/* open and hash again, rather than installing by path */
+	data->downloaded = TRUE;
+	fwupd_client_install_release_cache (FWUPD_CLIENT (source), g_steal_pointer (&task));
 }
+#endif
 
 static void
-fwupd_client_install_release_download_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+fwupd_client_install_release_download (FwupdClient *self,
+				       const gchar *url,
+				       GTask *task_in)
 {
-	g_autoptr(GBytes) blob = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GTask) task = task_in;
 	FwupdClientInstallReleaseData *data = g_task_get_task_data (task);
-	GChecksumType checksum_type;
-	GCancellable *cancellable = g_task_get_cancellable (task);
 	const gchar *checksum_expected;
-	g_autofree gchar *checksum_actual = NULL;
+	g_autofree gchar *basename = NULL;
+	g_autofree gchar *cachedir = NULL;
+	g_autofree gchar *fn = NULL;
 
-	blob = fwupd_client_download_bytes_finish (FWUPD_CLIENT (source), res, &error);
-	if (blob == NULL) {
-		g_task_return_error (task, g_steal_pointer (&error));
+	/* the cache is content-addressed, so the checksum is used as the filename */
+	checksum_expected = fwupd_checksum_get_best (fwupd_release_get_checksums (data->release));
+	if (checksum_expected == NULL) {
+		g_task_return_new_error (task,
+					 FWUPD_ERROR,
+					 FWUPD_ERROR_INVALID_FILE,
+					 "no checksum for release %s",
+					 fwupd_release_get_version (data->release));
 		return;
 	}
-
-	/* verify checksum */
-	checksum_expected = fwupd_checksum_get_best (fwupd_release_get_checksums (data->release));
-	checksum_type = fwupd_checksum_guess_kind (checksum_expected);
-	checksum_actual = g_compute_checksum_for_bytes (checksum_type, blob);
-	if (g_strcmp0 (checksum_expected, checksum_actual) != 0) {
+	cachedir = fwupd_client_get_firmware_cache_dir ();
+	if (g_mkdir_with_parents (cachedir, 0755) < 0) {
 		g_task_return_new_error (task,
 					 FWUPD_ERROR,
 					 FWUPD_ERROR_INVALID_FILE,
-					 "checksum invalid, expected %s got %s",
-					 checksum_expected, checksum_actual);
+					 "failed to create %s",
+					 cachedir);
 		return;
 	}
-
-	/* if the device specifies ONLY_OFFLINE automatically set this flag */
-	if (fwupd_device_has_flag (data->device, FWUPD_DEVICE_FLAG_ONLY_OFFLINE))
-		data->install_flags |= FWUPD_INSTALL_FLAG_OFFLINE;
-	fwupd_client_install_bytes_async (FWUPD_CLIENT (source),
-					  fwupd_device_get_id (data->device), blob,
-					  data->install_flags, cancellable,
-					  fwupd_client_install_release_bytes_cb,
-					  g_steal_pointer (&task));
+	basename = g_strdup_printf ("%s.cab", checksum_expected);
+	fn = g_build_filename (cachedir, basename, NULL);
+	data->file = g_file_new_for_path (fn);
+	data->url = g_strdup (url);
+	data->checksum_expected = g_strdup (checksum_expected);
+#ifdef HAVE_GIO_UNIX
+	fwupd_client_install_release_cache (self, g_steal_pointer (&task));
+#else
+	g_task_return_new_error (task,
+				 FWUPD_ERROR,
+				 FWUPD_ERROR_NOT_SUPPORTED,
+				 "Not supported as <glib-unix.h> is unavailable");
+#endif
 }
 
 static gboolean
@@ -2398,11 +3625,8 @@ fwupd_client_install_release_remote_cb (GObject *source, GAsyncResult *res, gpoi
 	}
 
 	/* download file */
-	fwupd_client_download_bytes_async (FWUPD_CLIENT (source), uri_str,
-					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
-					   cancellable,
-					   fwupd_client_install_release_download_cb,
-					   g_steal_pointer (&task));
+	fwupd_client_install_release_download (FWUPD_CLIENT (source), uri_str,
+					       g_steal_pointer (&task));
 }
 
 /**
@@ -2450,12 +3674,9 @@ fwupd_client_install_release_async (FwupdClient *self,
 	/* work out what remote-specific URI fields this should use */
 	remote_id = fwupd_release_get_remote_id (release);
 	if (remote_id == NULL) {
-		fwupd_client_download_bytes_async (self,
-						   fwupd_release_get_uri (release),
-						   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
-						   cancellable,
-						   fwupd_client_install_release_download_cb,
-						   g_steal_pointer (&task));
+		fwupd_client_install_release_download (self,
+						       fwupd_release_get_uri (release),
+						       g_steal_pointer (&task));
 		return;
 	}
 
@@ -2491,26 +3712,19 @@ fwupd_client_install_release_finish (FwupdClient *self, GAsyncResult *res, GErro
 static void
 fwupd_client_get_details_stream_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
-	g_autoptr(GDBusMessage) msg = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GVariant) val = NULL;
 
-	msg = g_dbus_connection_send_message_with_reply_finish (G_DBUS_CONNECTION (source),
-								res, &error);
-	if (msg == NULL) {
-		fwupd_client_fixup_dbus_error (error);
-		g_task_return_error (task, g_steal_pointer (&error));
-		return;
-	}
-	if (g_dbus_message_to_gerror (msg, &error)) {
-		fwupd_client_fixup_dbus_error (error);
+	val = fwupd_client_call_fd_finish (FWUPD_CLIENT (source), res, &error);
+	if (val == NULL) {
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
 
 	/* success */
 	g_task_return_pointer (task,
-			       fwupd_device_array_from_variant (g_dbus_message_get_body (msg)),
+			       fwupd_device_array_from_variant (val),
 			       (GDestroyNotify) g_ptr_array_unref);
 }
 
@@ -2521,31 +3735,21 @@ fwupd_client_get_details_stream_async (FwupdClient *self,
 				       GAsyncReadyCallback callback,
 				       gpointer callback_data)
 {
-	FwupdClientPrivate *priv = GET_PRIVATE (self);
 	gint fd = g_unix_input_stream_get_fd (istr);
-	g_autoptr(GDBusMessage) request = NULL;
 	g_autoptr(GUnixFDList) fd_list = NULL;
 	g_autoptr(GTask) task = g_task_new (self, cancellable, callback, callback_data);
 
 	/* set out of band file descriptor */
 	fd_list = g_unix_fd_list_new ();
 	g_unix_fd_list_append (fd_list, fd, NULL);
-	request = g_dbus_message_new_method_call (FWUPD_DBUS_SERVICE,
-						  FWUPD_DBUS_PATH,
-						  FWUPD_DBUS_INTERFACE,
-						  "GetDetails");
-	g_dbus_message_set_unix_fd_list (request, fd_list);
 
 	/* call into daemon */
-	g_dbus_message_set_body (request, g_variant_new ("(h)", fd));
-	g_dbus_connection_send_message_with_reply (priv->conn,
-						   request,
-						   G_DBUS_SEND_MESSAGE_FLAGS_NONE,
-						   G_MAXINT,
-						   NULL,
-						   cancellable,
-						   fwupd_client_get_details_stream_cb,
-						   g_steal_pointer (&task));
+	fwupd_client_call_fd_with_unix_fd_list_async (self, "GetDetails",
+						      g_variant_new ("(h)", 0),
+						      fd_list, "(aa{sv})",
+						      G_MAXINT, cancellable,
+						      fwupd_client_get_details_stream_cb,
+						      g_steal_pointer (&task));
 }
 #endif
 
@@ -2920,6 +4124,7 @@ fwupd_client_update_metadata_bytes_finish (FwupdClient *self, GAsyncResult *res,
 typedef struct {
 	FwupdRemote	*remote;
 	GBytes		*signature;
+	GBytes		*signature_delta;
 	GBytes		*metadata;
 } FwupdClientRefreshRemoteData;
 
@@ -2928,6 +4133,8 @@ fwupd_client_refresh_remote_data_free (FwupdClientRefreshRemoteData *data)
 {
 	if (data->signature != NULL)
 		g_bytes_unref (data->signature);
+	if (data->signature_delta != NULL)
+		g_bytes_unref (data->signature_delta);
 	if (data->metadata != NULL)
 		g_bytes_unref (data->metadata);
 	g_object_unref (data->remote);
@@ -2982,6 +4189,133 @@ fwupd_client_refresh_remote_metadata_cb (GObject *source,
 						  g_steal_pointer (&task));
 }
 
+static void
+fwupd_client_refresh_remote_download_metadata (GTask *task)
+{
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data (task);
+	FwupdClient *self = g_task_get_source_object (task);
+	GCancellable *cancellable = g_task_get_cancellable (task);
+
+	fwupd_client_download_bytes_async (self,
+					   fwupd_remote_get_metadata_uri (data->remote),
+					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					   cancellable,
+					   fwupd_client_refresh_remote_metadata_cb,
+					   g_object_ref (task));
+}
+
+/* the delta is published next to the uncompressed metadata, e.g.
+ * firmware.xml.delta and firmware.xml.delta.jcat */
+static gchar *
+fwupd_client_refresh_remote_get_delta_uri (FwupdRemote *remote, const gchar *suffix)
+{
+	const gchar *uri = fwupd_remote_get_metadata_uri (remote);
+	if (g_str_has_suffix (uri, ".gz"))
+		return g_strdup_printf ("%.*s%s", (gint) (strlen (uri) - 3), uri, suffix);
+	return g_strdup_printf ("%s%s", uri, suffix);
+}
+
+static void
+fwupd_client_refresh_remote_delta_update_cb (GObject *source,
+					     GAsyncResult *res,
+					     gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data (task);
+
+	/* the daemon may be too old, or the delta is for different metadata */
+	if (!fwupd_client_update_metadata_bytes_finish (FWUPD_CLIENT (source), res, &error)) {
+		g_debug ("failed to apply metadata delta for %s, "
+			 "falling back to full download: %s",
+			 fwupd_remote_get_id (data->remote),
+			 error->message);
+		fwupd_client_refresh_remote_download_metadata (task);
+		return;
+	}
+
+	/* success */
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+fwupd_client_refresh_remote_delta_cb (GObject *source,
+				      GAsyncResult *res,
+				      gpointer user_data)
+{
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data (task);
+	FwupdClient *self = g_task_get_source_object (task);
+	GCancellable *cancellable = g_task_get_cancellable (task);
+
+	bytes = fwupd_client_download_bytes_finish (FWUPD_CLIENT (source), res, &error);
+	if (bytes == NULL) {
+		g_debug ("failed to download metadata delta for %s: %s",
+			 fwupd_remote_get_id (data->remote),
+			 error->message);
+		fwupd_client_refresh_remote_download_metadata (task);
+		return;
+	}
+
+	/* send the delta and the signature of the result to fwupd */
+	fwupd_client_update_metadata_bytes_async (self,
+						  fwupd_remote_get_id (data->remote),
+						  bytes,
+						  data->signature_delta,
+						  cancellable,
+						  fwupd_client_refresh_remote_delta_update_cb,
+						  g_steal_pointer (&task));
+}
+
+static void
+fwupd_client_refresh_remote_delta_signature_cb (GObject *source,
+						GAsyncResult *res,
+						gpointer user_data)
+{
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GTask) task = G_TASK (user_data);
+	FwupdClientRefreshRemoteData *data = g_task_get_task_data (task);
+	FwupdClient *self = g_task_get_source_object (task);
+	GCancellable *cancellable = g_task_get_cancellable (task);
+	GChecksumType checksum_kind;
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *uri = NULL;
+
+	/* not all remotes publish a delta */
+	bytes = fwupd_client_download_bytes_finish (FWUPD_CLIENT (source), res, &error);
+	if (bytes == NULL) {
+		g_debug ("no metadata delta for %s: %s",
+			 fwupd_remote_get_id (data->remote),
+			 error->message);
+		fwupd_client_refresh_remote_download_metadata (task);
+		return;
+	}
+
+	/* the last refresh already applied this delta */
+	checksum_kind = fwupd_checksum_guess_kind (fwupd_remote_get_checksum (data->remote));
+	checksum = g_compute_checksum_for_data (checksum_kind,
+						(const guchar *) g_bytes_get_data (bytes, NULL),
+						g_bytes_get_size (bytes));
+	if (g_strcmp0 (checksum, fwupd_remote_get_checksum (data->remote)) == 0) {
+		g_debug ("metadata delta of %s is unchanged, skipping",
+			 fwupd_remote_get_id (data->remote));
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+	data->signature_delta = g_steal_pointer (&bytes);
+
+	/* download delta */
+	uri = fwupd_client_refresh_remote_get_delta_uri (data->remote, ".delta");
+	fwupd_client_download_bytes_async (self, uri,
+					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+					   cancellable,
+					   fwupd_client_refresh_remote_delta_cb,
+					   g_steal_pointer (&task));
+}
+
 static void
 fwupd_client_refresh_remote_signature_cb (GObject *source,
 					  GAsyncResult *res,
@@ -2999,6 +4333,12 @@ fwupd_client_refresh_remote_signature_cb (GObject *source,
 	/* save signature */
 	bytes = fwupd_client_download_bytes_finish (FWUPD_CLIENT (source), res, &error);
 	if (bytes == NULL) {
+		if (g_error_matches (error, FWUPD_ERROR, FWUPD_ERROR_NOTHING_TO_DO)) {
+			g_debug ("metadata signature of %s is not modified, skipping",
+				 fwupd_remote_get_id (data->remote));
+			g_task_return_boolean (task, TRUE);
+			return;
+		}
 		g_task_return_error (task, g_steal_pointer (&error));
 		return;
 	}
@@ -3023,13 +4363,21 @@ fwupd_client_refresh_remote_signature_cb (GObject *source,
 		return;
 	}
 
+	/* try to only download the changes since the metadata we have */
+	if (fwupd_remote_get_keyring_kind (data->remote) == FWUPD_KEYRING_KIND_JCAT &&
+	    fwupd_remote_get_checksum (data->remote) != NULL) {
+		g_autofree gchar *uri = NULL;
+		uri = fwupd_client_refresh_remote_get_delta_uri (data->remote, ".delta.jcat");
+		fwupd_client_download_bytes_async (self, uri,
+						   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						   cancellable,
+						   fwupd_client_refresh_remote_delta_signature_cb,
+						   g_steal_pointer (&task));
+		return;
+	}
+
 	/* download metadata */
-	fwupd_client_download_bytes_async (self,
-					   fwupd_remote_get_metadata_uri (data->remote),
-					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
-					   cancellable,
-					   fwupd_client_refresh_remote_metadata_cb,
-					   g_steal_pointer (&task));
+	fwupd_client_refresh_remote_download_metadata (task);
 }
 
 /**
@@ -3051,44 +4399,186 @@ fwupd_client_refresh_remote_async (FwupdClient *self,
 				   GAsyncReadyCallback callback,
 				   gpointer callback_data)
 {
-	FwupdClientRefreshRemoteData *data;
+	FwupdClientRefreshRemoteData *data;
+	guint64 age = fwupd_remote_get_age (remote);
+	guint64 mtime = 0;
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (FWUPD_IS_REMOTE (remote));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	task = g_task_new (self, cancellable, callback, callback_data);
+	data = g_new0 (FwupdClientRefreshRemoteData, 1);
+	data->remote = g_object_ref (remote);
+	g_task_set_task_data (task,
+			      g_steal_pointer (&data),
+			      (GDestroyNotify) fwupd_client_refresh_remote_data_free);
+
+	/* only download the signature if it is newer than the local metadata */
+	if (fwupd_remote_get_checksum (remote) != NULL && age != G_MAXUINT64)
+		mtime = ((guint64) g_get_real_time () / G_USEC_PER_SEC) - age;
+	fwupd_client_download_bytes_full_async (self,
+						fwupd_remote_get_metadata_uri_sig (remote),
+						FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
+						mtime,
+						cancellable,
+						fwupd_client_refresh_remote_signature_cb,
+						g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_refresh_remote_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_refresh_remote_async().
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.0
+ **/
+gboolean
+fwupd_client_refresh_remote_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean (G_TASK(res), error);
+}
+
+typedef struct {
+	guint			 pending;
+	GError			*error;		/* (nullable): the first failure */
+} FwupdClientRefreshRemotesData;
+
+typedef struct {
+	GTask			*task;
+	FwupdRemote		*remote;
+	GTimer			*timer;
+} FwupdClientRefreshRemotesItem;
+
+static void
+fwupd_client_refresh_remotes_data_free (FwupdClientRefreshRemotesData *data)
+{
+	if (data->error != NULL)
+		g_error_free (data->error);
+	g_free (data);
+}
+
+static void
+fwupd_client_refresh_remotes_item_free (FwupdClientRefreshRemotesItem *item)
+{
+	g_object_unref (item->task);
+	g_object_unref (item->remote);
+	g_timer_destroy (item->timer);
+	g_free (item);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FwupdClientRefreshRemotesItem, fwupd_client_refresh_remotes_item_free)
+
+static void
+fwupd_client_refresh_remotes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(FwupdClientRefreshRemotesItem) item = user_data;
+	FwupdClientRefreshRemotesData *data = g_task_get_task_data (item->task);
+	g_autoptr(GError) error = NULL;
+
+	if (!fwupd_client_refresh_remote_finish (FWUPD_CLIENT (source), res, &error)) {
+		g_debug ("failed to refresh %s after %.0fms: %s",
+			 fwupd_remote_get_id (item->remote),
+			 g_timer_elapsed (item->timer, NULL) * 1000.f,
+			 error->message);
+		if (data->error == NULL) {
+			g_prefix_error (&error, "failed to refresh %s: ",
+					fwupd_remote_get_id (item->remote));
+			data->error = g_steal_pointer (&error);
+		}
+	} else {
+		g_debug ("refreshed %s in %.0fms",
+			 fwupd_remote_get_id (item->remote),
+			 g_timer_elapsed (item->timer, NULL) * 1000.f);
+	}
+
+	/* wait for the others */
+	if (--data->pending > 0)
+		return;
+	if (data->error != NULL) {
+		g_task_return_error (item->task, g_steal_pointer (&data->error));
+		return;
+	}
+	g_task_return_boolean (item->task, TRUE);
+}
+
+/**
+ * fwupd_client_refresh_remotes_async:
+ * @self: A #FwupdClient
+ * @remotes: (element-type FwupdRemote): remotes to refresh
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Refreshes multiple remotes at the same time by downloading new metadata.
+ * The signature of each remote is only downloaded if it has been modified
+ * since the metadata was last refreshed.
+ *
+ * All remotes are refreshed even if one fails, and the first error is
+ * returned. The percentage is the average progress of all the downloads, and
+ * is only updated in the thread-default main context of the caller.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_client_refresh_remotes_async (FwupdClient *self,
+				    GPtrArray *remotes,
+				    GCancellable *cancellable,
+				    GAsyncReadyCallback callback,
+				    gpointer callback_data)
+{
+	FwupdClientRefreshRemotesData *data;
 	g_autoptr(GTask) task = NULL;
 
 	g_return_if_fail (FWUPD_IS_CLIENT (self));
-	g_return_if_fail (FWUPD_IS_REMOTE (remote));
+	g_return_if_fail (remotes != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
 	task = g_task_new (self, cancellable, callback, callback_data);
-	data = g_new0 (FwupdClientRefreshRemoteData, 1);
-	data->remote = g_object_ref (remote);
-	g_task_set_task_data (task,
-			      g_steal_pointer (&data),
-			      (GDestroyNotify) fwupd_client_refresh_remote_data_free);
-
-	/* download signature */
-	fwupd_client_download_bytes_async (self,
-					   fwupd_remote_get_metadata_uri_sig (remote),
-					   FWUPD_CLIENT_DOWNLOAD_FLAG_NONE,
-					   cancellable,
-					   fwupd_client_refresh_remote_signature_cb,
-					   g_steal_pointer (&task));
+	if (remotes->len == 0) {
+		g_task_return_boolean (task, TRUE);
+		return;
+	}
+	data = g_new0 (FwupdClientRefreshRemotesData, 1);
+	data->pending = remotes->len;
+	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_refresh_remotes_data_free);
 
+	/* each download runs in its own thread */
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index (remotes, i);
+		FwupdClientRefreshRemotesItem *item = g_new0 (FwupdClientRefreshRemotesItem, 1);
+		item->task = g_object_ref (task);
+		item->remote = g_object_ref (remote);
+		item->timer = g_timer_new ();
+		fwupd_client_refresh_remote_async (self, remote, cancellable,
+						   fwupd_client_refresh_remotes_cb,
+						   item);
+	}
 }
 
 /**
- * fwupd_client_refresh_remote_finish:
+ * fwupd_client_refresh_remotes_finish:
  * @self: A #FwupdClient
  * @res: the #GAsyncResult
  * @error: the #GError, or %NULL
  *
- * Gets the result of fwupd_client_refresh_remote_async().
+ * Gets the result of fwupd_client_refresh_remotes_async().
  *
  * Returns: %TRUE for success
  *
- * Since: 1.5.0
+ * Since: 1.5.5
  **/
 gboolean
-fwupd_client_refresh_remote_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+fwupd_client_refresh_remotes_finish (FwupdClient *self, GAsyncResult *res, GError **error)
 {
 	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
 	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
@@ -4054,15 +5544,46 @@ fwupd_client_download_write_callback_cb (char *ptr, size_t size, size_t nmemb, v
 	return realsize;
 }
 
+static void
+fwupd_client_download_set_error (FwupdCurlHelper *helper,
+				 CURLcode res,
+				 const gchar *errbuf,
+				 GError **error)
+{
+	glong status_code = 0;
+	curl_easy_getinfo (helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+	g_debug ("status-code was %ld", status_code);
+	if (status_code == 429) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "Failed to download due to server limit");
+		return;
+	}
+	if (errbuf[0] != '\0') {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "failed to download file: %s",
+			     errbuf);
+		return;
+	}
+	g_set_error (error,
+		     FWUPD_ERROR,
+		     FWUPD_ERROR_INVALID_FILE,
+		     "failed to download file: %s",
+		     curl_easy_strerror (res));
+}
+
 static void
 fwupd_client_download_bytes_thread_cb (GTask *task,
 				       gpointer source_object,
 				       gpointer task_data,
 				       GCancellable *cancellable)
 {
-	FwupdClient *self = FWUPD_CLIENT (source_object);
 	FwupdCurlHelper *helper = g_task_get_task_data (task);
 	CURLcode res;
+	glong unmet = 0;
 	gchar errbuf[CURL_ERROR_SIZE] = { '\0' };
 	g_autoptr(GByteArray) buf = g_byte_array_new ();
 
@@ -4070,32 +5591,21 @@ fwupd_client_download_bytes_thread_cb (GTask *task,
 	curl_easy_setopt (helper->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_write_callback_cb);
 	curl_easy_setopt (helper->curl, CURLOPT_WRITEDATA, buf);
 	res = curl_easy_perform (helper->curl);
-	fwupd_client_set_status (self, FWUPD_STATUS_IDLE);
+	fwupd_client_curl_helper_finished (helper);
 	if (res != CURLE_OK) {
-		glong status_code = 0;
-		curl_easy_getinfo (helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
-		g_debug ("status-code was %ld", status_code);
-		if (status_code == 429) {
-			g_task_return_new_error (task,
-						 FWUPD_ERROR,
-						 FWUPD_ERROR_INVALID_FILE,
-						 "Failed to download due to server limit");
-			return;
-		}
-		if (errbuf[0] != '\0') {
-			g_task_return_new_error (task,
-						 FWUPD_ERROR,
-						 FWUPD_ERROR_INVALID_FILE,
-						 "failed to download file: %s",
-						 errbuf);
-			return;
-		}
+		g_autoptr(GError) error = NULL;
+		fwupd_client_download_set_error (helper, res, errbuf, &error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* the server returned 304 for the If-Modified-Since request */
+	curl_easy_getinfo (helper->curl, CURLINFO_CONDITION_UNMET, &unmet);
+	if (unmet != 0) {
 		g_task_return_new_error (task,
 					 FWUPD_ERROR,
-					 FWUPD_ERROR_INVALID_FILE,
-					 "failed to download file: %s",
-					 curl_easy_strerror (res));
-
+					 FWUPD_ERROR_NOTHING_TO_DO,
+					 "not modified");
 		return;
 	}
 	g_task_return_pointer (task,
@@ -4129,15 +5639,31 @@ fwupd_client_download_bytes_async (FwupdClient *self,
 				   gpointer callback_data)
 {
 	FwupdClientPrivate *priv = GET_PRIVATE (self);
-	g_autoptr(GTask) task = NULL;
-	g_autoptr(GError) error = NULL;
-	g_autoptr(FwupdCurlHelper) helper = NULL;
 
 	g_return_if_fail (FWUPD_IS_CLIENT (self));
 	g_return_if_fail (url != NULL);
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 	g_return_if_fail (priv->proxy != NULL);
 
+	fwupd_client_download_bytes_full_async (self, url, flags, 0, cancellable,
+						callback, callback_data);
+}
+
+/* if @mtime is set then FWUPD_ERROR_NOTHING_TO_DO is returned if the
+ * resource has not been modified since that time */
+static void
+fwupd_client_download_bytes_full_async (FwupdClient *self,
+					const gchar *url,
+					FwupdClientDownloadFlags flags,
+					guint64 mtime,
+					GCancellable *cancellable,
+					GAsyncReadyCallback callback,
+					gpointer callback_data)
+{
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+
 	/* ensure networking set up */
 	task = g_task_new (self, cancellable, callback, callback_data);
 	helper = fwupd_client_curl_new (self, &error);
@@ -4146,6 +5672,10 @@ fwupd_client_download_bytes_async (FwupdClient *self,
 		return;
 	}
 	curl_easy_setopt (helper->curl, CURLOPT_URL, url);
+	if (mtime > 0) {
+		curl_easy_setopt (helper->curl, CURLOPT_TIMECONDITION, (long) CURL_TIMECOND_IFMODSINCE);
+		curl_easy_setopt (helper->curl, CURLOPT_TIMEVALUE, (long) mtime);
+	}
 	g_task_set_task_data (task, g_steal_pointer (&helper), (GDestroyNotify) fwupd_client_curl_helper_free);
 
 	/* download data */
@@ -4175,13 +5705,497 @@ fwupd_client_download_bytes_finish (FwupdClient *self, GAsyncResult *res, GError
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+typedef struct {
+	FwupdCurlHelper		*helper;
+	GFile			*file;
+	GFile			*file_tmp;	/* partial download */
+	GFile			*file_info;	/* describes @file_tmp */
+	gboolean		 resumable;
+	gchar			*url;
+	gchar			*validator;	/* (nullable): for If-Range */
+	gchar			*etag;		/* (nullable): from the response */
+	gchar			*last_modified;	/* (nullable): from the response */
+	GOutputStream		*ostream;
+	GChecksum		*checksum;	/* (nullable) */
+	gchar			*checksum_expected;
+	goffset			 offset;	/* of the current request */
+	gboolean		 preallocated;
+	GError			*error;		/* from the write callback */
+} FwupdClientDownloadFileData;
+
+static void
+fwupd_client_download_file_delete (GFile *file)
+{
+	g_autoptr(GError) error_local = NULL;
+	if (!g_file_delete (file, NULL, &error_local) &&
+	    !g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+		g_debug ("failed to delete: %s", error_local->message);
+}
+
+static void
+fwupd_client_download_file_data_free (FwupdClientDownloadFileData *data)
+{
+	fwupd_client_curl_helper_free (data->helper);
+	if (data->ostream != NULL)
+		g_object_unref (data->ostream);
+	if (data->checksum != NULL)
+		g_checksum_free (data->checksum);
+	if (data->error != NULL)
+		g_error_free (data->error);
+	if (!data->resumable) {
+		fwupd_client_download_file_delete (data->file_tmp);
+		fwupd_client_download_file_delete (data->file_info);
+	}
+	g_object_unref (data->file);
+	g_object_unref (data->file_tmp);
+	g_object_unref (data->file_info);
+	g_free (data->checksum_expected);
+	g_free (data->url);
+	g_free (data->validator);
+	g_free (data->etag);
+	g_free (data->last_modified);
+	g_free (data);
+}
+
+static void
+fwupd_client_download_file_preallocate (FwupdClientDownloadFileData *data)
+{
+#if defined(HAVE_GIO_UNIX) && defined(HAVE_LIBCURL_7_56_0) && defined(FALLOC_FL_KEEP_SIZE)
+	curl_off_t offset = 0;
+	curl_off_t length = -1;
+	GOutputStream *ostream = data->ostream;
+
+	/* only the remaining data is reported when resuming, and the file size
+	 * is kept so that an interrupted download can still be resumed */
+	if (!G_IS_FILE_DESCRIPTOR_BASED (ostream))
+		return;
+	curl_easy_getinfo (data->helper->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+	if (length <= 0)
+		return;
+	offset = g_seekable_tell (G_SEEKABLE (ostream));
+	if (fallocate (g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (ostream)),
+		       FALLOC_FL_KEEP_SIZE, offset, length) < 0)
+		g_debug ("failed to preallocate %" G_GINT64_FORMAT " bytes", (gint64) length);
+#endif
+}
+
+static size_t
+fwupd_client_download_file_header_cb (char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdClientDownloadFileData *data = (FwupdClientDownloadFileData *) userdata;
+	gsize realsize = size * nmemb;
+	g_autofree gchar *line = g_strndup (ptr, realsize);
+
+	/* a redirect sends more than one set of headers, the last one wins */
+	if (g_ascii_strncasecmp (line, "ETag:", 5) == 0) {
+		g_free (data->etag);
+		data->etag = g_strdup (g_strstrip (line + 5));
+	} else if (g_ascii_strncasecmp (line, "Last-Modified:", 14) == 0) {
+		g_free (data->last_modified);
+		data->last_modified = g_strdup (g_strstrip (line + 14));
+	}
+	return realsize;
+}
+
+/* record what the partial download is of, so that it is only resumed if the
+ * server still has the same resource at the same URL */
+static void
+fwupd_client_download_file_save_info (FwupdClientDownloadFileData *data)
+{
+	g_autofree gchar *fn = g_file_get_path (data->file_info);
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new ();
+#ifdef HAVE_LIBCURL_7_56_0
+	curl_off_t length = -1;
+#endif
+
+	/* the data cannot be validated later, so do not resume it */
+	if (data->etag == NULL && data->last_modified == NULL) {
+		fwupd_client_download_file_delete (data->file_info);
+		return;
+	}
+	g_key_file_set_string (kf, "fwupd Download", "URL", data->url);
+	if (data->etag != NULL)
+		g_key_file_set_string (kf, "fwupd Download", "ETag", data->etag);
+	if (data->last_modified != NULL)
+		g_key_file_set_string (kf, "fwupd Download", "LastModified", data->last_modified);
+#ifdef HAVE_LIBCURL_7_56_0
+	curl_easy_getinfo (data->helper->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+	if (length > 0)
+		g_key_file_set_uint64 (kf, "fwupd Download", "Size", (guint64) length);
+#endif
+	if (!g_key_file_save_to_file (kf, fn, &error_local))
+		g_debug ("failed to save download info: %s", error_local->message);
+}
+
+static size_t
+fwupd_client_download_file_write_cb (char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	FwupdClientDownloadFileData *data = (FwupdClientDownloadFileData *) userdata;
+	gsize realsize = size * nmemb;
+
+	/* we know the content length now */
+	if (!data->preallocated) {
+		fwupd_client_download_file_preallocate (data);
+		if (data->resumable && data->offset == 0 && data->checksum_expected == NULL)
+			fwupd_client_download_file_save_info (data);
+		data->preallocated = TRUE;
+	}
+
+	/* returning a short write makes curl abort the transfer */
+	if (!g_output_stream_write_all (data->ostream, ptr, realsize,
+					NULL, NULL, &data->error))
+		return 0;
+	if (data->checksum != NULL)
+		g_checksum_update (data->checksum, (const guchar *) ptr, realsize);
+	return realsize;
+}
+
+/* only resume data downloaded from the same URL, and only when the server can
+ * tell us with If-Range if the resource has changed since */
+static gboolean
+fwupd_client_download_file_load_info (FwupdClientDownloadFileData *data,
+				      GCancellable *cancellable)
+{
+	guint64 size;
+	g_autofree gchar *fn = g_file_get_path (data->file_info);
+	g_autofree gchar *url = NULL;
+	g_autofree gchar *validator = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GFileInfo) info = NULL;
+	g_autoptr(GKeyFile) kf = g_key_file_new ();
+
+	/* the partial download is named after the checksum of the complete
+	 * file, which is verified when the download finishes */
+	if (data->checksum_expected != NULL)
+		return TRUE;
+
+	if (!g_key_file_load_from_file (kf, fn, G_KEY_FILE_NONE, &error_local)) {
+		g_debug ("no download info: %s", error_local->message);
+		return FALSE;
+	}
+	url = g_key_file_get_string (kf, "fwupd Download", "URL", NULL);
+	if (g_strcmp0 (url, data->url) != 0) {
+		g_debug ("partial download was of %s", url);
+		return FALSE;
+	}
+	validator = g_key_file_get_string (kf, "fwupd Download", "ETag", NULL);
+	if (validator == NULL)
+		validator = g_key_file_get_string (kf, "fwupd Download", "LastModified", NULL);
+	if (validator == NULL)
+		return FALSE;
+
+	/* a complete or oversized file cannot be resumed */
+	size = g_key_file_get_uint64 (kf, "fwupd Download", "Size", NULL);
+	info = g_file_query_info (data->file_tmp,
+				  G_FILE_ATTRIBUTE_STANDARD_SIZE,
+				  G_FILE_QUERY_INFO_NONE,
+				  cancellable, &error_local);
+	if (info == NULL) {
+		g_debug ("failed to query partial download: %s", error_local->message);
+		return FALSE;
+	}
+	if (size > 0 && (guint64) g_file_info_get_size (info) >= size) {
+		g_debug ("partial download is 0x%x bytes, expected less than 0x%x",
+			 (guint) g_file_info_get_size (info), (guint) size);
+		return FALSE;
+	}
+	data->validator = g_steal_pointer (&validator);
+	return TRUE;
+}
+
+/* hash any data already downloaded by a previous attempt */
+static gboolean
+fwupd_client_download_file_resume (FwupdClientDownloadFileData *data,
+				   goffset *offset,
+				   GCancellable *cancellable,
+				   GError **error)
+{
+	gsize bufsz = 32 * 1024;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autoptr(GFileInputStream) istream = NULL;
+
+	/* nothing to hash */
+	if (data->checksum == NULL) {
+		g_autoptr(GFileInfo) info = NULL;
+		info = g_file_query_info (data->file_tmp,
+					  G_FILE_ATTRIBUTE_STANDARD_SIZE,
+					  G_FILE_QUERY_INFO_NONE,
+					  cancellable, error);
+		if (info == NULL)
+			return FALSE;
+		*offset = g_file_info_get_size (info);
+		return TRUE;
+	}
+
+	istream = g_file_read (data->file_tmp, cancellable, error);
+	if (istream == NULL)
+		return FALSE;
+	*offset = 0;
+	for (;;) {
+		gssize sz = g_input_stream_read (G_INPUT_STREAM (istream), buf, bufsz,
+						 cancellable, error);
+		if (sz < 0)
+			return FALSE;
+		if (sz == 0)
+			break;
+		g_checksum_update (data->checksum, buf, (gsize) sz);
+		*offset += sz;
+	}
+	return TRUE;
+}
+
+static gboolean
+fwupd_client_download_file_perform (FwupdClientDownloadFileData *data,
+				    goffset offset,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	CURLcode res;
+	gchar errbuf[CURL_ERROR_SIZE] = { '\0' };
+
+	/* append to the partial download, or start again */
+	data->offset = offset;
+	g_clear_object (&data->ostream);
+	if (offset > 0) {
+		data->ostream = G_OUTPUT_STREAM (g_file_append_to (data->file_tmp,
+								   G_FILE_CREATE_NONE,
+								   cancellable,
+								   error));
+	} else {
+		data->ostream = G_OUTPUT_STREAM (g_file_replace (data->file_tmp,
+								 NULL, FALSE,
+								 G_FILE_CREATE_NONE,
+								 cancellable,
+								 error));
+	}
+	if (data->ostream == NULL)
+		return FALSE;
+	data->preallocated = FALSE;
+
+	curl_easy_setopt (data->helper->curl, CURLOPT_ERRORBUFFER, errbuf);
+	curl_easy_setopt (data->helper->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_file_write_cb);
+	curl_easy_setopt (data->helper->curl, CURLOPT_WRITEDATA, data);
+	curl_easy_setopt (data->helper->curl, CURLOPT_HEADERFUNCTION, fwupd_client_download_file_header_cb);
+	curl_easy_setopt (data->helper->curl, CURLOPT_HEADERDATA, data);
+	curl_easy_setopt (data->helper->curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t) offset);
+
+	/* the server sends the whole resource if it has changed */
+	if (offset > 0 && data->validator != NULL) {
+		g_autofree gchar *hdr = g_strdup_printf ("If-Range: %s", data->validator);
+		data->helper->headers = curl_slist_append (data->helper->headers, hdr);
+		curl_easy_setopt (data->helper->curl, CURLOPT_HTTPHEADER, data->helper->headers);
+	} else {
+		curl_easy_setopt (data->helper->curl, CURLOPT_HTTPHEADER, NULL);
+	}
+	res = curl_easy_perform (data->helper->curl);
+	if (!g_output_stream_close (data->ostream, NULL, error))
+		return FALSE;
+	if (data->error != NULL) {
+		g_propagate_error (error, g_steal_pointer (&data->error));
+		return FALSE;
+	}
+	if (offset > 0) {
+		glong status_code = 0;
+		curl_easy_getinfo (data->helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
+
+		/* the server does not support byte ranges, or the resource changed */
+		if (res == CURLE_RANGE_ERROR || (res == CURLE_OK && status_code != 206)) {
+			g_debug ("unable to resume download, starting again");
+			if (data->checksum != NULL)
+				g_checksum_reset (data->checksum);
+			return fwupd_client_download_file_perform (data, 0, cancellable, error);
+		}
+	}
+	if (res != CURLE_OK) {
+		fwupd_client_download_set_error (data->helper, res, errbuf, error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+fwupd_client_download_file_thread_cb (GTask *task,
+				      gpointer source_object,
+				      gpointer task_data,
+				      GCancellable *cancellable)
+{
+	FwupdClientDownloadFileData *data = g_task_get_task_data (task);
+	goffset offset = 0;
+	g_autoptr(GError) error = NULL;
+
+	/* continue from where a previous attempt was interrupted */
+	if (data->resumable &&
+	    g_file_query_exists (data->file_tmp, cancellable) &&
+	    fwupd_client_download_file_load_info (data, cancellable)) {
+		if (!fwupd_client_download_file_resume (data, &offset, cancellable, &error)) {
+			fwupd_client_curl_helper_finished (data->helper);
+			g_task_return_error (task, g_steal_pointer (&error));
+			return;
+		}
+		g_debug ("resuming download from 0x%x", (guint) offset);
+	}
+	if (!fwupd_client_download_file_perform (data, offset, cancellable, &error)) {
+		fwupd_client_curl_helper_finished (data->helper);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	fwupd_client_curl_helper_finished (data->helper);
+
+	/* verify checksum, and do not try to resume from corrupt data */
+	if (data->checksum != NULL) {
+		const gchar *checksum_actual = g_checksum_get_string (data->checksum);
+		if (g_strcmp0 (data->checksum_expected, checksum_actual) != 0) {
+			fwupd_client_download_file_delete (data->file_tmp);
+			g_task_return_new_error (task,
+						 FWUPD_ERROR,
+						 FWUPD_ERROR_INVALID_FILE,
+						 "checksum invalid, expected %s got %s",
+						 data->checksum_expected, checksum_actual);
+			return;
+		}
+	}
+
+	/* only make the file visible when complete */
+	if (!g_file_move (data->file_tmp, data->file,
+			  G_FILE_COPY_OVERWRITE,
+			  cancellable, NULL, NULL, &error)) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	fwupd_client_download_file_delete (data->file_info);
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+fwupd_client_download_file_full_async (FwupdClient *self,
+				       const gchar *url,
+				       GFile *file,
+				       const gchar *checksum_expected,
+				       FwupdClientDownloadFlags flags,
+				       GCancellable *cancellable,
+				       GAsyncReadyCallback callback,
+				       gpointer callback_data)
+{
+	FwupdClientDownloadFileData *data;
+	g_autofree gchar *basename = g_file_get_basename (file);
+	g_autofree gchar *basename_tmp = NULL;
+	g_autofree gchar *basename_info = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) parent = g_file_get_parent (file);
+	g_autoptr(GFile) file_tmp = NULL;
+	g_autoptr(GTask) task = NULL;
+	g_autoptr(FwupdCurlHelper) helper = NULL;
+
+	/* ensure networking set up */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	helper = fwupd_client_curl_new (self, &error);
+	if (helper == NULL) {
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+	curl_easy_setopt (helper->curl, CURLOPT_URL, url);
+
+	/* name a content-addressed partial download after the checksum so that
+	 * it can be resumed even if the mirror or the destination changes */
+	if (checksum_expected != NULL) {
+		basename_tmp = g_strdup_printf ("%s.part", checksum_expected);
+		basename_info = g_strdup_printf ("%s.part.info", checksum_expected);
+	} else {
+		basename_tmp = g_strdup_printf ("%s.part", basename);
+		basename_info = g_strdup_printf ("%s.part.info", basename);
+	}
+	file_tmp = g_file_get_child (parent, basename_tmp);
+
+	data = g_new0 (FwupdClientDownloadFileData, 1);
+	data->helper = g_steal_pointer (&helper);
+	data->file = g_object_ref (file);
+	data->file_tmp = g_steal_pointer (&file_tmp);
+	data->file_info = g_file_get_child (parent, basename_info);
+	data->url = g_strdup (url);
+	data->resumable = (flags & FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME) > 0;
+	if (checksum_expected != NULL) {
+		data->checksum = g_checksum_new (fwupd_checksum_guess_kind (checksum_expected));
+		data->checksum_expected = g_strdup (checksum_expected);
+	}
+	g_task_set_task_data (task, data, (GDestroyNotify) fwupd_client_download_file_data_free);
+
+	/* download data */
+	g_debug ("downloading %s to file", url);
+	fwupd_client_set_status (self, FWUPD_STATUS_DOWNLOADING);
+	g_task_run_in_thread (task, fwupd_client_download_file_thread_cb);
+}
+
+/**
+ * fwupd_client_download_file_async:
+ * @self: A #FwupdClient
+ * @url: the remote URL
+ * @file: a #GFile
+ * @flags: #FwupdClientDownloadFlags, e.g. %FWUPD_CLIENT_DOWNLOAD_FLAG_NONE
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Downloads data from a remote server directly to a file, without holding the
+ * entire payload in memory. The data is written to a temporary file in the
+ * same directory as @file, and @file is only replaced when it is complete.
+ *
+ * If @flags includes %FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME then the temporary file
+ * is kept if the download is interrupted. A later call with the same @url and
+ * @file then only downloads the remaining data, as long as the server supports
+ * byte ranges and reports that the resource has not changed. Otherwise the
+ * download starts again.
+ *
+ * The fwupd_client_set_user_agent() function should be called before this
+ * method is used.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_client_download_file_async (FwupdClient *self,
+				  const gchar *url,
+				  GFile *file,
+				  FwupdClientDownloadFlags flags,
+				  GCancellable *cancellable,
+				  GAsyncReadyCallback callback,
+				  gpointer callback_data)
+{
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (url != NULL);
+	g_return_if_fail (G_IS_FILE (file));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	fwupd_client_download_file_full_async (self, url, file, NULL, flags,
+					       cancellable, callback, callback_data);
+}
+
+/**
+ * fwupd_client_download_file_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_download_file_async().
+ *
+ * Returns: %TRUE if the file was written
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fwupd_client_download_file_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), FALSE);
+	g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	return g_task_propagate_boolean (G_TASK(res), error);
+}
+
 static void
 fwupd_client_upload_bytes_thread_cb (GTask *task,
 				     gpointer source_object,
 				     gpointer task_data,
 				     GCancellable *cancellable)
 {
-	FwupdClient *self = FWUPD_CLIENT (source_object);
 	FwupdCurlHelper *helper = g_task_get_task_data (task);
 	CURLcode res;
 	gchar errbuf[CURL_ERROR_SIZE] = { '\0' };
@@ -4191,7 +6205,7 @@ fwupd_client_upload_bytes_thread_cb (GTask *task,
 	curl_easy_setopt (helper->curl, CURLOPT_WRITEFUNCTION, fwupd_client_download_write_callback_cb);
 	curl_easy_setopt (helper->curl, CURLOPT_WRITEDATA, buf);
 	res = curl_easy_perform (helper->curl);
-	fwupd_client_set_status (self, FWUPD_STATUS_IDLE);
+	fwupd_client_curl_helper_finished (helper);
 	if (res != CURLE_OK) {
 		glong status_code = 0;
 		curl_easy_getinfo (helper->curl, CURLINFO_RESPONSE_CODE, &status_code);
@@ -4630,6 +6644,9 @@ fwupd_client_class_init (FwupdClientClass *klass)
 static void
 fwupd_client_init (FwupdClient *self)
 {
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_mutex_init (&priv->transfers_mutex);
+	priv->transfers = g_ptr_array_new ();
 }
 
 static void
@@ -4639,11 +6656,21 @@ fwupd_client_finalize (GObject *object)
 	FwupdClientPrivate *priv = GET_PRIVATE (self);
 
 	g_clear_pointer (&priv->main_ctx, g_main_context_unref);
+	g_mutex_clear (&priv->transfers_mutex);
+	g_ptr_array_unref (priv->transfers);
 	g_free (priv->user_agent);
 	g_free (priv->daemon_version);
 	g_free (priv->host_product);
 	g_free (priv->host_machine_id);
 	g_free (priv->host_security_id);
+	if (priv->cached_devices != NULL)
+		g_ptr_array_unref (priv->cached_devices);
+	if (priv->cached_remotes != NULL)
+		g_ptr_array_unref (priv->cached_remotes);
+	if (priv->loading_devices != NULL)
+		g_ptr_array_unref (priv->loading_devices);
+	if (priv->loading_remotes != NULL)
+		g_ptr_array_unref (priv->loading_remotes);
 	if (priv->conn != NULL)
 		g_object_unref (priv->conn);
 	if (priv->proxy != NULL)
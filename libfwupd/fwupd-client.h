@@ -44,11 +44,13 @@ struct _FwupdClientClass
 /**
  * FwupdClientDownloadFlags:
  * @FWUPD_CLIENT_DOWNLOAD_FLAG_NONE:		No flags set
+ * @FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME:		Keep and resume interrupted downloads to a file
  *
  * The options to use for downloading.
  **/
 typedef enum {
 	FWUPD_CLIENT_DOWNLOAD_FLAG_NONE			= 0,		/* Since: 1.4.5 */
+	FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME		= 1 << 0,	/* Since: 1.5.5 */
 	/*< private >*/
 	FWUPD_CLIENT_DOWNLOAD_FLAG_LAST
 } FwupdClientDownloadFlags;
@@ -123,6 +125,22 @@ void		 fwupd_client_get_upgrades_async	(FwupdClient	*self,
 GPtrArray	*fwupd_client_get_upgrades_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error);
+void		 fwupd_client_get_releases_batch_async	(FwupdClient	*self,
+							 GPtrArray	*device_ids,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_releases_batch_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
+void		 fwupd_client_get_upgrades_batch_async	(FwupdClient	*self,
+							 GPtrArray	*device_ids,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GPtrArray	*fwupd_client_get_upgrades_batch_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
 void		 fwupd_client_get_details_bytes_async	(FwupdClient	*self,
 							 GBytes		*bytes,
 							 GCancellable	*cancellable,
@@ -259,6 +277,14 @@ void		 fwupd_client_refresh_remote_async	(FwupdClient	*self,
 gboolean	 fwupd_client_refresh_remote_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error);
+void		 fwupd_client_refresh_remotes_async	(FwupdClient	*self,
+							 GPtrArray	*remotes,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_refresh_remotes_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
 void		 fwupd_client_modify_remote_async	(FwupdClient	*self,
 							 const gchar	*remote_id,
 							 const gchar	*key,
@@ -286,6 +312,17 @@ void		 fwupd_client_get_report_metadata_async	(FwupdClient	*self,
 GHashTable	*fwupd_client_get_report_metadata_finish(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error);
+void		 fwupd_client_load_cache_async		(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_load_cache_finish		(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
+GPtrArray	*fwupd_client_get_cached_devices	(FwupdClient	*self);
+FwupdDevice	*fwupd_client_get_cached_device_by_id	(FwupdClient	*self,
+							 const gchar	*device_id);
+GPtrArray	*fwupd_client_get_cached_remotes	(FwupdClient	*self);
 
 FwupdStatus	 fwupd_client_get_status		(FwupdClient	*self);
 gboolean	 fwupd_client_get_tainted		(FwupdClient	*self);
@@ -373,6 +410,16 @@ void		 fwupd_client_download_bytes_async	(FwupdClient	*self,
 GBytes		*fwupd_client_download_bytes_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error);
+void		 fwupd_client_download_file_async	(FwupdClient	*self,
+							 const gchar	*url,
+							 GFile		*file,
+							 FwupdClientDownloadFlags flags,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+gboolean	 fwupd_client_download_file_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
 void		 fwupd_client_upload_bytes_async	(FwupdClient	*self,
 							 const gchar	*url,
 							 const gchar	*payload,
@@ -20,6 +20,11 @@ gchar		*fwupd_checksum_format_for_display	(const gchar	*checksum);
 GVariant	*fwupd_hash_kv_to_variant		(GHashTable	*hash);
 GHashTable	*fwupd_variant_to_hash_kv		(GVariant	*dict);
 gchar		*fwupd_build_user_agent_system		(void);
+const gchar	*fwupd_intern_string_ref		(const gchar	*str);
+void		 fwupd_intern_string_unref		(const gchar	*str);
+void		 fwupd_intern_string_get_stats		(guint		*unique,
+							 guint64	*shared,
+							 guint64	*saved);
 
 void		 fwupd_input_stream_read_bytes_async	(GInputStream	*stream,
 							 GCancellable	*cancellable,
@@ -940,6 +940,114 @@ fwupd_variant_to_hash_kv (GVariant *dict)
 	return hash;
 }
 
+/* string -> (guint *) refcount, both owned by the pool */
+static GMutex fwupd_intern_mutex;
+static GHashTable *fwupd_intern_pool = NULL;
+static guint64 fwupd_intern_shared = 0;
+static guint64 fwupd_intern_saved = 0;
+
+/**
+ * fwupd_intern_string_ref: (skip):
+ * @str: (nullable): A string
+ *
+ * Returns a shared copy of @str, which is useful for properties like the
+ * plugin, protocol or vendor that only ever take a few different values but
+ * are set on thousands of devices and releases.
+ *
+ * Unlike g_intern_string() the copy is freed when the last reference is
+ * dropped using fwupd_intern_string_unref(), so strings from untrusted
+ * metadata do not stay in memory for the lifetime of the process.
+ *
+ * Returns: a shared string, or %NULL
+ *
+ * Since: 1.5.5
+ **/
+const gchar *
+fwupd_intern_string_ref (const gchar *str)
+{
+	gpointer key = NULL;
+	gpointer value = NULL;
+	guint *refcount;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (str == NULL)
+		return NULL;
+	locker = g_mutex_locker_new (&fwupd_intern_mutex);
+	if (fwupd_intern_pool == NULL)
+		fwupd_intern_pool = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	/* the refcount is changed in place, as inserting the key again would
+	 * free the string that is being returned */
+	if (g_hash_table_lookup_extended (fwupd_intern_pool, str, &key, &value)) {
+		refcount = (guint *) value;
+		(*refcount)++;
+		fwupd_intern_shared++;
+		fwupd_intern_saved += strlen (str) + 1;
+		return key;
+	}
+	refcount = g_new (guint, 1);
+	*refcount = 1;
+	key = g_strdup (str);
+	g_hash_table_insert (fwupd_intern_pool, key, refcount);
+	return key;
+}
+
+/**
+ * fwupd_intern_string_unref: (skip):
+ * @str: (nullable): A string returned from fwupd_intern_string_ref()
+ *
+ * Drops a reference to a shared string, freeing it when it is no longer used.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_intern_string_unref (const gchar *str)
+{
+	guint *refcount;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (str == NULL)
+		return;
+	locker = g_mutex_locker_new (&fwupd_intern_mutex);
+	refcount = fwupd_intern_pool != NULL ? g_hash_table_lookup (fwupd_intern_pool, str) : NULL;
+	if (refcount == NULL) {
+		g_critical ("%s was not returned from fwupd_intern_string_ref()", str);
+		return;
+	}
+
+	/* @str may be the pooled copy, so it cannot be used after the remove */
+	if (*refcount == 1) {
+		g_hash_table_remove (fwupd_intern_pool, str);
+		return;
+	}
+	(*refcount)--;
+	fwupd_intern_shared--;
+	fwupd_intern_saved -= strlen (str) + 1;
+}
+
+/**
+ * fwupd_intern_string_get_stats: (skip):
+ * @unique: (out) (optional): number of distinct strings currently in use
+ * @shared: (out) (optional): number of references to a string already in use
+ * @saved: (out) (optional): bytes that would otherwise have been allocated
+ *
+ * Gets statistics about the strings currently returned by
+ * fwupd_intern_string_ref() and not yet released.
+ *
+ * Since: 1.5.5
+ **/
+void
+fwupd_intern_string_get_stats (guint *unique, guint64 *shared, guint64 *saved)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&fwupd_intern_mutex);
+	if (unique != NULL)
+		*unique = fwupd_intern_pool != NULL ? g_hash_table_size (fwupd_intern_pool) : 0;
+	if (shared != NULL)
+		*shared = fwupd_intern_shared;
+	if (saved != NULL)
+		*saved = fwupd_intern_saved;
+}
+
 static void
 fwupd_input_stream_read_bytes_cb (GObject *source,
 				  GAsyncResult *res,
@@ -26,6 +26,63 @@
  */
 
 static void fwupd_device_finalize	 (GObject *object);
+/* string and array properties that are only decoded from the GVariant
+ * passed to fwupd_device_from_variant() when first used */
+typedef enum {
+	FWUPD_DEVICE_LAZY_ID,
+	FWUPD_DEVICE_LAZY_PARENT_ID,
+	FWUPD_DEVICE_LAZY_GUIDS,
+	FWUPD_DEVICE_LAZY_INSTANCE_IDS,
+	FWUPD_DEVICE_LAZY_ICONS,
+	FWUPD_DEVICE_LAZY_NAME,
+	FWUPD_DEVICE_LAZY_SERIAL,
+	FWUPD_DEVICE_LAZY_SUMMARY,
+	FWUPD_DEVICE_LAZY_BRANCH,
+	FWUPD_DEVICE_LAZY_DESCRIPTION,
+	FWUPD_DEVICE_LAZY_VENDOR,
+	FWUPD_DEVICE_LAZY_VENDOR_ID,
+	FWUPD_DEVICE_LAZY_PLUGIN,
+	FWUPD_DEVICE_LAZY_PROTOCOL,
+	FWUPD_DEVICE_LAZY_VERSION,
+	FWUPD_DEVICE_LAZY_VERSION_LOWEST,
+	FWUPD_DEVICE_LAZY_VERSION_BOOTLOADER,
+	FWUPD_DEVICE_LAZY_CHECKSUMS,
+	FWUPD_DEVICE_LAZY_UPDATE_ERROR,
+	FWUPD_DEVICE_LAZY_UPDATE_MESSAGE,
+	FWUPD_DEVICE_LAZY_UPDATE_IMAGE,
+	FWUPD_DEVICE_LAZY_RELEASES,
+	FWUPD_DEVICE_LAZY_LAST
+} FwupdDeviceLazy;
+
+static const gchar *fwupd_device_lazy_keys[] = {
+	FWUPD_RESULT_KEY_DEVICE_ID,
+	FWUPD_RESULT_KEY_PARENT_DEVICE_ID,
+	FWUPD_RESULT_KEY_GUID,
+	FWUPD_RESULT_KEY_INSTANCE_IDS,
+	FWUPD_RESULT_KEY_ICON,
+	FWUPD_RESULT_KEY_NAME,
+	FWUPD_RESULT_KEY_SERIAL,
+	FWUPD_RESULT_KEY_SUMMARY,
+	FWUPD_RESULT_KEY_BRANCH,
+	FWUPD_RESULT_KEY_DESCRIPTION,
+	FWUPD_RESULT_KEY_VENDOR,
+	FWUPD_RESULT_KEY_VENDOR_ID,
+	FWUPD_RESULT_KEY_PLUGIN,
+	FWUPD_RESULT_KEY_PROTOCOL,
+	FWUPD_RESULT_KEY_VERSION,
+	FWUPD_RESULT_KEY_VERSION_LOWEST,
+	FWUPD_RESULT_KEY_VERSION_BOOTLOADER,
+	FWUPD_RESULT_KEY_CHECKSUM,
+	FWUPD_RESULT_KEY_UPDATE_ERROR,
+	FWUPD_RESULT_KEY_UPDATE_MESSAGE,
+	FWUPD_RESULT_KEY_UPDATE_IMAGE,
+	FWUPD_RESULT_KEY_RELEASE,
+};
+
+static void fwupd_device_ensure		(FwupdDevice	*device,
+						 FwupdDeviceLazy idx);
+static void fwupd_device_ensure_all	(FwupdDevice	*device);
+
 
 typedef struct {
 	gchar				*id;
@@ -39,13 +96,13 @@ typedef struct {
 	gchar				*name;
 	gchar				*serial;
 	gchar				*summary;
-	gchar				*branch;
+	const gchar			*branch;
 	gchar				*description;
-	gchar				*vendor;
-	gchar				*vendor_id;
+	const gchar			*vendor;
+	const gchar			*vendor_id;
 	gchar				*homepage;
-	gchar				*plugin;
-	gchar				*protocol;
+	const gchar			*plugin;
+	const gchar			*protocol;
 	gchar				*version;
 	gchar				*version_lowest;
 	gchar				*version_bootloader;
@@ -64,6 +121,8 @@ typedef struct {
 	FwupdStatus			 status;
 	GPtrArray			*releases;
 	FwupdDevice			*parent;	/* noref */
+	GVariant			*lazy_dict;	/* a{sv} */
+	guint32				 lazy_done;
 } FwupdDevicePrivate;
 
 enum {
@@ -94,6 +153,7 @@ fwupd_device_get_checksums (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_CHECKSUMS);
 	return priv->checksums;
 }
 
@@ -112,6 +172,7 @@ fwupd_device_add_checksum (FwupdDevice *device, const gchar *checksum)
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	g_return_if_fail (checksum != NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_CHECKSUMS);
 	for (guint i = 0; i < priv->checksums->len; i++) {
 		const gchar *checksum_tmp = g_ptr_array_index (priv->checksums, i);
 		if (g_strcmp0 (checksum_tmp, checksum) == 0)
@@ -153,6 +214,7 @@ fwupd_device_get_summary (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_SUMMARY);
 	return priv->summary;
 }
 
@@ -170,6 +232,7 @@ fwupd_device_set_summary (FwupdDevice *device, const gchar *summary)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_SUMMARY);
 	g_free (priv->summary);
 	priv->summary = g_strdup (summary);
 }
@@ -189,6 +252,7 @@ fwupd_device_get_branch (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_BRANCH);
 	return priv->branch;
 }
 
@@ -205,9 +269,12 @@ void
 fwupd_device_set_branch (FwupdDevice *device, const gchar *branch)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->branch);
-	priv->branch = g_strdup (branch);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_BRANCH);
+	old = priv->branch;
+	priv->branch = fwupd_intern_string_ref (branch);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -225,6 +292,7 @@ fwupd_device_get_serial (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_SERIAL);
 	return priv->serial;
 }
 
@@ -242,6 +310,7 @@ fwupd_device_set_serial (FwupdDevice *device, const gchar *serial)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_SERIAL);
 	g_free (priv->serial);
 	priv->serial = g_strdup (serial);
 }
@@ -261,6 +330,7 @@ fwupd_device_get_id (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_ID);
 	return priv->id;
 }
 
@@ -278,6 +348,7 @@ fwupd_device_set_id (FwupdDevice *device, const gchar *id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_ID);
 	g_free (priv->id);
 	priv->id = g_strdup (id);
 }
@@ -297,6 +368,7 @@ fwupd_device_get_parent_id (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PARENT_ID);
 	return priv->parent_id;
 }
 
@@ -314,6 +386,7 @@ fwupd_device_set_parent_id (FwupdDevice *device, const gchar *parent_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PARENT_ID);
 	g_free (priv->parent_id);
 	priv->parent_id = g_strdup (parent_id);
 }
@@ -400,6 +473,7 @@ fwupd_device_get_guids (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_GUIDS);
 	return priv->guids;
 }
 
@@ -420,6 +494,7 @@ fwupd_device_has_guid (FwupdDevice *device, const gchar *guid)
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), FALSE);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_GUIDS);
 
 	for (guint i = 0; i < priv->guids->len; i++) {
 		const gchar *guid_tmp = g_ptr_array_index (priv->guids, i);
@@ -443,6 +518,7 @@ fwupd_device_add_guid (FwupdDevice *device, const gchar *guid)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_GUIDS);
 	if (fwupd_device_has_guid (device, guid))
 		return;
 	g_ptr_array_add (priv->guids, g_strdup (guid));
@@ -463,6 +539,7 @@ fwupd_device_get_guid_default (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_GUIDS);
 	if (priv->guids->len == 0)
 		return NULL;
 	return g_ptr_array_index (priv->guids, 0);
@@ -483,6 +560,7 @@ fwupd_device_get_instance_ids (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_INSTANCE_IDS);
 	return priv->instance_ids;
 }
 
@@ -503,6 +581,7 @@ fwupd_device_has_instance_id (FwupdDevice *device, const gchar *instance_id)
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), FALSE);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_INSTANCE_IDS);
 
 	for (guint i = 0; i < priv->instance_ids->len; i++) {
 		const gchar *instance_id_tmp = g_ptr_array_index (priv->instance_ids, i);
@@ -526,6 +605,7 @@ fwupd_device_add_instance_id (FwupdDevice *device, const gchar *instance_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_INSTANCE_IDS);
 	if (fwupd_device_has_instance_id (device, instance_id))
 		return;
 	g_ptr_array_add (priv->instance_ids, g_strdup (instance_id));
@@ -549,6 +629,7 @@ fwupd_device_get_icons (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_ICONS);
 	return priv->icons;
 }
 
@@ -556,6 +637,7 @@ static gboolean
 fwupd_device_has_icon (FwupdDevice *device, const gchar *icon)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_ICONS);
 	for (guint i = 0; i < priv->icons->len; i++) {
 		const gchar *icon_tmp = g_ptr_array_index (priv->icons, i);
 		if (g_strcmp0 (icon, icon_tmp) == 0)
@@ -578,6 +660,7 @@ fwupd_device_add_icon (FwupdDevice *device, const gchar *icon)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_ICONS);
 	if (fwupd_device_has_icon (device, icon))
 		return;
 	g_ptr_array_add (priv->icons, g_strdup (icon));
@@ -598,6 +681,7 @@ fwupd_device_get_name (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_NAME);
 	return priv->name;
 }
 
@@ -615,6 +699,7 @@ fwupd_device_set_name (FwupdDevice *device, const gchar *name)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_NAME);
 	g_free (priv->name);
 	priv->name = g_strdup (name);
 }
@@ -634,6 +719,7 @@ fwupd_device_get_vendor (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VENDOR);
 	return priv->vendor;
 }
 
@@ -650,9 +736,12 @@ void
 fwupd_device_set_vendor (FwupdDevice *device, const gchar *vendor)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->vendor);
-	priv->vendor = g_strdup (vendor);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VENDOR);
+	old = priv->vendor;
+	priv->vendor = fwupd_intern_string_ref (vendor);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -670,6 +759,7 @@ fwupd_device_get_vendor_id (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VENDOR_ID);
 	return priv->vendor_id;
 }
 
@@ -686,9 +776,12 @@ void
 fwupd_device_set_vendor_id (FwupdDevice *device, const gchar *vendor_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->vendor_id);
-	priv->vendor_id = g_strdup (vendor_id);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VENDOR_ID);
+	old = priv->vendor_id;
+	priv->vendor_id = fwupd_intern_string_ref (vendor_id);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -706,6 +799,7 @@ fwupd_device_get_description (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_DESCRIPTION);
 	return priv->description;
 }
 
@@ -723,6 +817,7 @@ fwupd_device_set_description (FwupdDevice *device, const gchar *description)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_DESCRIPTION);
 	g_free (priv->description);
 	priv->description = g_strdup (description);
 }
@@ -742,6 +837,7 @@ fwupd_device_get_version (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION);
 	return priv->version;
 }
 
@@ -759,6 +855,7 @@ fwupd_device_set_version (FwupdDevice *device, const gchar *version)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION);
 	g_free (priv->version);
 	priv->version = g_strdup (version);
 }
@@ -778,6 +875,7 @@ fwupd_device_get_version_lowest (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION_LOWEST);
 	return priv->version_lowest;
 }
 
@@ -795,6 +893,7 @@ fwupd_device_set_version_lowest (FwupdDevice *device, const gchar *version_lowes
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION_LOWEST);
 	g_free (priv->version_lowest);
 	priv->version_lowest = g_strdup (version_lowest);
 }
@@ -849,6 +948,7 @@ fwupd_device_get_version_bootloader (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION_BOOTLOADER);
 	return priv->version_bootloader;
 }
 
@@ -866,6 +966,7 @@ fwupd_device_set_version_bootloader (FwupdDevice *device, const gchar *version_b
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_VERSION_BOOTLOADER);
 	g_free (priv->version_bootloader);
 	priv->version_bootloader = g_strdup (version_bootloader);
 }
@@ -990,6 +1091,7 @@ fwupd_device_get_plugin (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PLUGIN);
 	return priv->plugin;
 }
 
@@ -1006,9 +1108,12 @@ void
 fwupd_device_set_plugin (FwupdDevice *device, const gchar *plugin)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->plugin);
-	priv->plugin = g_strdup (plugin);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PLUGIN);
+	old = priv->plugin;
+	priv->plugin = fwupd_intern_string_ref (plugin);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -1026,6 +1131,7 @@ fwupd_device_get_protocol (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PROTOCOL);
 	return priv->protocol;
 }
 
@@ -1042,9 +1148,12 @@ void
 fwupd_device_set_protocol (FwupdDevice *device, const gchar *protocol)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->protocol);
-	priv->protocol = g_strdup (protocol);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_PROTOCOL);
+	old = priv->protocol;
+	priv->protocol = fwupd_intern_string_ref (protocol);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -1233,6 +1342,9 @@ fwupd_device_incorporate (FwupdDevice *self, FwupdDevice *donor)
 	FwupdDevicePrivate *priv = GET_PRIVATE (self);
 	FwupdDevicePrivate *priv_donor = GET_PRIVATE (donor);
 
+	fwupd_device_ensure_all (self);
+	fwupd_device_ensure_all (donor);
+
 	if (priv->flags == 0)
 		fwupd_device_add_flag (self, priv_donor->flags);
 	if (priv->created == 0)
@@ -1328,6 +1440,7 @@ fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
 	GVariantBuilder builder;
 
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure_all (device);
 
 	/* create an array with all the metadata in */
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
@@ -1694,6 +1807,47 @@ fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *va
 	}
 }
 
+static gboolean
+fwupd_device_is_lazy_key (const gchar *key)
+{
+	for (guint i = 0; i < FWUPD_DEVICE_LAZY_LAST; i++) {
+		if (g_strcmp0 (key, fwupd_device_lazy_keys[i]) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+fwupd_device_ensure (FwupdDevice *device, FwupdDeviceLazy idx)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_autoptr(GVariant) value = NULL;
+
+	/* not created from a variant, or already decoded */
+	if (priv->lazy_dict == NULL)
+		return;
+	if (priv->lazy_done & (1u << idx))
+		return;
+
+	/* set first as the setters called below also ensure */
+	priv->lazy_done |= 1u << idx;
+	value = g_variant_lookup_value (priv->lazy_dict, fwupd_device_lazy_keys[idx], NULL);
+	if (value != NULL)
+		fwupd_device_from_key_value (device, fwupd_device_lazy_keys[idx], value);
+
+	/* nothing more to decode */
+	if (priv->lazy_done == (1u << FWUPD_DEVICE_LAZY_LAST) - 1)
+		g_clear_pointer (&priv->lazy_dict, g_variant_unref);
+}
+
+static void
+fwupd_device_ensure_all (FwupdDevice *device)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	for (guint i = 0; i < FWUPD_DEVICE_LAZY_LAST && priv->lazy_dict != NULL; i++)
+		fwupd_device_ensure (device, i);
+}
+
 static void
 fwupd_pad_kv_str (GString *str, const gchar *key, const gchar *value)
 {
@@ -1871,6 +2025,7 @@ fwupd_device_get_update_message (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_MESSAGE);
 	return priv->update_message;
 }
 
@@ -1888,6 +2043,7 @@ fwupd_device_set_update_message (FwupdDevice *device, const gchar *update_messag
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_MESSAGE);
 	g_free (priv->update_message);
 	priv->update_message = g_strdup (update_message);
 }
@@ -1907,6 +2063,7 @@ fwupd_device_get_update_image (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_IMAGE);
 	return priv->update_image;
 }
 
@@ -1924,6 +2081,7 @@ fwupd_device_set_update_image (FwupdDevice *device, const gchar *update_image)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_IMAGE);
 	g_free (priv->update_image);
 	priv->update_image = g_strdup (update_image);
 }
@@ -1943,6 +2101,7 @@ fwupd_device_get_update_error (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_ERROR);
 	return priv->update_error;
 }
 
@@ -1960,6 +2119,7 @@ fwupd_device_set_update_error (FwupdDevice *device, const gchar *update_error)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_UPDATE_ERROR);
 	g_free (priv->update_error);
 	priv->update_error = g_strdup (update_error);
 }
@@ -1979,6 +2139,7 @@ fwupd_device_get_release_default (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_RELEASES);
 	if (priv->releases->len == 0)
 		return NULL;
 	return FWUPD_RELEASE (g_ptr_array_index (priv->releases, 0));
@@ -1999,6 +2160,7 @@ fwupd_device_get_releases (FwupdDevice *device)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_RELEASES);
 	return priv->releases;
 }
 
@@ -2016,6 +2178,7 @@ fwupd_device_add_release (FwupdDevice *device, FwupdRelease *release)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	fwupd_device_ensure (device, FWUPD_DEVICE_LAZY_RELEASES);
 	g_ptr_array_add (priv->releases, g_object_ref (release));
 }
 /**
@@ -2098,6 +2261,7 @@ fwupd_device_to_json (FwupdDevice *device, JsonBuilder *builder)
 
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	g_return_if_fail (builder != NULL);
+	fwupd_device_ensure_all (device);
 
 	fwupd_device_json_add_string (builder, FWUPD_RESULT_KEY_NAME, priv->name);
 	fwupd_device_json_add_string (builder, FWUPD_RESULT_KEY_DEVICE_ID, priv->id);
@@ -2211,6 +2375,7 @@ fwupd_device_to_string (FwupdDevice *device)
 	GString *str;
 
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+	fwupd_device_ensure_all (device);
 
 	str = g_string_new ("");
 	if (priv->name != NULL)
@@ -2315,6 +2480,7 @@ fwupd_device_get_property (GObject *object, guint prop_id,
 {
 	FwupdDevice *self = FWUPD_DEVICE (object);
 	FwupdDevicePrivate *priv = GET_PRIVATE (self);
+	fwupd_device_ensure (self, FWUPD_DEVICE_LAZY_PROTOCOL);
 	switch (prop_id) {
 	case PROP_VERSION_FORMAT:
 		g_value_set_uint (value, priv->version_format);
@@ -2437,11 +2603,11 @@ fwupd_device_finalize (GObject *object)
 	g_free (priv->name);
 	g_free (priv->serial);
 	g_free (priv->summary);
-	g_free (priv->branch);
-	g_free (priv->vendor);
-	g_free (priv->vendor_id);
-	g_free (priv->plugin);
-	g_free (priv->protocol);
+	fwupd_intern_string_unref (priv->branch);
+	fwupd_intern_string_unref (priv->vendor);
+	fwupd_intern_string_unref (priv->vendor_id);
+	fwupd_intern_string_unref (priv->plugin);
+	fwupd_intern_string_unref (priv->protocol);
 	g_free (priv->update_error);
 	g_free (priv->update_message);
 	g_free (priv->update_image);
@@ -2454,19 +2620,29 @@ fwupd_device_finalize (GObject *object)
 	g_ptr_array_unref (priv->checksums);
 	g_ptr_array_unref (priv->children);
 	g_ptr_array_unref (priv->releases);
+	if (priv->lazy_dict != NULL)
+		g_variant_unref (priv->lazy_dict);
 
 	G_OBJECT_CLASS (fwupd_device_parent_class)->finalize (object);
 }
 
 static void
-fwupd_device_set_from_variant_iter (FwupdDevice *device, GVariantIter *iter)
+fwupd_device_set_from_variant_dict (FwupdDevice *device, GVariant *dict)
 {
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	GVariantIter iter;
 	GVariant *value;
 	const gchar *key;
-	while (g_variant_iter_next (iter, "{&sv}", &key, &value)) {
-		fwupd_device_from_key_value (device, key, value);
+
+	/* integers are cheap to decode now, but strings and arrays are
+	 * only copied out of the (shared) serialized data when used */
+	g_variant_iter_init (&iter, dict);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		if (!fwupd_device_is_lazy_key (key))
+			fwupd_device_from_key_value (device, key, value);
 		g_variant_unref (value);
 	}
+	priv->lazy_dict = g_variant_ref (dict);
 }
 
 /**
@@ -2475,6 +2651,10 @@ fwupd_device_set_from_variant_iter (FwupdDevice *device, GVariantIter *iter)
  *
  * Creates a new device using packed data.
  *
+ * A reference to @value is kept and string and array properties are only
+ * decoded when first used, which is much cheaper when only a few
+ * properties are required.
+ *
  * Returns: (transfer full): a new #FwupdDevice, or %NULL if @value was invalid
  *
  * Since: 1.0.0
@@ -2484,18 +2664,16 @@ fwupd_device_from_variant (GVariant *value)
 {
 	FwupdDevice *dev = NULL;
 	const gchar *type_string;
-	g_autoptr(GVariantIter) iter = NULL;
 
 	/* format from GetDetails */
 	type_string = g_variant_get_type_string (value);
 	if (g_strcmp0 (type_string, "(a{sv})") == 0) {
+		g_autoptr(GVariant) dict = g_variant_get_child_value (value, 0);
 		dev = fwupd_device_new ();
-		g_variant_get (value, "(a{sv})", &iter);
-		fwupd_device_set_from_variant_iter (dev, iter);
+		fwupd_device_set_from_variant_dict (dev, dict);
 	} else if (g_strcmp0 (type_string, "a{sv}") == 0) {
 		dev = fwupd_device_new ();
-		g_variant_get (value, "a{sv}", &iter);
-		fwupd_device_set_from_variant_iter (dev, iter);
+		fwupd_device_set_from_variant_dict (dev, value);
 	} else {
 		g_warning ("type %s not known", type_string);
 	}
@@ -2594,6 +2772,8 @@ fwupd_device_compare (FwupdDevice *device1, FwupdDevice *device2)
 	FwupdDevicePrivate *priv2 = GET_PRIVATE (device2);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device1), 0);
 	g_return_val_if_fail (FWUPD_IS_DEVICE (device2), 0);
+	fwupd_device_ensure (device1, FWUPD_DEVICE_LAZY_ID);
+	fwupd_device_ensure (device2, FWUPD_DEVICE_LAZY_ID);
 	return g_strcmp0 (priv1->id, priv2->id);
 }
 
@@ -203,6 +203,8 @@ fwupd_device_flag_to_string (FwupdDeviceFlags device_flag)
 		return "has-multiple-branches";
 	if (device_flag == FWUPD_DEVICE_FLAG_BACKUP_BEFORE_INSTALL)
 		return "backup-before-install";
+	if (device_flag == FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE)
+		return "cache-prepared-firmware";
 	if (device_flag == FWUPD_DEVICE_FLAG_UNKNOWN)
 		return "unknown";
 	return NULL;
@@ -307,6 +309,8 @@ fwupd_device_flag_from_string (const gchar *device_flag)
 		return FWUPD_DEVICE_FLAG_HAS_MULTIPLE_BRANCHES;
 	if (g_strcmp0 (device_flag, "backup-before-install") == 0)
 		return FWUPD_DEVICE_FLAG_BACKUP_BEFORE_INSTALL;
+	if (g_strcmp0 (device_flag, "cache-prepared-firmware") == 0)
+		return FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE;
 	return FWUPD_DEVICE_FLAG_UNKNOWN;
 }
 
@@ -28,6 +28,67 @@
 
 static void fwupd_release_finalize	 (GObject *object);
 
+/* string and array properties that are only decoded from the GVariant
+ * passed to fwupd_release_from_variant() when first used */
+typedef enum {
+	FWUPD_RELEASE_LAZY_CHECKSUMS,
+	FWUPD_RELEASE_LAZY_CATEGORIES,
+	FWUPD_RELEASE_LAZY_ISSUES,
+	FWUPD_RELEASE_LAZY_METADATA,
+	FWUPD_RELEASE_LAZY_DESCRIPTION,
+	FWUPD_RELEASE_LAZY_FILENAME,
+	FWUPD_RELEASE_LAZY_PROTOCOL,
+	FWUPD_RELEASE_LAZY_HOMEPAGE,
+	FWUPD_RELEASE_LAZY_DETAILS_URL,
+	FWUPD_RELEASE_LAZY_SOURCE_URL,
+	FWUPD_RELEASE_LAZY_APPSTREAM_ID,
+	FWUPD_RELEASE_LAZY_DETACH_CAPTION,
+	FWUPD_RELEASE_LAZY_DETACH_IMAGE,
+	FWUPD_RELEASE_LAZY_LICENSE,
+	FWUPD_RELEASE_LAZY_NAME,
+	FWUPD_RELEASE_LAZY_NAME_VARIANT_SUFFIX,
+	FWUPD_RELEASE_LAZY_SUMMARY,
+	FWUPD_RELEASE_LAZY_BRANCH,
+	FWUPD_RELEASE_LAZY_URI,
+	FWUPD_RELEASE_LAZY_VENDOR,
+	FWUPD_RELEASE_LAZY_VERSION,
+	FWUPD_RELEASE_LAZY_REMOTE_ID,
+	FWUPD_RELEASE_LAZY_UPDATE_MESSAGE,
+	FWUPD_RELEASE_LAZY_UPDATE_IMAGE,
+	FWUPD_RELEASE_LAZY_LAST
+} FwupdReleaseLazy;
+
+static const gchar *fwupd_release_lazy_keys[] = {
+	FWUPD_RESULT_KEY_CHECKSUM,
+	FWUPD_RESULT_KEY_CATEGORIES,
+	FWUPD_RESULT_KEY_ISSUES,
+	FWUPD_RESULT_KEY_METADATA,
+	FWUPD_RESULT_KEY_DESCRIPTION,
+	FWUPD_RESULT_KEY_FILENAME,
+	FWUPD_RESULT_KEY_PROTOCOL,
+	FWUPD_RESULT_KEY_HOMEPAGE,
+	FWUPD_RESULT_KEY_DETAILS_URL,
+	FWUPD_RESULT_KEY_SOURCE_URL,
+	FWUPD_RESULT_KEY_APPSTREAM_ID,
+	FWUPD_RESULT_KEY_DETACH_CAPTION,
+	FWUPD_RESULT_KEY_DETACH_IMAGE,
+	FWUPD_RESULT_KEY_LICENSE,
+	FWUPD_RESULT_KEY_NAME,
+	FWUPD_RESULT_KEY_NAME_VARIANT_SUFFIX,
+	FWUPD_RESULT_KEY_SUMMARY,
+	FWUPD_RESULT_KEY_BRANCH,
+	FWUPD_RESULT_KEY_URI,
+	FWUPD_RESULT_KEY_VENDOR,
+	FWUPD_RESULT_KEY_VERSION,
+	FWUPD_RESULT_KEY_REMOTE_ID,
+	FWUPD_RESULT_KEY_UPDATE_MESSAGE,
+	FWUPD_RESULT_KEY_UPDATE_IMAGE,
+};
+
+static void fwupd_release_ensure		(FwupdRelease	*release,
+						 FwupdReleaseLazy idx);
+static void fwupd_release_ensure_all	(FwupdRelease	*release);
+
 typedef struct {
 	GPtrArray			*checksums;
 	GPtrArray			*categories;
@@ -35,22 +96,22 @@ typedef struct {
 	GHashTable			*metadata;
 	gchar				*description;
 	gchar				*filename;
-	gchar				*protocol;
+	const gchar			*protocol;
 	gchar				*homepage;
 	gchar				*details_url;
 	gchar				*source_url;
 	gchar				*appstream_id;
 	gchar				*detach_caption;
 	gchar				*detach_image;
-	gchar				*license;
+	const gchar			*license;
 	gchar				*name;
 	gchar				*name_variant_suffix;
 	gchar				*summary;
-	gchar				*branch;
+	const gchar			*branch;
 	gchar				*uri;
-	gchar				*vendor;
+	const gchar			*vendor;
 	gchar				*version;
-	gchar				*remote_id;
+	const gchar			*remote_id;
 	guint64				 size;
 	guint64				 created;
 	guint32				 install_duration;
@@ -58,6 +119,8 @@ typedef struct {
 	FwupdReleaseUrgency		 urgency;
 	gchar				*update_message;
 	gchar				*update_image;
+	GVariant			*lazy_dict;	/* a{sv} */
+	guint32				 lazy_done;
 } FwupdReleasePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FwupdRelease, fwupd_release, G_TYPE_OBJECT)
@@ -82,6 +145,7 @@ fwupd_release_get_remote_id (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_REMOTE_ID);
 	return priv->remote_id;
 }
 
@@ -98,9 +162,12 @@ void
 fwupd_release_set_remote_id (FwupdRelease *release, const gchar *remote_id)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
-	g_free (priv->remote_id);
-	priv->remote_id = g_strdup (remote_id);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_REMOTE_ID);
+	old = priv->remote_id;
+	priv->remote_id = fwupd_intern_string_ref (remote_id);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -118,6 +185,7 @@ fwupd_release_get_version (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_VERSION);
 	return priv->version;
 }
 
@@ -135,6 +203,7 @@ fwupd_release_set_version (FwupdRelease *release, const gchar *version)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_VERSION);
 	g_free (priv->version);
 	priv->version = g_strdup (version);
 }
@@ -154,6 +223,7 @@ fwupd_release_get_filename (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_FILENAME);
 	return priv->filename;
 }
 
@@ -171,6 +241,7 @@ fwupd_release_set_filename (FwupdRelease *release, const gchar *filename)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_FILENAME);
 	g_free (priv->filename);
 	priv->filename = g_strdup (filename);
 }
@@ -190,6 +261,7 @@ fwupd_release_get_update_message (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_UPDATE_MESSAGE);
 	return priv->update_message;
 }
 
@@ -207,6 +279,7 @@ fwupd_release_set_update_message (FwupdRelease *release, const gchar *update_mes
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_UPDATE_MESSAGE);
 	g_free (priv->update_message);
 	priv->update_message = g_strdup (update_message);
 }
@@ -226,6 +299,7 @@ fwupd_release_get_update_image (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_UPDATE_IMAGE);
 	return priv->update_image;
 }
 
@@ -243,6 +317,7 @@ fwupd_release_set_update_image (FwupdRelease *release, const gchar *update_image
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_UPDATE_IMAGE);
 	g_free (priv->update_image);
 	priv->update_image = g_strdup (update_image);
 }
@@ -262,6 +337,7 @@ fwupd_release_get_protocol (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_PROTOCOL);
 	return priv->protocol;
 }
 
@@ -278,9 +354,12 @@ void
 fwupd_release_set_protocol (FwupdRelease *release, const gchar *protocol)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
-	g_free (priv->protocol);
-	priv->protocol = g_strdup (protocol);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_PROTOCOL);
+	old = priv->protocol;
+	priv->protocol = fwupd_intern_string_ref (protocol);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -298,6 +377,7 @@ fwupd_release_get_issues (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_ISSUES);
 	return priv->issues;
 }
 
@@ -316,6 +396,7 @@ fwupd_release_add_issue (FwupdRelease *release, const gchar *issue)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (issue != NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_ISSUES);
 	for (guint i = 0; i < priv->issues->len; i++) {
 		const gchar *issue_tmp = g_ptr_array_index (priv->issues, i);
 		if (g_strcmp0 (issue_tmp, issue) == 0)
@@ -339,6 +420,7 @@ fwupd_release_get_categories (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CATEGORIES);
 	return priv->categories;
 }
 
@@ -357,6 +439,7 @@ fwupd_release_add_category (FwupdRelease *release, const gchar *category)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (category != NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CATEGORIES);
 	for (guint i = 0; i < priv->categories->len; i++) {
 		const gchar *category_tmp = g_ptr_array_index (priv->categories, i);
 		if (g_strcmp0 (category_tmp, category) == 0)
@@ -382,6 +465,7 @@ fwupd_release_has_category (FwupdRelease *release, const gchar *category)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), FALSE);
 	g_return_val_if_fail (category != NULL, FALSE);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CATEGORIES);
 	for (guint i = 0; i < priv->categories->len; i++) {
 		const gchar *category_tmp = g_ptr_array_index (priv->categories, i);
 		if (g_strcmp0 (category_tmp, category) == 0)
@@ -405,6 +489,7 @@ fwupd_release_get_checksums (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CHECKSUMS);
 	return priv->checksums;
 }
 
@@ -423,6 +508,7 @@ fwupd_release_add_checksum (FwupdRelease *release, const gchar *checksum)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (checksum != NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CHECKSUMS);
 	for (guint i = 0; i < priv->checksums->len; i++) {
 		const gchar *checksum_tmp = g_ptr_array_index (priv->checksums, i);
 		if (g_strcmp0 (checksum_tmp, checksum) == 0)
@@ -448,6 +534,7 @@ fwupd_release_has_checksum (FwupdRelease *release, const gchar *checksum)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), FALSE);
 	g_return_val_if_fail (checksum != NULL, FALSE);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_CHECKSUMS);
 	for (guint i = 0; i < priv->checksums->len; i++) {
 		const gchar *checksum_tmp = g_ptr_array_index (priv->checksums, i);
 		if (g_strcmp0 (checksum_tmp, checksum) == 0)
@@ -471,6 +558,7 @@ fwupd_release_get_metadata (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_METADATA);
 	return priv->metadata;
 }
 
@@ -491,6 +579,7 @@ fwupd_release_add_metadata_item (FwupdRelease *release, const gchar *key, const
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (key != NULL);
 	g_return_if_fail (value != NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_METADATA);
 	g_hash_table_insert (priv->metadata, g_strdup (key), g_strdup (value));
 }
 
@@ -511,6 +600,7 @@ fwupd_release_add_metadata (FwupdRelease *release, GHashTable *hash)
 
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (hash != NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_METADATA);
 
 	/* deep copy the whole map */
 	keys = g_hash_table_get_keys (hash);
@@ -538,6 +628,7 @@ fwupd_release_get_metadata_item (FwupdRelease *release, const gchar *key)
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
 	g_return_val_if_fail (key != NULL, NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_METADATA);
 	return g_hash_table_lookup (priv->metadata, key);
 }
 
@@ -556,6 +647,7 @@ fwupd_release_get_uri (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_URI);
 	return priv->uri;
 }
 
@@ -573,6 +665,7 @@ fwupd_release_set_uri (FwupdRelease *release, const gchar *uri)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_URI);
 	g_free (priv->uri);
 	priv->uri = g_strdup (uri);
 }
@@ -592,6 +685,7 @@ fwupd_release_get_homepage (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_HOMEPAGE);
 	return priv->homepage;
 }
 
@@ -609,6 +703,7 @@ fwupd_release_set_homepage (FwupdRelease *release, const gchar *homepage)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_HOMEPAGE);
 	g_free (priv->homepage);
 	priv->homepage = g_strdup (homepage);
 }
@@ -628,6 +723,7 @@ fwupd_release_get_details_url (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETAILS_URL);
 	return priv->details_url;
 }
 
@@ -645,6 +741,7 @@ fwupd_release_set_details_url (FwupdRelease *release, const gchar *details_url)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETAILS_URL);
 	g_free (priv->details_url);
 	priv->details_url = g_strdup (details_url);
 }
@@ -664,6 +761,7 @@ fwupd_release_get_source_url (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_SOURCE_URL);
 	return priv->source_url;
 }
 
@@ -681,6 +779,7 @@ fwupd_release_set_source_url (FwupdRelease *release, const gchar *source_url)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_SOURCE_URL);
 	g_free (priv->source_url);
 	priv->source_url = g_strdup (source_url);
 }
@@ -700,6 +799,7 @@ fwupd_release_get_description (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DESCRIPTION);
 	return priv->description;
 }
 
@@ -717,6 +817,7 @@ fwupd_release_set_description (FwupdRelease *release, const gchar *description)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DESCRIPTION);
 	g_free (priv->description);
 	priv->description = g_strdup (description);
 }
@@ -736,6 +837,7 @@ fwupd_release_get_appstream_id (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_APPSTREAM_ID);
 	return priv->appstream_id;
 }
 
@@ -753,6 +855,7 @@ fwupd_release_set_appstream_id (FwupdRelease *release, const gchar *appstream_id
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_APPSTREAM_ID);
 	g_free (priv->appstream_id);
 	priv->appstream_id = g_strdup (appstream_id);
 }
@@ -772,6 +875,7 @@ fwupd_release_get_detach_caption (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETACH_CAPTION);
 	return priv->detach_caption;
 }
 
@@ -789,6 +893,7 @@ fwupd_release_set_detach_caption (FwupdRelease *release, const gchar *detach_cap
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETACH_CAPTION);
 	g_free (priv->detach_caption);
 	priv->detach_caption = g_strdup (detach_caption);
 }
@@ -808,6 +913,7 @@ fwupd_release_get_detach_image (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETACH_IMAGE);
 	return priv->detach_image;
 }
 
@@ -825,6 +931,7 @@ fwupd_release_set_detach_image (FwupdRelease *release, const gchar *detach_image
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_DETACH_IMAGE);
 	g_free (priv->detach_image);
 	priv->detach_image = g_strdup (detach_image);
 }
@@ -914,6 +1021,7 @@ fwupd_release_get_summary (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_SUMMARY);
 	return priv->summary;
 }
 
@@ -931,6 +1039,7 @@ fwupd_release_set_summary (FwupdRelease *release, const gchar *summary)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_SUMMARY);
 	g_free (priv->summary);
 	priv->summary = g_strdup (summary);
 }
@@ -950,6 +1059,7 @@ fwupd_release_get_branch (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_BRANCH);
 	return priv->branch;
 }
 
@@ -966,9 +1076,12 @@ void
 fwupd_release_set_branch (FwupdRelease *release, const gchar *branch)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
-	g_free (priv->branch);
-	priv->branch = g_strdup (branch);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_BRANCH);
+	old = priv->branch;
+	priv->branch = fwupd_intern_string_ref (branch);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -986,6 +1099,7 @@ fwupd_release_get_vendor (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_VENDOR);
 	return priv->vendor;
 }
 
@@ -1002,9 +1116,12 @@ void
 fwupd_release_set_vendor (FwupdRelease *release, const gchar *vendor)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
-	g_free (priv->vendor);
-	priv->vendor = g_strdup (vendor);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_VENDOR);
+	old = priv->vendor;
+	priv->vendor = fwupd_intern_string_ref (vendor);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -1022,6 +1139,7 @@ fwupd_release_get_license (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_LICENSE);
 	return priv->license;
 }
 
@@ -1038,9 +1156,12 @@ void
 fwupd_release_set_license (FwupdRelease *release, const gchar *license)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	const gchar *old;
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
-	g_free (priv->license);
-	priv->license = g_strdup (license);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_LICENSE);
+	old = priv->license;
+	priv->license = fwupd_intern_string_ref (license);
+	fwupd_intern_string_unref (old);
 }
 
 /**
@@ -1058,6 +1179,7 @@ fwupd_release_get_name (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_NAME);
 	return priv->name;
 }
 
@@ -1075,6 +1197,7 @@ fwupd_release_set_name (FwupdRelease *release, const gchar *name)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_NAME);
 	g_free (priv->name);
 	priv->name = g_strdup (name);
 }
@@ -1094,6 +1217,7 @@ fwupd_release_get_name_variant_suffix (FwupdRelease *release)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_NAME_VARIANT_SUFFIX);
 	return priv->name_variant_suffix;
 }
 
@@ -1111,6 +1235,7 @@ fwupd_release_set_name_variant_suffix (FwupdRelease *release, const gchar *name_
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
+	fwupd_release_ensure (release, FWUPD_RELEASE_LAZY_NAME_VARIANT_SUFFIX);
 	g_free (priv->name_variant_suffix);
 	priv->name_variant_suffix = g_strdup (name_variant_suffix);
 }
@@ -1328,6 +1453,7 @@ fwupd_release_to_variant (FwupdRelease *release)
 	GVariantBuilder builder;
 
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure_all (release);
 
 	/* create an array with all the metadata in */
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
@@ -1612,6 +1738,47 @@ fwupd_release_from_key_value (FwupdRelease *release, const gchar *key, GVariant
 	}
 }
 
+static gboolean
+fwupd_release_is_lazy_key (const gchar *key)
+{
+	for (guint i = 0; i < FWUPD_RELEASE_LAZY_LAST; i++) {
+		if (g_strcmp0 (key, fwupd_release_lazy_keys[i]) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+fwupd_release_ensure (FwupdRelease *release, FwupdReleaseLazy idx)
+{
+	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	g_autoptr(GVariant) value = NULL;
+
+	/* not created from a variant, or already decoded */
+	if (priv->lazy_dict == NULL)
+		return;
+	if (priv->lazy_done & (1u << idx))
+		return;
+
+	/* set first as the setters called below also ensure */
+	priv->lazy_done |= 1u << idx;
+	value = g_variant_lookup_value (priv->lazy_dict, fwupd_release_lazy_keys[idx], NULL);
+	if (value != NULL)
+		fwupd_release_from_key_value (release, fwupd_release_lazy_keys[idx], value);
+
+	/* nothing more to decode */
+	if (priv->lazy_done == (1u << FWUPD_RELEASE_LAZY_LAST) - 1)
+		g_clear_pointer (&priv->lazy_dict, g_variant_unref);
+}
+
+static void
+fwupd_release_ensure_all (FwupdRelease *release)
+{
+	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	for (guint i = 0; i < FWUPD_RELEASE_LAZY_LAST && priv->lazy_dict != NULL; i++)
+		fwupd_release_ensure (release, i);
+}
+
 static void
 fwupd_pad_kv_str (GString *str, const gchar *key, const gchar *value)
 {
@@ -1716,6 +1883,7 @@ fwupd_release_to_json (FwupdRelease *release, JsonBuilder *builder)
 
 	g_return_if_fail (FWUPD_IS_RELEASE (release));
 	g_return_if_fail (builder != NULL);
+	fwupd_release_ensure_all (release);
 
 	fwupd_release_json_add_string (builder, FWUPD_RESULT_KEY_APPSTREAM_ID, priv->appstream_id);
 	fwupd_release_json_add_string (builder, FWUPD_RESULT_KEY_REMOTE_ID, priv->remote_id);
@@ -1805,6 +1973,7 @@ fwupd_release_to_string (FwupdRelease *release)
 	g_autoptr(GList) keys = NULL;
 
 	g_return_val_if_fail (FWUPD_IS_RELEASE (release), NULL);
+	fwupd_release_ensure_all (release);
 
 	str = g_string_new ("");
 	fwupd_pad_kv_str (str, FWUPD_RESULT_KEY_APPSTREAM_ID, priv->appstream_id);
@@ -1884,41 +2053,51 @@ fwupd_release_finalize (GObject *object)
 
 	g_free (priv->description);
 	g_free (priv->filename);
-	g_free (priv->protocol);
 	g_free (priv->appstream_id);
 	g_free (priv->detach_caption);
 	g_free (priv->detach_image);
-	g_free (priv->license);
 	g_free (priv->name);
 	g_free (priv->name_variant_suffix);
 	g_free (priv->summary);
-	g_free (priv->branch);
 	g_free (priv->uri);
 	g_free (priv->homepage);
 	g_free (priv->details_url);
 	g_free (priv->source_url);
-	g_free (priv->vendor);
 	g_free (priv->version);
-	g_free (priv->remote_id);
+	fwupd_intern_string_unref (priv->protocol);
+	fwupd_intern_string_unref (priv->license);
+	fwupd_intern_string_unref (priv->branch);
+	fwupd_intern_string_unref (priv->vendor);
+	fwupd_intern_string_unref (priv->remote_id);
 	g_free (priv->update_message);
 	g_free (priv->update_image);
 	g_ptr_array_unref (priv->categories);
 	g_ptr_array_unref (priv->issues);
 	g_ptr_array_unref (priv->checksums);
 	g_hash_table_unref (priv->metadata);
+	if (priv->lazy_dict != NULL)
+		g_variant_unref (priv->lazy_dict);
 
 	G_OBJECT_CLASS (fwupd_release_parent_class)->finalize (object);
 }
 
 static void
-fwupd_release_set_from_variant_iter (FwupdRelease *release, GVariantIter *iter)
+fwupd_release_set_from_variant_dict (FwupdRelease *release, GVariant *dict)
 {
+	FwupdReleasePrivate *priv = GET_PRIVATE (release);
+	GVariantIter iter;
 	GVariant *value;
 	const gchar *key;
-	while (g_variant_iter_next (iter, "{&sv}", &key, &value)) {
-		fwupd_release_from_key_value (release, key, value);
+
+	/* integers are cheap to decode now, but strings and arrays are
+	 * only copied out of the (shared) serialized data when used */
+	g_variant_iter_init (&iter, dict);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		if (!fwupd_release_is_lazy_key (key))
+			fwupd_release_from_key_value (release, key, value);
 		g_variant_unref (value);
 	}
+	priv->lazy_dict = g_variant_ref (dict);
 }
 
 /**
@@ -1927,6 +2106,10 @@ fwupd_release_set_from_variant_iter (FwupdRelease *release, GVariantIter *iter)
  *
  * Creates a new release using packed data.
  *
+ * A reference to @value is kept and string and array properties are only
+ * decoded when first used, which is much cheaper when only a few
+ * properties are required.
+ *
  * Returns: (transfer full): a new #FwupdRelease, or %NULL if @value was invalid
  *
  * Since: 1.0.0
@@ -1936,18 +2119,16 @@ fwupd_release_from_variant (GVariant *value)
 {
 	FwupdRelease *rel = NULL;
 	const gchar *type_string;
-	g_autoptr(GVariantIter) iter = NULL;
 
 	/* format from GetDetails */
 	type_string = g_variant_get_type_string (value);
 	if (g_strcmp0 (type_string, "(a{sv})") == 0) {
+		g_autoptr(GVariant) dict = g_variant_get_child_value (value, 0);
 		rel = fwupd_release_new ();
-		g_variant_get (value, "(a{sv})", &iter);
-		fwupd_release_set_from_variant_iter (rel, iter);
+		fwupd_release_set_from_variant_dict (rel, dict);
 	} else if (g_strcmp0 (type_string, "a{sv}") == 0) {
 		rel = fwupd_release_new ();
-		g_variant_get (value, "a{sv}", &iter);
-		fwupd_release_set_from_variant_iter (rel, iter);
+		fwupd_release_set_from_variant_dict (rel, value);
 	} else {
 		g_warning ("type %s not known", type_string);
 	}
@@ -6,6 +6,7 @@
 
 #include "config.h"
 
+#include <gio/gio.h>
 #include <glib-object.h>
 #include <string.h>
 #ifdef HAVE_FNMATCH_H
@@ -14,7 +15,7 @@
 
 #include "fwupd-client.h"
 #include "fwupd-client-sync.h"
-#include "fwupd-common.h"
+#include "fwupd-common-private.h"
 #include "fwupd-enums.h"
 #include "fwupd-error.h"
 #include "fwupd-device-private.h"
@@ -312,6 +313,47 @@ fwupd_release_func (void)
 	g_assert_cmpstr (fwupd_release_get_metadata_item (release2, "baz"), ==, "bam");
 }
 
+static void
+fwupd_device_lazy_func (void)
+{
+	FwupdRelease *rel_tmp;
+	g_autofree gchar *str1 = NULL;
+	g_autofree gchar *str2 = NULL;
+	g_autoptr(FwupdDevice) dev1 = fwupd_device_new ();
+	g_autoptr(FwupdDevice) dev2 = NULL;
+	g_autoptr(FwupdRelease) rel = fwupd_release_new ();
+	g_autoptr(GVariant) data = NULL;
+
+	fwupd_device_set_id (dev1, "USB:foo");
+	fwupd_device_set_name (dev1, "ColorHug2");
+	fwupd_device_set_version (dev1, "1.2.3");
+	fwupd_device_set_flags (dev1, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fwupd_device_add_guid (dev1, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	fwupd_release_set_version (rel, "1.2.4");
+	fwupd_release_set_description (rel, "<p>Hi there!</p>");
+	fwupd_device_add_release (dev1, rel);
+	data = fwupd_device_to_variant (dev1);
+
+	/* decoded on demand */
+	dev2 = fwupd_device_from_variant (data);
+	g_assert_true (fwupd_device_has_flag (dev2, FWUPD_DEVICE_FLAG_UPDATABLE));
+	g_assert_cmpstr (fwupd_device_get_name (dev2), ==, "ColorHug2");
+	g_assert_true (fwupd_device_has_guid (dev2, "2082b5e0-7a64-478a-b1b2-e3404fab6dad"));
+	rel_tmp = fwupd_device_get_release_default (dev2);
+	g_assert_nonnull (rel_tmp);
+	g_assert_cmpstr (fwupd_release_get_description (rel_tmp), ==, "<p>Hi there!</p>");
+
+	/* setting a property replaces the packed value */
+	fwupd_device_set_version (dev2, "1.2.4");
+	g_assert_cmpstr (fwupd_device_get_version (dev2), ==, "1.2.4");
+
+	/* everything else is still there */
+	fwupd_device_set_version (dev1, "1.2.4");
+	str1 = fwupd_device_to_string (dev1);
+	str2 = fwupd_device_to_string (dev2);
+	g_assert_cmpstr (str1, ==, str2);
+}
+
 static void
 fwupd_device_func (void)
 {
@@ -488,6 +530,64 @@ fwupd_client_devices_func (void)
 	g_assert_cmpstr (fwupd_device_get_id (dev), !=, NULL);
 }
 
+static void
+fwupd_client_batch_func (void)
+{
+	gboolean ret;
+	GPtrArray *rels;
+	g_autoptr(FwupdClient) client = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) device_ids = g_ptr_array_new ();
+	g_autoptr(GPtrArray) rels_all = NULL;
+
+	client = fwupd_client_new ();
+
+	/* only run if running fwupd is new enough */
+	ret = fwupd_client_connect (client, NULL, &error);
+	if (ret == FALSE && g_error_matches (error, G_DBUS_ERROR, G_DBUS_ERROR_TIMED_OUT)) {
+		g_debug ("%s", error->message);
+		g_test_skip ("timeout connecting to daemon");
+		return;
+	}
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	if (fwupd_client_get_daemon_version (client) == NULL) {
+		g_test_skip ("no enabled fwupd daemon");
+		return;
+	}
+	if (!g_str_has_prefix (fwupd_client_get_daemon_version (client), "1.")) {
+		g_test_skip ("running fwupd is too old");
+		return;
+	}
+	devices = fwupd_client_get_devices (client, NULL, &error);
+	if (devices == NULL) {
+		g_test_skip ("no available fwupd devices");
+		return;
+	}
+
+	/* a device that was removed does not fail the others */
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		g_ptr_array_add (device_ids, (gpointer) fwupd_device_get_id (dev));
+	}
+	g_ptr_array_add (device_ids, (gpointer) "0000000000000000000000000000000000000000");
+	rels_all = fwupd_client_get_releases_batch (client, device_ids, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rels_all);
+	g_assert_cmpint (rels_all->len, ==, device_ids->len);
+	rels = g_ptr_array_index (rels_all, device_ids->len - 1);
+	g_assert_cmpint (rels->len, ==, 0);
+	g_clear_pointer (&rels_all, g_ptr_array_unref);
+
+	rels_all = fwupd_client_get_upgrades_batch (client, device_ids, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (rels_all);
+	g_assert_cmpint (rels_all->len, ==, device_ids->len);
+	rels = g_ptr_array_index (rels_all, device_ids->len - 1);
+	g_assert_cmpint (rels->len, ==, 0);
+}
+
 static void
 fwupd_client_remotes_func (void)
 {
@@ -549,6 +649,494 @@ fwupd_client_remotes_func (void)
 	g_assert (remote3 == NULL);
 }
 
+#define FWUPD_TEST_HTTP_ETAG	"\"fwupd-self-test\""
+
+typedef struct {
+	GBytes		*blob;
+	gint		 partial_cnt;	/* atomic */
+} FwupdTestHttpServer;
+
+static gboolean
+fwupd_test_http_run_cb (GThreadedSocketService *service,
+			GSocketConnection *connection,
+			GObject *source_object,
+			gpointer user_data)
+{
+	FwupdTestHttpServer *server = (FwupdTestHttpServer *) user_data;
+	GOutputStream *ostream = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+	gsize offset = 0;
+	gsize bufsz = g_bytes_get_size (server->blob);
+	gboolean unchanged = TRUE;
+	const guint8 *buf = g_bytes_get_data (server->blob, NULL);
+	g_autofree gchar *hdr = NULL;
+	g_autoptr(GDataInputStream) dstream = NULL;
+
+	/* every path has the same contents, and byte ranges are supported */
+	dstream = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+	for (;;) {
+		g_autofree gchar *line = g_data_input_stream_read_line (dstream, NULL, NULL, NULL);
+		if (line == NULL || line[0] == '\r' || line[0] == '\0')
+			break;
+		g_strstrip (line);
+		if (g_ascii_strncasecmp (line, "Range: bytes=", 13) == 0)
+			offset = g_ascii_strtoull (line + 13, NULL, 10);
+		else if (g_ascii_strncasecmp (line, "If-Range: ", 10) == 0)
+			unchanged = g_strcmp0 (line + 10, FWUPD_TEST_HTTP_ETAG) == 0;
+	}
+	if (offset > 0 && offset < bufsz && unchanged) {
+		g_atomic_int_inc (&server->partial_cnt);
+		hdr = g_strdup_printf ("HTTP/1.1 206 Partial Content\r\n"
+				       "Content-Range: bytes %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT "/%" G_GSIZE_FORMAT "\r\n"
+				       "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+				       "ETag: " FWUPD_TEST_HTTP_ETAG "\r\n"
+				       "Connection: close\r\n\r\n",
+				       offset, bufsz - 1, bufsz, bufsz - offset);
+	} else {
+		offset = 0;
+		hdr = g_strdup_printf ("HTTP/1.1 200 OK\r\n"
+				       "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+				       "ETag: " FWUPD_TEST_HTTP_ETAG "\r\n"
+				       "Connection: close\r\n\r\n",
+				       bufsz);
+	}
+	if (!g_output_stream_write_all (ostream, hdr, strlen (hdr), NULL, NULL, NULL))
+		return FALSE;
+	g_output_stream_write_all (ostream, buf + offset, bufsz - offset, NULL, NULL, NULL);
+	return FALSE;
+}
+
+typedef struct {
+	GMainLoop	*loop;
+	gboolean	 ret;
+	GError		*error;
+	guint		 status_cnt;
+	guint		 percentage_cnt;
+} FwupdClientRefreshHelper;
+
+static void
+fwupd_client_refresh_status_changed_cb (FwupdClient *client,
+					FwupdStatus status,
+					gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	g_assert_true (g_main_context_is_owner (g_main_context_default ()));
+	helper->status_cnt++;
+}
+
+static void
+fwupd_client_refresh_percentage_cb (GObject *object,
+				    GParamSpec *pspec,
+				    gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	g_assert_true (g_main_context_is_owner (g_main_context_default ()));
+	g_assert_cmpint (fwupd_client_get_percentage (FWUPD_CLIENT (object)), <=, 100);
+	helper->percentage_cnt++;
+}
+
+static void
+fwupd_client_refresh_remotes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	helper->ret = fwupd_client_refresh_remotes_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+static void
+fwupd_client_refresh_remotes_func (void)
+{
+	guint16 port;
+	gsize bufsz = 4 * 1024 * 1024;
+	g_autofree gchar *tmpdir = NULL;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autoptr(FwupdClient) client = fwupd_client_new ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+	g_autoptr(GPtrArray) remotes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GSocketService) service = g_threaded_socket_service_new (4);
+	FwupdClientRefreshHelper helper = { loop, FALSE, NULL, 0, 0 };
+	FwupdTestHttpServer server = { NULL, 0 };
+
+	/* do not send requests for localhost to a proxy */
+	g_unsetenv ("https_proxy");
+	g_unsetenv ("HTTPS_PROXY");
+	g_unsetenv ("http_proxy");
+	g_unsetenv ("HTTP_PROXY");
+
+	/* serve something large enough to report progress */
+	memset (buf, 'x', bufsz);
+	blob = g_bytes_new_take (g_steal_pointer (&buf), bufsz);
+	port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (port, !=, 0);
+	server.blob = blob;
+	g_signal_connect (service, "run", G_CALLBACK (fwupd_test_http_run_cb), &server);
+	g_socket_service_start (service);
+
+	/* the signature matches what was served, so no metadata is required */
+	tmpdir = g_dir_make_tmp ("fwupd-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	for (guint i = 0; i < 2; i++) {
+		gboolean ret;
+		g_autofree gchar *conf = NULL;
+		g_autofree gchar *fn_conf = NULL;
+		g_autofree gchar *fn_sig = NULL;
+		g_autofree gchar *id = g_strdup_printf ("test%u", i);
+		g_autofree gchar *path = g_build_filename (tmpdir, id, NULL);
+		g_autoptr(FwupdRemote) remote = fwupd_remote_new ();
+
+		conf = g_strdup_printf ("[fwupd Remote]\n"
+					"Enabled=true\n"
+					"Keyring=gpg\n"
+					"MetadataURI=http://127.0.0.1:%u/%s/firmware.xml.gz\n",
+					port, id);
+		fn_conf = g_strdup_printf ("%s.conf", path);
+		ret = g_file_set_contents (fn_conf, conf, -1, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		g_assert_cmpint (g_mkdir_with_parents (path, 0700), ==, 0);
+		fn_sig = g_build_filename (path, "metadata.xml.gz.asc", NULL);
+		ret = g_file_set_contents (fn_sig,
+					   g_bytes_get_data (blob, NULL),
+					   (gssize) g_bytes_get_size (blob),
+					   &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+
+		fwupd_remote_set_remotes_dir (remote, tmpdir);
+		ret = fwupd_remote_load_from_filename (remote, fn_conf, NULL, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		g_assert_cmpstr (fwupd_remote_get_checksum (remote), !=, NULL);
+		g_ptr_array_add (remotes, g_steal_pointer (&remote));
+	}
+
+	/* progress is only emitted in the context of the caller */
+	fwupd_client_set_user_agent (client, "fwupd/" PACKAGE_VERSION);
+	g_signal_connect (client, "status-changed",
+			  G_CALLBACK (fwupd_client_refresh_status_changed_cb), &helper);
+	g_signal_connect (client, "notify::percentage",
+			  G_CALLBACK (fwupd_client_refresh_percentage_cb), &helper);
+	fwupd_client_refresh_remotes_async (client, remotes, NULL,
+					    fwupd_client_refresh_remotes_cb,
+					    &helper);
+	g_main_loop_run (loop);
+	g_assert_no_error (helper.error);
+	g_assert_true (helper.ret);
+	g_assert_cmpint (helper.status_cnt, >=, 2);
+	g_assert_cmpint (helper.percentage_cnt, >, 0);
+	g_assert_cmpint (fwupd_client_get_status (client), ==, FWUPD_STATUS_IDLE);
+	g_socket_service_stop (service);
+}
+
+static void
+fwupd_client_download_file_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	helper->ret = fwupd_client_download_file_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+static void
+fwupd_client_download_file_check (FwupdClient *client,
+				  FwupdTestHttpServer *server,
+				  const gchar *url,
+				  GFile *file,
+				  gint partial_cnt)
+{
+	gboolean ret;
+	gsize bufsz = 0;
+	g_autofree gchar *buf = NULL;
+	g_autofree gchar *fn = g_file_get_path (file);
+	g_autofree gchar *fn_part = g_strdup_printf ("%s.part", fn);
+	g_autofree gchar *fn_info = g_strdup_printf ("%s.part.info", fn);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+	FwupdClientRefreshHelper helper = { loop, FALSE, NULL, 0, 0 };
+
+	g_atomic_int_set (&server->partial_cnt, 0);
+	fwupd_client_download_file_async (client, url, file,
+					  FWUPD_CLIENT_DOWNLOAD_FLAG_RESUME, NULL,
+					  fwupd_client_download_file_cb, &helper);
+	g_main_loop_run (loop);
+	g_assert_no_error (helper.error);
+	g_assert_true (helper.ret);
+	g_assert_cmpint (g_atomic_int_get (&server->partial_cnt), ==, partial_cnt);
+	ret = g_file_get_contents (fn, &buf, &bufsz, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (bufsz, ==, g_bytes_get_size (server->blob));
+	g_assert_cmpint (memcmp (buf, g_bytes_get_data (server->blob, NULL), bufsz), ==, 0);
+	g_assert_false (g_file_test (fn_part, G_FILE_TEST_EXISTS));
+	g_assert_false (g_file_test (fn_info, G_FILE_TEST_EXISTS));
+}
+
+static void
+fwupd_client_download_file_func (void)
+{
+	gboolean ret;
+	guint16 port;
+	gsize bufsz = 1024 * 1024;
+	g_autofree gchar *fn = NULL;
+	g_autofree gchar *fn_info = NULL;
+	g_autofree gchar *fn_part = NULL;
+	g_autofree gchar *info_changed = NULL;
+	g_autofree gchar *info_valid = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	g_autofree gchar *url = NULL;
+	g_autofree gchar *url_other = NULL;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autofree gchar *junk = g_strnfill (bufsz / 2, 'y');
+	g_autoptr(FwupdClient) client = fwupd_client_new ();
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GSocketService) service = g_threaded_socket_service_new (4);
+	FwupdTestHttpServer server = { NULL, 0 };
+
+	/* do not send requests for localhost to a proxy */
+	g_unsetenv ("https_proxy");
+	g_unsetenv ("HTTPS_PROXY");
+	g_unsetenv ("http_proxy");
+	g_unsetenv ("HTTP_PROXY");
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8) i;
+	blob = g_bytes_new_take (g_steal_pointer (&buf), bufsz);
+	server.blob = blob;
+	port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (port, !=, 0);
+	g_signal_connect (service, "run", G_CALLBACK (fwupd_test_http_run_cb), &server);
+	g_socket_service_start (service);
+
+	tmpdir = g_dir_make_tmp ("fwupd-self-test-XXXXXX", &error);
+	g_assert_no_error (error);
+	fn = g_build_filename (tmpdir, "firmware.bin", NULL);
+	fn_part = g_strdup_printf ("%s.part", fn);
+	fn_info = g_strdup_printf ("%s.part.info", fn);
+	file = g_file_new_for_path (fn);
+	url = g_strdup_printf ("http://127.0.0.1:%u/firmware.bin", port);
+	url_other = g_strdup_printf ("http://127.0.0.1:%u/other.bin", port);
+	info_valid = g_strdup_printf ("[fwupd Download]\n"
+				      "URL=%s\n"
+				      "ETag=" FWUPD_TEST_HTTP_ETAG "\n",
+				      url);
+	info_changed = g_strdup_printf ("[fwupd Download]\n"
+					"URL=%s\n"
+					"ETag=\"changed\"\n",
+					url);
+	fwupd_client_set_user_agent (client, "fwupd/" PACKAGE_VERSION);
+
+	/* a partial download with nothing to say what it is of is ignored */
+	ret = g_file_set_contents (fn_part, junk, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fwupd_client_download_file_check (client, &server, url, file, 0);
+
+	/* ...as is one from a different URL */
+	ret = g_file_set_contents (fn_part, junk, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_file_set_contents (fn_info, info_valid, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fwupd_client_download_file_check (client, &server, url_other, file, 0);
+
+	/* ...and one where the resource has changed since */
+	ret = g_file_set_contents (fn_part, junk, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_file_set_contents (fn_info, info_changed, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fwupd_client_download_file_check (client, &server, url, file, 0);
+
+	/* a valid partial download is resumed */
+	ret = g_file_set_contents (fn_part, g_bytes_get_data (blob, NULL), bufsz / 2, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_file_set_contents (fn_info, info_valid, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fwupd_client_download_file_check (client, &server, url, file, 1);
+	g_socket_service_stop (service);
+}
+
+static const gchar *fwupd_test_daemon_xml =
+	"<node>"
+	"  <interface name='" FWUPD_DBUS_INTERFACE "'>"
+	"    <method name='GetDevices'>"
+	"      <arg type='aa{sv}' name='devices' direction='out'/>"
+	"    </method>"
+	"    <method name='GetRemotes'>"
+	"      <arg type='aa{sv}' name='remotes' direction='out'/>"
+	"    </method>"
+	"    <signal name='DeviceAdded'>"
+	"      <arg type='a{sv}' name='device'/>"
+	"    </signal>"
+	"    <signal name='DeviceRemoved'>"
+	"      <arg type='a{sv}' name='device'/>"
+	"    </signal>"
+	"  </interface>"
+	"</node>";
+
+static void
+fwupd_test_daemon_emit_device (GDBusConnection *connection,
+			       const gchar *signal_name,
+			       const gchar *device_id)
+{
+	GVariant *val;
+	g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+	g_autoptr(GError) error = NULL;
+
+	fwupd_device_set_id (dev, device_id);
+	val = fwupd_device_to_variant (dev);
+	g_dbus_connection_emit_signal (connection, NULL,
+				       FWUPD_DBUS_PATH,
+				       FWUPD_DBUS_INTERFACE,
+				       signal_name,
+				       g_variant_new_tuple (&val, 1),
+				       &error);
+	g_assert_no_error (error);
+}
+
+static void
+fwupd_test_daemon_method_call_cb (GDBusConnection *connection,
+				  const gchar *sender,
+				  const gchar *object_path,
+				  const gchar *interface_name,
+				  const gchar *method_name,
+				  GVariant *parameters,
+				  GDBusMethodInvocation *invocation,
+				  gpointer user_data)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+	if (g_strcmp0 (method_name, "GetDevices") == 0) {
+		g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+		fwupd_device_set_id (dev, "1111111111111111111111111111111111111111");
+		g_variant_builder_add_value (&builder, fwupd_device_to_variant (dev));
+		g_dbus_method_invocation_return_value (invocation,
+						       g_variant_new ("(aa{sv})", &builder));
+		return;
+	}
+
+	/* the devices have already been sent, so the client has to apply these
+	 * even though it is still waiting for the remotes */
+	fwupd_test_daemon_emit_device (connection, "DeviceAdded",
+				       "2222222222222222222222222222222222222222");
+	fwupd_test_daemon_emit_device (connection, "DeviceRemoved",
+				       "1111111111111111111111111111111111111111");
+	g_dbus_method_invocation_return_value (invocation,
+					       g_variant_new ("(aa{sv})", &builder));
+}
+
+static void
+fwupd_client_load_cache_connect_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	helper->ret = fwupd_client_connect_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+static void
+fwupd_client_load_cache_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientRefreshHelper *helper = (FwupdClientRefreshHelper *) user_data;
+	helper->ret = fwupd_client_load_cache_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+static void
+fwupd_client_load_cache_func (void)
+{
+	const gchar *address;
+	guint registration_id;
+	GPtrArray *devices;
+	GDBusInterfaceVTable vtable = { fwupd_test_daemon_method_call_cb, NULL, NULL };
+	g_autofree gchar *dbus_daemon = g_find_program_in_path ("dbus-daemon");
+	g_autoptr(FwupdClient) client = NULL;
+	g_autoptr(GDBusConnection) conn = NULL;
+	g_autoptr(GDBusConnection) conn_system = NULL;
+	g_autoptr(GDBusNodeInfo) node = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+	g_autoptr(GTestDBus) bus = NULL;
+	g_autoptr(GVariant) val = NULL;
+	FwupdClientRefreshHelper helper = { loop, FALSE, NULL, 0, 0 };
+
+	/* the system bus is a per-process singleton, so use a fresh process */
+	if (dbus_daemon == NULL) {
+		g_test_skip ("no dbus-daemon");
+		return;
+	}
+	if (!g_test_subprocess ()) {
+		g_test_trap_subprocess (NULL, 0, 0);
+		g_test_trap_assert_passed ();
+		return;
+	}
+
+	/* pretend to be the daemon on a private bus */
+	bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+	g_test_dbus_up (bus);
+	address = g_test_dbus_get_bus_address (bus);
+	g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", address, TRUE);
+	conn = g_dbus_connection_new_for_address_sync (address,
+						       G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+						       G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+						       NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (conn);
+	node = g_dbus_node_info_new_for_xml (fwupd_test_daemon_xml, &error);
+	g_assert_no_error (error);
+	registration_id = g_dbus_connection_register_object (conn,
+							     FWUPD_DBUS_PATH,
+							     node->interfaces[0],
+							     &vtable,
+							     NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (registration_id, >, 0);
+	val = g_dbus_connection_call_sync (conn,
+					   "org.freedesktop.DBus",
+					   "/org/freedesktop/DBus",
+					   "org.freedesktop.DBus",
+					   "RequestName",
+					   g_variant_new ("(su)", FWUPD_DBUS_SERVICE, 0),
+					   G_VARIANT_TYPE ("(u)"),
+					   G_DBUS_CALL_FLAGS_NONE,
+					   -1, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (val);
+
+	/* the bus goes away before the client does */
+	conn_system = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &error);
+	g_assert_no_error (error);
+	g_dbus_connection_set_exit_on_close (conn_system, FALSE);
+
+	client = fwupd_client_new ();
+	fwupd_client_connect_async (client, NULL, fwupd_client_load_cache_connect_cb, &helper);
+	g_main_loop_run (loop);
+	g_assert_no_error (helper.error);
+	g_assert_true (helper.ret);
+
+	/* signals that arrive between the two replies are not lost */
+	fwupd_client_load_cache_async (client, NULL, fwupd_client_load_cache_cb, &helper);
+	g_main_loop_run (loop);
+	g_assert_no_error (helper.error);
+	g_assert_true (helper.ret);
+	devices = fwupd_client_get_cached_devices (client);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 1);
+	g_assert_nonnull (fwupd_client_get_cached_device_by_id (client, "2222222222222222222222222222222222222222"));
+	g_assert_null (fwupd_client_get_cached_device_by_id (client, "1111111111111111111111111111111111111111"));
+
+	g_dbus_connection_unregister_object (conn, registration_id);
+	g_test_dbus_down (bus);
+}
+
 static gboolean
 fwupd_has_system_bus (void)
 {
@@ -605,6 +1193,68 @@ fwupd_common_device_id_func (void)
 	g_assert_true (fwupd_device_id_is_valid ("d3fae86d95e5d56626129d00e332c4b8dac95442"));
 }
 
+static void
+fwupd_common_intern_func (void)
+{
+	const gchar *str1;
+	const gchar *str2;
+	const gchar *str3;
+	guint unique0 = 0;
+	guint unique1 = 0;
+	guint unique2 = 0;
+	guint64 saved1 = 0;
+	guint64 saved2 = 0;
+	g_autofree gchar *vendor = g_strdup ("Hughski Limited");
+	g_autoptr(FwupdDevice) dev1 = fwupd_device_new ();
+	g_autoptr(FwupdDevice) dev2 = fwupd_device_new ();
+
+	/* both devices point at the same string */
+	fwupd_intern_string_get_stats (&unique0, NULL, NULL);
+	fwupd_device_set_vendor (dev1, "Hughski Limited");
+	fwupd_intern_string_get_stats (&unique1, NULL, &saved1);
+	g_assert_cmpint (unique1, ==, unique0 + 1);
+	fwupd_device_set_vendor (dev2, vendor);
+	fwupd_intern_string_get_stats (&unique2, NULL, &saved2);
+	g_assert_cmpint (unique2, ==, unique1);
+	g_assert_true (fwupd_device_get_vendor (dev1) == fwupd_device_get_vendor (dev2));
+	g_assert_cmpint (saved2 - saved1, ==, strlen (vendor) + 1);
+
+	/* setting the same value again does not free it */
+	fwupd_device_set_vendor (dev1, fwupd_device_get_vendor (dev1));
+	g_assert_cmpstr (fwupd_device_get_vendor (dev1), ==, "Hughski Limited");
+
+	/* the string is freed when the last user goes away */
+	fwupd_device_set_vendor (dev1, "Hughski Ltd");
+	fwupd_intern_string_get_stats (&unique2, NULL, &saved2);
+	g_assert_cmpint (unique2, ==, unique1 + 1);
+	g_assert_cmpint (saved2, ==, saved1);
+	g_clear_object (&dev1);
+	g_clear_object (&dev2);
+	fwupd_intern_string_get_stats (&unique2, NULL, &saved2);
+	g_assert_cmpint (unique2, ==, unique0);
+	g_assert_null (fwupd_intern_string_ref (NULL));
+
+	/* the pooled copy stays valid until the last reference is dropped */
+	fwupd_intern_string_get_stats (&unique0, NULL, &saved2);
+	str1 = fwupd_intern_string_ref (vendor);
+	str2 = fwupd_intern_string_ref (vendor);
+	str3 = fwupd_intern_string_ref (str1);
+	g_assert_true (str1 == str2);
+	g_assert_true (str1 == str3);
+	g_assert_true (str1 != vendor);
+	fwupd_intern_string_get_stats (&unique1, NULL, &saved1);
+	g_assert_cmpint (unique1, ==, unique0 + 1);
+	g_assert_cmpint (saved1 - saved2, ==, 2 * (strlen (vendor) + 1));
+	fwupd_intern_string_unref (str3);
+	g_assert_cmpstr (str1, ==, vendor);
+	fwupd_intern_string_unref (str2);
+	g_assert_cmpstr (str1, ==, vendor);
+	fwupd_intern_string_unref (str1);
+	fwupd_intern_string_get_stats (&unique2, NULL, &saved1);
+	g_assert_cmpint (unique2, ==, unique0);
+	g_assert_cmpint (saved1, ==, saved2);
+}
+
 static void
 fwupd_common_guid_func (void)
 {
@@ -671,15 +1321,22 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{machine-hash}", fwupd_common_machine_hash_func);
 	g_test_add_func ("/fwupd/common{device-id}", fwupd_common_device_id_func);
 	g_test_add_func ("/fwupd/common{guid}", fwupd_common_guid_func);
+	g_test_add_func ("/fwupd/common{intern}", fwupd_common_intern_func);
 	g_test_add_func ("/fwupd/release", fwupd_release_func);
 	g_test_add_func ("/fwupd/device", fwupd_device_func);
+	g_test_add_func ("/fwupd/device{lazy}", fwupd_device_lazy_func);
 	g_test_add_func ("/fwupd/remote{download}", fwupd_remote_download_func);
 	g_test_add_func ("/fwupd/remote{base-uri}", fwupd_remote_baseuri_func);
 	g_test_add_func ("/fwupd/remote{no-path}", fwupd_remote_nopath_func);
 	g_test_add_func ("/fwupd/remote{local}", fwupd_remote_local_func);
-	if (fwupd_has_system_bus ()) {
+	g_test_add_func ("/fwupd/client{refresh-remotes}", fwupd_client_refresh_remotes_func);
+	g_test_add_func ("/fwupd/client{download-file}", fwupd_client_download_file_func);
+	g_test_add_func ("/fwupd/client{load-cache}", fwupd_client_load_cache_func);
+	/* a subprocess must not connect to the real system bus */
+	if (!g_test_subprocess () && fwupd_has_system_bus ()) {
 		g_test_add_func ("/fwupd/client{remotes}", fwupd_client_remotes_func);
 		g_test_add_func ("/fwupd/client{devices}", fwupd_client_devices_func);
+		g_test_add_func ("/fwupd/client{batch}", fwupd_client_batch_func);
 	}
 	return g_test_run ();
 }
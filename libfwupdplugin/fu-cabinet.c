@@ -138,6 +138,7 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 	const gchar *csum_filename = NULL;
 	g_autofree gchar *basename = NULL;
 	g_autoptr(XbNode) csum_tmp = NULL;
+	g_autoptr(XbNode) delta = NULL;
 	g_autoptr(XbNode) metadata_trust = NULL;
 	g_autoptr(XbNode) nsize = NULL;
 	g_autoptr(JcatItem) item = NULL;
@@ -159,9 +160,22 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 	if (csum_filename == NULL)
 		csum_filename = "firmware.bin";
 
-	/* get the main firmware file */
+	/* get the main firmware file, falling back to a delta against the
+	 * firmware already on the device, e.g.
+	 * <delta source="$SHA256" filename="firmware.bin.delta"/> */
 	basename = g_path_get_basename (csum_filename);
 	cabfile = fu_cabinet_get_file_by_name (self, basename);
+	if (cabfile == NULL) {
+		const gchar *delta_filename = NULL;
+		delta = xb_node_query_first (release, "delta", NULL);
+		if (delta != NULL)
+			delta_filename = xb_node_get_attr (delta, "filename");
+		if (delta_filename != NULL) {
+			g_free (basename);
+			basename = g_path_get_basename (delta_filename);
+			cabfile = fu_cabinet_get_file_by_name (self, basename);
+		}
+	}
 	if (cabfile == NULL) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -179,12 +193,28 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 		return FALSE;
 	}
 
-	/* set the blob */
-	xb_node_set_data (release, "fwupd::FirmwareBlob", blob);
+	/* the reconstructed image is checked against the content checksum */
+	if (delta != NULL) {
+		if (xb_node_get_attr (delta, "source") == NULL ||
+		    csum_tmp == NULL || xb_node_get_text (csum_tmp) == NULL) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "delta %s requires a source and content checksum",
+				     basename);
+			return FALSE;
+		}
+		xb_node_set_data (release, "fwupd::FirmwareDelta", blob);
+	} else {
+		/* set the blob */
+		xb_node_set_data (release, "fwupd::FirmwareBlob", blob);
+	}
 
 	/* set as metadata if unset, but error if specified and incorrect */
 	nsize = xb_node_query_first (release, "size[@type='installed']", NULL);
-	if (nsize != NULL) {
+	if (delta != NULL) {
+		g_debug ("not checking size of %s", basename);
+	} else if (nsize != NULL) {
 		guint64 size = fu_common_strtoull (xb_node_get_text (nsize));
 		if (size != g_bytes_get_size (blob)) {
 			g_set_error (error,
@@ -202,7 +232,7 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 	}
 
 	/* set if unspecified, but error out if specified and incorrect */
-	if (csum_tmp != NULL && xb_node_get_text (csum_tmp) != NULL) {
+	if (delta == NULL && csum_tmp != NULL && xb_node_get_text (csum_tmp) != NULL) {
 		g_autofree gchar *checksum = NULL;
 		checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, blob);
 		if (g_strcmp0 (checksum, xb_node_get_text (csum_tmp)) != 0) {
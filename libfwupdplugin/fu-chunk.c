@@ -103,6 +103,163 @@ fu_chunk_array_to_string (GPtrArray *chunks)
 	return g_string_free (str, FALSE);
 }
 
+/**
+ * fu_chunk_iter_init: (skip):
+ * @iter: an uninitialized #FuChunkIter, typically on the stack
+ * @data: a linear blob of memory, or %NULL
+ * @data_sz: size of @data_sz
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Initializes an iterator that splits a linear blob of memory into the same
+ * packets as fu_chunk_array_new(), but without allocating anything.
+ *
+ * |[
+ * FuChunkIter iter;
+ * FuChunk chk;
+ * fu_chunk_iter_init (&iter, buf, bufsz, 0x0, 0x0, 64);
+ * while (fu_chunk_iter_next (&iter, &chk)) {
+ *   if (!write_packet (self, chk.address, chk.data, chk.data_sz, error))
+ *     return FALSE;
+ * }
+ * ]|
+ *
+ * @data must not be freed while the iterator is being used.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_chunk_iter_init (FuChunkIter *iter,
+		    const guint8 *data,
+		    guint32 data_sz,
+		    guint32 addr_start,
+		    guint32 page_sz,
+		    guint32 packet_sz)
+{
+	g_return_if_fail (iter != NULL);
+	iter->data = data;
+	iter->data_sz = data_sz;
+	iter->addr_start = addr_start;
+	iter->page_sz = page_sz;
+	iter->packet_sz = packet_sz;
+	iter->offset = 0;
+	iter->idx = 0;
+}
+
+/**
+ * fu_chunk_iter_init_bytes: (skip):
+ * @iter: an uninitialized #FuChunkIter, typically on the stack
+ * @blob: a #GBytes
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Initializes an iterator that splits a #GBytes into packets.
+ * A reference to @blob is not taken, so it must not be freed while the
+ * iterator is being used.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_chunk_iter_init_bytes (FuChunkIter *iter,
+			  GBytes *blob,
+			  guint32 addr_start,
+			  guint32 page_sz,
+			  guint32 packet_sz)
+{
+	gsize sz = 0;
+	const guint8 *data;
+	g_return_if_fail (blob != NULL);
+	data = g_bytes_get_data (blob, &sz);
+	fu_chunk_iter_init (iter, data, (guint32) sz, addr_start, page_sz, packet_sz);
+}
+
+/**
+ * fu_chunk_iter_next: (skip):
+ * @iter: a #FuChunkIter
+ * @item: (out caller-allocates): a #FuChunk, typically on the stack
+ *
+ * Advances the iterator to the next packet, ensuring the packet does not
+ * cross a page boundary and is no larger than the transfer size.
+ *
+ * The packet data is a view into the data the iterator was created with.
+ *
+ * Return value: %FALSE if there are no more packets
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_chunk_iter_next (FuChunkIter *iter, FuChunk *item)
+{
+	guint32 address;
+	guint32 page = 0;
+	guint64 chunk_sz;
+
+	g_return_val_if_fail (iter != NULL, FALSE);
+	g_return_val_if_fail (item != NULL, FALSE);
+
+	/* finished */
+	if (iter->offset >= iter->data_sz)
+		return FALSE;
+
+	/* stop at the end of the page */
+	chunk_sz = iter->data_sz - iter->offset;
+	address = iter->addr_start + iter->offset;
+	if (iter->page_sz > 0) {
+		guint32 address_page = address;
+		guint64 page_end;
+
+		/* the first byte has always been included in the page of the
+		 * second byte, even when they are on different pages */
+		if (iter->offset == 0 && iter->data_sz > 1)
+			address_page++;
+		page = address_page / iter->page_sz;
+		page_end = ((guint64) page + 1) * iter->page_sz;
+		chunk_sz = MIN (chunk_sz, page_end - address);
+		address %= iter->page_sz;
+	}
+
+	/* stop at the transfer size */
+	if (iter->packet_sz > 0)
+		chunk_sz = MIN (chunk_sz, iter->packet_sz);
+
+	item->idx = iter->idx++;
+	item->page = page;
+	item->address = address;
+	item->data = iter->data != NULL ? iter->data + iter->offset : NULL;
+	item->data_sz = (guint32) chunk_sz;
+	iter->offset += item->data_sz;
+	return TRUE;
+}
+
+/**
+ * fu_chunk_iter_get_n_chunks: (skip):
+ * @iter: a #FuChunkIter
+ *
+ * Gets the number of packets the iterator returns in total, which is useful
+ * for progress reporting.
+ *
+ * Return value: integer
+ *
+ * Since: 1.5.5
+ **/
+guint32
+fu_chunk_iter_get_n_chunks (FuChunkIter *iter)
+{
+	FuChunkIter iter_tmp;
+	FuChunk chk;
+	guint32 n_chunks = 0;
+
+	g_return_val_if_fail (iter != NULL, 0);
+
+	fu_chunk_iter_init (&iter_tmp, NULL, iter->data_sz, iter->addr_start,
+			    iter->page_sz, iter->packet_sz);
+	while (fu_chunk_iter_next (&iter_tmp, &chk))
+		n_chunks++;
+	return n_chunks;
+}
+
 /**
  * fu_chunk_array_new: (skip):
  * @data: a linear blob of memory, or %NULL
@@ -114,6 +271,9 @@ fu_chunk_array_to_string (GPtrArray *chunks)
  * Chunks a linear blob of memory into packets, ensuring each packet does not
  * cross a package boundary and is less that a specific transfer size.
  *
+ * Large images should use fu_chunk_iter_init() instead, which does not
+ * allocate each packet.
+ *
  * Return value: (transfer container) (element-type FuChunk): array of packets
  *
  * Since: 1.1.2
@@ -125,66 +285,22 @@ fu_chunk_array_new (const guint8 *data,
 		    guint32 page_sz,
 		    guint32 packet_sz)
 {
-	GPtrArray *segments = NULL;
-	guint32 page_old = G_MAXUINT32;
-	guint32 idx;
-	guint32 last_flush = 0;
+	FuChunkIter iter;
+	FuChunk chk;
+	GPtrArray *chunks;
 
 	g_return_val_if_fail (data_sz > 0, NULL);
 
-	segments = g_ptr_array_new_with_free_func (g_free);
-	for (idx = 1; idx < data_sz; idx++) {
-		guint32 page = 0;
-		if (page_sz > 0)
-			page = (addr_start + idx) / page_sz;
-		if (page_old == G_MAXUINT32) {
-			page_old = page;
-		} else if (page != page_old) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page_old,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			page_old = page;
-			continue;
-		}
-		if (packet_sz > 0 && idx - last_flush >= packet_sz) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			continue;
-		}
+	fu_chunk_iter_init (&iter, data, data_sz, addr_start, page_sz, packet_sz);
+	chunks = g_ptr_array_new_full (fu_chunk_iter_get_n_chunks (&iter), g_free);
+	while (fu_chunk_iter_next (&iter, &chk)) {
+		g_ptr_array_add (chunks, fu_chunk_new (chk.idx,
+						       chk.page,
+						       chk.address,
+						       chk.data,
+						       chk.data_sz));
 	}
-	if (last_flush != idx) {
-		const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-		guint32 address_offset = addr_start + last_flush;
-		guint32 page = 0;
-		if (page_sz > 0) {
-			address_offset %= page_sz;
-			page = (addr_start + (idx - 1)) / page_sz;
-		}
-		g_ptr_array_add (segments,
-				 fu_chunk_new (segments->len,
-					       page,
-					       address_offset,
-					       data_offset,
-					       data_sz - last_flush));
-	}
-	return segments;
+	return chunks;
 }
 
 /**
@@ -212,3 +328,89 @@ fu_chunk_array_new_from_bytes (GBytes *blob,
 	return fu_chunk_array_new (data, (guint32) sz,
 				   addr_start, page_sz, packet_sz);
 }
+
+/**
+ * fu_chunk_array_new_from_segments: (skip):
+ * @segments: (element-type GBytes): segments, e.g. from fu_firmware_write_segments()
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Chunks the concatenation of @segments into packets exactly as
+ * fu_chunk_array_new() would, but without joining the segments first.
+ *
+ * Packets that fit inside one segment reference the segment data directly,
+ * and only the few packets that straddle a segment boundary are copied.
+ * The segments must outlive the returned array.
+ *
+ * Return value: (transfer container) (element-type FuChunk): array of packets
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fu_chunk_array_new_from_segments (GPtrArray *segments,
+				  guint32 addr_start,
+				  guint32 page_sz,
+				  guint32 packet_sz)
+{
+	GPtrArray *chunks;
+	gsize offset = 0;
+	gsize seg_offset = 0;
+	gsize total_sz = 0;
+	guint seg_idx = 0;
+
+	g_return_val_if_fail (segments != NULL, NULL);
+
+	/* use the same layout as a linear blob */
+	for (guint i = 0; i < segments->len; i++)
+		total_sz += g_bytes_get_size (g_ptr_array_index (segments, i));
+	chunks = fu_chunk_array_new (NULL, (guint32) total_sz,
+				     addr_start, page_sz, packet_sz);
+	if (chunks == NULL)
+		return NULL;
+
+	for (guint i = 0; i < chunks->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks, i);
+		GBytes *seg;
+		gsize segsz = 0;
+		const guint8 *segbuf;
+
+		/* find the segment this packet starts in */
+		for (;;) {
+			seg = g_ptr_array_index (segments, seg_idx);
+			if (offset < seg_offset + g_bytes_get_size (seg))
+				break;
+			seg_offset += g_bytes_get_size (seg);
+			seg_idx++;
+		}
+		segbuf = g_bytes_get_data (seg, &segsz);
+
+		/* reference the segment directly */
+		if (offset + chk->data_sz <= seg_offset + segsz) {
+			chk->data = segbuf + (offset - seg_offset);
+		} else {
+			/* copy into a buffer allocated with the chunk */
+			FuChunk *chk_new = g_malloc0 (sizeof(FuChunk) + chk->data_sz);
+			guint8 *buf = (guint8 *) (chk_new + 1);
+			gsize copied = 0;
+			gsize seg_offset_tmp = seg_offset;
+			memcpy (chk_new, chk, sizeof(FuChunk));
+			for (guint j = seg_idx; copied < chk->data_sz; j++) {
+				GBytes *seg_tmp = g_ptr_array_index (segments, j);
+				gsize seg_tmpsz = 0;
+				const guint8 *seg_tmpbuf = g_bytes_get_data (seg_tmp, &seg_tmpsz);
+				gsize start = offset + copied - seg_offset_tmp;
+				gsize len = MIN (seg_tmpsz - start, chk->data_sz - copied);
+				memcpy (buf + copied, seg_tmpbuf + start, len);
+				copied += len;
+				seg_offset_tmp += seg_tmpsz;
+			}
+			chk_new->data = buf;
+			g_ptr_array_index (chunks, i) = chk_new;
+			g_free (chk);
+			chk = chk_new;
+		}
+		offset += chk->data_sz;
+	}
+	return chunks;
+}
@@ -17,6 +17,17 @@ typedef struct {
 	guint32		 data_sz;
 } FuChunk;
 
+typedef struct {
+	/*< private >*/
+	const guint8	*data;
+	guint32		 data_sz;
+	guint32		 addr_start;
+	guint32		 page_sz;
+	guint32		 packet_sz;
+	guint32		 offset;
+	guint32		 idx;
+} FuChunkIter;
+
 FuChunk		*fu_chunk_new				(guint32	 idx,
 							 guint32	 page,
 							 guint32	 address,
@@ -24,6 +35,21 @@ FuChunk		*fu_chunk_new				(guint32	 idx,
 							 guint32	 data_sz);
 gchar		*fu_chunk_to_string			(FuChunk	*item);
 
+void		 fu_chunk_iter_init			(FuChunkIter	*iter,
+							 const guint8	*data,
+							 guint32	 data_sz,
+							 guint32	 addr_start,
+							 guint32	 page_sz,
+							 guint32	 packet_sz);
+void		 fu_chunk_iter_init_bytes		(FuChunkIter	*iter,
+							 GBytes		*blob,
+							 guint32	 addr_start,
+							 guint32	 page_sz,
+							 guint32	 packet_sz);
+gboolean	 fu_chunk_iter_next			(FuChunkIter	*iter,
+							 FuChunk	*item);
+guint32		 fu_chunk_iter_get_n_chunks		(FuChunkIter	*iter);
+
 gchar		*fu_chunk_array_to_string		(GPtrArray	*chunks);
 GPtrArray	*fu_chunk_array_new			(const guint8	*data,
 							 guint32	 data_sz,
@@ -34,3 +60,7 @@ GPtrArray	*fu_chunk_array_new_from_bytes		(GBytes		*blob,
 							 guint32	 addr_start,
 							 guint32	 page_sz,
 							 guint32	 packet_sz);
+GPtrArray	*fu_chunk_array_new_from_segments	(GPtrArray	*segments,
+							 guint32	 addr_start,
+							 guint32	 page_sz,
+							 guint32	 packet_sz);
@@ -285,6 +285,50 @@ fu_common_get_contents_fd (gint fd, gsize count, GError **error)
 #endif
 }
 
+/**
+ * fu_common_get_contents_stream:
+ * @stream: A seekable #GInputStream
+ * @offset: The offset to read from
+ * @count: The number of bytes to read
+ * @error: A #GError, or %NULL
+ *
+ * Reads exactly @count bytes from a specific offset in a stream. It is an
+ * error if the stream is shorter than @offset plus @count.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL
+ *
+ * Since: 1.5.5
+ **/
+GBytes *
+fu_common_get_contents_stream (GInputStream *stream,
+			       goffset offset,
+			       gsize count,
+			       GError **error)
+{
+	gsize bytes_read = 0;
+	g_autofree guint8 *buf = NULL;
+
+	g_return_val_if_fail (G_IS_SEEKABLE (stream), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!g_seekable_seek (G_SEEKABLE (stream), offset, G_SEEK_SET, NULL, error))
+		return NULL;
+	buf = g_malloc (count);
+	if (!g_input_stream_read_all (stream, buf, count, &bytes_read, NULL, error))
+		return NULL;
+	if (bytes_read != count) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "only read 0x%x of 0x%x bytes @0x%x",
+			     (guint) bytes_read,
+			     (guint) count,
+			     (guint) offset);
+		return NULL;
+	}
+	return g_bytes_new_take (g_steal_pointer (&buf), count);
+}
+
 static gboolean
 fu_common_extract_archive_entry (struct archive_entry *entry, const gchar *dir)
 {
@@ -1668,6 +1712,164 @@ fu_common_bytes_new_offset (GBytes *bytes,
 	return g_bytes_new_from_bytes (bytes, offset, length);
 }
 
+/* checks the delta operation at @offset is in range of both buffers, and
+ * returns the data it writes to the new image */
+static gboolean
+fu_common_bytes_patch_parse_op (const guint8 *buf,
+				gsize bufsz,
+				const guint8 *dbuf,
+				gsize dbufsz,
+				gsize *offset,
+				const guint8 **data,
+				guint32 *len,
+				GError **error)
+{
+	guint8 op = dbuf[*offset];
+
+	/* copy from source */
+	if (op == 0x01) {
+		guint32 src;
+		if (dbufsz - *offset < 9) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "truncated delta copy @0x%04x",
+				     (guint) *offset);
+			return FALSE;
+		}
+		src = fu_common_read_uint32 (dbuf + *offset + 1, G_LITTLE_ENDIAN);
+		*len = fu_common_read_uint32 (dbuf + *offset + 5, G_LITTLE_ENDIAN);
+		if ((guint64) src + *len > bufsz) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "delta copy of 0x%04x bytes @0x%04x outside "
+				     "source of 0x%04x bytes",
+				     (guint) *len, (guint) src, (guint) bufsz);
+			return FALSE;
+		}
+		*data = buf + src;
+		*offset += 9;
+		return TRUE;
+	}
+
+	/* insert from delta */
+	if (op == 0x02) {
+		if (dbufsz - *offset < 5) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "truncated delta insert @0x%04x",
+				     (guint) *offset);
+			return FALSE;
+		}
+		*len = fu_common_read_uint32 (dbuf + *offset + 1, G_LITTLE_ENDIAN);
+		if (*len > dbufsz - *offset - 5) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "delta insert of 0x%04x bytes @0x%04x outside "
+				     "delta of 0x%04x bytes",
+				     (guint) *len, (guint) *offset, (guint) dbufsz);
+			return FALSE;
+		}
+		*data = dbuf + *offset + 5;
+		*offset += 5 + *len;
+		return TRUE;
+	}
+
+	g_set_error (error,
+		     FWUPD_ERROR,
+		     FWUPD_ERROR_INVALID_FILE,
+		     "invalid delta operation 0x%02x @0x%04x",
+		     op, (guint) *offset);
+	return FALSE;
+}
+
+/**
+ * fu_common_bytes_patch:
+ * @bytes: a #GBytes of the source image
+ * @delta: a #GBytes of the delta
+ * @error: A #GError or %NULL
+ *
+ * Reconstructs a new image by applying a delta to the source image.
+ *
+ * The delta starts with the magic `FUDELTA1` and the little endian 32 bit size
+ * of the new image, followed by any number of operations. A `0x01` operation
+ * copies a range from the source image, and has a 32 bit offset and 32 bit
+ * length. A `0x02` operation inserts new data, and has a 32 bit length and then
+ * the data itself.
+ *
+ * The delta is not trusted, so every operation is checked and the size of the
+ * new image has to match the header before any memory is allocated for it.
+ *
+ * Return value: (transfer full): a #GBytes, or #NULL if the delta is invalid
+ *
+ * Since: 1.5.5
+ **/
+GBytes *
+fu_common_bytes_patch (GBytes *bytes, GBytes *delta, GError **error)
+{
+	const guint8 *buf;
+	const guint8 *dbuf;
+	gsize bufsz = 0;
+	gsize dbufsz = 0;
+	gsize offset = 0x0;
+	gsize offset_out = 0x0;
+	guint64 size_total = 0;
+	guint32 size_out = 0;
+	g_autofree guint8 *buf_out = NULL;
+
+	g_return_val_if_fail (bytes != NULL, NULL);
+	g_return_val_if_fail (delta != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* header */
+	buf = g_bytes_get_data (bytes, &bufsz);
+	dbuf = g_bytes_get_data (delta, &dbufsz);
+	if (dbufsz < 12 || memcmp (dbuf, "FUDELTA1", 8) != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "invalid delta header");
+		return NULL;
+	}
+	size_out = fu_common_read_uint32 (dbuf + 8, G_LITTLE_ENDIAN);
+
+	/* the delta has to describe every byte */
+	for (offset = 12; offset < dbufsz;) {
+		const guint8 *data = NULL;
+		guint32 len = 0;
+		if (!fu_common_bytes_patch_parse_op (buf, bufsz, dbuf, dbufsz,
+						     &offset, &data, &len, error))
+			return NULL;
+		size_total += len;
+		if (size_total > size_out)
+			break;
+	}
+	if (size_total != size_out) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "delta wrote 0x%04x bytes, expected 0x%04x",
+			     (guint) size_total, (guint) size_out);
+		return NULL;
+	}
+
+	/* operations */
+	buf_out = g_malloc (size_out);
+	for (offset = 12; offset < dbufsz;) {
+		const guint8 *data = NULL;
+		guint32 len = 0;
+		if (!fu_common_bytes_patch_parse_op (buf, bufsz, dbuf, dbufsz,
+						     &offset, &data, &len, error))
+			return NULL;
+		memcpy (buf_out + offset_out, data, len);
+		offset_out += len;
+	}
+	return g_bytes_new_take (g_steal_pointer (&buf_out), size_out);
+}
+
 /**
  * fu_common_realpath:
  * @filename: a filename
@@ -1877,6 +2079,169 @@ fu_memcpy_safe (guint8 *dst, gsize dst_sz, gsize dst_offset,
 	return TRUE;
 }
 
+/**
+ * fu_memmem_safe:
+ * @haystack: destination buffer
+ * @haystack_sz: size of @haystack, typically `sizeof(haystack)`
+ * @needle: source buffer
+ * @needle_sz: size of @needle, typically `sizeof(needle)`
+ * @offset: (out) (allow-none): offset in bytes @needle has been found in @haystack
+ * @error: A #GError or %NULL
+ *
+ * Finds the first occurrence of @needle in @haystack. This uses the C library
+ * memmem() where available, which is much faster than comparing at each
+ * offset for large images.
+ *
+ * Return value: %TRUE if the needle was found in @haystack
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_memmem_safe (const guint8 *haystack, gsize haystack_sz,
+		const guint8 *needle, gsize needle_sz,
+		gsize *offset, GError **error)
+{
+	const guint8 *tmp = NULL;
+
+	g_return_val_if_fail (haystack != NULL || haystack_sz == 0, FALSE);
+	g_return_val_if_fail (needle != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (needle_sz > 0 && needle_sz <= haystack_sz) {
+#ifdef HAVE_MEMMEM
+		tmp = memmem (haystack, haystack_sz, needle, needle_sz);
+#else
+		/* memchr is vectorized, so skip quickly to a possible match */
+		const guint8 *end = haystack + haystack_sz - needle_sz + 1;
+		for (const guint8 *p = haystack; p < end; p++) {
+			p = memchr (p, needle[0], end - p);
+			if (p == NULL)
+				break;
+			if (memcmp (p, needle, needle_sz) == 0) {
+				tmp = p;
+				break;
+			}
+		}
+#endif
+	}
+	if (tmp == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "failed to find 0x%x bytes in buffer of 0x%x",
+			     (guint) needle_sz, (guint) haystack_sz);
+		return FALSE;
+	}
+	if (offset != NULL)
+		*offset = tmp - haystack;
+	return TRUE;
+}
+
+/* the Aho-Corasick automaton is stored as a dense table of states */
+#define FU_MEMMEM_MULTI_STATES_MAX	0x400
+
+/**
+ * fu_memmem_multi:
+ * @haystack: destination buffer
+ * @haystack_sz: size of @haystack, typically `sizeof(haystack)`
+ * @needles: a %NULL terminated array of strings, at most 64
+ * @offsets: (out caller-allocates): an array with one element for each needle
+ *
+ * Finds the first occurrence of each needle in @haystack, reading the
+ * haystack only once however many needles are being searched for.
+ *
+ * If a needle is empty or not found then the offset is set to %G_MAXSIZE.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_memmem_multi (const guint8 *haystack, gsize haystack_sz,
+		 const gchar * const *needles, gsize *offsets)
+{
+	guint needles_len = 0;
+	guint needles_found = 0;
+	guint states_len = 1;
+	guint state = 0;
+	guint head = 0;
+	guint tail = 0;
+	gsize needle_lens[64] = { 0x0 };
+	g_autofree guint16 *states = NULL;	/* [state][byte] */
+	g_autofree guint16 *fail = NULL;
+	g_autofree guint16 *queue = NULL;
+	g_autofree guint64 *matches = NULL;	/* bitmask of needles */
+
+	g_return_if_fail (haystack != NULL || haystack_sz == 0);
+	g_return_if_fail (needles != NULL);
+	g_return_if_fail (offsets != NULL);
+
+	/* count */
+	for (guint i = 0; needles[i] != NULL; i++) {
+		g_return_if_fail (i < G_N_ELEMENTS (needle_lens));
+		offsets[i] = G_MAXSIZE;
+		needle_lens[i] = strlen (needles[i]);
+		states_len += needle_lens[i];
+		needles_len++;
+	}
+	g_return_if_fail (states_len <= FU_MEMMEM_MULTI_STATES_MAX);
+
+	/* build the trie, where 0 is both the root and "no transition" */
+	states = g_new0 (guint16, states_len * 256);
+	fail = g_new0 (guint16, states_len);
+	queue = g_new0 (guint16, states_len);
+	matches = g_new0 (guint64, states_len);
+	states_len = 1;
+	for (guint i = 0; i < needles_len; i++) {
+		guint16 tmp = 0;
+		if (needle_lens[i] == 0) {
+			needles_found++;
+			continue;
+		}
+		for (gsize j = 0; j < needle_lens[i]; j++) {
+			guint8 c = (guint8) needles[i][j];
+			if (states[tmp * 256 + c] == 0)
+				states[tmp * 256 + c] = states_len++;
+			tmp = states[tmp * 256 + c];
+		}
+		matches[tmp] |= (guint64) 1 << i;
+	}
+
+	/* the children of the root fail back to the root */
+	for (guint c = 0; c < 256; c++) {
+		if (states[c] != 0)
+			queue[tail++] = states[c];
+	}
+
+	/* add the other failure transitions in breadth-first order, which
+	 * turns the trie into a state machine that never backtracks */
+	while (head < tail) {
+		guint16 tmp = queue[head++];
+		for (guint c = 0; c < 256; c++) {
+			guint16 next = states[tmp * 256 + c];
+			guint16 next_fail = states[fail[tmp] * 256 + c];
+			if (next == 0) {
+				states[tmp * 256 + c] = next_fail;
+				continue;
+			}
+			fail[next] = next_fail;
+			matches[next] |= matches[next_fail];
+			queue[tail++] = next;
+		}
+	}
+
+	/* search */
+	for (gsize i = 0; i < haystack_sz && needles_found < needles_len; i++) {
+		guint64 tmp;
+		state = states[state * 256 + haystack[i]];
+		tmp = matches[state];
+		for (guint j = 0; tmp != 0; j++, tmp >>= 1) {
+			if ((tmp & 1) == 0 || offsets[j] != G_MAXSIZE)
+				continue;
+			offsets[j] = i + 1 - needle_lens[j];
+			needles_found++;
+		}
+	}
+}
+
 /**
  * fu_common_read_uint8_safe:
  * @buf: source buffer
@@ -116,6 +116,10 @@ GBytes		*fu_common_get_contents_bytes	(const gchar	*filename,
 GBytes		*fu_common_get_contents_fd	(gint		 fd,
 						 gsize		 count,
 						 GError		**error);
+GBytes		*fu_common_get_contents_stream	(GInputStream	*stream,
+						 goffset	 offset,
+						 gsize		 count,
+						 GError		**error);
 gboolean	 fu_common_extract_archive	(GBytes		*blob,
 						 const gchar	*dir,
 						 GError		**error);
@@ -159,6 +163,9 @@ GBytes		*fu_common_bytes_new_offset	(GBytes		*bytes,
 						 gsize		 offset,
 						 gsize		 length,
 						 GError		**error);
+GBytes		*fu_common_bytes_patch		(GBytes		*bytes,
+						 GBytes		*delta,
+						 GError		**error);
 gsize		 fu_common_strwidth		(const gchar	*text);
 gboolean	 fu_memcpy_safe			(guint8		*dst,
 						 gsize		 dst_sz,
@@ -168,6 +175,16 @@ gboolean	 fu_memcpy_safe			(guint8		*dst,
 						 gsize		 src_offset,
 						 gsize		 n,
 						 GError		**error);
+gboolean	 fu_memmem_safe			(const guint8	*haystack,
+						 gsize		 haystack_sz,
+						 const guint8	*needle,
+						 gsize		 needle_sz,
+						 gsize		*offset,
+						 GError		**error);
+void		 fu_memmem_multi		(const guint8	*haystack,
+						 gsize		 haystack_sz,
+						 const gchar * const *needles,
+						 gsize		*offsets);
 gboolean	 fu_common_read_uint8_safe	(const guint8	*buf,
 						 gsize		 bufsz,
 						 gsize		 offset,
@@ -30,3 +30,9 @@ gchar		*fu_device_get_guids_as_str		(FuDevice	*self);
 GPtrArray	*fu_device_get_possible_plugins		(FuDevice	*self);
 void		 fu_device_add_possible_plugin		(FuDevice	*self,
 							 const gchar	*plugin);
+void		 fu_device_set_firmware_cache		(FuDevice	*self,
+							 GHashTable	*firmware_cache);
+GPtrArray	*fu_device_read_region_checksums	(FuDevice	*self,
+							 guint32	 address,
+							 gsize		 bufsz,
+							 GError		**error);
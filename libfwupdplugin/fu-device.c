@@ -12,6 +12,7 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 
+#include "fu-chunk.h"
 #include "fu-common.h"
 #include "fu-common-version.h"
 #include "fu-device-private.h"
@@ -42,6 +43,7 @@ typedef struct {
 	FuQuirks			*quirks;
 	GHashTable			*metadata;	/* (nullable) */
 	GRWLock				 metadata_mutex;
+	GHashTable			*firmware_cache;	/* (nullable): key:FuFirmware */
 	GPtrArray			*parent_guids;
 	GRWLock				 parent_guids_mutex;
 	guint				 remove_delay;	/* ms */
@@ -2252,6 +2254,10 @@ fu_device_set_progress_full (FuDevice *self, gsize progress_done, gsize progress
  * The value is gven in whole seconds as it does not make sense to show the
  * progressbar advancing so quickly for durations of less than one second.
  *
+ * This should not be used to wait for the device to re-enumerate; instead set
+ * %FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG and a suitable remove-delay so that the
+ * daemon can continue as soon as the device has been added back.
+ *
  * Since: 1.5.0
  **/
 void
@@ -2460,6 +2466,46 @@ fu_device_write_firmware (FuDevice *self,
 	return klass->write_firmware (self, firmware, flags, error);
 }
 
+/**
+ * fu_device_set_firmware_cache:
+ * @self: A #FuDevice
+ * @firmware_cache: (nullable): A #GHashTable of string:#FuFirmware
+ *
+ * Sets a cache of prepared firmware owned by the engine, so that a payload is
+ * only parsed and validated once when the same update is being deployed to
+ * multiple identical devices. The cache is only used if the device has the
+ * %FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE flag set.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_device_set_firmware_cache (FuDevice *self, GHashTable *firmware_cache)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	if (priv->firmware_cache == firmware_cache)
+		return;
+	if (priv->firmware_cache != NULL)
+		g_hash_table_unref (priv->firmware_cache);
+	priv->firmware_cache = firmware_cache != NULL ? g_hash_table_ref (firmware_cache) : NULL;
+}
+
+/* plugins setting FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE promise that the
+ * prepare_firmware vfunc only depends on the device type and mode, and does not
+ * modify the firmware for a specific device instance */
+static gchar *
+fu_device_get_firmware_cache_key (FuDevice *self, GBytes *fw, FwupdInstallFlags flags)
+{
+	g_autofree gchar *checksum = NULL;
+	checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, fw);
+	return g_strdup_printf ("%s:%s:%s:%" G_GUINT64_FORMAT,
+				G_OBJECT_TYPE_NAME (self),
+				fu_device_has_flag (self, FWUPD_DEVICE_FLAG_IS_BOOTLOADER) ?
+					"bootloader" : "runtime",
+				checksum,
+				(guint64) flags);
+}
+
 /**
  * fu_device_prepare_firmware:
  * @self: A #FuDevice
@@ -2487,6 +2533,7 @@ fu_device_prepare_firmware (FuDevice *self,
 {
 	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
 	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_autofree gchar *cache_key = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
 	g_autoptr(GBytes) fw_def = NULL;
 
@@ -2494,12 +2541,32 @@ fu_device_prepare_firmware (FuDevice *self,
 	g_return_val_if_fail (fw != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
+	/* already prepared for an identical device, only if the plugin opted in */
+	if (priv->firmware_cache != NULL &&
+	    klass->prepare_firmware != NULL &&
+	    fu_device_has_flag (self, FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE)) {
+		cache_key = fu_device_get_firmware_cache_key (self, fw, flags);
+		firmware = g_hash_table_lookup (priv->firmware_cache, cache_key);
+		if (firmware != NULL) {
+			g_debug ("using prepared firmware from cache for %s",
+				 fu_device_get_id (self));
+			g_object_ref (firmware);
+		}
+	}
+
 	/* optionally subclassed */
-	if (klass->prepare_firmware != NULL) {
+	if (firmware != NULL) {
+		/* nothing to do */
+	} else if (klass->prepare_firmware != NULL) {
 		fu_device_set_status (self, FWUPD_STATUS_DECOMPRESSING);
 		firmware = klass->prepare_firmware (self, fw, flags, error);
 		if (firmware == NULL)
 			return NULL;
+		if (cache_key != NULL) {
+			g_hash_table_insert (priv->firmware_cache,
+					     g_steal_pointer (&cache_key),
+					     g_object_ref (firmware));
+		}
 	} else {
 		firmware = fu_firmware_new_from_bytes (fw);
 	}
@@ -2614,6 +2681,401 @@ fu_device_dump_firmware (FuDevice *self, GError **error)
 	return klass->dump_firmware (self, error);
 }
 
+/**
+ * fu_device_dump_firmware_to_stream:
+ * @self: A #FuDevice
+ * @stream: A #GOutputStream
+ * @checksum: (nullable): A #GChecksum, or %NULL
+ * @error: A #GError
+ *
+ * Reads the raw firmware image from the device and writes it to @stream,
+ * optionally also updating @checksum with the data as it is written.
+ *
+ * If the device implements the ->dump_firmware vfunc then this is always used,
+ * as the subclass may need to do extra work such as switching modes before
+ * the image can be read. Otherwise, if the device implements ->read_region,
+ * the image is read in blocks so that it is never held in memory at once.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_device_dump_firmware_to_stream (FuDevice *self,
+				   GOutputStream *stream,
+				   GChecksum *checksum,
+				   GError **error)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+	GChecksum *csums[] = { checksum, NULL };
+	gsize bufsz;
+	const guint8 *buf;
+	g_autoptr(GBytes) fw = NULL;
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* read in blocks, so the memory use is constant */
+	if (klass->dump_firmware == NULL &&
+	    klass->read_region != NULL &&
+	    fu_device_get_firmware_size_max (self) > 0) {
+		fu_device_set_status (self, FWUPD_STATUS_DEVICE_READ);
+		return fu_device_read_region_hash (self, 0x0,
+						   fu_device_get_firmware_size_max (self),
+						   csums, stream, error);
+	}
+
+	/* read the entire image in one go */
+	fw = fu_device_dump_firmware (self, error);
+	if (fw == NULL)
+		return FALSE;
+	buf = g_bytes_get_data (fw, &bufsz);
+	if (checksum != NULL)
+		g_checksum_update (checksum, buf, bufsz);
+	return g_output_stream_write_all (stream, buf, bufsz, NULL, NULL, error);
+}
+
+/**
+ * fu_device_read_region:
+ * @self: A #FuDevice
+ * @address: the absolute address on the device
+ * @buf: (out caller-allocates): the buffer to fill
+ * @bufsz: the size of @buf, and the number of bytes to read
+ * @error: A #GError
+ *
+ * Reads a region of the raw firmware image from the device by calling a
+ * plugin-specific vfunc. The region should be read from the same address space
+ * that is used when writing firmware.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_device_read_region (FuDevice *self,
+		       guint32 address,
+		       guint8 *buf,
+		       gsize bufsz,
+		       GError **error)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
+	g_return_val_if_fail (buf != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* no plugin-specific method */
+	if (klass->read_region == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "not supported");
+		return FALSE;
+	}
+
+	/* proxy */
+	return klass->read_region (self, address, buf, bufsz, error);
+}
+
+/* reuse one small buffer so that large regions use constant memory */
+#define FU_DEVICE_REGION_BLOCK_SZ		0x1000
+
+static gboolean
+fu_device_read_region_hash (FuDevice *self,
+			    guint32 address,
+			    gsize bufsz,
+			    GChecksum **csums,
+			    GOutputStream *stream,
+			    GError **error)
+{
+	g_autofree guint8 *buf = g_malloc0 (MIN (bufsz, FU_DEVICE_REGION_BLOCK_SZ));
+	for (gsize offset = 0; offset < bufsz; offset += FU_DEVICE_REGION_BLOCK_SZ) {
+		gsize blocksz = MIN (bufsz - offset, FU_DEVICE_REGION_BLOCK_SZ);
+		if (!fu_device_read_region (self, address + offset, buf, blocksz, error))
+			return FALSE;
+		for (guint i = 0; csums != NULL && csums[i] != NULL; i++)
+			g_checksum_update (csums[i], buf, blocksz);
+		if (stream != NULL &&
+		    !g_output_stream_write_all (stream, buf, blocksz, NULL, NULL, error))
+			return FALSE;
+		fu_device_set_progress_full (self, offset + blocksz, bufsz);
+	}
+	return TRUE;
+}
+
+/**
+ * fu_device_read_region_checksums:
+ * @self: A #FuDevice
+ * @address: the absolute address on the device
+ * @bufsz: the number of bytes to read
+ * @error: A #GError
+ *
+ * Reads a region of the device using fu_device_read_region() and hashes the
+ * data as it is read, without ever holding the whole region in memory.
+ *
+ * Returns: (transfer container) (element-type utf8): the SHA1 and SHA256 hashes, or %NULL for error
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fu_device_read_region_checksums (FuDevice *self,
+				 guint32 address,
+				 gsize bufsz,
+				 GError **error)
+{
+	GPtrArray *checksums;
+	g_autoptr(GChecksum) csum_sha1 = g_checksum_new (G_CHECKSUM_SHA1);
+	g_autoptr(GChecksum) csum_sha256 = g_checksum_new (G_CHECKSUM_SHA256);
+	GChecksum *csums[] = { csum_sha1, csum_sha256, NULL };
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (!fu_device_read_region_hash (self, address, bufsz, csums, NULL, error))
+		return NULL;
+	checksums = g_ptr_array_new_with_free_func (g_free);
+	for (guint i = 0; csums[i] != NULL; i++)
+		g_ptr_array_add (checksums, g_strdup (g_checksum_get_string (csums[i])));
+	return checksums;
+}
+
+/**
+ * fu_device_checksum_region:
+ * @self: A #FuDevice
+ * @address: the absolute address on the device
+ * @bufsz: the number of bytes to checksum
+ * @error: A #GError
+ *
+ * Gets the checksum of a region of the device by calling a plugin-specific
+ * vfunc, which typically uses a checksum calculated by the device itself so
+ * that the data does not have to be transferred to the host.
+ *
+ * If the device does not support calculating checksums then the region is
+ * read back using fu_device_read_region() and hashed using SHA256.
+ *
+ * The checksum format is device-specific and may be much weaker than a
+ * cryptographic hash, so it should only be used to detect regions that have
+ * changed and never to verify the firmware against a published checksum.
+ *
+ * Returns: (transfer full): a checksum, or %NULL for error
+ *
+ * Since: 1.5.5
+ **/
+gchar *
+fu_device_checksum_region (FuDevice *self,
+			   guint32 address,
+			   gsize bufsz,
+			   GError **error)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+	g_autoptr(GChecksum) csum = NULL;
+	GChecksum *csums[] = { NULL, NULL };
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* calculated by hardware */
+	if (klass->checksum_region != NULL)
+		return klass->checksum_region (self, address, bufsz, error);
+
+	/* fall back to reading the data */
+	csum = g_checksum_new (G_CHECKSUM_SHA256);
+	csums[0] = csum;
+	if (!fu_device_read_region_hash (self, address, bufsz, csums, NULL, error))
+		return NULL;
+	return g_strdup (g_checksum_get_string (csum));
+}
+
+/* read back in blocks and compare every byte */
+static gboolean
+fu_device_compare_region (FuDevice *self,
+			  guint32 address,
+			  const guint8 *buf,
+			  gsize bufsz,
+			  GError **error)
+{
+	g_autofree guint8 *buf_tmp = g_malloc0 (MIN (bufsz, FU_DEVICE_REGION_BLOCK_SZ));
+	for (gsize offset = 0; offset < bufsz; offset += FU_DEVICE_REGION_BLOCK_SZ) {
+		gsize blocksz = MIN (bufsz - offset, FU_DEVICE_REGION_BLOCK_SZ);
+		if (!fu_device_read_region (self, address + offset, buf_tmp, blocksz, error))
+			return FALSE;
+		if (memcmp (buf_tmp, buf + offset, blocksz) != 0) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "data @0x%x did not match",
+				     (guint) (address + offset));
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static gchar *
+fu_device_checksum_data (FuDevice *self, const guint8 *buf, gsize bufsz)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+	if (klass->checksum_data != NULL)
+		return klass->checksum_data (self, buf, bufsz);
+	return g_compute_checksum_for_data (G_CHECKSUM_SHA256, buf, bufsz);
+}
+
+/**
+ * fu_device_verify_region:
+ * @self: A #FuDevice
+ * @address: the absolute address on the device
+ * @buf: the expected data
+ * @bufsz: the size of @buf
+ * @error: A #GError
+ *
+ * Verifies that a region of the device matches the expected data.
+ *
+ * If the device can calculate checksums then only the checksum is compared,
+ * otherwise the region is read back in blocks and compared with @buf.
+ *
+ * If the data does not match, %G_IO_ERROR_INVALID_DATA is returned.
+ *
+ * Returns: %TRUE if the region matches
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_device_verify_region (FuDevice *self,
+			 guint32 address,
+			 const guint8 *buf,
+			 gsize bufsz,
+			 GError **error)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), FALSE);
+	g_return_val_if_fail (buf != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* prefer the checksum as it does not need a readback */
+	if (klass->checksum_region != NULL) {
+		g_autofree gchar *csum_device = NULL;
+		g_autofree gchar *csum_host = NULL;
+		csum_device = fu_device_checksum_region (self, address, bufsz, error);
+		if (csum_device == NULL)
+			return FALSE;
+		csum_host = fu_device_checksum_data (self, buf, bufsz);
+		if (g_strcmp0 (csum_device, csum_host) != 0) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "checksum @0x%x was %s, expected %s",
+				     address, csum_device, csum_host);
+			return FALSE;
+		}
+		return TRUE;
+	}
+
+	/* compare block by block */
+	return fu_device_compare_region (self, address, buf, bufsz, error);
+}
+
+/**
+ * fu_device_get_changed_chunks:
+ * @self: A #FuDevice
+ * @chunks: (element-type FuChunk): array of erase blocks
+ * @flags: #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_FORCE
+ * @error: A #GError
+ *
+ * Compares the erase blocks of the new firmware image with what is currently
+ * on the device and returns only the blocks that are different. Only these
+ * blocks then need to be erased and written, which is faster and causes less
+ * flash wear for incremental releases.
+ *
+ * If the device implements ->checksum_region and ->checksum_data then a block
+ * with a different
+ * checksum is known to have changed without reading it back. Blocks with a
+ * matching checksum are still read back and compared byte for byte, as a
+ * device-calculated checksum may be too weak to detect a block where the bytes
+ * have only been reordered.
+ *
+ * The chunks should have been created using fu_chunk_array_new() with a page
+ * size of zero, so that each address is absolute, and with a packet size that
+ * matches the erase block size of the device.
+ *
+ * If the device does not support reading back regions, or if
+ * %FWUPD_INSTALL_FLAG_FORCE is specified, then all the chunks are returned.
+ *
+ * Returns: (transfer container) (element-type FuChunk): changed chunks, or %NULL for error
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fu_device_get_changed_chunks (FuDevice *self,
+			      GPtrArray *chunks,
+			      FwupdInstallFlags flags,
+			      GError **error)
+{
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (self);
+	g_autoptr(GPtrArray) chunks_changed = g_ptr_array_new ();
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	g_return_val_if_fail (chunks != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* rewrite everything */
+	if (klass->read_region == NULL || (flags & FWUPD_INSTALL_FLAG_FORCE) > 0) {
+		for (guint i = 0; i < chunks->len; i++)
+			g_ptr_array_add (chunks_changed, g_ptr_array_index (chunks, i));
+		return g_steal_pointer (&chunks_changed);
+	}
+
+	/* compare each block with the contents of the device */
+	fu_device_set_status (self, FWUPD_STATUS_DEVICE_VERIFY);
+	for (guint i = 0; i < chunks->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks, i);
+		g_autoptr(GError) error_local = NULL;
+
+		/* a different checksum means the block has definitely changed */
+		if (klass->checksum_region != NULL && klass->checksum_data != NULL) {
+			g_autofree gchar *csum_device = NULL;
+			g_autofree gchar *csum_host = NULL;
+			csum_device = fu_device_checksum_region (self, chk->address,
+								 chk->data_sz, error);
+			if (csum_device == NULL)
+				return NULL;
+			csum_host = fu_device_checksum_data (self, chk->data, chk->data_sz);
+			if (g_strcmp0 (csum_device, csum_host) != 0) {
+				g_ptr_array_add (chunks_changed, chk);
+				fu_device_set_progress_full (self, (gsize) i, (gsize) chunks->len);
+				continue;
+			}
+		}
+		if (!fu_device_compare_region (self, chk->address,
+					       chk->data, chk->data_sz,
+					       &error_local)) {
+			if (g_error_matches (error_local,
+					     G_IO_ERROR,
+					     G_IO_ERROR_INVALID_DATA)) {
+				g_ptr_array_add (chunks_changed, chk);
+				continue;
+			}
+			if (g_error_matches (error_local,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_NOT_SUPPORTED)) {
+				g_debug ("cannot read back, writing all blocks: %s",
+					 error_local->message);
+				g_ptr_array_set_size (chunks_changed, 0);
+				for (guint j = 0; j < chunks->len; j++)
+					g_ptr_array_add (chunks_changed, g_ptr_array_index (chunks, j));
+				return g_steal_pointer (&chunks_changed);
+			}
+			g_propagate_error (error, g_steal_pointer (&error_local));
+			g_prefix_error (error, "failed to verify @0x%x: ", chk->address);
+			return NULL;
+		}
+		fu_device_set_progress_full (self, (gsize) i, (gsize) chunks->len);
+	}
+	g_debug ("%u of %u blocks changed", chunks_changed->len, chunks->len);
+	return g_steal_pointer (&chunks_changed);
+}
+
 /**
  * fu_device_detach:
  * @self: A #FuDevice
@@ -3376,6 +3838,8 @@ fu_device_finalize (GObject *object)
 		g_source_remove (priv->poll_id);
 	if (priv->metadata != NULL)
 		g_hash_table_unref (priv->metadata);
+	if (priv->firmware_cache != NULL)
+		g_hash_table_unref (priv->firmware_cache);
 	g_ptr_array_unref (priv->parent_guids);
 	g_ptr_array_unref (priv->possible_plugins);
 	g_ptr_array_unref (priv->retry_recs);
@@ -76,8 +76,20 @@ struct _FuDeviceClass
 							 GError		**error);
 	GBytes			*(*dump_firmware)	(FuDevice	*self,
 							 GError		**error);
+	gboolean		 (*read_region)		(FuDevice	*self,
+							 guint32	 address,
+							 guint8		*buf,
+							 gsize		 bufsz,
+							 GError		**error);
+	gchar			*(*checksum_region)	(FuDevice	*self,
+							 guint32	 address,
+							 gsize		 bufsz,
+							 GError		**error);
+	gchar			*(*checksum_data)	(FuDevice	*self,
+							 const guint8	*buf,
+							 gsize		 bufsz);
 	/*< private >*/
-	gpointer	padding[11];
+	gpointer	padding[8];
 };
 
 /**
@@ -292,6 +304,28 @@ FuFirmware	*fu_device_read_firmware		(FuDevice	*self,
 							 GError		**error);
 GBytes		*fu_device_dump_firmware		(FuDevice	*self,
 							 GError		**error);
+gboolean	 fu_device_dump_firmware_to_stream	(FuDevice	*self,
+							 GOutputStream	*stream,
+							 GChecksum	*checksum,
+							 GError		**error);
+gboolean	 fu_device_read_region			(FuDevice	*self,
+							 guint32	 address,
+							 guint8		*buf,
+							 gsize		 bufsz,
+							 GError		**error);
+gchar		*fu_device_checksum_region		(FuDevice	*self,
+							 guint32	 address,
+							 gsize		 bufsz,
+							 GError		**error);
+gboolean	 fu_device_verify_region		(FuDevice	*self,
+							 guint32	 address,
+							 const guint8	*buf,
+							 gsize		 bufsz,
+							 GError		**error);
+GPtrArray	*fu_device_get_changed_chunks		(FuDevice	*self,
+							 GPtrArray	*chunks,
+							 FwupdInstallFlags flags,
+							 GError		**error);
 gboolean	 fu_device_attach			(FuDevice	*self,
 							 GError		**error);
 gboolean	 fu_device_detach			(FuDevice	*self,
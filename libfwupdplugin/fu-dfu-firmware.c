@@ -275,16 +275,13 @@ fu_dfu_firmware_parse (FuFirmware *firmware,
 }
 
 static GBytes *
-fu_dfu_firmware_add_footer (FuDfuFirmware *self, GBytes *contents, GError **error)
+fu_dfu_firmware_build_footer (FuDfuFirmware *self, GBytes *contents)
 {
 	FuDfuFirmwarePrivate *priv = GET_PRIVATE (self);
-	GByteArray *buf = g_byte_array_new ();
+	GByteArray *buf = g_byte_array_sized_new (sizeof(FuDfuFirmwareFooter));
 	const guint8 *blob;
 	gsize blobsz = 0;
-
-	/* add the raw firmware data */
-	blob = g_bytes_get_data (contents, &blobsz);
-	g_byte_array_append (buf, blob, blobsz);
+	guint32 crc;
 
 	/* append footer */
 	fu_byte_array_append_uint16 (buf, priv->release, G_LITTLE_ENDIAN);
@@ -293,15 +290,22 @@ fu_dfu_firmware_add_footer (FuDfuFirmware *self, GBytes *contents, GError **erro
 	fu_byte_array_append_uint16 (buf, priv->version, G_LITTLE_ENDIAN);
 	g_byte_array_append (buf, (const guint8 *) "UFD", 3);
 	fu_byte_array_append_uint8 (buf, sizeof(FuDfuFirmwareFooter));
-	fu_byte_array_append_uint32 (buf, ~fu_common_crc32 (buf->data, buf->len), G_LITTLE_ENDIAN);
+
+	/* the CRC covers the raw firmware data and the footer so far */
+	blob = g_bytes_get_data (contents, &blobsz);
+	crc = fu_common_crc32 (blob, blobsz);
+	crc = fu_common_crc32_full (buf->data, buf->len, ~crc, 0xEDB88320);
+	fu_byte_array_append_uint32 (buf, ~crc, G_LITTLE_ENDIAN);
 	return g_byte_array_free_to_bytes (buf);
 }
 
-static GBytes *
-fu_dfu_firmware_write (FuFirmware *firmware, GError **error)
+static GPtrArray *
+fu_dfu_firmware_write_segments (FuFirmware *firmware, GError **error)
 {
 	FuDfuFirmware *self = FU_DFU_FIRMWARE (firmware);
+	GPtrArray *segments;
 	g_autoptr(GPtrArray) images = fu_firmware_get_images (firmware);
+	g_autoptr(GBytes) footer = NULL;
 	g_autoptr(GBytes) fw = NULL;
 
 	/* can only contain one image */
@@ -313,11 +317,15 @@ fu_dfu_firmware_write (FuFirmware *firmware, GError **error)
 		return NULL;
 	}
 
-	/* add footer */
+	/* raw firmware data, then footer */
 	fw = fu_firmware_get_image_default_bytes (firmware, error);
 	if (fw == NULL)
 		return NULL;
-	return fu_dfu_firmware_add_footer (self, fw, error);
+	footer = fu_dfu_firmware_build_footer (self, fw);
+	segments = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	g_ptr_array_add (segments, g_steal_pointer (&fw));
+	g_ptr_array_add (segments, g_steal_pointer (&footer));
+	return segments;
 }
 
 static void
@@ -336,7 +344,7 @@ fu_dfu_firmware_class_init (FuDfuFirmwareClass *klass)
 	FuFirmwareClass *klass_firmware = FU_FIRMWARE_CLASS (klass);
 	klass_firmware->to_string = fu_dfu_firmware_to_string;
 	klass_firmware->parse = fu_dfu_firmware_parse;
-	klass_firmware->write = fu_dfu_firmware_write;
+	klass_firmware->write_segments = fu_dfu_firmware_write_segments;
 }
 
 /**
@@ -10,8 +10,302 @@
 
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "fwupd-error.h"
+
 #include "fu-firmware-common.h"
 
+/* nibble value with 0x10 set, or zero for characters that are not hex digits */
+static const guint8 fu_firmware_hex_lut[256] = {
+	['0'] = 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+	['A'] = 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+	['a'] = 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+/* parses up to @digits leading hex digits, like g_ascii_strtoull() */
+static guint32
+fu_firmware_strparse_uint (const gchar *data, guint digits)
+{
+	guint32 val = 0;
+	for (guint i = 0; i < digits; i++) {
+		guint8 tmp = fu_firmware_hex_lut[(guint8) data[i]];
+		if ((tmp & 0x10) == 0)
+			break;
+		val = (val << 4) | (tmp & 0xf);
+	}
+	return val;
+}
+
+/* the kernels return the number of characters (or bytes) processed, and stop
+ * early at a block containing anything that is not a hex digit */
+typedef struct {
+	const gchar	*name;
+	gsize		 (*decode)	(const gchar	*data,
+					 gsize		 datasz,
+					 guint8		*buf);
+	gsize		 (*encode)	(const guint8	*buf,
+					 gsize		 bufsz,
+					 gchar		*data);
+} FuFirmwareHexImpl;
+
+static gsize
+fu_firmware_hex_decode_scalar (const gchar *data, gsize datasz, guint8 *buf)
+{
+	gsize i;
+	for (i = 0; i + 1 < datasz; i += 2) {
+		guint8 hi = fu_firmware_hex_lut[(guint8) data[i]];
+		guint8 lo = fu_firmware_hex_lut[(guint8) data[i + 1]];
+		if ((hi & lo & 0x10) == 0)
+			break;
+		buf[i / 2] = ((hi & 0xf) << 4) | (lo & 0xf);
+	}
+	return i;
+}
+
+static gsize
+fu_firmware_hex_encode_scalar (const guint8 *buf, gsize bufsz, gchar *data)
+{
+	const gchar *hex = "0123456789ABCDEF";
+	for (gsize i = 0; i < bufsz; i++) {
+		data[i * 2] = hex[buf[i] >> 4];
+		data[i * 2 + 1] = hex[buf[i] & 0xf];
+	}
+	return bufsz;
+}
+
+#ifdef __SSE2__
+static gsize
+fu_firmware_hex_decode_sse2 (const gchar *data, gsize datasz, guint8 *buf)
+{
+	const __m128i c0 = _mm_set1_epi8 ('0' - 1);
+	const __m128i c9 = _mm_set1_epi8 ('9' + 1);
+	const __m128i ca = _mm_set1_epi8 ('a' - 1);
+	const __m128i cf = _mm_set1_epi8 ('f' + 1);
+	const __m128i lower = _mm_set1_epi8 (0x20);
+	const __m128i mask = _mm_set1_epi16 (0x00ff);
+	gsize i;
+
+	for (i = 0; i + 16 <= datasz; i += 16) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+		__m128i lc = _mm_or_si128 (v, lower);
+		__m128i is_digit = _mm_and_si128 (_mm_cmpgt_epi8 (v, c0), _mm_cmplt_epi8 (v, c9));
+		__m128i is_alpha = _mm_and_si128 (_mm_cmpgt_epi8 (lc, ca), _mm_cmplt_epi8 (lc, cf));
+		__m128i nib;
+		__m128i val;
+
+		/* bytes >= 0x80 are negative and so fail both checks */
+		if (_mm_movemask_epi8 (_mm_or_si128 (is_digit, is_alpha)) != 0xffff)
+			break;
+		nib = _mm_or_si128 (_mm_and_si128 (is_digit, _mm_sub_epi8 (v, _mm_set1_epi8 ('0'))),
+				    _mm_and_si128 (is_alpha, _mm_sub_epi8 (lc, _mm_set1_epi8 ('a' - 10))));
+
+		/* combine the nibble pairs and narrow to bytes */
+		val = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (nib, mask), 4),
+				    _mm_srli_epi16 (nib, 8));
+		_mm_storel_epi64 ((__m128i *) (buf + i / 2), _mm_packus_epi16 (val, val));
+	}
+	return i;
+}
+
+static inline __m128i
+fu_firmware_hex_nibble_to_ascii_sse2 (__m128i n)
+{
+	__m128i alpha = _mm_and_si128 (_mm_cmpgt_epi8 (n, _mm_set1_epi8 (9)),
+				       _mm_set1_epi8 ('A' - '0' - 10));
+	return _mm_add_epi8 (_mm_add_epi8 (n, _mm_set1_epi8 ('0')), alpha);
+}
+
+static gsize
+fu_firmware_hex_encode_sse2 (const guint8 *buf, gsize bufsz, gchar *data)
+{
+	const __m128i mask = _mm_set1_epi8 (0x0f);
+	gsize i;
+
+	for (i = 0; i + 16 <= bufsz; i += 16) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (buf + i));
+		__m128i hi = _mm_and_si128 (_mm_srli_epi16 (v, 4), mask);
+		__m128i lo = _mm_and_si128 (v, mask);
+		_mm_storeu_si128 ((__m128i *) (data + i * 2),
+				  fu_firmware_hex_nibble_to_ascii_sse2 (_mm_unpacklo_epi8 (hi, lo)));
+		_mm_storeu_si128 ((__m128i *) (data + i * 2 + 16),
+				  fu_firmware_hex_nibble_to_ascii_sse2 (_mm_unpackhi_epi8 (hi, lo)));
+	}
+	return i;
+}
+#endif
+
+#ifdef HAVE_AVX2
+static __attribute__((target("avx2"))) gsize
+fu_firmware_hex_decode_avx2 (const gchar *data, gsize datasz, guint8 *buf)
+{
+	const __m256i c0 = _mm256_set1_epi8 ('0' - 1);
+	const __m256i c9 = _mm256_set1_epi8 ('9' + 1);
+	const __m256i ca = _mm256_set1_epi8 ('a' - 1);
+	const __m256i cf = _mm256_set1_epi8 ('f' + 1);
+	const __m256i lower = _mm256_set1_epi8 (0x20);
+	const __m256i mask = _mm256_set1_epi16 (0x00ff);
+	gsize i;
+
+	for (i = 0; i + 32 <= datasz; i += 32) {
+		__m256i v = _mm256_loadu_si256 ((const __m256i *) (data + i));
+		__m256i lc = _mm256_or_si256 (v, lower);
+		__m256i is_digit = _mm256_and_si256 (_mm256_cmpgt_epi8 (v, c0),
+						     _mm256_cmpgt_epi8 (c9, v));
+		__m256i is_alpha = _mm256_and_si256 (_mm256_cmpgt_epi8 (lc, ca),
+						     _mm256_cmpgt_epi8 (cf, lc));
+		__m256i nib;
+		__m256i val;
+
+		if (_mm256_movemask_epi8 (_mm256_or_si256 (is_digit, is_alpha)) != -1)
+			break;
+		nib = _mm256_or_si256 (_mm256_and_si256 (is_digit, _mm256_sub_epi8 (v, _mm256_set1_epi8 ('0'))),
+				       _mm256_and_si256 (is_alpha, _mm256_sub_epi8 (lc, _mm256_set1_epi8 ('a' - 10))));
+		val = _mm256_or_si256 (_mm256_slli_epi16 (_mm256_and_si256 (nib, mask), 4),
+				       _mm256_srli_epi16 (nib, 8));
+
+		/* packus works per 128-bit lane, so gather the two low qwords */
+		val = _mm256_permute4x64_epi64 (_mm256_packus_epi16 (val, val), 0x08);
+		_mm_storeu_si128 ((__m128i *) (buf + i / 2), _mm256_castsi256_si128 (val));
+	}
+	return i;
+}
+
+static __attribute__((target("avx2"))) __m256i
+fu_firmware_hex_nibble_to_ascii_avx2 (__m256i n)
+{
+	__m256i alpha = _mm256_and_si256 (_mm256_cmpgt_epi8 (n, _mm256_set1_epi8 (9)),
+					  _mm256_set1_epi8 ('A' - '0' - 10));
+	return _mm256_add_epi8 (_mm256_add_epi8 (n, _mm256_set1_epi8 ('0')), alpha);
+}
+
+static __attribute__((target("avx2"))) gsize
+fu_firmware_hex_encode_avx2 (const guint8 *buf, gsize bufsz, gchar *data)
+{
+	const __m256i mask = _mm256_set1_epi8 (0x0f);
+	gsize i;
+
+	for (i = 0; i + 32 <= bufsz; i += 32) {
+		__m256i v = _mm256_loadu_si256 ((const __m256i *) (buf + i));
+		__m256i hi = _mm256_and_si256 (_mm256_srli_epi16 (v, 4), mask);
+		__m256i lo = _mm256_and_si256 (v, mask);
+		__m256i a = fu_firmware_hex_nibble_to_ascii_avx2 (_mm256_unpacklo_epi8 (hi, lo));
+		__m256i b = fu_firmware_hex_nibble_to_ascii_avx2 (_mm256_unpackhi_epi8 (hi, lo));
+
+		/* unpack works per 128-bit lane, so swap the middle halves */
+		_mm256_storeu_si256 ((__m256i *) (data + i * 2),
+				     _mm256_permute2x128_si256 (a, b, 0x20));
+		_mm256_storeu_si256 ((__m256i *) (data + i * 2 + 32),
+				     _mm256_permute2x128_si256 (a, b, 0x31));
+	}
+	return i;
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static inline gboolean
+fu_firmware_hex_nibble_neon (uint8x16_t v, uint8x16_t *nib)
+{
+	uint8x16_t d = vsubq_u8 (v, vdupq_n_u8 ('0'));
+	uint8x16_t a = vsubq_u8 (vorrq_u8 (v, vdupq_n_u8 (0x20)), vdupq_n_u8 ('a'));
+	uint8x16_t is_digit = vcltq_u8 (d, vdupq_n_u8 (10));
+	uint8x16_t is_alpha = vcltq_u8 (a, vdupq_n_u8 (6));
+	if (vminvq_u8 (vorrq_u8 (is_digit, is_alpha)) == 0)
+		return FALSE;
+	*nib = vorrq_u8 (vandq_u8 (is_digit, d),
+			 vandq_u8 (is_alpha, vaddq_u8 (a, vdupq_n_u8 (10))));
+	return TRUE;
+}
+
+static gsize
+fu_firmware_hex_decode_neon (const gchar *data, gsize datasz, guint8 *buf)
+{
+	gsize i;
+	for (i = 0; i + 32 <= datasz; i += 32) {
+		uint8x16x2_t v = vld2q_u8 ((const guint8 *) data + i);
+		uint8x16_t hi;
+		uint8x16_t lo;
+		if (!fu_firmware_hex_nibble_neon (v.val[0], &hi) ||
+		    !fu_firmware_hex_nibble_neon (v.val[1], &lo))
+			break;
+		vst1q_u8 (buf + i / 2, vorrq_u8 (vshlq_n_u8 (hi, 4), lo));
+	}
+	return i;
+}
+
+static gsize
+fu_firmware_hex_encode_neon (const guint8 *buf, gsize bufsz, gchar *data)
+{
+	const uint8x16_t lut = vld1q_u8 ((const guint8 *) "0123456789ABCDEF");
+	gsize i;
+	for (i = 0; i + 16 <= bufsz; i += 16) {
+		uint8x16_t v = vld1q_u8 (buf + i);
+		uint8x16x2_t out;
+		out.val[0] = vqtbl1q_u8 (lut, vshrq_n_u8 (v, 4));
+		out.val[1] = vqtbl1q_u8 (lut, vandq_u8 (v, vdupq_n_u8 (0x0f)));
+		vst2q_u8 ((guint8 *) data + i * 2, out);
+	}
+	return i;
+}
+#endif
+
+static const FuFirmwareHexImpl *
+fu_firmware_hex_get_impl (void)
+{
+	static const FuFirmwareHexImpl *impl = NULL;
+	static gsize once = 0;
+
+	if (g_once_init_enter (&once)) {
+		static const FuFirmwareHexImpl impl_scalar = {
+			"scalar",
+			fu_firmware_hex_decode_scalar,
+			fu_firmware_hex_encode_scalar,
+		};
+		impl = &impl_scalar;
+#ifdef __SSE2__
+		{
+			static const FuFirmwareHexImpl impl_sse2 = {
+				"sse2",
+				fu_firmware_hex_decode_sse2,
+				fu_firmware_hex_encode_sse2,
+			};
+			impl = &impl_sse2;
+		}
+#endif
+#ifdef HAVE_AVX2
+		if (__builtin_cpu_supports ("avx2")) {
+			static const FuFirmwareHexImpl impl_avx2 = {
+				"avx2",
+				fu_firmware_hex_decode_avx2,
+				fu_firmware_hex_encode_avx2,
+			};
+			impl = &impl_avx2;
+		}
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+		{
+			static const FuFirmwareHexImpl impl_neon = {
+				"neon",
+				fu_firmware_hex_decode_neon,
+				fu_firmware_hex_encode_neon,
+			};
+			impl = &impl_neon;
+		}
+#endif
+		g_debug ("using %s hex encoder and decoder", impl->name);
+		g_once_init_leave (&once, 1);
+	}
+	return impl;
+}
+
 /**
  * fu_firmware_strparse_uint4:
  * @data: a string
@@ -28,10 +322,7 @@
 guint8
 fu_firmware_strparse_uint4 (const gchar *data)
 {
-	gchar buffer[2];
-	memcpy (buffer, data, 1);
-	buffer[1] = '\0';
-	return (guint8) g_ascii_strtoull (buffer, NULL, 16);
+	return (guint8) fu_firmware_strparse_uint (data, 1);
 }
 
 /**
@@ -50,10 +341,7 @@ fu_firmware_strparse_uint4 (const gchar *data)
 guint8
 fu_firmware_strparse_uint8 (const gchar *data)
 {
-	gchar buffer[3];
-	memcpy (buffer, data, 2);
-	buffer[2] = '\0';
-	return (guint8) g_ascii_strtoull (buffer, NULL, 16);
+	return (guint8) fu_firmware_strparse_uint (data, 2);
 }
 
 /**
@@ -72,10 +360,7 @@ fu_firmware_strparse_uint8 (const gchar *data)
 guint16
 fu_firmware_strparse_uint16 (const gchar *data)
 {
-	gchar buffer[5];
-	memcpy (buffer, data, 4);
-	buffer[4] = '\0';
-	return (guint16) g_ascii_strtoull (buffer, NULL, 16);
+	return (guint16) fu_firmware_strparse_uint (data, 4);
 }
 
 /**
@@ -94,10 +379,7 @@ fu_firmware_strparse_uint16 (const gchar *data)
 guint32
 fu_firmware_strparse_uint24 (const gchar *data)
 {
-	gchar buffer[7];
-	memcpy (buffer, data, 6);
-	buffer[6] = '\0';
-	return (guint32) g_ascii_strtoull (buffer, NULL, 16);
+	return (guint32) fu_firmware_strparse_uint (data, 6);
 }
 
 /**
@@ -116,8 +398,82 @@ fu_firmware_strparse_uint24 (const gchar *data)
 guint32
 fu_firmware_strparse_uint32 (const gchar *data)
 {
-	gchar buffer[9];
-	memcpy (buffer, data, 8);
-	buffer[8] = '\0';
-	return (guint32) g_ascii_strtoull (buffer, NULL, 16);
+	return (guint32) fu_firmware_strparse_uint (data, 8);
+}
+
+/**
+ * fu_firmware_strparse_hex:
+ * @data: a string of hex digits
+ * @datasz: size of @data in characters, which must be even
+ * @buf: (out caller-allocates): destination buffer
+ * @bufsz: size of @buf, which must be at least @datasz / 2
+ * @error: A #GError or %NULL
+ *
+ * Decodes pairs of base 16 digits into bytes without allocating memory.
+ * Unlike fu_firmware_strparse_uint8(), invalid characters are reported as
+ * an error rather than being silently parsed as zero.
+ *
+ * Return value: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_firmware_strparse_hex (const gchar *data, gsize datasz,
+			  guint8 *buf, gsize bufsz, GError **error)
+{
+	gsize done;
+
+	g_return_val_if_fail (data != NULL || datasz == 0, FALSE);
+	g_return_val_if_fail (buf != NULL || bufsz == 0, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (datasz % 2 != 0 || datasz / 2 > bufsz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "cannot decode 0x%x hex digits into 0x%x bytes",
+			     (guint) datasz, (guint) bufsz);
+		return FALSE;
+	}
+
+	/* vectorized blocks, then the remainder */
+	done = fu_firmware_hex_get_impl()->decode (data, datasz, buf);
+	done += fu_firmware_hex_decode_scalar (data + done, datasz - done, buf + done / 2);
+	if (done != datasz) {
+		guint8 hi = fu_firmware_hex_lut[(guint8) data[done]];
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid hex digit at offset 0x%x",
+			     (guint) ((hi & 0x10) == 0 ? done : done + 1));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_firmware_strappend_hex:
+ * @str: a #GString
+ * @buf: source buffer
+ * @bufsz: size of @buf
+ *
+ * Appends @buf to @str as pairs of uppercase base 16 digits, which is much
+ * faster than calling g_string_append_printf() for each byte.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_firmware_strappend_hex (GString *str, const guint8 *buf, gsize bufsz)
+{
+	gsize done;
+	gsize len;
+
+	g_return_if_fail (str != NULL);
+	g_return_if_fail (buf != NULL || bufsz == 0);
+
+	/* write directly into the string */
+	len = str->len;
+	g_string_set_size (str, len + bufsz * 2);
+	done = fu_firmware_hex_get_impl()->encode (buf, bufsz, str->str + len);
+	fu_firmware_hex_encode_scalar (buf + done, bufsz - done, str->str + len + done * 2);
 }
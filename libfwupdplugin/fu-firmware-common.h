@@ -13,3 +13,11 @@ guint8		 fu_firmware_strparse_uint8		(const gchar	*data);
 guint16		 fu_firmware_strparse_uint16		(const gchar	*data);
 guint32		 fu_firmware_strparse_uint24		(const gchar	*data);
 guint32		 fu_firmware_strparse_uint32		(const gchar	*data);
+gboolean	 fu_firmware_strparse_hex		(const gchar	*data,
+							 gsize		 datasz,
+							 guint8		*buf,
+							 gsize		 bufsz,
+							 GError		**error);
+void		 fu_firmware_strappend_hex		(GString	*str,
+							 const guint8	*buf,
+							 gsize		 bufsz);
@@ -6,8 +6,14 @@
 
 #pragma once
 
+#include "fu-firmware.h"
 #include "fu-firmware-image.h"
 
 void		 fu_firmware_image_add_string	(FuFirmwareImage	*self,
 						 guint			 idt,
 						 GString		*str);
+gsize		 fu_firmware_image_get_data_size	(FuFirmwareImage	*self);
+void		 fu_firmware_image_add_parent	(FuFirmwareImage	*self,
+						 FuFirmware		*firmware);
+void		 fu_firmware_image_remove_parent	(FuFirmwareImage	*self,
+						 FuFirmware		*firmware);
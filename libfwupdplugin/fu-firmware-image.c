@@ -10,6 +10,7 @@
 
 #include "fu-common.h"
 #include "fu-firmware-image-private.h"
+#include "fu-firmware-private.h"
 
 /**
  * SECTION:fu-firmware-image
@@ -21,16 +22,33 @@
 typedef struct {
 	gchar			*id;
 	GBytes			*bytes;
+	GInputStream		*stream;	/* until bytes are loaded */
+	goffset			 stream_offset;
+	gsize			 stream_size;
 	guint64			 addr;
 	guint64			 offset;
 	guint64			 idx;
 	gchar			*version;
 	gchar			*filename;
+	GPtrArray		*parents;	/* (nullable) (element-type FuFirmware) (not owned) */
 } FuFirmwareImagePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FuFirmwareImage, fu_firmware_image, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (fu_firmware_image_get_instance_private (o))
 
+/* the ID, index, address or data has changed */
+static void
+fu_firmware_image_changed (FuFirmwareImage *self)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	if (priv->parents == NULL)
+		return;
+	for (guint i = 0; i < priv->parents->len; i++) {
+		FuFirmware *firmware = g_ptr_array_index (priv->parents, i);
+		fu_firmware_invalidate_indexes (firmware);
+	}
+}
+
 /**
  * fu_firmware_image_get_version:
  * @self: A #FuFirmwareImage
@@ -117,6 +135,7 @@ fu_firmware_image_set_id (FuFirmwareImage *self, const gchar *id)
 	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (self));
 	g_free (priv->id);
 	priv->id = g_strdup (id);
+	fu_firmware_image_changed (self);
 }
 
 /**
@@ -152,6 +171,7 @@ fu_firmware_image_set_addr (FuFirmwareImage *self, guint64 addr)
 	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
 	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (self));
 	priv->addr = addr;
+	fu_firmware_image_changed (self);
 }
 
 /**
@@ -222,6 +242,7 @@ fu_firmware_image_set_idx (FuFirmwareImage *self, guint64 idx)
 	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
 	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (self));
 	priv->idx = idx;
+	fu_firmware_image_changed (self);
 }
 
 /**
@@ -259,6 +280,101 @@ fu_firmware_image_set_bytes (FuFirmwareImage *self, GBytes *bytes)
 	g_return_if_fail (bytes != NULL);
 	g_return_if_fail (priv->bytes == NULL);
 	priv->bytes = g_bytes_ref (bytes);
+	g_clear_object (&priv->stream);
+	fu_firmware_image_changed (self);
+}
+
+/**
+ * fu_firmware_image_set_stream:
+ * @self: a #FuFirmwareImage
+ * @stream: A seekable #GInputStream
+ * @offset: offset into @stream where the image data starts
+ * @size: size of the image data
+ *
+ * Sets the contents of the image to a region of a stream. The data is only
+ * read from the stream when the bytes are first required, so parsers can
+ * describe large images without loading them into memory.
+ *
+ * The image takes a reference to @stream and seeks it when loading, so the
+ * stream is owned by the images from then on and should not be read by the
+ * caller. Any data changed in the underlying file before the image is loaded
+ * is what will be returned, so use fu_firmware_image_set_bytes() if the
+ * source is not trusted to stay the same.
+ *
+ * Since: 1.5.5
+ **/
+void
+fu_firmware_image_set_stream (FuFirmwareImage *self,
+			      GInputStream *stream,
+			      goffset offset,
+			      gsize size)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (self));
+	g_return_if_fail (G_IS_SEEKABLE (stream));
+	g_return_if_fail (priv->bytes == NULL);
+	g_set_object (&priv->stream, stream);
+	priv->stream_offset = offset;
+	priv->stream_size = size;
+	fu_firmware_image_changed (self);
+}
+
+/* the size of the data without loading it from the stream */
+gsize
+fu_firmware_image_get_data_size (FuFirmwareImage *self)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	if (priv->bytes != NULL)
+		return g_bytes_get_size (priv->bytes);
+	if (priv->stream != NULL)
+		return priv->stream_size;
+	return 0;
+}
+
+/* the firmware the image has been added to, so the image lookups can be
+ * invalidated when a property used as a key is changed */
+void
+fu_firmware_image_add_parent (FuFirmwareImage *self, FuFirmware *firmware)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	if (priv->parents == NULL)
+		priv->parents = g_ptr_array_new ();
+	g_ptr_array_add (priv->parents, firmware);
+}
+
+void
+fu_firmware_image_remove_parent (FuFirmwareImage *self, FuFirmware *firmware)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	if (priv->parents == NULL)
+		return;
+	g_ptr_array_remove (priv->parents, firmware);
+}
+
+/* images often share a stream which has a single position */
+static GMutex fu_firmware_image_stream_mutex;
+
+static gboolean
+fu_firmware_image_ensure_bytes (FuFirmwareImage *self, GError **error)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (priv->stream == NULL)
+		return TRUE;
+	locker = g_mutex_locker_new (&fu_firmware_image_stream_mutex);
+	if (priv->bytes != NULL)
+		return TRUE;
+	priv->bytes = fu_common_get_contents_stream (priv->stream,
+						     priv->stream_offset,
+						     priv->stream_size,
+						     error);
+	if (priv->bytes == NULL) {
+		g_prefix_error (error, "failed to load image %s: ", priv->id);
+		return FALSE;
+	}
+	g_clear_object (&priv->stream);
+	return TRUE;
 }
 
 /**
@@ -270,6 +386,10 @@ fu_firmware_image_set_bytes (FuFirmwareImage *self, GBytes *bytes)
  * This should only really be used by objects subclassing #FuFirmwareImage as
  * images are normally exported to a file using fu_firmware_image_write().
  *
+ * If the data could not be loaded from the stream set with
+ * fu_firmware_image_set_stream() then %NULL is returned, and
+ * fu_firmware_image_load_bytes() should be used to get the error.
+ *
  * Returns: (transfer full): a #GBytes of the data, or %NULL if the bytes is not set
  *
  * Since: 1.5.0
@@ -278,12 +398,47 @@ GBytes *
 fu_firmware_image_get_bytes (FuFirmwareImage *self)
 {
 	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GError) error_local = NULL;
 	g_return_val_if_fail (FU_IS_FIRMWARE_IMAGE (self), NULL);
+	if (!fu_firmware_image_ensure_bytes (self, &error_local)) {
+		g_debug ("%s", error_local->message);
+		return NULL;
+	}
 	if (priv->bytes == NULL)
 		return NULL;
 	return g_bytes_ref (priv->bytes);
 }
 
+/**
+ * fu_firmware_image_load_bytes:
+ * @self: a #FuFirmwareImage
+ * @error: A #GError, or %NULL
+ *
+ * Gets the data set using fu_firmware_image_set_bytes(), or loads it from the
+ * stream set using fu_firmware_image_set_stream().
+ *
+ * Returns: (transfer full): a #GBytes of the data, or %NULL for error
+ *
+ * Since: 1.5.5
+ **/
+GBytes *
+fu_firmware_image_load_bytes (FuFirmwareImage *self, GError **error)
+{
+	FuFirmwareImagePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_FIRMWARE_IMAGE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	if (!fu_firmware_image_ensure_bytes (self, error))
+		return NULL;
+	if (priv->bytes == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "no bytes found in firmware image %s", priv->id);
+		return NULL;
+	}
+	return g_bytes_ref (priv->bytes);
+}
+
 /**
  * fu_firmware_image_parse:
  * @self: A #FuFirmwareImage
@@ -369,10 +524,10 @@ fu_firmware_image_build (FuFirmwareImage *self, XbNode *n, GError **error)
 	data = xb_node_query_first (n, "data", NULL);
 	if (data != NULL && xb_node_get_text (data) != NULL) {
 		gsize bufsz = 0;
-		g_autofree guchar *buf = NULL;
+		guchar *buf = NULL;
 		g_autoptr(GBytes) blob = NULL;
 		buf = g_base64_decode (xb_node_get_text (data), &bufsz);
-		blob = g_bytes_new (buf, bufsz);
+		blob = g_bytes_new_take (buf, bufsz);
 		fu_firmware_image_set_bytes (self, blob);
 	} else if (data != NULL) {
 		g_autoptr(GBytes) blob = NULL;
@@ -418,6 +573,8 @@ fu_firmware_image_write (FuFirmwareImage *self, GError **error)
 		return klass->write (self, error);
 
 	/* fall back to what was set manually */
+	if (!fu_firmware_image_ensure_bytes (self, error))
+		return NULL;
 	if (priv->bytes == NULL) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -466,6 +623,8 @@ fu_firmware_image_write_chunk (FuFirmwareImage *self,
 	}
 
 	/* offset into data */
+	if (!fu_firmware_image_ensure_bytes (self, error))
+		return NULL;
 	offset = address - priv->addr;
 	if (offset > g_bytes_get_size (priv->bytes)) {
 		g_set_error (error,
@@ -515,6 +674,8 @@ fu_firmware_image_add_string (FuFirmwareImage *self, guint idt, GString *str)
 	if (priv->bytes != NULL) {
 		fu_common_string_append_kx (str, idt, "Data",
 					    g_bytes_get_size (priv->bytes));
+	} else if (priv->stream != NULL) {
+		fu_common_string_append_kx (str, idt, "Data", priv->stream_size);
 	}
 
 	/* vfunc */
@@ -555,6 +716,10 @@ fu_firmware_image_finalize (GObject *object)
 	g_free (priv->filename);
 	if (priv->bytes != NULL)
 		g_bytes_unref (priv->bytes);
+	if (priv->stream != NULL)
+		g_object_unref (priv->stream);
+	if (priv->parents != NULL)
+		g_ptr_array_unref (priv->parents);
 	G_OBJECT_CLASS (fu_firmware_image_parent_class)->finalize (object);
 }
 
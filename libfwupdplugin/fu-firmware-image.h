@@ -58,8 +58,14 @@ guint64		 fu_firmware_image_get_idx	(FuFirmwareImage	*self);
 void		 fu_firmware_image_set_idx	(FuFirmwareImage	*self,
 						 guint64		 idx);
 GBytes		*fu_firmware_image_get_bytes	(FuFirmwareImage	*self);
+GBytes		*fu_firmware_image_load_bytes	(FuFirmwareImage	*self,
+						 GError			**error);
 void		 fu_firmware_image_set_bytes	(FuFirmwareImage	*self,
 						 GBytes			*bytes);
+void		 fu_firmware_image_set_stream	(FuFirmwareImage	*self,
+						 GInputStream		*stream,
+						 goffset		 offset,
+						 gsize			 size);
 gboolean	 fu_firmware_image_parse	(FuFirmwareImage	*self,
 						 GBytes			*fw,
 						 FwupdInstallFlags	 flags,
@@ -11,6 +11,7 @@
 #include "fu-common.h"
 #include "fu-firmware.h"
 #include "fu-firmware-image-private.h"
+#include "fu-firmware-private.h"
 
 /**
  * SECTION:fu-firmware
@@ -24,8 +25,23 @@ typedef struct {
 	FuFirmwareFlags			 flags;
 	GPtrArray			*images;	/* FuFirmwareImage */
 	gchar				*version;
+	GHashTable			*images_by_id;	/* id : FuFirmwareImage */
+	FuFirmwareImage			*image_no_id;	/* no ref */
+	GHashTable			*images_by_idx;	/* guint64 : FuFirmwareImage */
+	GArray				*images_by_addr; /* FuFirmwareRange, sorted by addr */
 } FuFirmwarePrivate;
 
+typedef struct {
+	guint64				 addr;
+	guint64				 addr_end;	/* exclusive */
+	guint64				 addr_end_max;	/* of this and all lower ranges */
+	guint				 pos;		/* in priv->images */
+	FuFirmwareImage			*img;		/* no ref */
+} FuFirmwareRange;
+
+/* below this a linear search is faster than maintaining the indexes */
+#define FU_FIRMWARE_IMAGES_INDEX_MIN	16
+
 G_DEFINE_TYPE_WITH_PRIVATE (FuFirmware, fu_firmware, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (fu_firmware_get_instance_private (o))
 
@@ -350,6 +366,9 @@ fu_firmware_build (FuFirmware *self, XbNode *n, GError **error)
  *
  * Parses a firmware file, typically breaking the firmware into images.
  *
+ * If the format supports parsing from a stream the file is kept open and the
+ * image data is read later, as described in fu_firmware_parse_stream().
+ *
  * Returns: %TRUE for success
  *
  * Since: 1.3.3
@@ -357,15 +376,110 @@ fu_firmware_build (FuFirmware *self, XbNode *n, GError **error)
 gboolean
 fu_firmware_parse_file (FuFirmware *self, GFile *file, FwupdInstallFlags flags, GError **error)
 {
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS (self);
 	gchar *buf = NULL;
 	gsize bufsz = 0;
 	g_autoptr(GBytes) fw = NULL;
+
+	/* only read the parts of the file that are needed */
+	if (klass->parse_stream != NULL) {
+		g_autoptr(GFileInputStream) stream = g_file_read (file, NULL, error);
+		if (stream == NULL)
+			return FALSE;
+		return fu_firmware_parse_stream (self, G_INPUT_STREAM (stream), flags, error);
+	}
+
 	if (!g_file_load_contents (file, NULL, &buf, &bufsz, NULL, error))
 		return FALSE;
 	fw = g_bytes_new_take (buf, bufsz);
 	return fu_firmware_parse (self, fw, flags, error);
 }
 
+/**
+ * fu_firmware_parse_stream:
+ * @self: A #FuFirmware
+ * @stream: A #GInputStream
+ * @flags: some #FwupdInstallFlags, e.g. %FWUPD_INSTALL_FLAG_FORCE
+ * @error: A #GError, or %NULL
+ *
+ * Parses a firmware from a stream, typically breaking the firmware into images.
+ *
+ * If the format supports it and @stream is seekable then only the headers are
+ * read, and the images load their data from @stream when it is first needed.
+ * In this case the images keep a reference to @stream and seek it as
+ * required, so the caller should not read from or close @stream afterwards.
+ * The data is read when each image is loaded rather than now, so use
+ * fu_firmware_parse() instead if the file may be modified in the meantime.
+ * Otherwise the whole stream is read into memory and fu_firmware_parse() is
+ * used.
+ *
+ * Returns: %TRUE for success
+ *
+ * Since: 1.5.5
+ **/
+gboolean
+fu_firmware_parse_stream (FuFirmware *self,
+			  GInputStream *stream,
+			  FwupdInstallFlags flags,
+			  GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS (self);
+	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+
+	g_return_val_if_fail (FU_IS_FIRMWARE (self), FALSE);
+	g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* subclassed */
+	if (klass->parse_stream != NULL &&
+	    G_IS_SEEKABLE (stream) &&
+	    g_seekable_can_seek (G_SEEKABLE (stream)))
+		return klass->parse_stream (self, stream, flags, error);
+
+	/* read it all */
+	ostream = g_memory_output_stream_new_resizable ();
+	if (g_output_stream_splice (ostream, stream,
+				    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				    NULL, error) < 0)
+		return FALSE;
+	fw = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+	return fu_firmware_parse (self, fw, flags, error);
+}
+
+/**
+ * fu_firmware_segments_join:
+ * @segments: (element-type GBytes): segments
+ *
+ * Concatenates segments, e.g. from fu_firmware_write_segments(), into one
+ * contiguous blob. If there is only one segment it is returned without
+ * copying.
+ *
+ * Returns: (transfer full): a #GBytes
+ *
+ * Since: 1.5.5
+ **/
+GBytes *
+fu_firmware_segments_join (GPtrArray *segments)
+{
+	GByteArray *buf;
+	gsize total_sz = 0;
+
+	g_return_val_if_fail (segments != NULL, NULL);
+
+	if (segments->len == 1)
+		return g_bytes_ref (g_ptr_array_index (segments, 0));
+	for (guint i = 0; i < segments->len; i++)
+		total_sz += g_bytes_get_size (g_ptr_array_index (segments, i));
+	buf = g_byte_array_sized_new (total_sz);
+	for (guint i = 0; i < segments->len; i++) {
+		gsize bufsz = 0;
+		const guint8 *data = g_bytes_get_data (g_ptr_array_index (segments, i), &bufsz);
+		g_byte_array_append (buf, data, bufsz);
+	}
+	return g_byte_array_free_to_bytes (buf);
+}
+
 /**
  * fu_firmware_write:
  * @self: A #FuFirmware
@@ -388,11 +502,57 @@ fu_firmware_write (FuFirmware *self, GError **error)
 	/* subclassed */
 	if (klass->write != NULL)
 		return klass->write (self, error);
+	if (klass->write_segments != NULL) {
+		g_autoptr(GPtrArray) segments = klass->write_segments (self, error);
+		if (segments == NULL)
+			return NULL;
+		return fu_firmware_segments_join (segments);
+	}
 
 	/* just add default blob */
 	return fu_firmware_get_image_default_bytes (self, error);
 }
 
+/**
+ * fu_firmware_write_segments:
+ * @self: A #FuFirmware
+ * @error: A #GError, or %NULL
+ *
+ * Writes a firmware as a list of segments which when concatenated are the
+ * same as the output of fu_firmware_write().
+ *
+ * Formats that implement this only allocate their headers and footers, and
+ * the image payloads are returned as references to the existing image data.
+ * This avoids copying the whole image when the result is going to be written
+ * to a file, checksummed or split into chunks anyway.
+ *
+ * Returns: (transfer container) (element-type GBytes): segments
+ *
+ * Since: 1.5.5
+ **/
+GPtrArray *
+fu_firmware_write_segments (FuFirmware *self, GError **error)
+{
+	FuFirmwareClass *klass = FU_FIRMWARE_GET_CLASS (self);
+	GPtrArray *segments;
+	g_autoptr(GBytes) blob = NULL;
+
+	g_return_val_if_fail (FU_IS_FIRMWARE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* subclassed */
+	if (klass->write_segments != NULL)
+		return klass->write_segments (self, error);
+
+	/* one contiguous blob */
+	blob = fu_firmware_write (self, error);
+	if (blob == NULL)
+		return NULL;
+	segments = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	g_ptr_array_add (segments, g_steal_pointer (&blob));
+	return segments;
+}
+
 /**
  * fu_firmware_write_file:
  * @self: A #FuFirmware
@@ -408,16 +568,237 @@ fu_firmware_write (FuFirmware *self, GError **error)
 gboolean
 fu_firmware_write_file (FuFirmware *self, GFile *file, GError **error)
 {
-	g_autoptr(GBytes) blob = NULL;
-	blob = fu_firmware_write (self, error);
-	if (blob == NULL)
+	g_autoptr(GFileOutputStream) stream = NULL;
+	g_autoptr(GPtrArray) segments = NULL;
+
+	segments = fu_firmware_write_segments (self, error);
+	if (segments == NULL)
+		return FALSE;
+
+	/* write each segment in turn rather than joining them first */
+	stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+	if (stream == NULL)
+		return FALSE;
+	for (guint i = 0; i < segments->len; i++) {
+		GBytes *blob = g_ptr_array_index (segments, i);
+		if (!g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+						g_bytes_get_data (blob, NULL),
+						g_bytes_get_size (blob),
+						NULL, NULL, error)) {
+			/* closing when cancelled discards the temporary file */
+			g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+			g_cancellable_cancel (cancellable);
+			g_output_stream_close (G_OUTPUT_STREAM (stream), cancellable, NULL);
+			return FALSE;
+		}
+	}
+	return g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+}
+
+static gboolean
+fu_firmware_images_find (GPtrArray *images, FuFirmwareImage *img, guint *pos)
+{
+	for (guint i = 0; i < images->len; i++) {
+		if (g_ptr_array_index (images, i) == img) {
+			*pos = i;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/* called when an image is removed, or a key of an image is changed */
+void
+fu_firmware_invalidate_indexes (FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	priv->image_no_id = NULL;
+	g_clear_pointer (&priv->images_by_id, g_hash_table_unref);
+	g_clear_pointer (&priv->images_by_idx, g_hash_table_unref);
+	g_clear_pointer (&priv->images_by_addr, g_array_unref);
+}
+
+/* only the first image with a given ID or index is indexed */
+static void
+fu_firmware_index_image (FuFirmware *self, FuFirmwareImage *img)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	const gchar *id = fu_firmware_image_get_id (img);
+	guint64 idx = fu_firmware_image_get_idx (img);
+
+	/* indexes are built on first use */
+	if (priv->images_by_id == NULL)
+		return;
+
+	/* the address index has to be sorted again */
+	g_clear_pointer (&priv->images_by_addr, g_array_unref);
+
+	/* the hash tables do not take NULL keys */
+	if (id == NULL) {
+		if (priv->image_no_id == NULL)
+			priv->image_no_id = img;
+	} else if (!g_hash_table_contains (priv->images_by_id, id)) {
+		g_hash_table_insert (priv->images_by_id, g_strdup (id), img);
+	}
+	if (!g_hash_table_contains (priv->images_by_idx, &idx)) {
+		guint64 *key = g_new (guint64, 1);
+		*key = idx;
+		g_hash_table_insert (priv->images_by_idx, key, img);
+	}
+}
+
+/* returns FALSE if the images should be searched linearly instead */
+static gboolean
+fu_firmware_ensure_indexes (FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+
+	/* not worth it */
+	if (priv->images->len < FU_FIRMWARE_IMAGES_INDEX_MIN)
 		return FALSE;
-	return g_file_replace_contents (file,
-					g_bytes_get_data (blob, NULL),
-					g_bytes_get_size (blob),
-					NULL, FALSE,
-					G_FILE_CREATE_NONE,
-					NULL, NULL, error);
+	if (priv->images_by_id != NULL)
+		return TRUE;
+
+	priv->images_by_id = g_hash_table_new_full (g_str_hash, g_str_equal,
+						    g_free, NULL);
+	priv->images_by_idx = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+						     g_free, NULL);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
+		fu_firmware_index_image (self, img);
+	}
+	return TRUE;
+}
+
+static gint
+fu_firmware_range_sort_cb (gconstpointer a, gconstpointer b)
+{
+	const FuFirmwareRange *range1 = a;
+	const FuFirmwareRange *range2 = b;
+	if (range1->addr < range2->addr)
+		return -1;
+	if (range1->addr > range2->addr)
+		return 1;
+	if (range1->pos < range2->pos)
+		return -1;
+	if (range1->pos > range2->pos)
+		return 1;
+	return 0;
+}
+
+static void
+fu_firmware_ensure_addr_index (FuFirmware *self)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	guint64 addr_end_max = 0;
+
+	if (priv->images_by_addr != NULL)
+		return;
+	priv->images_by_addr = g_array_sized_new (FALSE, FALSE,
+						  sizeof(FuFirmwareRange),
+						  priv->images->len);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
+		gsize size = fu_firmware_image_get_data_size (img);
+		FuFirmwareRange range = {
+			.addr = fu_firmware_image_get_addr (img),
+			.pos = i,
+			.img = img,
+		};
+		if (size == 0)
+			continue;
+		range.addr_end = range.addr + size;
+		if (range.addr_end < range.addr)
+			range.addr_end = G_MAXUINT64;
+		g_array_append_val (priv->images_by_addr, range);
+	}
+	g_array_sort (priv->images_by_addr, fu_firmware_range_sort_cb);
+
+	/* so the search knows when no lower range can reach the address */
+	for (guint i = 0; i < priv->images_by_addr->len; i++) {
+		FuFirmwareRange *range = &g_array_index (priv->images_by_addr,
+							 FuFirmwareRange, i);
+		addr_end_max = MAX (addr_end_max, range->addr_end);
+		range->addr_end_max = addr_end_max;
+	}
+}
+
+static FuFirmwareImage *
+fu_firmware_lookup_image_by_id (FuFirmware *self, const gchar *id)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	if (fu_firmware_ensure_indexes (self)) {
+		if (id == NULL)
+			return priv->image_no_id;
+		return g_hash_table_lookup (priv->images_by_id, id);
+	}
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
+		if (g_strcmp0 (fu_firmware_image_get_id (img), id) == 0)
+			return img;
+	}
+	return NULL;
+}
+
+static FuFirmwareImage *
+fu_firmware_lookup_image_by_idx (FuFirmware *self, guint64 idx)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	if (fu_firmware_ensure_indexes (self))
+		return g_hash_table_lookup (priv->images_by_idx, &idx);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
+		if (fu_firmware_image_get_idx (img) == idx)
+			return img;
+	}
+	return NULL;
+}
+
+static FuFirmwareImage *
+fu_firmware_lookup_image_by_addr (FuFirmware *self, guint64 addr)
+{
+	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	FuFirmwareImage *img = NULL;
+	guint pos = G_MAXUINT;
+	guint lo = 0;
+	guint hi;
+
+	if (!fu_firmware_ensure_indexes (self)) {
+		for (guint i = 0; i < priv->images->len; i++) {
+			FuFirmwareImage *img_tmp = g_ptr_array_index (priv->images, i);
+			guint64 addr_tmp = fu_firmware_image_get_addr (img_tmp);
+			gsize size = fu_firmware_image_get_data_size (img_tmp);
+			if (addr >= addr_tmp && addr - addr_tmp < size)
+				return img_tmp;
+		}
+		return NULL;
+	}
+	fu_firmware_ensure_addr_index (self);
+
+	/* find the first range starting above the address */
+	hi = priv->images_by_addr->len;
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		const FuFirmwareRange *range = &g_array_index (priv->images_by_addr,
+							       FuFirmwareRange, mid);
+		if (range->addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* walk down while a lower range could still contain the address */
+	for (guint i = lo; i > 0; i--) {
+		const FuFirmwareRange *range = &g_array_index (priv->images_by_addr,
+							       FuFirmwareRange, i - 1);
+		if (range->addr_end_max <= addr)
+			break;
+		if (addr < range->addr_end && range->pos < pos) {
+			pos = range->pos;
+			img = range->img;
+		}
+	}
+	return img;
 }
 
 /**
@@ -436,29 +817,37 @@ void
 fu_firmware_add_image (FuFirmware *self, FuFirmwareImage *img)
 {
 	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	FuFirmwareImage *img_id = NULL;
+	FuFirmwareImage *img_idx = NULL;
+
 	g_return_if_fail (FU_IS_FIRMWARE (self));
 	g_return_if_fail (FU_IS_FIRMWARE_IMAGE (img));
 
-	/* dedupe */
-	for (guint i = 0; i < priv->images->len; i++) {
-		FuFirmwareImage *img_tmp = g_ptr_array_index (priv->images, i);
-		if (priv->flags & FU_FIRMWARE_FLAG_DEDUPE_ID) {
-			if (g_strcmp0 (fu_firmware_image_get_id (img_tmp),
-				       fu_firmware_image_get_id (img)) == 0) {
-				g_ptr_array_remove_index (priv->images, i);
-				break;
-			}
-		}
-		if (priv->flags & FU_FIRMWARE_FLAG_DEDUPE_IDX) {
-			if (fu_firmware_image_get_idx (img_tmp) ==
-			    fu_firmware_image_get_idx (img)) {
-				g_ptr_array_remove_index (priv->images, i);
-				break;
-			}
-		}
+	/* dedupe, removing whichever match comes first */
+	if (priv->flags & FU_FIRMWARE_FLAG_DEDUPE_ID)
+		img_id = fu_firmware_lookup_image_by_id (self, fu_firmware_image_get_id (img));
+	if (priv->flags & FU_FIRMWARE_FLAG_DEDUPE_IDX)
+		img_idx = fu_firmware_lookup_image_by_idx (self, fu_firmware_image_get_idx (img));
+	if (img_id != NULL && img_idx != NULL && img_id != img_idx) {
+		guint pos_id = 0;
+		guint pos_idx = 0;
+		fu_firmware_images_find (priv->images, img_id, &pos_id);
+		fu_firmware_images_find (priv->images, img_idx, &pos_idx);
+		if (pos_idx < pos_id)
+			img_id = NULL;
+		else
+			img_idx = NULL;
+	}
+	if (img_id != NULL || img_idx != NULL) {
+		FuFirmwareImage *img_old = img_id != NULL ? img_id : img_idx;
+		fu_firmware_image_remove_parent (img_old, self);
+		g_ptr_array_remove (priv->images, img_old);
+		fu_firmware_invalidate_indexes (self);
 	}
 
 	g_ptr_array_add (priv->images, g_object_ref (img));
+	fu_firmware_image_add_parent (img, self);
+	fu_firmware_index_image (self, img);
 }
 
 /**
@@ -477,13 +866,18 @@ gboolean
 fu_firmware_remove_image (FuFirmware *self, FuFirmwareImage *img, GError **error)
 {
 	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	guint pos = 0;
 
 	g_return_val_if_fail (FU_IS_FIRMWARE (self), FALSE);
 	g_return_val_if_fail (FU_IS_FIRMWARE_IMAGE (img), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	if (g_ptr_array_remove (priv->images, img))
+	if (fu_firmware_images_find (priv->images, img, &pos)) {
+		fu_firmware_image_remove_parent (img, self);
+		g_ptr_array_remove_index (priv->images, pos);
+		fu_firmware_invalidate_indexes (self);
 		return TRUE;
+	}
 
 	/* did not exist */
 	g_set_error (error,
@@ -518,7 +912,9 @@ fu_firmware_remove_image_by_idx (FuFirmware *self, guint64 idx, GError **error)
 	img = fu_firmware_get_image_by_idx (self, idx, error);
 	if (img == NULL)
 		return FALSE;
+	fu_firmware_image_remove_parent (img, self);
 	g_ptr_array_remove (priv->images, img);
+	fu_firmware_invalidate_indexes (self);
 	return TRUE;
 }
 
@@ -546,7 +942,9 @@ fu_firmware_remove_image_by_id (FuFirmware *self, const gchar *id, GError **erro
 	img = fu_firmware_get_image_by_id (self, id, error);
 	if (img == NULL)
 		return FALSE;
+	fu_firmware_image_remove_parent (img, self);
 	g_ptr_array_remove (priv->images, img);
+	fu_firmware_invalidate_indexes (self);
 	return TRUE;
 }
 
@@ -591,16 +989,14 @@ fu_firmware_get_images (FuFirmware *self)
 FuFirmwareImage *
 fu_firmware_get_image_by_id (FuFirmware *self, const gchar *id, GError **error)
 {
-	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	FuFirmwareImage *img;
 
 	g_return_val_if_fail (FU_IS_FIRMWARE (self), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	for (guint i = 0; i < priv->images->len; i++) {
-		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
-		if (g_strcmp0 (fu_firmware_image_get_id (img), id) == 0)
-			return g_object_ref (img);
-	}
+	img = fu_firmware_lookup_image_by_id (self, id);
+	if (img != NULL)
+		return g_object_ref (img);
 	g_set_error (error,
 		     FWUPD_ERROR,
 		     FWUPD_ERROR_NOT_FOUND,
@@ -644,16 +1040,14 @@ fu_firmware_get_image_by_id_bytes (FuFirmware *self, const gchar *id, GError **e
 FuFirmwareImage *
 fu_firmware_get_image_by_idx (FuFirmware *self, guint64 idx, GError **error)
 {
-	FuFirmwarePrivate *priv = GET_PRIVATE (self);
+	FuFirmwareImage *img;
 
 	g_return_val_if_fail (FU_IS_FIRMWARE (self), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	for (guint i = 0; i < priv->images->len; i++) {
-		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
-		if (fu_firmware_image_get_idx (img) == idx)
-			return g_object_ref (img);
-	}
+	img = fu_firmware_lookup_image_by_idx (self, idx);
+	if (img != NULL)
+		return g_object_ref (img);
 	g_set_error (error,
 		     FWUPD_ERROR,
 		     FWUPD_ERROR_NOT_FOUND,
@@ -661,6 +1055,39 @@ fu_firmware_get_image_by_idx (FuFirmware *self, guint64 idx, GError **error)
 	return NULL;
 }
 
+/**
+ * fu_firmware_get_image_by_addr:
+ * @self: a #FuPlugin
+ * @addr: an address, e.g. `0x8000`
+ * @error: A #GError, or %NULL
+ *
+ * Gets the firmware image that contains the address, using the base address
+ * and the data size of each image. If the images overlap then the image that
+ * was added first is returned.
+ *
+ * Returns: (transfer full): a #FuFirmwareImage, or %NULL if the image is not found
+ *
+ * Since: 1.5.5
+ **/
+FuFirmwareImage *
+fu_firmware_get_image_by_addr (FuFirmware *self, guint64 addr, GError **error)
+{
+	FuFirmwareImage *img;
+
+	g_return_val_if_fail (FU_IS_FIRMWARE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	img = fu_firmware_lookup_image_by_addr (self, addr);
+	if (img != NULL)
+		return g_object_ref (img);
+	g_set_error (error,
+		     FWUPD_ERROR,
+		     FWUPD_ERROR_NOT_FOUND,
+		     "no image for address 0x%" G_GINT64_MODIFIER "x found in firmware",
+		     addr);
+	return NULL;
+}
+
 /**
  * fu_firmware_get_image_by_idx_bytes:
  * @self: a #FuPlugin
@@ -796,7 +1223,12 @@ fu_firmware_finalize (GObject *object)
 	FuFirmware *self = FU_FIRMWARE (object);
 	FuFirmwarePrivate *priv = GET_PRIVATE (self);
 	g_free (priv->version);
+	for (guint i = 0; i < priv->images->len; i++) {
+		FuFirmwareImage *img = g_ptr_array_index (priv->images, i);
+		fu_firmware_image_remove_parent (img, self);
+	}
 	g_ptr_array_unref (priv->images);
+	fu_firmware_invalidate_indexes (self);
 	G_OBJECT_CLASS (fu_firmware_parent_class)->finalize (object);
 }
 
@@ -35,8 +35,14 @@ struct _FuFirmwareClass
 	gboolean		 (*build)		(FuFirmware	*self,
 							 XbNode		*n,
 							 GError		**error);
+	GPtrArray		*(*write_segments)	(FuFirmware	*self,
+							 GError		**error);
+	gboolean		 (*parse_stream)	(FuFirmware	*self,
+							 GInputStream	*stream,
+							 FwupdInstallFlags flags,
+							 GError		**error);
 	/*< private >*/
-	gpointer		 padding[27];
+	gpointer		 padding[25];
 };
 
 /**
@@ -81,6 +87,10 @@ gboolean	 fu_firmware_parse_file			(FuFirmware	*self,
 							 GFile		*file,
 							 FwupdInstallFlags flags,
 							 GError		**error);
+gboolean	 fu_firmware_parse_stream		(FuFirmware	*self,
+							 GInputStream	*stream,
+							 FwupdInstallFlags flags,
+							 GError		**error);
 gboolean	 fu_firmware_parse_full			(FuFirmware	*self,
 							 GBytes		*fw,
 							 guint64	 addr_start,
@@ -89,6 +99,9 @@ gboolean	 fu_firmware_parse_full			(FuFirmware	*self,
 							 GError		**error);
 GBytes		*fu_firmware_write			(FuFirmware	*self,
 							 GError		**error);
+GPtrArray	*fu_firmware_write_segments		(FuFirmware	*self,
+							 GError		**error);
+GBytes		*fu_firmware_segments_join		(GPtrArray	*segments);
 gboolean	 fu_firmware_write_file			(FuFirmware	*self,
 							 GFile		*file,
 							 GError		**error);
@@ -114,6 +127,9 @@ GBytes		*fu_firmware_get_image_by_id_bytes	(FuFirmware	*self,
 FuFirmwareImage *fu_firmware_get_image_by_idx		(FuFirmware	*self,
 							 guint64	 idx,
 							 GError		**error);
+FuFirmwareImage *fu_firmware_get_image_by_addr		(FuFirmware	*self,
+							 guint64	 addr,
+							 GError		**error);
 GBytes		*fu_firmware_get_image_by_idx_bytes	(FuFirmware	*self,
 							 guint64	 idx,
 							 GError		**error);
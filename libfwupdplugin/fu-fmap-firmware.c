@@ -31,12 +31,11 @@ fmap_size (FuFmap *fmap)
 	return sizeof (*fmap) + (fmap->nareas * sizeof (FuFmapArea));
 }
 
-/* brute force linear search */
+/* linear search */
 static gboolean
 fmap_lsearch (const guint8 *image, gsize len, gsize *offset, GError **error)
 {
-	gsize i;
-	gboolean fmap_found = FALSE;
+	gsize i = 0;
 
 	if (offset == NULL) {
 		g_set_error_literal (error,
@@ -46,16 +45,10 @@ fmap_lsearch (const guint8 *image, gsize len, gsize *offset, GError **error)
 		return FALSE;
 	}
 
-	for (i = 0; i < len - strlen(FMAP_SIGNATURE); i++) {
-		if (!memcmp(&image[i],
-		            FMAP_SIGNATURE,
-		            strlen(FMAP_SIGNATURE))) {
-			fmap_found = TRUE;
-			break;
-		}
-	}
-
-	if (!fmap_found) {
+	if (!fu_memmem_safe (image, len,
+			     (const guint8 *) FMAP_SIGNATURE,
+			     strlen (FMAP_SIGNATURE),
+			     &i, NULL)) {
 		g_set_error_literal (error,
 				     G_IO_ERROR,
 				     G_IO_ERROR_INVALID_DATA,
@@ -178,6 +171,55 @@ fu_fmap_firmware_to_string (FuFirmware *firmware, guint idt, GString *str)
 	fu_common_string_append_kx (str, idt, "Base", priv->base);
 }
 
+static gboolean
+fu_fmap_firmware_parse_header (FuFmapFirmware *self,
+			       const FuFmap *fmap,
+			       gsize bufsz,
+			       GError **error)
+{
+	FuFmapFirmwarePrivate *priv = GET_PRIVATE (self);
+	priv->base = GUINT64_FROM_LE (fmap->base);
+	if (GUINT32_FROM_LE (fmap->size) != bufsz) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_INVALID_DATA,
+			     "file size incorrect, expected 0x%04x got 0x%04x",
+			     (guint) fmap->size,
+			     (guint) bufsz);
+		return FALSE;
+	}
+	if (GUINT16_FROM_LE (fmap->nareas) < 1) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_INVALID_DATA,
+			     "number of areas too small, got %" G_GUINT16_FORMAT,
+			     GUINT16_FROM_LE (fmap->nareas));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* the image data is set by the caller */
+static FuFirmwareImage *
+fu_fmap_firmware_image_new (const FuFmap *fmap, const FuFmapArea *area, gsize idx)
+{
+	FuFirmwareImage *img = fu_firmware_image_new (NULL);
+	g_autofree gchar *area_name = NULL;
+
+	area_name = g_strndup ((const gchar *) area->name, FU_FMAP_FIRMWARE_STRLEN);
+	fu_firmware_image_set_id (img, area_name);
+	fu_firmware_image_set_idx (img, idx + 1);
+	fu_firmware_image_set_addr (img, GUINT32_FROM_LE (area->offset));
+	if (g_strcmp0 (area_name, FMAP_AREANAME) == 0) {
+		g_autofree gchar *version = NULL;
+		version = g_strdup_printf ("%d.%d",
+					   fmap->ver_major,
+					   fmap->ver_minor);
+		fu_firmware_image_set_version (img, version);
+	}
+	return img;
+}
+
 static gboolean
 fu_fmap_firmware_parse (FuFirmware *firmware,
 			GBytes *fw,
@@ -187,7 +229,6 @@ fu_fmap_firmware_parse (FuFirmware *firmware,
 			GError **error)
 {
 	FuFmapFirmware *self = FU_FMAP_FIRMWARE (firmware);
-	FuFmapFirmwarePrivate *priv = GET_PRIVATE (self);
 	FuFmapFirmwareClass *klass_firmware = FU_FMAP_FIRMWARE_GET_CLASS (firmware);
 	gsize bufsz;
 	const guint8 *buf = g_bytes_get_data (fw, &bufsz);
@@ -216,65 +257,35 @@ fu_fmap_firmware_parse (FuFirmware *firmware,
 			     buf, bufsz, offset,			/* src */
 			     sizeof(fmap), error))
 		return FALSE;
-	priv->base = GUINT64_FROM_LE (fmap.base);
-
-	if (GUINT32_FROM_LE (fmap.size) != bufsz) {
-		g_set_error (error,
-			     G_IO_ERROR,
-			     G_IO_ERROR_INVALID_DATA,
-			     "file size incorrect, expected 0x%04x got 0x%04x",
-			     (guint) fmap.size,
-			     (guint) bufsz);
+	if (!fu_fmap_firmware_parse_header (self, &fmap, bufsz, error))
 		return FALSE;
-	}
-	if (GUINT16_FROM_LE (fmap.nareas) < 1) {
-		g_set_error (error,
-			     G_IO_ERROR,
-			     G_IO_ERROR_INVALID_DATA,
-			     "number of areas too small, got %" G_GUINT16_FORMAT,
-			     GUINT16_FROM_LE (fmap.nareas));
-		return FALSE;
-	}
 	offset += sizeof(fmap);
 
 	for (gsize i = 0; i < GUINT16_FROM_LE (fmap.nareas); i++) {
 		FuFmapArea area;
 		g_autoptr(FuFirmwareImage) img = NULL;
 		g_autoptr(GBytes) bytes = NULL;
-		g_autofree gchar *area_name = NULL;
 
 		/* load area */
 		if (!fu_memcpy_safe ((guint8 *) &area, sizeof(area), 0x0,	/* dst */
 				     buf, bufsz, offset,			/* src */
 				     sizeof(area), error))
 			return FALSE;
+		offset += sizeof(area);
 
 		/* skip */
 		if (area.size == 0)
 			continue;
 
-		img = fu_firmware_image_new (NULL);
 		bytes = fu_common_bytes_new_offset (fw,
 						    (gsize) GUINT32_FROM_LE (area.offset),
 						    (gsize) GUINT32_FROM_LE (area.size),
 						    error);
 		if (bytes == NULL)
 			return FALSE;
-		area_name = g_strndup ((const gchar *) area.name, FU_FMAP_FIRMWARE_STRLEN);
-		fu_firmware_image_set_id (img, area_name);
-		fu_firmware_image_set_idx (img, i + 1);
-		fu_firmware_image_set_addr (img, GUINT32_FROM_LE (area.offset));
+		img = fu_fmap_firmware_image_new (&fmap, &area, i);
 		fu_firmware_image_set_bytes (img, bytes);
 		fu_firmware_add_image (firmware, img);
-
-		if (g_strcmp0 (area_name, FMAP_AREANAME) == 0) {
-			g_autofree gchar *version = NULL;
-			version = g_strdup_printf ("%d.%d",
-						   fmap.ver_major,
-						   fmap.ver_minor);
-			fu_firmware_image_set_version (img, version);
-		}
-		offset += sizeof(area);
 	}
 
 	/* subclassed */
@@ -287,14 +298,144 @@ fu_fmap_firmware_parse (FuFirmware *firmware,
 	return TRUE;
 }
 
-static GBytes *
-fu_fmap_firmware_write (FuFirmware *firmware, GError **error)
+/* search in blocks so that the whole image is never in memory at once */
+static gboolean
+fu_fmap_firmware_find_stream (GInputStream *stream,
+			      gsize streamsz,
+			      gsize *offset,
+			      GError **error)
+{
+	const gsize blocksz = 0x10000;
+	const gsize siglen = strlen (FMAP_SIGNATURE);
+	g_autofree guint8 *buf = g_malloc (blocksz + siglen);
+
+	for (gsize pos = 0; pos < streamsz; pos += blocksz) {
+		gsize bytes_read = 0;
+		gsize offset_tmp = 0;
+
+		/* overlap so a signature spanning two blocks is found */
+		if (!g_seekable_seek (G_SEEKABLE (stream), pos, G_SEEK_SET, NULL, error))
+			return FALSE;
+		if (!g_input_stream_read_all (stream, buf,
+					      MIN (blocksz + siglen - 1, streamsz - pos),
+					      &bytes_read, NULL, error))
+			return FALSE;
+		if (fu_memmem_safe (buf, bytes_read,
+				    (const guint8 *) FMAP_SIGNATURE, siglen,
+				    &offset_tmp, NULL)) {
+			*offset = pos + offset_tmp;
+			return TRUE;
+		}
+	}
+	g_set_error_literal (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_INVALID_DATA,
+			     "fmap not found using linear search");
+	return FALSE;
+}
+
+static gboolean
+fu_fmap_firmware_parse_stream (FuFirmware *firmware,
+			       GInputStream *stream,
+			       FwupdInstallFlags flags,
+			       GError **error)
+{
+	FuFmapFirmware *self = FU_FMAP_FIRMWARE (firmware);
+	FuFmapFirmwareClass *klass_firmware = FU_FMAP_FIRMWARE_GET_CLASS (firmware);
+	FuFmap fmap;
+	const FuFmapArea *areas;
+	gsize offset = 0;
+	gsize streamsz;
+	g_autoptr(GBytes) blob_areas = NULL;
+	g_autoptr(GBytes) blob_hdr = NULL;
+
+	/* get size */
+	if (!g_seekable_seek (G_SEEKABLE (stream), 0, G_SEEK_END, NULL, error))
+		return FALSE;
+	streamsz = (gsize) g_seekable_tell (G_SEEKABLE (stream));
+
+	/* subclasses parse the whole image */
+	if (klass_firmware->parse != NULL) {
+		g_autoptr(GBytes) fw = NULL;
+		fw = fu_common_get_contents_stream (stream, 0, streamsz, error);
+		if (fw == NULL)
+			return FALSE;
+		return fu_firmware_parse (firmware, fw, flags, error);
+	}
+
+	/* corrupt */
+	if (streamsz < sizeof (FuFmap)) {
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "firmware too small for fmap");
+		return FALSE;
+	}
+
+	/* only search for the fmap signature if not fuzzing */
+	if ((flags & FWUPD_INSTALL_FLAG_NO_SEARCH) == 0) {
+		if (!fu_fmap_firmware_find_stream (stream, streamsz, &offset, error)) {
+			g_prefix_error (error, "cannot find fmap in image: ");
+			return FALSE;
+		}
+	}
+
+	/* load header */
+	blob_hdr = fu_common_get_contents_stream (stream, offset, sizeof(fmap), error);
+	if (blob_hdr == NULL)
+		return FALSE;
+	memcpy (&fmap, g_bytes_get_data (blob_hdr, NULL), sizeof(fmap));
+	if (!fu_fmap_firmware_parse_header (self, &fmap, streamsz, error))
+		return FALSE;
+
+	/* load all the areas in one read */
+	blob_areas = fu_common_get_contents_stream (stream,
+						    offset + sizeof(fmap),
+						    GUINT16_FROM_LE (fmap.nareas) * sizeof(FuFmapArea),
+						    error);
+	if (blob_areas == NULL)
+		return FALSE;
+	areas = g_bytes_get_data (blob_areas, NULL);
+	for (gsize i = 0; i < GUINT16_FROM_LE (fmap.nareas); i++) {
+		const FuFmapArea *area = &areas[i];
+		gsize area_offset = GUINT32_FROM_LE (area->offset);
+		gsize area_size = GUINT32_FROM_LE (area->size);
+		g_autoptr(FuFirmwareImage) img = NULL;
+
+		/* skip */
+		if (area_size == 0)
+			continue;
+		if (area_offset + area_size > streamsz) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     "area @0x%x for 0x%x too large for image of 0x%x",
+				     (guint) area_offset,
+				     (guint) area_size,
+				     (guint) streamsz);
+			return FALSE;
+		}
+
+		/* data is read when first required */
+		img = fu_fmap_firmware_image_new (&fmap, area, i);
+		fu_firmware_image_set_stream (img, stream, area_offset, area_size);
+		fu_firmware_add_image (firmware, img);
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static GPtrArray *
+fu_fmap_firmware_write_segments (FuFirmware *firmware, GError **error)
 {
 	FuFmapFirmware *self = FU_FMAP_FIRMWARE (firmware);
 	FuFmapFirmwarePrivate *priv = GET_PRIVATE (self);
+	GPtrArray *segments;
 	gsize total_sz;
 	gsize offset;
 	g_autoptr(GPtrArray) images = fu_firmware_get_images (firmware);
+	g_autoptr(GPtrArray) blobs = NULL;
 	g_autoptr(GByteArray) buf = g_byte_array_new ();
 	FuFmap hdr = {
 		.signature = { FMAP_SIGNATURE },
@@ -306,13 +447,20 @@ fu_fmap_firmware_write (FuFirmware *firmware, GError **error)
 		.nareas = GUINT32_TO_LE (images->len),
 	};
 
-	/* add header */
-	total_sz = offset = sizeof(hdr) + (sizeof(FuFmapArea) * images->len);
+	/* load each image once, as they may be backed by a stream */
+	blobs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
 	for (guint i = 0; i < images->len; i++) {
 		FuFirmwareImage *img = g_ptr_array_index (images, i);
-		g_autoptr(GBytes) fw = fu_firmware_image_get_bytes (img);
-		total_sz += g_bytes_get_size (fw);
+		GBytes *fw = fu_firmware_image_load_bytes (img, error);
+		if (fw == NULL)
+			return NULL;
+		g_ptr_array_add (blobs, fw);
 	}
+
+	/* add header */
+	total_sz = offset = sizeof(hdr) + (sizeof(FuFmapArea) * images->len);
+	for (guint i = 0; i < blobs->len; i++)
+		total_sz += g_bytes_get_size (g_ptr_array_index (blobs, i));
 	hdr.size = GUINT16_TO_LE (total_sz);
 	g_byte_array_append (buf, (const guint8 *) &hdr, sizeof(hdr));
 
@@ -320,7 +468,7 @@ fu_fmap_firmware_write (FuFirmware *firmware, GError **error)
 	for (guint i = 0; i < images->len; i++) {
 		FuFirmwareImage *img = g_ptr_array_index (images, i);
 		const gchar *id = fu_firmware_image_get_id (img);
-		g_autoptr(GBytes) fw = fu_firmware_image_get_bytes (img);
+		GBytes *fw = g_ptr_array_index (blobs, i);
 		FuFmapArea area = {
 			.offset = GUINT32_TO_LE (offset),
 			.size = GUINT32_TO_LE (g_bytes_get_size (fw)),
@@ -333,17 +481,14 @@ fu_fmap_firmware_write (FuFirmware *firmware, GError **error)
 		offset += g_bytes_get_size (fw);
 	}
 
-	/* add the images */
-	for (guint i = 0; i < images->len; i++) {
-		FuFirmwareImage *img = g_ptr_array_index (images, i);
-		g_autoptr(GBytes) fw = fu_firmware_image_get_bytes (img);
-		g_byte_array_append (buf,
-				     g_bytes_get_data (fw, NULL),
-				     g_bytes_get_size (fw));
-	}
+	/* the header, then references to the images */
+	segments = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	g_ptr_array_add (segments, g_byte_array_free_to_bytes (g_steal_pointer (&buf)));
+	for (guint i = 0; i < blobs->len; i++)
+		g_ptr_array_add (segments, g_bytes_ref (g_ptr_array_index (blobs, i)));
 
 	/* success */
-	return g_byte_array_free_to_bytes (g_steal_pointer (&buf));
+	return segments;
 }
 
 static gboolean
@@ -373,7 +518,8 @@ fu_fmap_firmware_class_init (FuFmapFirmwareClass *klass)
 	FuFirmwareClass *klass_firmware = FU_FIRMWARE_CLASS (klass);
 	klass_firmware->to_string = fu_fmap_firmware_to_string;
 	klass_firmware->parse = fu_fmap_firmware_parse;
-	klass_firmware->write = fu_fmap_firmware_write;
+	klass_firmware->parse_stream = fu_fmap_firmware_parse_stream;
+	klass_firmware->write_segments = fu_fmap_firmware_write_segments;
 	klass_firmware->build = fu_fmap_firmware_build;
 }
 
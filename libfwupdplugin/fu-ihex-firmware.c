@@ -25,11 +25,33 @@
 
 struct _FuIhexFirmware {
 	FuFirmware		 parent_instance;
-	GPtrArray		*records;
+	GBytes			*fw;
+	GArray			*tokens;	/* of FuIhexFirmwareToken */
+	GByteArray		*payload;	/* decoded record data */
+	GPtrArray		*records;	/* (nullable): created on demand */
 };
 
+/* a record that has been validated but not copied out of the text */
+typedef struct {
+	guint			 ln;
+	guint8			 byte_cnt;
+	guint8			 record_type;
+	guint16			 addr;
+	gsize			 line_offset;	/* into fw */
+	gsize			 line_len;
+	guint32			 data_offset;	/* into payload */
+} FuIhexFirmwareToken;
+
 G_DEFINE_TYPE (FuIhexFirmware, fu_ihex_firmware, FU_TYPE_FIRMWARE)
 
+static void
+fu_ihex_firmware_record_free (FuIhexFirmwareRecord *rcd)
+{
+	g_string_free (rcd->buf, TRUE);
+	g_byte_array_unref (rcd->data);
+	g_free (rcd);
+}
+
 /**
  * fu_ihex_firmware_get_records:
  * @self: A #FuIhexFirmware
@@ -46,31 +68,51 @@ G_DEFINE_TYPE (FuIhexFirmware, fu_ihex_firmware, FU_TYPE_FIRMWARE)
 GPtrArray *
 fu_ihex_firmware_get_records (FuIhexFirmware *self)
 {
+	const gchar *data = NULL;
+
 	g_return_val_if_fail (FU_IS_IHEX_FIRMWARE (self), NULL);
-	return self->records;
-}
 
-static void
-fu_ihex_firmware_record_free (FuIhexFirmwareRecord *rcd)
-{
-	g_string_free (rcd->buf, TRUE);
-	g_byte_array_unref (rcd->data);
-	g_free (rcd);
-}
+	/* already created */
+	if (self->records != NULL)
+		return self->records;
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuIhexFirmwareRecord, fu_ihex_firmware_record_free)
+	/* the tokenizer does not allocate anything per-line */
+	self->records = g_ptr_array_new_with_free_func ((GFreeFunc) fu_ihex_firmware_record_free);
+	if (self->fw != NULL)
+		data = g_bytes_get_data (self->fw, NULL);
+	for (guint i = 0; i < self->tokens->len; i++) {
+		FuIhexFirmwareToken *tok = &g_array_index (self->tokens, FuIhexFirmwareToken, i);
+		FuIhexFirmwareRecord *rcd = g_new0 (FuIhexFirmwareRecord, 1);
+		rcd->ln = tok->ln;
+		rcd->buf = g_string_new_len (data + tok->line_offset, tok->line_len);
+		rcd->byte_cnt = tok->byte_cnt;
+		rcd->addr = tok->addr;
+		rcd->record_type = tok->record_type;
+		rcd->data = g_byte_array_sized_new (tok->byte_cnt);
+		g_byte_array_append (rcd->data,
+				     self->payload->data + tok->data_offset,
+				     tok->byte_cnt);
+		g_ptr_array_add (self->records, rcd);
+	}
+	return self->records;
+}
 
-static FuIhexFirmwareRecord *
-fu_ihex_firmware_record_new (guint ln, const gchar *line,
-			     FwupdInstallFlags flags, GError **error)
+static gboolean
+fu_ihex_firmware_tokenize_line (FuIhexFirmware *self,
+				FuIhexFirmwareToken *tok,
+				const gchar *line,
+				FwupdInstallFlags flags,
+				GError **error)
 {
-	g_autoptr(FuIhexFirmwareRecord) rcd = NULL;
-	guint line_end;
+	guint8 hdr[4] = { 0x0 };
+	guint8 checksum = 0;
+	guint8 checksum_tmp = 0;
+	gsize line_end;
 
 	/* check starting token */
 	if (line[0] != ':') {
 		g_autoptr(GString) str = g_string_new (NULL);
-		for (gsize i = 0; line[i] != '\0' && i < 5; i++) {
+		for (gsize i = 0; i < tok->line_len && i < 5; i++) {
 			if (!g_ascii_isprint (line[i]))
 				break;
 			g_string_append_c (str, line[i]);
@@ -81,68 +123,71 @@ fu_ihex_firmware_record_new (guint ln, const gchar *line,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "invalid starting token: %s",
 				     str->str);
-			return NULL;
+			return FALSE;
 		}
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "invalid starting token");
-		return NULL;
+		return FALSE;
 	}
 
-	/* length, 16-bit address, type */
-	rcd = g_new0 (FuIhexFirmwareRecord, 1);
-	rcd->ln = ln;
-	rcd->data = g_byte_array_new ();
-	rcd->buf = g_string_new (line);
-	rcd->byte_cnt = fu_firmware_strparse_uint8 (line + 1);
-	rcd->addr = fu_firmware_strparse_uint16 (line + 3);
-	rcd->record_type = fu_firmware_strparse_uint8 (line + 7);
-
 	/* check there's enough data for the smallest possible record */
-	if (rcd->buf->len < 11) {
+	if (tok->line_len < 11) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
 			     "line incomplete, length: %u",
-			     (guint) rcd->buf->len);
-		return NULL;
+			     (guint) tok->line_len);
+		return FALSE;
 	}
 
+	/* length, 16-bit address, type */
+	if (!fu_firmware_strparse_hex (line + 1, 8, hdr, sizeof(hdr), error))
+		return FALSE;
+	tok->byte_cnt = hdr[0];
+	tok->addr = ((guint16) hdr[1] << 8) | hdr[2];
+	tok->record_type = hdr[3];
+
 	/* position of checksum */
-	line_end = 9 + rcd->byte_cnt * 2;
-	if (line_end > (guint) rcd->buf->len) {
+	line_end = 9 + (gsize) tok->byte_cnt * 2;
+	if (line_end + 2 > tok->line_len) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
 			     "line malformed, length: %u",
-			     line_end);
-		return NULL;
+			     (guint) line_end);
+		return FALSE;
 	}
 
+	/* decode straight into the shared payload buffer */
+	tok->data_offset = self->payload->len;
+	g_byte_array_set_size (self->payload, self->payload->len + tok->byte_cnt);
+	if (!fu_firmware_strparse_hex (line + 9, line_end - 9,
+				       self->payload->data + tok->data_offset,
+				       tok->byte_cnt, error))
+		return FALSE;
+
 	/* verify checksum */
 	if ((flags & FWUPD_INSTALL_FLAG_IGNORE_CHECKSUM) == 0) {
-		guint8 checksum = 0;
-		for (guint i = 1; i < line_end + 2; i += 2) {
-			guint8 data_tmp = fu_firmware_strparse_uint8 (line + i);
-			checksum += data_tmp;
-		}
+		if (!fu_firmware_strparse_hex (line + line_end, 2,
+					       &checksum_tmp, 1, error))
+			return FALSE;
+		checksum = checksum_tmp;
+		for (guint i = 0; i < sizeof(hdr); i++)
+			checksum += hdr[i];
+		for (guint i = 0; i < tok->byte_cnt; i++)
+			checksum += self->payload->data[tok->data_offset + i];
 		if (checksum != 0)  {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
 				     "invalid checksum (0x%02x)",
 				     checksum);
-			return NULL;
+			return FALSE;
 		}
 	}
-
-	/* add data */
-	for (guint i = 9; i < line_end; i += 2) {
-		guint8 tmp_c = fu_firmware_strparse_uint8 (line + i);
-		fu_byte_array_append_uint8 (rcd->data, tmp_c);
-	}
-	return g_steal_pointer (&rcd);
+	return TRUE;
 }
 
 static const gchar *
@@ -172,21 +217,45 @@ fu_ihex_firmware_tokenize (FuFirmware *firmware, GBytes *fw,
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE (firmware);
 	gsize sz = 0;
 	const gchar *data = g_bytes_get_data (fw, &sz);
-	g_auto(GStrv) lines = fu_common_strnsplit (data, sz, "\n", -1);
-
-	for (guint ln = 0; lines[ln] != NULL; ln++) {
-		g_autoptr(FuIhexFirmwareRecord) rcd = NULL;
-		g_strdelimit (lines[ln], "\r\x1a", '\0');
-		if (g_str_has_prefix (lines[ln], ";"))
-			continue;
-		if (lines[ln][0] == '\0')
+	const gchar *nul;
+	gsize offset = 0;
+
+	/* text stops at the first NUL */
+	nul = memchr (data, '\0', sz);
+	if (nul != NULL)
+		sz = nul - data;
+
+	/* reset, and preallocate as the data is never more than half the text */
+	g_clear_pointer (&self->records, g_ptr_array_unref);
+	g_clear_pointer (&self->fw, g_bytes_unref);
+	g_array_set_size (self->tokens, 0);
+	g_byte_array_set_size (self->payload, sz / 2);
+	g_byte_array_set_size (self->payload, 0);
+	self->fw = g_bytes_ref (fw);
+
+	/* walk the lines in place */
+	for (guint ln = 1; offset < sz; ln++) {
+		FuIhexFirmwareToken tok = { .ln = ln, .line_offset = offset };
+		const gchar *line = data + offset;
+		const gchar *eol = memchr (line, '\n', sz - offset);
+		gsize linesz = eol != NULL ? (gsize) (eol - line) : sz - offset;
+
+		/* trailing CR and SUB characters */
+		offset += linesz + 1;
+		for (gsize i = 0; i < linesz; i++) {
+			if (line[i] == '\r' || line[i] == '\x1a') {
+				linesz = i;
+				break;
+			}
+		}
+		if (linesz == 0 || line[0] == ';')
 			continue;
-		rcd = fu_ihex_firmware_record_new (ln + 1, lines[ln], flags, error);
-		if (rcd == NULL) {
-			g_prefix_error (error, "invalid line %u: ", ln + 1);
+		tok.line_len = linesz;
+		if (!fu_ihex_firmware_tokenize_line (self, &tok, line, flags, error)) {
+			g_prefix_error (error, "invalid line %u: ", ln);
 			return FALSE;
 		}
-		g_ptr_array_add (self->records, g_steal_pointer (&rcd));
+		g_array_append_val (self->tokens, tok);
 	}
 	return TRUE;
 }
@@ -207,17 +276,18 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 	guint32 seg_addr = 0x0;
 	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (NULL);
 	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) buf = g_byte_array_new ();
+	g_autoptr(GByteArray) buf = g_byte_array_sized_new (self->payload->len);
 
 	/* parse records */
-	for (guint k = 0; k < self->records->len; k++) {
-		FuIhexFirmwareRecord *rcd = g_ptr_array_index (self->records, k);
+	for (guint k = 0; k < self->tokens->len; k++) {
+		FuIhexFirmwareToken *rcd = &g_array_index (self->tokens, FuIhexFirmwareToken, k);
+		const guint8 *rcd_data = self->payload->data + rcd->data_offset;
 		guint16 addr16 = 0;
 		guint32 addr = rcd->addr + seg_addr + abs_addr;
 		guint32 len_hole;
 
 		g_debug ("%s:", fu_ihex_firmware_record_type_to_string (rcd->record_type));
-		g_debug ("  length:\t0x%02x", rcd->data->len);
+		g_debug ("  length:\t0x%02x", rcd->byte_cnt);
 		g_debug ("  addr:\t0x%08x", addr);
 
 		/* process different record types */
@@ -253,16 +323,14 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 			if (addr_last > 0x0 && len_hole > 1) {
 				g_debug ("filling address 0x%08x to 0x%08x on line %u",
 					 addr_last + 1, addr_last + len_hole - 1, rcd->ln);
-				for (guint j = 1; j < len_hole; j++) {
-					/* although 0xff might be clearer,
-					 * we can't write 0xffff to pic14 */
-					fu_byte_array_append_uint8 (buf, 0x00);
-				}
+				/* although 0xff might be clearer,
+				 * we can't write 0xffff to pic14 */
+				fu_byte_array_set_size (buf, buf->len + len_hole - 1);
 			}
-			addr_last = addr + rcd->data->len - 1;
+			addr_last = addr + rcd->byte_cnt - 1;
 
 			/* write into buf */
-			g_byte_array_append (buf, rcd->data->data, rcd->data->len);
+			g_byte_array_append (buf, rcd_data, rcd->byte_cnt);
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_EOF:
 			if (got_eof) {
@@ -276,20 +344,20 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 			got_eof = TRUE;
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_LINEAR:
-			if (!fu_common_read_uint16_safe (rcd->data->data, rcd->data->len,
+			if (!fu_common_read_uint16_safe (rcd_data, rcd->byte_cnt,
 							 0x0, &addr16, G_BIG_ENDIAN, error))
 				return FALSE;
 			abs_addr = (guint32) addr16 << 16;
 			g_debug ("  abs_addr:\t0x%02x on line %u", abs_addr, rcd->ln);
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_START_LINEAR:
-			if (!fu_common_read_uint32_safe (rcd->data->data, rcd->data->len,
+			if (!fu_common_read_uint32_safe (rcd_data, rcd->byte_cnt,
 							 0x0, &abs_addr, G_BIG_ENDIAN, error))
 				return FALSE;
 			g_debug ("  abs_addr:\t0x%08x on line %u", abs_addr, rcd->ln);
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_EXTENDED_SEGMENT:
-			if (!fu_common_read_uint16_safe (rcd->data->data, rcd->data->len,
+			if (!fu_common_read_uint16_safe (rcd_data, rcd->byte_cnt,
 							 0x0, &addr16, G_BIG_ENDIAN, error))
 				return FALSE;
 			/* segment base address, so ~1Mb addressable */
@@ -298,14 +366,14 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_START_SEGMENT:
 			/* initial content of the CS:IP registers */
-			if (!fu_common_read_uint32_safe (rcd->data->data, rcd->data->len,
+			if (!fu_common_read_uint32_safe (rcd_data, rcd->byte_cnt,
 							 0x0, &seg_addr, G_BIG_ENDIAN, error))
 				return FALSE;
 			g_debug ("  seg_addr:\t0x%02x on line %u", seg_addr, rcd->ln);
 			break;
 		case FU_IHEX_FIRMWARE_RECORD_TYPE_SIGNATURE:
-			if (rcd->data->len > 0) {
-				g_autoptr(GBytes) data_sig = g_bytes_new (rcd->data->data, rcd->data->len);
+			if (rcd->byte_cnt > 0) {
+				g_autoptr(GBytes) data_sig = g_bytes_new (rcd_data, rcd->byte_cnt);
 				g_autoptr(FuFirmwareImage) img_sig = fu_firmware_image_new (data_sig);
 				fu_firmware_image_set_id (img_sig, FU_FIRMWARE_IMAGE_ID_SIGNATURE);
 				fu_firmware_add_image (firmware, img_sig);
@@ -334,7 +402,7 @@ fu_ihex_firmware_parse (FuFirmware *firmware,
 	}
 
 	/* add single image */
-	img_bytes = g_bytes_new (buf->data, buf->len);
+	img_bytes = g_byte_array_free_to_bytes (g_steal_pointer (&buf));
 	fu_firmware_image_set_bytes (img, img_bytes);
 	if (img_addr != G_MAXUINT32)
 		fu_firmware_image_set_addr (img, img_addr);
@@ -349,20 +417,22 @@ fu_ihex_firmware_emit_chunk (GString *str,
 			     const guint8 *data,
 			     gsize sz)
 {
+	guint8 buf[5 + 0xff] = { 0x0 };
 	guint8 checksum = 0x00;
-	g_string_append_printf (str, ":%02X%04X%02X",
-				(guint) sz,
-				(guint) address,
-				(guint) record_type);
-	for (gsize j = 0; j < sz; j++)
-		g_string_append_printf (str, "%02X", data[j]);
-	checksum = (guint8) sz;
-	checksum += (guint8) ((address & 0xff00) >> 8);
-	checksum += (guint8) (address & 0xff);
-	checksum += record_type;
-	for (gsize j = 0; j < sz; j++)
-		checksum += data[j];
-	g_string_append_printf (str, "%02X\n", (guint) (((~checksum) + 0x01) & 0xff));
+
+	/* build the whole record in binary and then encode it in one go */
+	g_return_if_fail (sz <= 0xff);
+	buf[0] = (guint8) sz;
+	fu_common_write_uint16 (buf + 1, address, G_BIG_ENDIAN);
+	buf[3] = record_type;
+	if (sz > 0)
+		memcpy (buf + 4, data, sz);
+	for (gsize j = 0; j < sz + 4; j++)
+		checksum += buf[j];
+	buf[sz + 4] = (guint8) ((~checksum) + 0x01);
+	g_string_append_c (str, ':');
+	fu_firmware_strappend_hex (str, buf, sz + 5);
+	g_string_append_c (str, '\n');
 }
 
 static gboolean
@@ -432,14 +502,20 @@ static void
 fu_ihex_firmware_finalize (GObject *object)
 {
 	FuIhexFirmware *self = FU_IHEX_FIRMWARE (object);
-	g_ptr_array_unref (self->records);
+	if (self->fw != NULL)
+		g_bytes_unref (self->fw);
+	if (self->records != NULL)
+		g_ptr_array_unref (self->records);
+	g_array_unref (self->tokens);
+	g_byte_array_unref (self->payload);
 	G_OBJECT_CLASS (fu_ihex_firmware_parent_class)->finalize (object);
 }
 
 static void
 fu_ihex_firmware_init (FuIhexFirmware *self)
 {
-	self->records = g_ptr_array_new_with_free_func ((GFreeFunc) fu_ihex_firmware_record_free);
+	self->tokens = g_array_new (FALSE, FALSE, sizeof(FuIhexFirmwareToken));
+	self->payload = g_byte_array_new ();
 }
 
 static void
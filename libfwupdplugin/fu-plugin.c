@@ -1121,9 +1121,10 @@ fu_plugin_device_write_firmware (FuPlugin *self, FuDevice *device,
 static gboolean
 fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error)
 {
+	FuDeviceClass *klass = FU_DEVICE_GET_CLASS (device);
 	g_autoptr(FuDeviceLocker) locker = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
-	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GPtrArray) segments = NULL;
 	GChecksumType checksum_types[] = {
 		G_CHECKSUM_SHA1,
 		G_CHECKSUM_SHA256,
@@ -1133,6 +1134,29 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 		return FALSE;
 	if (!fu_device_detach (device, error))
 		return FALSE;
+
+	/* hash the flash contents as they are read rather than building an image,
+	 * which is also preferred over ->dump_firmware as the memory use is constant */
+	if (klass->read_firmware == NULL &&
+	    klass->read_region != NULL &&
+	    fu_device_get_firmware_size_max (device) > 0 &&
+	    fu_device_has_flag (device, FWUPD_DEVICE_FLAG_CAN_VERIFY_IMAGE)) {
+		g_autoptr(GPtrArray) checksums = NULL;
+		checksums = fu_device_read_region_checksums (device, 0x0,
+							     fu_device_get_firmware_size_max (device),
+							     error);
+		if (checksums == NULL) {
+			g_autoptr(GError) error_local = NULL;
+			if (!fu_device_attach (device, &error_local))
+				g_debug ("ignoring attach failure: %s", error_local->message);
+			g_prefix_error (error, "failed to read firmware: ");
+			return FALSE;
+		}
+		for (guint i = 0; i < checksums->len; i++)
+			fu_device_add_checksum (device, g_ptr_array_index (checksums, i));
+		return fu_device_attach (device, error);
+	}
+
 	firmware = fu_device_read_firmware (device, error);
 	if (firmware == NULL) {
 		g_autoptr(GError) error_local = NULL;
@@ -1141,8 +1165,8 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 		g_prefix_error (error, "failed to read firmware: ");
 		return FALSE;
 	}
-	fw = fu_firmware_write (firmware, error);
-	if (fw == NULL) {
+	segments = fu_firmware_write_segments (firmware, error);
+	if (segments == NULL) {
 		g_autoptr(GError) error_local = NULL;
 		if (!fu_device_attach (device, &error_local))
 			g_debug ("ignoring attach failure: %s", error_local->message);
@@ -1150,9 +1174,14 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 		return FALSE;
 	}
 	for (guint i = 0; checksum_types[i] != 0; i++) {
-		g_autofree gchar *hash = NULL;
-		hash = g_compute_checksum_for_bytes (checksum_types[i], fw);
-		fu_device_add_checksum (device, hash);
+		g_autoptr(GChecksum) csum = g_checksum_new (checksum_types[i]);
+		for (guint j = 0; j < segments->len; j++) {
+			GBytes *blob = g_ptr_array_index (segments, j);
+			g_checksum_update (csum,
+					   g_bytes_get_data (blob, NULL),
+					   g_bytes_get_size (blob));
+		}
+		fu_device_add_checksum (device, g_checksum_get_string (csum));
 	}
 	return fu_device_attach (device, error);
 }
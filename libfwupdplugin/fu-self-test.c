@@ -14,6 +14,7 @@
 #include <glib/gstdio.h>
 
 #include "fu-device-private.h"
+#include "fu-fmap-firmware.h"
 #include "fu-plugin-private.h"
 #include "fu-security-attrs-private.h"
 #include "fu-smbios-private.h"
@@ -53,6 +54,17 @@ fu_test_loop_quit (void)
 	}
 }
 
+/* returns TRUE if @child references the memory of @parent rather than a copy */
+static gboolean
+fu_test_bytes_is_view (GBytes *parent, GBytes *child)
+{
+	gsize parentsz = 0;
+	gsize childsz = 0;
+	const guint8 *parentbuf = g_bytes_get_data (parent, &parentsz);
+	const guint8 *childbuf = g_bytes_get_data (child, &childsz);
+	return childbuf >= parentbuf && childbuf + childsz <= parentbuf + parentsz;
+}
+
 static void
 fu_archive_invalid_func (void)
 {
@@ -126,6 +138,145 @@ fu_common_byte_array_func (void)
 	g_assert_cmpint (memcmp (array->data, "hello\0\0\0\0\0", array->len), ==, 0);
 }
 
+static void
+fu_common_bytes_patch_func (void)
+{
+	const guint8 buf_delta[] = {
+		'F', 'U', 'D', 'E', 'L', 'T', 'A', '1', 0x12, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00,
+		0x02, 0x06, 0x00, 0x00, 0x00, 'f', 'w', 'u', 'p', 'd', ' ',
+		0x01, 0x06, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+		0x02, 0x01, 0x00, 0x00, 0x00, '!' };
+	const guint8 buf_invalid[] = {
+		'F', 'U', 'D', 'E', 'L', 'T', 'A', '1', 0x12, 0x00, 0x00, 0x00,
+		0x01, 0x08, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00 };
+	const guint8 buf_huge[] = {
+		'F', 'U', 'D', 'E', 'L', 'T', 'A', '1', 0xff, 0xff, 0xff, 0xff,
+		0x02, 0x01, 0x00, 0x00, 0x00, '!' };
+	const guint8 buf_truncated[] = {
+		'F', 'U', 'D', 'E', 'L', 'T', 'A', '1', 0x12, 0x00, 0x00, 0x00,
+		0x02, 0x06, 0x00, 0x00, 0x00, 'f', 'w' };
+	g_autoptr(GBytes) blob = g_bytes_new_static ("hello world", 11);
+	g_autoptr(GBytes) blob_delta = g_bytes_new_static (buf_delta, sizeof(buf_delta));
+	g_autoptr(GBytes) blob_invalid = g_bytes_new_static (buf_invalid, sizeof(buf_invalid));
+	g_autoptr(GBytes) blob_huge = g_bytes_new_static (buf_huge, sizeof(buf_huge));
+	g_autoptr(GBytes) blob_truncated = g_bytes_new_static (buf_truncated, sizeof(buf_truncated));
+	g_autoptr(GBytes) blob_new = NULL;
+	g_autoptr(GError) error = NULL;
+
+	blob_new = fu_common_bytes_patch (blob, blob_delta, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_new);
+	g_assert_cmpint (g_bytes_get_size (blob_new), ==, 18);
+	g_assert_cmpint (memcmp (g_bytes_get_data (blob_new, NULL), "hello fwupd world!", 18), ==, 0);
+
+	/* copy out of range of the source */
+	g_clear_pointer (&blob_new, g_bytes_unref);
+	blob_new = fu_common_bytes_patch (blob, blob_invalid, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_new);
+	g_clear_error (&error);
+
+	/* the size in the header does not match the operations */
+	blob_new = fu_common_bytes_patch (blob, blob_huge, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_new);
+	g_clear_error (&error);
+
+	/* insert past the end of the delta */
+	blob_new = fu_common_bytes_patch (blob, blob_truncated, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_new);
+}
+
+static void
+fu_common_memmem_func (void)
+{
+	const guint8 haystack[] = { '\0', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'B', 'C', 'D' };
+	const gchar *needles[] = { "CD", "BCD", "D", "X", "", "DEF", NULL };
+	gboolean ret;
+	gsize offset = 0;
+	gsize offsets[6] = { 0x0 };
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_memmem_safe (haystack, sizeof(haystack), (const guint8 *) "CDE", 3, &offset, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (offset, ==, 0x3);
+	ret = fu_memmem_safe (haystack, sizeof(haystack), (const guint8 *) "BCD", 3, &offset, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (offset, ==, 0x2);
+	ret = fu_memmem_safe (haystack, sizeof(haystack), (const guint8 *) "DX", 2, &offset, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+	g_clear_error (&error);
+	ret = fu_memmem_safe (haystack, 2, (const guint8 *) "ABC", 3, &offset, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+
+	/* all at once */
+	fu_memmem_multi (haystack, sizeof(haystack), needles, offsets);
+	g_assert_cmpint (offsets[0], ==, 0x3);
+	g_assert_cmpint (offsets[1], ==, 0x2);
+	g_assert_cmpint (offsets[2], ==, 0x4);
+	g_assert_cmpint (offsets[3], ==, G_MAXSIZE);
+	g_assert_cmpint (offsets[4], ==, G_MAXSIZE);
+	g_assert_cmpint (offsets[5], ==, 0x4);
+}
+
+static void
+fu_common_memmem_performance_func (void)
+{
+	const gsize bufsz = 16 * 1024 * 1024;
+	const gchar *needles[] = { "Version ", "Vension:", "Version", "PPID", NULL };
+	gboolean ret;
+	gdouble elapsed;
+	gsize offset = 0;
+	gsize offset_naive = G_MAXSIZE;
+	gsize offsets[4] = { 0x0 };
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autoptr(GTimer) timer = g_timer_new ();
+	g_autoptr(GError) error = NULL;
+
+	/* lowercase text with near misses, and the needles at the very end */
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8) g_random_int_range ('a', 'z');
+	for (gsize i = 0; i < bufsz - 8; i += 0x1000)
+		memcpy (buf + i, "Versio", 6);
+	memcpy (buf + bufsz - 64, "PPID Version 1.2.3", 18);
+
+	/* a compare at each offset */
+	g_timer_reset (timer);
+	for (gsize i = 0; i + 8 <= bufsz; i++) {
+		if (memcmp (buf + i, "Version ", 8) == 0) {
+			offset_naive = i;
+			break;
+		}
+	}
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_print ("memcmp=%.1fMB/s ", bufsz / elapsed / 0x100000);
+
+	/* single pattern */
+	g_timer_reset (timer);
+	ret = fu_memmem_safe (buf, bufsz, (const guint8 *) "Version ", 8, &offset, &error);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (offset, ==, offset_naive);
+	g_print ("memmem=%.1fMB/s ", bufsz / elapsed / 0x100000);
+
+	/* all the optionrom patterns in one pass */
+	g_timer_reset (timer);
+	fu_memmem_multi (buf, bufsz, needles, offsets);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert_cmpint (offset_naive, ==, bufsz - 59);
+	g_assert_cmpint (offsets[0], ==, offset_naive);
+	g_assert_cmpint (offsets[1], ==, G_MAXSIZE);
+	g_assert_cmpint (offsets[3], ==, bufsz - 64);
+	g_print ("multi=%.1fMB/s ", bufsz / elapsed / 0x100000);
+}
+
 static void
 fu_common_crc_func (void)
 {
@@ -276,6 +427,8 @@ fu_smbios3_func (void)
 	gboolean ret;
 	g_autofree gchar *path = NULL;
 	g_autoptr(FuSmbios) smbios = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
 	g_autoptr(GError) error = NULL;
 
 	path = g_build_filename (TESTDATADIR_SRC, "dmi", "tables64", NULL);
@@ -292,6 +445,15 @@ fu_smbios3_func (void)
 	str = fu_smbios_get_string (smbios, FU_SMBIOS_STRUCTURE_TYPE_BIOS, 0x04, &error);
 	g_assert_no_error (error);
 	g_assert_cmpstr (str, ==, "Dell Inc.");
+
+	/* the structure is shared, not copied */
+	blob1 = fu_smbios_get_data (smbios, FU_SMBIOS_STRUCTURE_TYPE_BIOS, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob1);
+	blob2 = fu_smbios_get_data (smbios, FU_SMBIOS_STRUCTURE_TYPE_BIOS, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob2);
+	g_assert (g_bytes_get_data (blob1, NULL) == g_bytes_get_data (blob2, NULL));
 }
 
 static void
@@ -1066,6 +1228,285 @@ fu_device_poll_func (void)
 	g_assert_cmpint (fu_device_get_metadata_integer (device, "cnt"), ==, cnt);
 }
 
+#define FU_TYPE_TEST_CACHE_DEVICE (fu_test_cache_device_get_type ())
+G_DECLARE_FINAL_TYPE (FuTestCacheDevice, fu_test_cache_device, FU, TEST_CACHE_DEVICE, FuDevice)
+
+struct _FuTestCacheDevice {
+	FuDevice		 parent_instance;
+	guint			 prepare_cnt;
+};
+
+G_DEFINE_TYPE (FuTestCacheDevice, fu_test_cache_device, FU_TYPE_DEVICE)
+
+static FuFirmware *
+fu_test_cache_device_prepare_firmware (FuDevice *device,
+				       GBytes *fw,
+				       FwupdInstallFlags flags,
+				       GError **error)
+{
+	FuTestCacheDevice *self = FU_TEST_CACHE_DEVICE (device);
+	self->prepare_cnt++;
+	return fu_firmware_new_from_bytes (fw);
+}
+
+static void
+fu_test_cache_device_init (FuTestCacheDevice *self)
+{
+}
+
+static void
+fu_test_cache_device_class_init (FuTestCacheDeviceClass *klass)
+{
+	FuDeviceClass *klass_device = FU_DEVICE_CLASS (klass);
+	klass_device->prepare_firmware = fu_test_cache_device_prepare_firmware;
+}
+
+static FuTestCacheDevice *
+fu_test_cache_device_new (const gchar *id, GHashTable *firmware_cache)
+{
+	FuTestCacheDevice *self = g_object_new (FU_TYPE_TEST_CACHE_DEVICE, NULL);
+	fu_device_set_id (FU_DEVICE (self), id);
+	fu_device_add_flag (FU_DEVICE (self), FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE);
+	fu_device_set_firmware_cache (FU_DEVICE (self), firmware_cache);
+	return self;
+}
+
+static void
+fu_device_firmware_cache_func (void)
+{
+	g_autoptr(FuTestCacheDevice) device1 = NULL;
+	g_autoptr(FuTestCacheDevice) device2 = NULL;
+	g_autoptr(FuFirmware) firmware1 = NULL;
+	g_autoptr(FuFirmware) firmware2 = NULL;
+	g_autoptr(FuFirmware) firmware3 = NULL;
+	g_autoptr(FuFirmware) firmware4 = NULL;
+	g_autoptr(FuFirmware) firmware5 = NULL;
+	g_autoptr(FuFirmware) firmware6 = NULL;
+	g_autoptr(GBytes) fw = g_bytes_new_static ("hello", 5);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) firmware_cache = NULL;
+
+	firmware_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+						g_free, (GDestroyNotify) g_object_unref);
+	device1 = fu_test_cache_device_new ("device1", firmware_cache);
+	device2 = fu_test_cache_device_new ("device2", firmware_cache);
+
+	/* parsed once and shared between two identical devices */
+	firmware1 = fu_device_prepare_firmware (FU_DEVICE (device1), fw, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (firmware1);
+	firmware2 = fu_device_prepare_firmware (FU_DEVICE (device2), fw, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (firmware1 == firmware2);
+	g_assert_cmpint (device1->prepare_cnt, ==, 1);
+	g_assert_cmpint (device2->prepare_cnt, ==, 0);
+	g_assert_cmpint (g_hash_table_size (firmware_cache), ==, 1);
+
+	/* different flags are prepared again */
+	firmware3 = fu_device_prepare_firmware (FU_DEVICE (device2), fw, FWUPD_INSTALL_FLAG_FORCE, &error);
+	g_assert_no_error (error);
+	g_assert_true (firmware3 != firmware1);
+	g_assert_cmpint (device2->prepare_cnt, ==, 1);
+
+	/* and a different mode */
+	fu_device_add_flag (FU_DEVICE (device1), FWUPD_DEVICE_FLAG_IS_BOOTLOADER);
+	firmware4 = fu_device_prepare_firmware (FU_DEVICE (device1), fw, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (firmware4 != firmware1);
+	g_assert_cmpint (device1->prepare_cnt, ==, 2);
+
+	/* not opted in */
+	fu_device_remove_flag (FU_DEVICE (device2), FWUPD_DEVICE_FLAG_CACHE_PREPARED_FIRMWARE);
+	firmware5 = fu_device_prepare_firmware (FU_DEVICE (device2), fw, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (firmware5 != firmware1);
+	g_assert_cmpint (device2->prepare_cnt, ==, 2);
+
+	/* the engine clears the cache when the batch is complete */
+	g_hash_table_remove_all (firmware_cache);
+	firmware6 = fu_device_prepare_firmware (FU_DEVICE (device1), fw, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (firmware6 != firmware4);
+	g_assert_cmpint (device1->prepare_cnt, ==, 3);
+}
+
+#define FU_TYPE_TEST_REGION_DEVICE (fu_test_region_device_get_type ())
+G_DECLARE_FINAL_TYPE (FuTestRegionDevice, fu_test_region_device, FU, TEST_REGION_DEVICE, FuDevice)
+
+struct _FuTestRegionDevice {
+	FuDevice		 parent_instance;
+	guint8			 flash[0x40];
+	guint			 checksum_data_cnt;
+	guint			 read_region_cnt;
+};
+
+G_DEFINE_TYPE (FuTestRegionDevice, fu_test_region_device, FU_TYPE_DEVICE)
+
+static gboolean
+fu_test_region_device_read_region (FuDevice *device,
+				   guint32 address,
+				   guint8 *buf,
+				   gsize bufsz,
+				   GError **error)
+{
+	FuTestRegionDevice *self = FU_TEST_REGION_DEVICE (device);
+	self->read_region_cnt++;
+	return fu_memcpy_safe (buf, bufsz, 0x0,
+			       self->flash, sizeof(self->flash), address,
+			       bufsz, error);
+}
+
+/* deliberately weak, so that reordered bytes have the same checksum */
+static gchar *
+fu_test_region_device_checksum_region (FuDevice *device,
+				       guint32 address,
+				       gsize bufsz,
+				       GError **error)
+{
+	FuTestRegionDevice *self = FU_TEST_REGION_DEVICE (device);
+	guint32 csum = 0;
+	for (gsize i = 0; i < bufsz; i++)
+		csum += self->flash[address + i];
+	return g_strdup_printf ("%08x", csum);
+}
+
+static gchar *
+fu_test_region_device_checksum_data (FuDevice *device, const guint8 *buf, gsize bufsz)
+{
+	FuTestRegionDevice *self = FU_TEST_REGION_DEVICE (device);
+	guint32 csum = 0;
+	for (gsize i = 0; i < bufsz; i++)
+		csum += buf[i];
+	self->checksum_data_cnt++;
+	return g_strdup_printf ("%08x", csum);
+}
+
+static void
+fu_test_region_device_init (FuTestRegionDevice *self)
+{
+}
+
+static void
+fu_test_region_device_class_init (FuTestRegionDeviceClass *klass)
+{
+	FuDeviceClass *klass_device = FU_DEVICE_CLASS (klass);
+	klass_device->read_region = fu_test_region_device_read_region;
+	klass_device->checksum_region = fu_test_region_device_checksum_region;
+	klass_device->checksum_data = fu_test_region_device_checksum_data;
+}
+
+static void
+fu_device_changed_chunks_func (void)
+{
+	guint8 buf[0x40] = { 0x0 };
+	g_autoptr(FuTestRegionDevice) device = g_object_new (FU_TYPE_TEST_REGION_DEVICE, NULL);
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GPtrArray) chunks_changed = NULL;
+	g_autoptr(GError) error = NULL;
+
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = device->flash[i] = i;
+
+	/* swap two bytes in the second block, and change the fourth */
+	buf[0x10] = 0x11;
+	buf[0x11] = 0x10;
+	buf[0x30] = 0xff;
+	chunks = fu_chunk_array_new (buf, sizeof(buf), 0x0, 0x0, 0x10);
+	chunks_changed = fu_device_get_changed_chunks (FU_DEVICE (device), chunks,
+						       FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (chunks_changed);
+	g_assert_cmpint (chunks_changed->len, ==, 2);
+	g_assert_cmpint (((FuChunk *) g_ptr_array_index (chunks_changed, 0))->address, ==, 0x10);
+	g_assert_cmpint (((FuChunk *) g_ptr_array_index (chunks_changed, 1))->address, ==, 0x30);
+
+	/* the fourth block had a different checksum so was never read back */
+	g_assert_cmpint (device->checksum_data_cnt, ==, 4);
+	g_assert_cmpint (device->read_region_cnt, ==, 3);
+}
+
+#define FU_TYPE_TEST_DUMP_DEVICE (fu_test_dump_device_get_type ())
+G_DECLARE_FINAL_TYPE (FuTestDumpDevice, fu_test_dump_device, FU, TEST_DUMP_DEVICE, FuDevice)
+
+struct _FuTestDumpDevice {
+	FuDevice		 parent_instance;
+	guint			 dump_cnt;
+	guint			 read_cnt;
+};
+
+G_DEFINE_TYPE (FuTestDumpDevice, fu_test_dump_device, FU_TYPE_DEVICE)
+
+static GBytes *
+fu_test_dump_device_dump_firmware (FuDevice *device, GError **error)
+{
+	FuTestDumpDevice *self = FU_TEST_DUMP_DEVICE (device);
+	self->dump_cnt++;
+	return g_bytes_new_static ("hello", 5);
+}
+
+static gboolean
+fu_test_dump_device_read_region (FuDevice *device,
+				 guint32 address,
+				 guint8 *buf,
+				 gsize bufsz,
+				 GError **error)
+{
+	FuTestDumpDevice *self = FU_TEST_DUMP_DEVICE (device);
+	self->read_cnt++;
+	memset (buf, 0xff, bufsz);
+	return TRUE;
+}
+
+static void
+fu_test_dump_device_init (FuTestDumpDevice *self)
+{
+	fu_device_set_firmware_size_max (FU_DEVICE (self), 5);
+}
+
+static void
+fu_test_dump_device_class_init (FuTestDumpDeviceClass *klass)
+{
+	FuDeviceClass *klass_device = FU_DEVICE_CLASS (klass);
+	klass_device->dump_firmware = fu_test_dump_device_dump_firmware;
+	klass_device->read_region = fu_test_dump_device_read_region;
+}
+
+static void
+fu_device_dump_firmware_stream_func (void)
+{
+	gboolean ret;
+	g_autofree gchar *csum_region = NULL;
+	g_autoptr(FuTestDumpDevice) device_dump = g_object_new (FU_TYPE_TEST_DUMP_DEVICE, NULL);
+	g_autoptr(FuTestRegionDevice) device_region = g_object_new (FU_TYPE_TEST_REGION_DEVICE, NULL);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GChecksum) checksum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOutputStream) ostream1 = g_memory_output_stream_new_resizable ();
+	g_autoptr(GOutputStream) ostream2 = g_memory_output_stream_new_resizable ();
+
+	/* the subclass may need to detach first, so ->dump_firmware is preferred */
+	ret = fu_device_dump_firmware_to_stream (FU_DEVICE (device_dump), ostream1, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (device_dump->dump_cnt, ==, 1);
+	g_assert_cmpint (device_dump->read_cnt, ==, 0);
+	g_assert_true (g_output_stream_close (ostream1, NULL, NULL));
+	blob = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream1));
+	g_assert_cmpint (g_bytes_get_size (blob), ==, 5);
+
+	/* otherwise read in blocks */
+	for (guint i = 0; i < sizeof(device_region->flash); i++)
+		device_region->flash[i] = i;
+	fu_device_set_firmware_size_max (FU_DEVICE (device_region), sizeof(device_region->flash));
+	ret = fu_device_dump_firmware_to_stream (FU_DEVICE (device_region), ostream2, checksum, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	csum_region = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+						   device_region->flash,
+						   sizeof(device_region->flash));
+	g_assert_cmpstr (g_checksum_get_string (checksum), ==, csum_region);
+}
+
 static void
 fu_device_func (void)
 {
@@ -1181,6 +1622,12 @@ fu_chunk_func (void)
 	g_autoptr(GPtrArray) chunked2 = NULL;
 	g_autoptr(GPtrArray) chunked3 = NULL;
 	g_autoptr(GPtrArray) chunked4 = NULL;
+	g_autoptr(GPtrArray) chunked5 = NULL;
+	g_autoptr(GPtrArray) segments = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	g_autofree gchar *chunked5_str = NULL;
+	g_autoptr(GString) chunked6_str = g_string_new (NULL);
+	FuChunkIter iter;
+	FuChunk chk;
 
 	chunked3 = fu_chunk_array_new ((const guint8 *) "123456", 6, 0x0, 3, 3);
 	chunked3_str = fu_chunk_array_to_string (chunked3);
@@ -1212,6 +1659,27 @@ fu_chunk_func (void)
 					   "#03: page:01 addr:0004 len:02 YY\n"
 					   "#04: page:02 addr:0000 len:04 ZZZZ\n"
 					   "#05: page:02 addr:0004 len:02 ZZ\n");
+
+	/* same layout as a linear blob, even across segment boundaries */
+	g_ptr_array_add (segments, g_bytes_new_static ("012", 3));
+	g_ptr_array_add (segments, g_bytes_new_static ("", 0));
+	g_ptr_array_add (segments, g_bytes_new_static ("3456789ab", 9));
+	g_ptr_array_add (segments, g_bytes_new_static ("cdef", 4));
+	chunked5 = fu_chunk_array_new_from_segments (segments, 0x0, 10, 4);
+	chunked5_str = fu_chunk_array_to_string (chunked5);
+	g_assert_cmpstr (chunked5_str, ==, chunked1_str);
+	g_assert (((FuChunk *) g_ptr_array_index (chunked5, 1))->data ==
+		  (const guint8 *) g_bytes_get_data (g_ptr_array_index (segments, 2), NULL) + 1);
+
+	/* same layout without allocating each chunk */
+	fu_chunk_iter_init (&iter, (const guint8 *) "0123456789abcdef", 16, 0x0, 10, 4);
+	g_assert_cmpint (fu_chunk_iter_get_n_chunks (&iter), ==, 5);
+	while (fu_chunk_iter_next (&iter, &chk)) {
+		g_autofree gchar *tmp = fu_chunk_to_string (&chk);
+		g_string_append_printf (chunked6_str, "%s\n", tmp);
+	}
+	g_assert_cmpstr (chunked6_str->str, ==, chunked1_str);
+	g_assert_false (fu_chunk_iter_next (&iter, &chk));
 }
 
 static void
@@ -1596,6 +2064,126 @@ fu_firmware_srec_tokenization_func (void)
 	g_assert_cmpint (rcd->buf->data[0], ==, 0x50);
 }
 
+static void
+fu_firmware_ihex_tokenization_func (void)
+{
+	FuIhexFirmwareRecord *rcd;
+	GPtrArray *records;
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_ihex_firmware_new ();
+	g_autoptr(GBytes) data_ihex = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *buf = "; comment\r\n"
+			   ":0300300002337A1E\r\n"
+			   "\r\n"
+			   ":00000001FF\x1a";
+	data_ihex = g_bytes_new_static (buf, strlen (buf));
+	ret = fu_firmware_tokenize (firmware, data_ihex, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	records = fu_ihex_firmware_get_records (FU_IHEX_FIRMWARE (firmware));
+	g_assert_nonnull (records);
+	g_assert_cmpint (records->len, ==, 2);
+	rcd = g_ptr_array_index (records, 0);
+	g_assert_cmpint (rcd->ln, ==, 2);
+	g_assert_cmpstr (rcd->buf->str, ==, ":0300300002337A1E");
+	g_assert_cmpint (rcd->byte_cnt, ==, 3);
+	g_assert_cmpint (rcd->addr, ==, 0x30);
+	g_assert_cmpint (rcd->record_type, ==, FU_IHEX_FIRMWARE_RECORD_TYPE_DATA);
+	g_assert_cmpint (rcd->data->len, ==, 3);
+	g_assert_cmpint (rcd->data->data[2], ==, 0x7a);
+	rcd = g_ptr_array_index (records, 1);
+	g_assert_cmpint (rcd->ln, ==, 4);
+	g_assert_cmpint (rcd->record_type, ==, FU_IHEX_FIRMWARE_RECORD_TYPE_EOF);
+}
+
+static void
+fu_firmware_strparse_hex_func (void)
+{
+	guint8 buf[4] = { 0x0 };
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_firmware_strparse_hex ("00fF7a", 6, buf, sizeof(buf), &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_assert_cmpint (buf[0], ==, 0x00);
+	g_assert_cmpint (buf[1], ==, 0xff);
+	g_assert_cmpint (buf[2], ==, 0x7a);
+
+	/* invalid digit */
+	ret = fu_firmware_strparse_hex ("0g", 2, buf, sizeof(buf), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+	g_clear_error (&error);
+
+	/* odd length, and too small */
+	ret = fu_firmware_strparse_hex ("000", 3, buf, sizeof(buf), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+	g_clear_error (&error);
+	ret = fu_firmware_strparse_hex ("0000000000", 10, buf, sizeof(buf), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert (!ret);
+}
+
+static void
+fu_firmware_strparse_hex_performance_func (void)
+{
+	const gsize bufsz = 4 * 1024 * 1024;
+	gboolean ret;
+	gdouble elapsed;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autofree guint8 *buf2 = g_malloc (bufsz);
+	g_autoptr(GString) str = g_string_new (NULL);
+	g_autoptr(GString) str2 = g_string_new (NULL);
+	g_autoptr(GTimer) timer = g_timer_new ();
+	g_autoptr(GError) error = NULL;
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8) g_random_int ();
+
+	/* encode, a byte at a time */
+	g_timer_reset (timer);
+	for (gsize i = 0; i < bufsz; i++)
+		g_string_append_printf (str, "%02X", buf[i]);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_print ("encode-printf=%.1fMB/s ", bufsz / elapsed / 0x100000);
+
+	/* encode, in bulk */
+	g_timer_reset (timer);
+	fu_firmware_strappend_hex (str2, buf, bufsz);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_print ("encode=%.1fMB/s ", bufsz / elapsed / 0x100000);
+	g_assert_cmpstr (str->str, ==, str2->str);
+
+	/* decode, a byte at a time */
+	g_timer_reset (timer);
+	for (gsize i = 0; i < bufsz; i++)
+		buf2[i] = fu_firmware_strparse_uint8 (str->str + (i * 2));
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_print ("decode-uint8=%.1fMB/s ", bufsz / elapsed / 0x100000);
+	g_assert (memcmp (buf, buf2, bufsz) == 0);
+
+	/* decode, in bulk */
+	memset (buf2, 0x0, bufsz);
+	g_timer_reset (timer);
+	ret = fu_firmware_strparse_hex (str->str, str->len, buf2, bufsz, &error);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_print ("decode=%.1fMB/s ", bufsz / elapsed / 0x100000);
+	g_assert (memcmp (buf, buf2, bufsz) == 0);
+
+	/* an invalid digit deep inside a vectorized block */
+	str->str[0x1235] = 'x';
+	ret = fu_firmware_strparse_hex (str->str, str->len, buf2, bufsz, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_nonnull (g_strstr_len (error->message, -1, "0x1235"));
+	g_assert (!ret);
+}
+
 static void
 fu_firmware_build_func (void)
 {
@@ -1675,7 +2263,10 @@ fu_firmware_dfu_func (void)
 	g_autoptr(GBytes) data_ref = NULL;
 	g_autoptr(GBytes) data_dfu = NULL;
 	g_autoptr(GBytes) data_bin = NULL;
+	g_autoptr(GBytes) data_joined = NULL;
+	g_autoptr(GBytes) data_written = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) segments = NULL;
 
 	filename_dfu = g_build_filename (TESTDATADIR_SRC, "firmware.dfu", NULL);
 	data_dfu = fu_common_get_contents_bytes (filename_dfu, &error);
@@ -1691,6 +2282,27 @@ fu_firmware_dfu_func (void)
 	g_assert_no_error (error);
 	g_assert_nonnull (data_bin);
 	g_assert_cmpint (g_bytes_get_size (data_bin), ==, 136);
+	g_assert_true (fu_test_bytes_is_view (data_dfu, data_bin));
+
+	/* the payload is written by reference, and only the footer is new */
+	segments = fu_firmware_write_segments (firmware, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (segments);
+	g_assert_cmpint (segments->len, ==, 2);
+	g_assert_true (fu_test_bytes_is_view (data_dfu, g_ptr_array_index (segments, 0)));
+	g_assert_cmpint (g_bytes_get_size (g_ptr_array_index (segments, 1)), ==, 16);
+
+	/* the footer and the chained CRC have to match the original file */
+	data_joined = fu_firmware_segments_join (segments);
+	ret = fu_common_bytes_compare (data_joined, data_dfu, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	data_written = fu_firmware_write (firmware, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data_written);
+	ret = fu_common_bytes_compare (data_written, data_dfu, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
 
 	/* did we match the reference file? */
 	filename_ref = g_build_filename (TESTDATADIR_SRC, "firmware.bin", NULL);
@@ -1702,6 +2314,198 @@ fu_firmware_dfu_func (void)
 	g_assert_true (ret);
 }
 
+static void
+fu_firmware_fmap_stream_func (void)
+{
+	gboolean ret;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuFirmware) firmware = fu_fmap_firmware_new ();
+	g_autoptr(FuFirmware) firmware2 = fu_fmap_firmware_new ();
+	g_autoptr(FuFirmwareImage) img1 = NULL;
+	g_autoptr(FuFirmwareImage) img2 = NULL;
+	g_autoptr(FuFirmwareImage) img_ro = NULL;
+	g_autoptr(FuFirmwareImage) img_short = fu_firmware_image_new (NULL);
+	g_autoptr(GBytes) blob = NULL;
+	g_autoptr(GBytes) blob_ro = NULL;
+	g_autoptr(GBytes) blob_short = NULL;
+	g_autoptr(GBytes) blob1 = g_bytes_new_static ("hello world", 11);
+	g_autoptr(GBytes) blob2 = g_bytes_new_static ("goodbye", 7);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+
+	/* build an image */
+	img1 = fu_firmware_image_new (blob1);
+	fu_firmware_image_set_id (img1, "RO_SECTION");
+	fu_firmware_add_image (firmware, img1);
+	img2 = fu_firmware_image_new (blob2);
+	fu_firmware_image_set_id (img2, "RW_SECTION");
+	fu_firmware_add_image (firmware, img2);
+	blob = fu_firmware_write (firmware, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob);
+
+	/* parse the headers only */
+	stream = g_memory_input_stream_new_from_bytes (blob);
+	ret = fu_firmware_parse_stream (firmware2, stream, FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	str = fu_firmware_to_string (firmware2);
+	g_print ("%s", str);
+	g_assert_nonnull (g_strstr_len (str, -1, "RW_SECTION"));
+
+	/* load the data on demand */
+	img_ro = fu_firmware_get_image_by_id (firmware2, "RO_SECTION", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (img_ro);
+	g_assert_cmpint (fu_firmware_image_get_idx (img_ro), ==, 1);
+	blob_ro = fu_firmware_image_load_bytes (img_ro, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_ro);
+	ret = fu_common_bytes_compare (blob_ro, blob1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* data that cannot be loaded is an error rather than a warning */
+	fu_firmware_image_set_stream (img_short, stream, 0x0, g_bytes_get_size (blob) + 1);
+	blob_short = fu_firmware_image_get_bytes (img_short);
+	g_assert_null (blob_short);
+	blob_short = fu_firmware_image_load_bytes (img_short, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_short);
+}
+
+static void
+fu_firmware_index_func (void)
+{
+	gboolean ret;
+	g_autoptr(FuFirmware) firmware = fu_firmware_new ();
+	g_autoptr(FuFirmware) firmware2 = fu_firmware_new ();
+	g_autoptr(FuFirmwareImage) img_addr = NULL;
+	g_autoptr(FuFirmwareImage) img_empty = fu_firmware_image_new (NULL);
+	g_autoptr(FuFirmwareImage) img_no_id = fu_firmware_image_new (NULL);
+	g_autoptr(FuFirmwareImage) img_id = NULL;
+	g_autoptr(FuFirmwareImage) img_idx = NULL;
+	g_autoptr(FuFirmwareImage) img_overlap = NULL;
+	g_autoptr(GBytes) blob = g_bytes_new_static ("0123456789abcdef", 16);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_bytes (blob);
+
+	/* enough images for the lookups to be indexed */
+	for (guint i = 0; i < 64; i++) {
+		g_autofree gchar *id = g_strdup_printf ("img%02u", i);
+		g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (blob);
+		fu_firmware_image_set_id (img, id);
+		fu_firmware_image_set_idx (img, i * 2);
+		fu_firmware_image_set_addr (img, 0x1000 + i * 0x20);
+		fu_firmware_add_image (firmware, img);
+	}
+
+	/* ID and index */
+	img_id = fu_firmware_get_image_by_id (firmware, "img42", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (img_id);
+	g_assert_cmpint (fu_firmware_image_get_idx (img_id), ==, 84);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 84, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_id);
+	g_clear_object (&img_idx);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 85, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (img_idx);
+	g_clear_error (&error);
+
+	/* address ranges, with a gap between each image */
+	img_addr = fu_firmware_get_image_by_addr (firmware, 0x1000 + 42 * 0x20 + 0xf, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_addr == img_id);
+	g_clear_object (&img_addr);
+	img_addr = fu_firmware_get_image_by_addr (firmware, 0x1000 + 42 * 0x20 + 0x10, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (img_addr);
+	g_clear_error (&error);
+	img_addr = fu_firmware_get_image_by_addr (firmware, 0x0, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (img_addr);
+	g_clear_error (&error);
+
+	/* a large image added later overlaps the others, without being loaded */
+	img_overlap = fu_firmware_image_new (NULL);
+	fu_firmware_image_set_id (img_overlap, "overlap");
+	fu_firmware_image_set_idx (img_overlap, 84);
+	fu_firmware_image_set_addr (img_overlap, 0x800);
+	fu_firmware_image_set_stream (img_overlap, stream, 0x0, 0x4000);
+	fu_firmware_add_image (firmware, img_overlap);
+	img_addr = fu_firmware_get_image_by_addr (firmware, 0x1000 + 42 * 0x20 + 0x10, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_addr == img_overlap);
+	g_clear_object (&img_addr);
+	img_addr = fu_firmware_get_image_by_addr (firmware, 0x1000 + 42 * 0x20, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_addr == img_id);
+	g_clear_object (&img_addr);
+
+	/* the first image wins for duplicate indexes */
+	g_clear_object (&img_idx);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 84, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_id);
+	g_clear_object (&img_idx);
+
+	/* changing an image after it was added */
+	fu_firmware_image_set_id (img_id, "renamed");
+	fu_firmware_image_set_idx (img_id, 85);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 85, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_id);
+	g_clear_object (&img_idx);
+	img_idx = fu_firmware_get_image_by_id (firmware, "renamed", &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_id);
+	g_clear_object (&img_idx);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 84, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (fu_firmware_image_get_id (img_idx), ==, "overlap");
+	g_clear_object (&img_idx);
+
+	/* removing */
+	ret = fu_firmware_remove_image_by_id (firmware, "img01", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 2, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (img_idx);
+	g_clear_error (&error);
+	img_idx = fu_firmware_get_image_by_idx (firmware, 4, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (fu_firmware_image_get_id (img_idx), ==, "img02");
+	g_clear_object (&img_idx);
+
+	/* no ID is not the same as an empty ID, as in the linear search */
+	fu_firmware_image_set_id (img_empty, "");
+	fu_firmware_add_image (firmware, img_empty);
+	img_idx = fu_firmware_get_image_by_id (firmware, NULL, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (img_idx);
+	g_clear_error (&error);
+	fu_firmware_add_image (firmware, img_no_id);
+	img_idx = fu_firmware_get_image_by_id (firmware, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_no_id);
+	g_clear_object (&img_idx);
+	img_idx = fu_firmware_get_image_by_id (firmware, "", &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_empty);
+	g_clear_object (&img_idx);
+
+	/* an image that was also in a firmware that no longer exists */
+	fu_firmware_add_image (firmware2, img_id);
+	g_clear_object (&firmware2);
+	fu_firmware_image_set_id (img_id, "shared");
+	img_idx = fu_firmware_get_image_by_id (firmware, "shared", &error);
+	g_assert_no_error (error);
+	g_assert_true (img_idx == img_id);
+}
+
 static void
 fu_firmware_func (void)
 {
@@ -2102,6 +2906,9 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/chunk", fu_chunk_func);
 	g_test_add_func ("/fwupd/common{byte-array}", fu_common_byte_array_func);
 	g_test_add_func ("/fwupd/common{crc}", fu_common_crc_func);
+	g_test_add_func ("/fwupd/common{memmem}", fu_common_memmem_func);
+	g_test_add_func ("/fwupd/common{memmem-performance}", fu_common_memmem_performance_func);
+	g_test_add_func ("/fwupd/common{bytes-patch}", fu_common_bytes_patch_func);
 	g_test_add_func ("/fwupd/common{string-append-kv}", fu_common_string_append_kv_func);
 	g_test_add_func ("/fwupd/common{version-guess-format}", fu_common_version_guess_format_func);
 	g_test_add_func ("/fwupd/common{version}", fu_common_version_func);
@@ -2131,9 +2938,14 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/firmware{ihex}", fu_firmware_ihex_func);
 	g_test_add_func ("/fwupd/firmware{ihex-offset}", fu_firmware_ihex_offset_func);
 	g_test_add_func ("/fwupd/firmware{ihex-signed}", fu_firmware_ihex_signed_func);
+	g_test_add_func ("/fwupd/firmware{ihex-tokenization}", fu_firmware_ihex_tokenization_func);
+	g_test_add_func ("/fwupd/firmware{strparse-hex}", fu_firmware_strparse_hex_func);
+	g_test_add_func ("/fwupd/firmware{strparse-hex-performance}", fu_firmware_strparse_hex_performance_func);
 	g_test_add_func ("/fwupd/firmware{srec-tokenization}", fu_firmware_srec_tokenization_func);
 	g_test_add_func ("/fwupd/firmware{srec}", fu_firmware_srec_func);
 	g_test_add_func ("/fwupd/firmware{dfu}", fu_firmware_dfu_func);
+	g_test_add_func ("/fwupd/firmware{index}", fu_firmware_index_func);
+	g_test_add_func ("/fwupd/firmware{fmap-stream}", fu_firmware_fmap_stream_func);
 	g_test_add_func ("/fwupd/archive{invalid}", fu_archive_invalid_func);
 	g_test_add_func ("/fwupd/archive{cab}", fu_archive_cab_func);
 	g_test_add_func ("/fwupd/device", fu_device_func);
@@ -2147,6 +2959,9 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/device{metadata}", fu_device_metadata_func);
 	g_test_add_func ("/fwupd/device{open-refcount}", fu_device_open_refcount_func);
 	g_test_add_func ("/fwupd/device{version-format}", fu_device_version_format_func);
+	g_test_add_func ("/fwupd/device{firmware-cache}", fu_device_firmware_cache_func);
+	g_test_add_func ("/fwupd/device{changed-chunks}", fu_device_changed_chunks_func);
+	g_test_add_func ("/fwupd/device{dump-firmware-stream}", fu_device_dump_firmware_stream_func);
 	g_test_add_func ("/fwupd/device{retry-success}", fu_device_retry_success_func);
 	g_test_add_func ("/fwupd/device{retry-failed}", fu_device_retry_failed_func);
 	g_test_add_func ("/fwupd/device{retry-hardware}", fu_device_retry_hardware_func);
@@ -64,7 +64,7 @@ typedef struct __attribute__((packed)) {
 typedef struct {
 	guint8			 type;
 	guint16			 handle;
-	GByteArray		*buf;
+	GBytes			*buf;		/* view into the structure table */
 	GPtrArray		*strings;
 } FuSmbiosItem;
 
@@ -74,9 +74,17 @@ static void
 fu_smbios_convert_dt_value (FuSmbios *self, guint8 type, guint8 offset, guint8 value)
 {
 	FuSmbiosItem *item = g_ptr_array_index (self->items, type);
-	for (guint i = item->buf->len; i < (guint) offset + 1; i++)
-		fu_byte_array_append_uint8 (item->buf, 0x0);
-	item->buf->data[offset] = value;
+	gsize bufsz = 0;
+	const guint8 *buf = g_bytes_get_data (item->buf, &bufsz);
+	GByteArray *tmp = g_byte_array_sized_new (MAX (bufsz, (gsize) offset + 1));
+
+	/* the faked structures are tiny, so just rebuild the blob */
+	g_byte_array_append (tmp, buf, bufsz);
+	for (guint i = (guint) bufsz; i < (guint) offset + 1; i++)
+		fu_byte_array_append_uint8 (tmp, 0x0);
+	tmp->data[offset] = value;
+	g_bytes_unref (item->buf);
+	item->buf = g_byte_array_free_to_bytes (tmp);
 }
 
 static void
@@ -106,7 +114,7 @@ fu_smbios_setup_from_path_dt (FuSmbios *self, const gchar *path, GError **error)
 	for (guint i = 0; i < FU_SMBIOS_STRUCTURE_TYPE_LAST; i++) {
 		FuSmbiosItem *item = g_new0 (FuSmbiosItem, 1);
 		item->type = i;
-		item->buf = g_byte_array_new ();
+		item->buf = g_bytes_new (NULL, 0);
 		item->strings = g_ptr_array_new_with_free_func (g_free);
 		g_ptr_array_add (self->items, item);
 	}
@@ -147,8 +155,11 @@ fu_smbios_setup_from_path_dt (FuSmbios *self, const gchar *path, GError **error)
 }
 
 static gboolean
-fu_smbios_setup_from_data (FuSmbios *self, const guint8 *buf, gsize sz, GError **error)
+fu_smbios_setup_from_data (FuSmbios *self, GBytes *blob, GError **error)
 {
+	gsize sz = 0;
+	const guint8 *buf = g_bytes_get_data (blob, &sz);
+
 	/* go through each structure */
 	for (gsize i = 0; i < sz; i++) {
 		FuSmbiosStructure *str = (FuSmbiosStructure *) &buf[i];
@@ -157,7 +168,7 @@ fu_smbios_setup_from_data (FuSmbios *self, const guint8 *buf, gsize sz, GError *
 		/* invalid */
 		if (str->len == 0x00)
 			break;
-		if (str->len >= sz) {
+		if (i + str->len >= sz) {
 			g_set_error_literal (error,
 					     FWUPD_ERROR,
 					     FWUPD_ERROR_INVALID_FILE,
@@ -169,9 +180,8 @@ fu_smbios_setup_from_data (FuSmbios *self, const guint8 *buf, gsize sz, GError *
 		item = g_new0 (FuSmbiosItem, 1);
 		item->type = str->type;
 		item->handle = GUINT16_FROM_LE (str->handle);
-		item->buf = g_byte_array_sized_new (str->len);
+		item->buf = g_bytes_new_from_bytes (blob, i, str->len);
 		item->strings = g_ptr_array_new_with_free_func (g_free);
-		g_byte_array_append (item->buf, buf + i, str->len);
 		g_ptr_array_add (self->items, item);
 
 		/* jump to the end of the struct */
@@ -211,8 +221,9 @@ gboolean
 fu_smbios_setup_from_file (FuSmbios *self, const gchar *filename, GError **error)
 {
 	gsize sz = 0;
-	g_autofree gchar *buf = NULL;
+	gchar *buf = NULL;
 	g_autofree gchar *basename = NULL;
+	g_autoptr(GBytes) blob = NULL;
 
 	g_return_val_if_fail (FU_IS_SMBIOS (self), FALSE);
 	g_return_val_if_fail (filename != NULL, FALSE);
@@ -225,7 +236,8 @@ fu_smbios_setup_from_file (FuSmbios *self, const gchar *filename, GError **error
 	/* DMI blob */
 	if (!g_file_get_contents (filename, &buf, &sz, error))
 		return FALSE;
-	return fu_smbios_setup_from_data (self, (guint8 *) buf, sz, error);
+	blob = g_bytes_new_take (buf, sz);
+	return fu_smbios_setup_from_data (self, blob, error);
 }
 
 static gboolean
@@ -323,6 +335,7 @@ fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error
 	gsize sz = 0;
 	g_autofree gchar *dmi_fn = NULL;
 	g_autofree gchar *dmi_raw = NULL;
+	g_autoptr(GBytes) dmi_blob = NULL;
 	g_autofree gchar *ep_fn = NULL;
 	g_autofree gchar *ep_raw = NULL;
 
@@ -377,7 +390,8 @@ fu_smbios_setup_from_path_dmi (FuSmbios *self, const gchar *path, GError **error
 	}
 
 	/* parse blob */
-	return fu_smbios_setup_from_data (self, (guint8 *) dmi_raw, sz, error);
+	dmi_blob = g_bytes_new_take (g_steal_pointer (&dmi_raw), sz);
+	return fu_smbios_setup_from_data (self, dmi_blob, error);
 }
 
 /**
@@ -470,7 +484,8 @@ fu_smbios_to_string (FuSmbios *self)
 	for (guint i = 0; i < self->items->len; i++) {
 		FuSmbiosItem *item = g_ptr_array_index (self->items, i);
 		g_string_append_printf (str, "Type: %02x\n", item->type);
-		g_string_append_printf (str, " Length: %u\n", item->buf->len);
+		g_string_append_printf (str, " Length: %" G_GSIZE_FORMAT "\n",
+					g_bytes_get_size (item->buf));
 		g_string_append_printf (str, " Handle: 0x%04x\n", item->handle);
 		for (guint j = 0; j < item->strings->len; j++) {
 			const gchar *tmp = g_ptr_array_index (item->strings, j);
@@ -516,7 +531,7 @@ fu_smbios_get_data (FuSmbios *self, guint8 type, GError **error)
 			     "no structure with type %02x", type);
 		return NULL;
 	}
-	return g_bytes_new (item->buf->data, item->buf->len);
+	return g_bytes_ref (item->buf);
 }
 
 /**
@@ -539,6 +554,8 @@ guint
 fu_smbios_get_integer (FuSmbios *self, guint8 type, guint8 offset, GError **error)
 {
 	FuSmbiosItem *item;
+	gsize bufsz = 0;
+	const guint8 *buf;
 
 	g_return_val_if_fail (FU_IS_SMBIOS (self), 0);
 
@@ -553,17 +570,18 @@ fu_smbios_get_integer (FuSmbios *self, guint8 type, guint8 offset, GError **erro
 	}
 
 	/* check offset valid */
-	if (offset >= item->buf->len) {
+	buf = g_bytes_get_data (item->buf, &bufsz);
+	if (offset >= bufsz) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
 			     "offset bigger than size %u",
-			     item->buf->len);
+			     (guint) bufsz);
 		return G_MAXUINT;
 	}
 
 	/* success */
-	return item->buf->data[offset];
+	return buf[offset];
 }
 
 /**
@@ -586,6 +604,8 @@ const gchar *
 fu_smbios_get_string (FuSmbios *self, guint8 type, guint8 offset, GError **error)
 {
 	FuSmbiosItem *item;
+	gsize bufsz = 0;
+	const guint8 *buf;
 
 	g_return_val_if_fail (FU_IS_SMBIOS (self), NULL);
 
@@ -600,15 +620,16 @@ fu_smbios_get_string (FuSmbios *self, guint8 type, guint8 offset, GError **error
 	}
 
 	/* check offset valid */
-	if (offset >= item->buf->len) {
+	buf = g_bytes_get_data (item->buf, &bufsz);
+	if (offset >= bufsz) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
 			     "offset bigger than size %u",
-			     item->buf->len);
+			     (guint) bufsz);
 		return NULL;
 	}
-	if (item->buf->data[offset] == 0x00) {
+	if (buf[offset] == 0x00) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_FOUND,
@@ -617,7 +638,7 @@ fu_smbios_get_string (FuSmbios *self, guint8 type, guint8 offset, GError **error
 	}
 
 	/* check string index valid */
-	if (item->buf->data[offset] > item->strings->len) {
+	if (buf[offset] > item->strings->len) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
@@ -625,13 +646,13 @@ fu_smbios_get_string (FuSmbios *self, guint8 type, guint8 offset, GError **error
 			     item->strings->len);
 		return NULL;
 	}
-	return g_ptr_array_index (item->strings, item->buf->data[offset] - 1);
+	return g_ptr_array_index (item->strings, buf[offset] - 1);
 }
 
 static void
 fu_smbios_item_free (FuSmbiosItem *item)
 {
-	g_byte_array_unref (item->buf);
+	g_bytes_unref (item->buf);
 	g_ptr_array_unref (item->strings);
 	g_free (item);
 }
@@ -25,11 +25,29 @@
 
 struct _FuSrecFirmware {
 	FuFirmware		 parent_instance;
-	GPtrArray		*records;
+	GArray			*tokens;	/* of FuSrecFirmwareToken */
+	GByteArray		*payload;	/* decoded record data */
+	GPtrArray		*records;	/* (nullable): created on demand */
 };
 
+/* a record that has been validated but not copied into a #GByteArray */
+typedef struct {
+	guint			 ln;
+	FuFirmareSrecRecordKind	 kind;
+	guint32			 addr;
+	guint32			 data_offset;	/* into payload */
+	guint32			 data_len;
+} FuSrecFirmwareToken;
+
 G_DEFINE_TYPE (FuSrecFirmware, fu_srec_firmware, FU_TYPE_FIRMWARE)
 
+static void
+fu_srec_firmware_record_free (FuSrecFirmwareRecord *rcd)
+{
+	g_byte_array_unref (rcd->buf);
+	g_free (rcd);
+}
+
 /**
  * fu_srec_firmware_get_records:
  * @self: A #FuSrecFirmware
@@ -47,14 +65,22 @@ GPtrArray *
 fu_srec_firmware_get_records (FuSrecFirmware *self)
 {
 	g_return_val_if_fail (FU_IS_SREC_FIRMWARE (self), NULL);
-	return self->records;
-}
 
-static void
-fu_srec_firmware_record_free (FuSrecFirmwareRecord *rcd)
-{
-	g_byte_array_unref (rcd->buf);
-	g_free (rcd);
+	/* already created */
+	if (self->records != NULL)
+		return self->records;
+
+	/* the tokenizer does not allocate anything per-line */
+	self->records = g_ptr_array_new_with_free_func ((GFreeFunc) fu_srec_firmware_record_free);
+	for (guint i = 0; i < self->tokens->len; i++) {
+		FuSrecFirmwareToken *tok = &g_array_index (self->tokens, FuSrecFirmwareToken, i);
+		FuSrecFirmwareRecord *rcd = fu_srec_firmware_record_new (tok->ln, tok->kind, tok->addr);
+		g_byte_array_append (rcd->buf,
+				     self->payload->data + tok->data_offset,
+				     tok->data_len);
+		g_ptr_array_add (self->records, rcd);
+	}
+	return self->records;
 }
 
 /**
@@ -81,155 +107,205 @@ fu_srec_firmware_record_new (guint ln, FuFirmareSrecRecordKind kind, guint32 add
 }
 
 static gboolean
-fu_srec_firmware_tokenize (FuFirmware *firmware, GBytes *fw,
-			   FwupdInstallFlags flags, GError **error)
+fu_srec_firmware_tokenize_line (FuSrecFirmware *self,
+				FuSrecFirmwareToken *tok,
+				const gchar *line,
+				gsize linesz,
+				FwupdInstallFlags flags,
+				gboolean *got_eof,
+				GError **error)
 {
-	FuSrecFirmware *self = FU_SREC_FIRMWARE (firmware);
-	const gchar *data;
-	gboolean got_eof = FALSE;
-	gsize sz = 0;
-	g_auto(GStrv) lines = NULL;
+	guint8 addr[4] = { 0x0 };
+	guint8 addrsz = 0;		/* bytes */
+	guint8 rec_count = 0;		/* words */
+	guint8 rec_csum = 0;
+	guint8 rec_csum_expected = 0;
+
+	/* check starting token */
+	if (line[0] != 'S') {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid starting token, got '%c' at line %u",
+			     line[0], tok->ln);
+		return FALSE;
+	}
 
-	/* parse records */
-	data = g_bytes_get_data (fw, &sz);
-	lines = fu_common_strnsplit (data, sz, "\n", -1);
-	for (guint ln = 0; lines[ln] != NULL; ln++) {
-		FuSrecFirmwareRecord *rcd;
-		const gchar *line = lines[ln];
-		gsize linesz;
-		guint32 rec_addr32;
-		guint8 addrsz = 0;		/* bytes */
-		guint8 rec_count;		/* words */
-		guint8 rec_kind;
+	/* check there's enough data for the smallest possible record */
+	if (linesz < 10) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "record incomplete at line %u, length %u",
+			     tok->ln, (guint) linesz);
+		return FALSE;
+	}
 
-		/* ignore blank lines */
-		g_strdelimit (lines[ln], "\r", '\0');
-		linesz = strlen (line);
-		if (linesz == 0)
-			continue;
+	/* kind, count, address, (data), checksum, linefeed */
+	tok->kind = line[1] - '0';
+	if (!fu_firmware_strparse_hex (line + 2, 2, &rec_count, 1, error)) {
+		g_prefix_error (error, "invalid count at line %u: ", tok->ln);
+		return FALSE;
+	}
+	if ((gsize) rec_count * 2 != linesz - 4) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "count incomplete at line %u, "
+			     "length %u, expected %u",
+			     tok->ln, (guint) linesz - 4, (guint) rec_count * 2);
+		return FALSE;
+	}
 
-		/* check starting token */
-		if (line[0] != 'S') {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid starting token, got '%c' at line %u",
-				     line[0], ln + 1);
-			return FALSE;
-		}
+	/* set each command settings */
+	switch (tok->kind) {
+	case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
+		addrsz = 2;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
+		addrsz = 2;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
+		addrsz = 3;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
+		addrsz = 4;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
+		addrsz = 2;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
+		addrsz = 3;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
+		addrsz = 4;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
+		addrsz = 3;
+		*got_eof = TRUE;
+		break;
+	case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
+		addrsz = 2;
+		*got_eof = TRUE;
+		break;
+	default:
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid srec record type S%c at line %u",
+			     line[1], tok->ln);
+		return FALSE;
+	}
+	if (rec_count < addrsz + 1) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "count 0x%02x too small for address at line %u",
+			     rec_count, tok->ln);
+		return FALSE;
+	}
 
-		/* check there's enough data for the smallest possible record */
-		if (linesz < 10) {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "record incomplete at line %u, length %u",
-				     ln + 1, (guint) linesz);
+	/* parse address */
+	if (!fu_firmware_strparse_hex (line + 4, addrsz * 2, addr, sizeof(addr), error)) {
+		g_prefix_error (error, "invalid address at line %u: ", tok->ln);
+		return FALSE;
+	}
+	for (guint8 i = 0; i < addrsz; i++)
+		tok->addr = (tok->addr << 8) | addr[i];
+
+	/* decode straight into the shared payload buffer */
+	tok->data_offset = self->payload->len;
+	tok->data_len = rec_count - addrsz - 1;
+	g_byte_array_set_size (self->payload, self->payload->len + tok->data_len);
+	if (!fu_firmware_strparse_hex (line + 4 + (addrsz * 2), tok->data_len * 2,
+				       self->payload->data + tok->data_offset,
+				       tok->data_len, error)) {
+		g_prefix_error (error, "invalid data at line %u: ", tok->ln);
+		return FALSE;
+	}
+
+	/* checksum check */
+	if ((flags & FWUPD_INSTALL_FLAG_IGNORE_CHECKSUM) == 0) {
+		if (!fu_firmware_strparse_hex (line + (rec_count * 2) + 2, 2,
+					       &rec_csum_expected, 1, error)) {
+			g_prefix_error (error, "invalid checksum at line %u: ", tok->ln);
 			return FALSE;
 		}
-
-		/* kind, count, address, (data), checksum, linefeed */
-		rec_kind = line[1] - '0';
-		rec_count = fu_firmware_strparse_uint8 (line + 2);
-		if (rec_count * 2 != linesz - 4) {
+		rec_csum = rec_count;
+		for (guint8 i = 0; i < addrsz; i++)
+			rec_csum += addr[i];
+		for (guint32 i = 0; i < tok->data_len; i++)
+			rec_csum += self->payload->data[tok->data_offset + i];
+		rec_csum ^= 0xff;
+		if (rec_csum != rec_csum_expected) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_INVALID_FILE,
-				     "count incomplete at line %u, "
-				     "length %u, expected %u",
-				     ln + 1, (guint) linesz - 4, (guint) rec_count * 2);
+				     "checksum incorrect line %u, "
+				     "expected %02x, got %02x",
+				     tok->ln, rec_csum_expected, rec_csum);
 			return FALSE;
 		}
+	}
 
-		/* checksum check */
-		if ((flags & FWUPD_INSTALL_FLAG_IGNORE_CHECKSUM) == 0) {
-			guint8 rec_csum = 0;
-			guint8 rec_csum_expected;
-			for (guint8 i = 0; i < rec_count; i++)
-				rec_csum += fu_firmware_strparse_uint8 (line + (i * 2) + 2);
-			rec_csum ^= 0xff;
-			rec_csum_expected = fu_firmware_strparse_uint8 (line + (rec_count * 2) + 2);
-			if (rec_csum != rec_csum_expected) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "checksum incorrect line %u, "
-					     "expected %02x, got %02x",
-					     ln + 1, rec_csum_expected, rec_csum);
-				return FALSE;
-			}
-		}
+	/* only data records have a payload */
+	if (tok->kind != FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16 &&
+	    tok->kind != FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24 &&
+	    tok->kind != FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32) {
+		g_byte_array_set_size (self->payload, tok->data_offset);
+		tok->data_len = 0;
+	}
 
-		/* set each command settings */
-		switch (rec_kind) {
-		case FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER:
-			addrsz = 2;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S1_DATA_16:
-			addrsz = 2;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S2_DATA_24:
-			addrsz = 3;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S3_DATA_32:
-			addrsz = 4;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S5_COUNT_16:
-			addrsz = 2;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S6_COUNT_24:
-			addrsz = 3;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S7_COUNT_32:
-			addrsz = 4;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S8_TERMINATION_24:
-			addrsz = 3;
-			got_eof = TRUE;
-			break;
-		case FU_FIRMWARE_SREC_RECORD_KIND_S9_TERMINATION_16:
-			addrsz = 2;
-			got_eof = TRUE;
-			break;
-		default:
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INVALID_FILE,
-				     "invalid srec record type S%c at line %u",
-				     line[1], ln + 1);
-			return FALSE;
-		}
+	g_debug ("line %03u S%u addr:0x%04x datalen:0x%02x",
+		 tok->ln, tok->kind, tok->addr,
+		 (guint) rec_count - addrsz - 1);
+	return TRUE;
+}
 
-		/* parse address */
-		switch (addrsz) {
-		case 2:
-			rec_addr32 = fu_firmware_strparse_uint16 (line + 4);
-			break;
-		case 3:
-			rec_addr32 = fu_firmware_strparse_uint24 (line + 4);
-			break;
-		case 4:
-			rec_addr32 = fu_firmware_strparse_uint32 (line + 4);
-			break;
-		default:
-			g_assert_not_reached ();
-		}
+static gboolean
+fu_srec_firmware_tokenize (FuFirmware *firmware, GBytes *fw,
+			   FwupdInstallFlags flags, GError **error)
+{
+	FuSrecFirmware *self = FU_SREC_FIRMWARE (firmware);
+	const gchar *data;
+	const gchar *nul;
+	gboolean got_eof = FALSE;
+	gsize offset = 0;
+	gsize sz = 0;
 
-		g_debug ("line %03u S%u addr:0x%04x datalen:0x%02x",
-			 ln + 1, rec_kind, rec_addr32,
-			 (guint) rec_count - addrsz - 1);
+	/* text stops at the first NUL */
+	data = g_bytes_get_data (fw, &sz);
+	nul = memchr (data, '\0', sz);
+	if (nul != NULL)
+		sz = nul - data;
+
+	/* reset, and preallocate as the data is never more than half the text */
+	g_clear_pointer (&self->records, g_ptr_array_unref);
+	g_array_set_size (self->tokens, 0);
+	g_byte_array_set_size (self->payload, sz / 2);
+	g_byte_array_set_size (self->payload, 0);
+
+	/* parse records in place */
+	for (guint ln = 1; offset < sz; ln++) {
+		FuSrecFirmwareToken tok = { .ln = ln };
+		const gchar *line = data + offset;
+		const gchar *eol = memchr (line, '\n', sz - offset);
+		const gchar *cr;
+		gsize linesz = eol != NULL ? (gsize) (eol - line) : sz - offset;
 
-		/* data */
-		rcd = fu_srec_firmware_record_new (ln + 1, rec_kind, rec_addr32);
-		if (rec_kind == 1 || rec_kind == 2 || rec_kind == 3) {
-			for (guint8 i = 4 + (addrsz * 2); i <= rec_count * 2; i += 2) {
-				guint8 tmp = fu_firmware_strparse_uint8 (line + i);
-				fu_byte_array_append_uint8 (rcd->buf, tmp);
-			}
-		}
-		g_ptr_array_add (self->records, rcd);
+		/* ignore blank lines */
+		offset += linesz + 1;
+		cr = memchr (line, '\r', linesz);
+		if (cr != NULL)
+			linesz = cr - line;
+		if (linesz == 0)
+			continue;
+		if (!fu_srec_firmware_tokenize_line (self, &tok, line, linesz,
+						     flags, &got_eof, error))
+			return FALSE;
+		g_array_append_val (self->tokens, tok);
 	}
 
 	/* no EOF */
@@ -258,11 +334,12 @@ fu_srec_firmware_parse (FuFirmware *firmware,
 	guint32 img_address = 0;
 	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (NULL);
 	g_autoptr(GBytes) img_bytes = NULL;
-	g_autoptr(GByteArray) outbuf = g_byte_array_new ();
+	g_autoptr(GByteArray) outbuf = g_byte_array_sized_new (self->payload->len);
 
 	/* parse records */
-	for (guint j = 0; j < self->records->len; j++) {
-		FuSrecFirmwareRecord *rcd = g_ptr_array_index (self->records, j);
+	for (guint j = 0; j < self->tokens->len; j++) {
+		FuSrecFirmwareToken *rcd = &g_array_index (self->tokens, FuSrecFirmwareToken, j);
+		const guint8 *rcd_data = self->payload->data + rcd->data_offset;
 
 		/* header */
 		if (rcd->kind == FU_FIRMWARE_SREC_RECORD_KIND_S0_HEADER) {
@@ -279,8 +356,8 @@ fu_srec_firmware_parse (FuFirmware *firmware,
 			}
 
 			/* could be anything, lets assume text */
-			for (guint8 i = 0; i < rcd->buf->len; i++) {
-				gchar tmp = rcd->buf->data[i];
+			for (guint8 i = 0; i < rcd->data_len; i++) {
+				gchar tmp = rcd_data[i];
 				if (!g_ascii_isgraph (tmp))
 					break;
 				g_string_append_c (modname, tmp);
@@ -352,17 +429,17 @@ fu_srec_firmware_parse (FuFirmware *firmware,
 				}
 
 				/* add data */
-				g_byte_array_append (outbuf, rcd->buf->data, rcd->buf->len);
+				g_byte_array_append (outbuf, rcd_data, rcd->data_len);
 				if (img_address == 0x0)
 					img_address = rcd->addr;
-				addr32_last = rcd->addr + rcd->buf->len;
+				addr32_last = rcd->addr + rcd->data_len;
 			}
 			data_cnt++;
 		}
 	}
 
 	/* add single image */
-	img_bytes = g_bytes_new (outbuf->data, outbuf->len);
+	img_bytes = g_byte_array_free_to_bytes (g_steal_pointer (&outbuf));
 	fu_firmware_image_set_bytes (img, img_bytes);
 	fu_firmware_image_set_addr (img, img_address);
 	fu_firmware_add_image (firmware, img);
@@ -373,14 +450,18 @@ static void
 fu_srec_firmware_finalize (GObject *object)
 {
 	FuSrecFirmware *self = FU_SREC_FIRMWARE (object);
-	g_ptr_array_unref (self->records);
+	if (self->records != NULL)
+		g_ptr_array_unref (self->records);
+	g_array_unref (self->tokens);
+	g_byte_array_unref (self->payload);
 	G_OBJECT_CLASS (fu_srec_firmware_parent_class)->finalize (object);
 }
 
 static void
 fu_srec_firmware_init (FuSrecFirmware *self)
 {
-	self->records = g_ptr_array_new_with_free_func ((GFreeFunc) fu_srec_firmware_record_free);
+	self->tokens = g_array_new (FALSE, FALSE, sizeof(FuSrecFirmwareToken));
+	self->payload = g_byte_array_new ();
 }
 
 static void
@@ -0,0 +1,273 @@
+#!/usr/bin/python3
+""" Builds a header of struct accessors for the plugins to include """
+
+# pylint: disable=invalid-name,wrong-import-position,pointless-string-statement
+
+"""
+SPDX-License-Identifier: LGPL-2.1+
+
+The input file has one or more struct descriptions, for example:
+
+    /* Bcm57xx NVRAM header */
+    struct Bcm57xxNvramHeader {
+        u32be   magic = 0x669955AA;
+        u32be   phys_addr;
+        u8      reserved[4];
+        char    name[8];
+    };
+
+Supported types are u8, u16le, u16be, u32le, u32be, u64le and u64be, and
+arrays of u8 or char. Integer fields can be given a constant value which is
+checked by fu_struct_NAME_validate().
+
+For each struct a FU_STRUCT_NAME_SIZE define, a FU_STRUCT_NAME_OFFSET_FIELD
+define for each field, and static inline getters and setters are generated.
+The accessors do no bounds checking, so fu_struct_NAME_validate() has to be
+called once before using them on untrusted data.
+"""
+
+import re
+import sys
+
+TYPES = {
+    "u8": ("guint8", 1, None),
+    "u16le": ("guint16", 2, "GUINT16_FROM_LE", "GUINT16_TO_LE"),
+    "u16be": ("guint16", 2, "GUINT16_FROM_BE", "GUINT16_TO_BE"),
+    "u32le": ("guint32", 4, "GUINT32_FROM_LE", "GUINT32_TO_LE"),
+    "u32be": ("guint32", 4, "GUINT32_FROM_BE", "GUINT32_TO_BE"),
+    "u64le": ("guint64", 8, "GUINT64_FROM_LE", "GUINT64_TO_LE"),
+    "u64be": ("guint64", 8, "GUINT64_FROM_BE", "GUINT64_TO_BE"),
+    "char": ("gchar", 1, None),
+}
+
+
+class Field:
+    def __init__(self, kind, name, n_elements, constant, offset):
+        self.kind = kind
+        self.name = name
+        self.n_elements = n_elements
+        self.constant = constant
+        self.offset = offset
+
+    @property
+    def ctype(self):
+        return TYPES[self.kind][0]
+
+    @property
+    def size(self):
+        return TYPES[self.kind][1] * (self.n_elements or 1)
+
+
+class Struct:
+    def __init__(self, name):
+        self.name = name
+        self.fields = []
+        self.size = 0
+
+    @property
+    def prefix(self):
+        return "fu_struct_" + re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", self.name).lower()
+
+    @property
+    def define(self):
+        return self.prefix.upper()
+
+
+def usage(return_code):
+    """ print usage and exit with the supplied return code """
+    if return_code == 0:
+        out = sys.stdout
+    else:
+        out = sys.stderr
+    out.write("usage: fu-struct.py <STRUCT> <HEADER>")
+    sys.exit(return_code)
+
+
+def parse(fn, text):
+    """ parse the struct descriptions """
+    structs = []
+    st = None
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.DOTALL)
+    for lineno, line in enumerate(text.split("\n"), 1):
+        line = line.strip()
+        if not line:
+            continue
+        if st is None:
+            m = re.fullmatch(r"struct\s+([A-Z][A-Za-z0-9]*)\s*{", line)
+            if not m:
+                raise ValueError("{}:{}: expected struct".format(fn, lineno))
+            st = Struct(m.group(1))
+            continue
+        if line == "};":
+            if not st.fields:
+                raise ValueError("{}:{}: {} has no fields".format(fn, lineno, st.name))
+            structs.append(st)
+            st = None
+            continue
+        m = re.fullmatch(
+            r"([a-z0-9]+)\s+([a-z][a-z0-9_]*)(?:\[(\d+)\])?(?:\s*=\s*(\w+))?\s*;", line
+        )
+        if not m or m.group(1) not in TYPES:
+            raise ValueError("{}:{}: invalid field".format(fn, lineno))
+        kind, name, n_elements, constant = m.groups()
+        if n_elements is not None and kind not in ["u8", "char"]:
+            raise ValueError("{}:{}: only u8 and char arrays supported".format(fn, lineno))
+        if n_elements is None and kind == "char":
+            raise ValueError("{}:{}: char has to be an array".format(fn, lineno))
+        if constant is not None and n_elements is not None:
+            raise ValueError("{}:{}: arrays cannot be constant".format(fn, lineno))
+        if name in [f.name for f in st.fields]:
+            raise ValueError("{}:{}: duplicate field {}".format(fn, lineno, name))
+        field = Field(
+            kind,
+            name,
+            int(n_elements) if n_elements else None,
+            int(constant, 0) if constant else None,
+            st.size,
+        )
+        st.fields.append(field)
+        st.size += field.size
+    if st is not None:
+        raise ValueError("{}: {} not terminated".format(fn, st.name))
+    return structs
+
+
+def generate_field(st, f):
+    """ generate the getter and setter for a field """
+    out = []
+    define = "{}_OFFSET_{}".format(st.define, f.name.upper())
+    if f.kind == "char":
+        out.append(
+            "static inline gchar *\n"
+            "{0}_get_{1} (const guint8 *st)\n"
+            "{{\n"
+            "\treturn g_strndup ((const gchar *) st + {2}, {3});\n"
+            "}}\n".format(st.prefix, f.name, define, f.n_elements)
+        )
+        out.append(
+            "static inline void\n"
+            "{0}_set_{1} (guint8 *st, const gchar *value)\n"
+            "{{\n"
+            "\tgsize len = value != NULL ? strnlen (value, {3}) : 0;\n"
+            "\tmemset (st + {2}, 0x0, {3});\n"
+            "\tif (len > 0)\n"
+            "\t\tmemcpy (st + {2}, value, len);\n"
+            "}}\n".format(st.prefix, f.name, define, f.n_elements)
+        )
+    elif f.n_elements is not None:
+        out.append(
+            "static inline const guint8 *\n"
+            "{0}_get_{1} (const guint8 *st)\n"
+            "{{\n"
+            "\treturn st + {2};\n"
+            "}}\n".format(st.prefix, f.name, define)
+        )
+        out.append(
+            "static inline void\n"
+            "{0}_set_{1} (guint8 *st, const guint8 *value)\n"
+            "{{\n"
+            "\tmemcpy (st + {2}, value, {3});\n"
+            "}}\n".format(st.prefix, f.name, define, f.n_elements)
+        )
+    elif f.kind == "u8":
+        out.append(
+            "static inline guint8\n"
+            "{0}_get_{1} (const guint8 *st)\n"
+            "{{\n"
+            "\treturn st[{2}];\n"
+            "}}\n".format(st.prefix, f.name, define)
+        )
+        out.append(
+            "static inline void\n"
+            "{0}_set_{1} (guint8 *st, guint8 value)\n"
+            "{{\n"
+            "\tst[{2}] = value;\n"
+            "}}\n".format(st.prefix, f.name, define)
+        )
+    else:
+        _, _, from_endian, to_endian = TYPES[f.kind]
+        out.append(
+            "static inline {3}\n"
+            "{0}_get_{1} (const guint8 *st)\n"
+            "{{\n"
+            "\t{3} tmp;\n"
+            "\tmemcpy (&tmp, st + {2}, sizeof(tmp));\n"
+            "\treturn {4} (tmp);\n"
+            "}}\n".format(st.prefix, f.name, define, f.ctype, from_endian)
+        )
+        out.append(
+            "static inline void\n"
+            "{0}_set_{1} (guint8 *st, {3} value)\n"
+            "{{\n"
+            "\t{3} tmp = {4} (value);\n"
+            "\tmemcpy (st + {2}, &tmp, sizeof(tmp));\n"
+            "}}\n".format(st.prefix, f.name, define, f.ctype, to_endian)
+        )
+    return out
+
+
+def generate_validate(st):
+    """ generate the bounds and constant checks """
+    out = []
+    out.append(
+        "static inline gboolean\n"
+        "{0}_validate (const guint8 *buf, gsize bufsz, gsize offset, GError **error)\n"
+        "{{\n"
+        "\tif (buf == NULL || bufsz < {1}_SIZE || offset > bufsz - {1}_SIZE) {{\n"
+        "\t\tg_set_error (error,\n"
+        "\t\t\t     FWUPD_ERROR,\n"
+        "\t\t\t     FWUPD_ERROR_INVALID_FILE,\n"
+        '\t\t\t     "{2} requires 0x%x bytes at 0x%x, buffer was 0x%x",\n'
+        "\t\t\t     (guint) {1}_SIZE, (guint) offset, (guint) bufsz);\n"
+        "\t\treturn FALSE;\n"
+        "\t}}\n".format(st.prefix, st.define, st.name)
+    )
+    for f in st.fields:
+        if f.constant is None:
+            continue
+        out.append(
+            "\tif ({0}_get_{1} (buf + offset) != 0x{2:x}) {{\n"
+            "\t\tg_set_error (error,\n"
+            "\t\t\t     FWUPD_ERROR,\n"
+            "\t\t\t     FWUPD_ERROR_INVALID_FILE,\n"
+            '\t\t\t     "{3}.{1} was 0x%x, expected 0x{2:x}",\n'
+            "\t\t\t     (guint) {0}_get_{1} (buf + offset));\n"
+            "\t\treturn FALSE;\n"
+            "\t}}\n".format(st.prefix, f.name, f.constant, st.name)
+        )
+    out.append("\treturn TRUE;\n}\n")
+    return ["".join(out)]
+
+
+def generate(fn_in, structs):
+    """ generate the header contents """
+    out = []
+    out.append("/* generated by fu-struct.py from {}, do not edit */\n".format(fn_in))
+    out.append("#pragma once\n")
+    out.append("#include <glib.h>\n#include <string.h>\n\n#include \"fwupd-error.h\"\n")
+    for st in structs:
+        defines = ["#define {}_SIZE\t0x{:x}".format(st.define, st.size)]
+        for f in st.fields:
+            defines.append(
+                "#define {}_OFFSET_{}\t0x{:x}".format(st.define, f.name.upper(), f.offset)
+            )
+        out.append("\n".join(defines) + "\n")
+        for f in st.fields:
+            out.extend(generate_field(st, f))
+        out.extend(generate_validate(st))
+    return "\n".join(out)
+
+
+if __name__ == "__main__":
+    if {"-?", "--help", "--usage"}.intersection(set(sys.argv)):
+        usage(0)
+    if len(sys.argv) != 3:
+        usage(1)
+    with open(sys.argv[1], "r") as f:
+        try:
+            structs_parsed = parse(sys.argv[1], f.read())
+        except ValueError as e:
+            sys.stderr.write("{}\n".format(e))
+            sys.exit(1)
+    with open(sys.argv[2], "w") as f2:
+        f2.write(generate(sys.argv[1].split("/")[-1], structs_parsed))
@@ -27,23 +27,6 @@
 #define BCM_NVRAM_INFO2_BASE			0x200
 #define BCM_NVRAM_STAGE1_BASE			0x28c
 
-#define BCM_NVRAM_HEADER_MAGIC			0x00
-#define BCM_NVRAM_HEADER_PHYS_ADDR		0x04
-#define BCM_NVRAM_HEADER_SIZE_WRDS		0x08
-#define BCM_NVRAM_HEADER_OFFSET			0x0C
-#define BCM_NVRAM_HEADER_CRC			0x10
-#define BCM_NVRAM_HEADER_SZ			0x14
-
-#define BCM_NVRAM_INFO_MAC_ADDR0		0x00
-#define BCM_NVRAM_INFO_VENDOR			0x2E
-#define BCM_NVRAM_INFO_DEVICE			0x2C
-#define BCM_NVRAM_INFO_SZ			0x8C
-
-#define BCM_NVRAM_DIRECTORY_ADDR		0x00
-#define BCM_NVRAM_DIRECTORY_SIZE_WRDS		0x04
-#define BCM_NVRAM_DIRECTORY_OFFSET		0x08
-#define BCM_NVRAM_DIRECTORY_SZ			0x0c
-
 #define BCM_NVRAM_VPD_SZ			0x100
 
 #define BCM_NVRAM_INFO2_SZ			0x8c
@@ -331,6 +331,17 @@ fu_bcm57xx_device_activate (FuDevice *device, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_bcm57xx_device_read_region (FuDevice *device,
+			       guint32 address,
+			       guint8 *buf,
+			       gsize bufsz,
+			       GError **error)
+{
+	FuBcm57xxDevice *self = FU_BCM57XX_DEVICE (device);
+	return fu_bcm57xx_device_nvram_read (self, address, buf, bufsz, error);
+}
+
 static GBytes *
 fu_bcm57xx_device_dump_firmware (FuDevice *device, GError **error)
 {
@@ -466,35 +477,43 @@ fu_bcm57xx_device_write_firmware (FuDevice *device,
 				  GError **error)
 {
 	FuBcm57xxDevice *self = FU_BCM57XX_DEVICE (device);
-	g_autoptr(GBytes) blob = NULL;
-	g_autoptr(GBytes) blob_verify = NULL;
 	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GPtrArray) chunks_changed = NULL;
+	g_autoptr(GPtrArray) segments = NULL;
 
-	/* build the images into one linear blob of the correct size */
+	/* build the images of the correct size, without joining them */
 	fu_device_set_status (device, FWUPD_STATUS_DECOMPRESSING);
-	blob = fu_firmware_write (firmware, error);
-	if (blob == NULL)
+	segments = fu_firmware_write_segments (firmware, error);
+	if (segments == NULL)
+		return FALSE;
+
+	/* only write the blocks that are different */
+	chunks = fu_chunk_array_new_from_segments (segments, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
+	chunks_changed = fu_device_get_changed_chunks (device, chunks, flags, error);
+	if (chunks_changed == NULL)
 		return FALSE;
 
 	/* hit hardware */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	chunks = fu_chunk_array_new_from_bytes (blob, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
+	for (guint i = 0; i < chunks_changed->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks_changed, i);
 		if (!fu_bcm57xx_device_nvram_write (self, chk->address,
 						    chk->data, chk->data_sz,
 						    error))
 			return FALSE;
-		fu_device_set_progress_full (device, i, chunks->len - 1);
+		fu_device_set_progress_full (device, i, chunks_changed->len);
 	}
 
-	/* verify */
+	/* verify, the unchanged blocks were already compared */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_VERIFY);
-	blob_verify = fu_bcm57xx_device_dump_firmware (device, error);
-	if (blob_verify == NULL)
-		return FALSE;
-	if (!fu_common_bytes_compare (blob, blob_verify, error))
-		return FALSE;
+	for (guint i = 0; i < chunks_changed->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks_changed, i);
+		if (!fu_device_verify_region (device, chk->address,
+					      chk->data, chk->data_sz,
+					      error))
+			return FALSE;
+		fu_device_set_progress_full (device, i, chunks_changed->len);
+	}
 
 	/* reset APE */
 	return fu_device_activate (device, error);
@@ -640,6 +659,7 @@ fu_bcm57xx_device_class_init (FuBcm57xxDeviceClass *klass)
 	klass_device->write_firmware = fu_bcm57xx_device_write_firmware;
 	klass_device->read_firmware = fu_bcm57xx_device_read_firmware;
 	klass_device->dump_firmware = fu_bcm57xx_device_dump_firmware;
+	klass_device->read_region = fu_bcm57xx_device_read_region;
 	klass_udev_device->probe = fu_bcm57xx_device_probe;
 	klass_udev_device->to_string = fu_bcm57xx_device_to_string;
 }
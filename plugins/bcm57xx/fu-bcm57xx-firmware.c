@@ -10,6 +10,7 @@
 #include "fu-common.h"
 
 #include "fu-bcm57xx-common.h"
+#include "fu-bcm57xx-struct.h"
 #include "fu-bcm57xx-firmware.h"
 #include "fu-bcm57xx-dict-image.h"
 #include "fu-bcm57xx-stage1-image.h"
@@ -57,31 +58,30 @@ fu_bcm57xx_firmware_parse_header (FuBcm57xxFirmware *self, GBytes *fw, GError **
 		return FALSE;
 
 	/* get address */
-	return fu_common_read_uint32_safe (buf, bufsz, BCM_NVRAM_HEADER_PHYS_ADDR,
-					   &self->phys_addr, G_BIG_ENDIAN, error);
+	if (!fu_struct_bcm57xx_nvram_header_validate (buf, bufsz, 0x0, error))
+		return FALSE;
+	self->phys_addr = fu_struct_bcm57xx_nvram_header_get_phys_addr (buf);
+	return TRUE;
 }
 
 static FuFirmwareImage *
 fu_bcm57xx_firmware_parse_info (FuBcm57xxFirmware *self, GBytes *fw, GError **error)
 {
 	gsize bufsz = 0x0;
-	guint32 mac_addr0 = 0;
+	guint32 mac_addr0;
 	const guint8 *buf = g_bytes_get_data (fw, &bufsz);
 	g_autoptr(FuFirmwareImage) img = fu_firmware_image_new (fw);
 
-	/* if the MAC is set non-zero this is an actual backup rather than a container */
-	if (!fu_common_read_uint32_safe (buf, bufsz, BCM_NVRAM_INFO_MAC_ADDR0,
-					 &mac_addr0, G_BIG_ENDIAN, error))
+	if (!fu_struct_bcm57xx_nvram_info_validate (buf, bufsz, 0x0, error))
 		return NULL;
+
+	/* if the MAC is set non-zero this is an actual backup rather than a container */
+	mac_addr0 = fu_struct_bcm57xx_nvram_info_get_mac_addr0 (buf);
 	self->is_backup = mac_addr0 != 0x0 && mac_addr0 != 0xffffffff;
 
 	/* read vendor + model */
-	if (!fu_common_read_uint16_safe (buf, bufsz, BCM_NVRAM_INFO_VENDOR,
-					 &self->vendor, G_BIG_ENDIAN, error))
-		return NULL;
-	if (!fu_common_read_uint16_safe (buf, bufsz, BCM_NVRAM_INFO_DEVICE,
-					 &self->model, G_BIG_ENDIAN, error))
-		return NULL;
+	self->vendor = fu_struct_bcm57xx_nvram_info_get_vendor (buf);
+	self->model = fu_struct_bcm57xx_nvram_info_get_device (buf);
 
 	/* success */
 	fu_firmware_image_set_id (img, "info");
@@ -96,22 +96,16 @@ fu_bcm57xx_firmware_parse_stage1 (FuBcm57xxFirmware *self,
 				  GError **error)
 {
 	gsize bufsz = 0x0;
-	guint32 stage1_wrds = 0;
 	guint32 stage1_sz;
-	guint32 stage1_off = 0;
+	guint32 stage1_off;
 	const guint8 *buf = g_bytes_get_data (fw, &bufsz);
 	g_autoptr(FuFirmwareImage) img = fu_bcm57xx_stage1_image_new ();
 	g_autoptr(GBytes) blob = NULL;
 
-	if (!fu_common_read_uint32_safe (buf, bufsz,
-					 BCM_NVRAM_HEADER_BASE + BCM_NVRAM_HEADER_SIZE_WRDS,
-					 &stage1_wrds, G_BIG_ENDIAN, error))
-		return NULL;
-	if (!fu_common_read_uint32_safe (buf, bufsz,
-					 BCM_NVRAM_HEADER_BASE + BCM_NVRAM_HEADER_OFFSET,
-					 &stage1_off, G_BIG_ENDIAN, error))
+	if (!fu_struct_bcm57xx_nvram_header_validate (buf, bufsz, BCM_NVRAM_HEADER_BASE, error))
 		return NULL;
-	stage1_sz = (stage1_wrds * sizeof(guint32));
+	stage1_sz = fu_struct_bcm57xx_nvram_header_get_size_wrds (buf + BCM_NVRAM_HEADER_BASE) * sizeof(guint32);
+	stage1_off = fu_struct_bcm57xx_nvram_header_get_offset (buf + BCM_NVRAM_HEADER_BASE);
 	if (stage1_off != BCM_NVRAM_STAGE1_BASE) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -193,28 +187,21 @@ fu_bcm57xx_firmware_parse_dict (FuBcm57xxFirmware *self, GBytes *fw, guint idx,
 				FwupdInstallFlags flags, GError **error)
 {
 	gsize bufsz = 0x0;
-	guint32 dict_addr = 0x0;
-	guint32 dict_info = 0x0;
-	guint32 dict_off = 0x0;
+	guint32 dict_addr;
+	guint32 dict_info;
+	guint32 dict_off;
 	guint32 dict_sz;
-	guint32 base = BCM_NVRAM_DIRECTORY_BASE + (idx * BCM_NVRAM_DIRECTORY_SZ);
+	guint32 base = BCM_NVRAM_DIRECTORY_BASE + (idx * FU_STRUCT_BCM57XX_NVRAM_DIRECTORY_SIZE);
 	const guint8 *buf = g_bytes_get_data (fw, &bufsz);
 	g_autoptr(FuFirmwareImage) img = fu_bcm57xx_dict_image_new ();
 	g_autoptr(GBytes) blob = NULL;
 
 	/* header */
-	if (!fu_common_read_uint32_safe (buf, bufsz,
-					 base + BCM_NVRAM_DIRECTORY_ADDR,
-					 &dict_addr, G_BIG_ENDIAN, error))
-		return FALSE;
-	if (!fu_common_read_uint32_safe (buf, bufsz,
-					 base + BCM_NVRAM_DIRECTORY_SIZE_WRDS,
-					 &dict_info, G_BIG_ENDIAN, error))
-		return FALSE;
-	if (!fu_common_read_uint32_safe (buf, bufsz,
-					 base + BCM_NVRAM_DIRECTORY_OFFSET,
-					 &dict_off, G_BIG_ENDIAN, error))
+	if (!fu_struct_bcm57xx_nvram_directory_validate (buf, bufsz, base, error))
 		return FALSE;
+	dict_addr = fu_struct_bcm57xx_nvram_directory_get_addr (buf + base);
+	dict_info = fu_struct_bcm57xx_nvram_directory_get_size_wrds (buf + base);
+	dict_off = fu_struct_bcm57xx_nvram_directory_get_offset (buf + base);
 
 	/* no dict stored */
 	if (dict_addr == 0 && dict_info == 0 && dict_off == 0)
@@ -320,7 +307,7 @@ fu_bcm57xx_firmware_parse (FuFirmware *firmware,
 	/* NVRAM header */
 	blob_header = fu_common_bytes_new_offset (fw,
 						  BCM_NVRAM_HEADER_BASE,
-						  BCM_NVRAM_HEADER_SZ,
+						  FU_STRUCT_BCM57XX_NVRAM_HEADER_SIZE,
 						  error);
 	if (blob_header == NULL)
 		return FALSE;
@@ -332,7 +319,7 @@ fu_bcm57xx_firmware_parse (FuFirmware *firmware,
 	/* info */
 	blob_info = fu_common_bytes_new_offset (fw,
 						BCM_NVRAM_INFO_BASE,
-						BCM_NVRAM_INFO_SZ,
+						FU_STRUCT_BCM57XX_NVRAM_INFO_SIZE,
 						error);
 	if (blob_info == NULL)
 		return FALSE;
@@ -510,13 +497,11 @@ fu_bcm57xx_firmware_write (FuFirmware *firmware, GError **error)
 		if (blob_info == NULL)
 			return NULL;
 	} else {
-		GByteArray *tmp = g_byte_array_sized_new (BCM_NVRAM_INFO_SZ);
-		for (gsize i = 0; i < BCM_NVRAM_INFO_SZ; i++)
+		GByteArray *tmp = g_byte_array_sized_new (FU_STRUCT_BCM57XX_NVRAM_INFO_SIZE);
+		for (gsize i = 0; i < FU_STRUCT_BCM57XX_NVRAM_INFO_SIZE; i++)
 			fu_byte_array_append_uint8 (tmp, 0x0);
-		fu_common_write_uint16 (tmp->data + BCM_NVRAM_INFO_VENDOR,
-					self->vendor, G_BIG_ENDIAN);
-		fu_common_write_uint16 (tmp->data + BCM_NVRAM_INFO_DEVICE,
-					self->model, G_BIG_ENDIAN);
+		fu_struct_bcm57xx_nvram_info_set_vendor (tmp->data, self->vendor);
+		fu_struct_bcm57xx_nvram_info_set_device (tmp->data, self->model);
 		blob_info = g_byte_array_free_to_bytes (tmp);
 	}
 	_g_byte_array_append_bytes (buf, blob_info);
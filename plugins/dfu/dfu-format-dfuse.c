@@ -24,23 +24,25 @@ typedef struct __attribute__((packed)) {
 
 /**
  * dfu_element_from_dfuse: (skip)
- * @data: data buffer
- * @length: length of @data we can access
+ * @bytes: data buffer
+ * @offset: offset into @bytes where the element starts
  * @consumed: (out): the number of bytes we consued
  * @error: a #GError, or %NULL
  *
- * Unpacks an element from DfuSe data.
+ * Unpacks an element from DfuSe data. The element contents reference @bytes
+ * rather than being copied.
  *
  * Returns: a #DfuElement, or %NULL for error
  **/
 static DfuElement *
-dfu_element_from_dfuse (const guint8 *data,
-			guint32 length,
+dfu_element_from_dfuse (GBytes *bytes,
+			gsize offset,
 			guint32 *consumed,
 			GError **error)
 {
 	DfuElement *element = NULL;
-	DfuSeElementPrefix *el = (DfuSeElementPrefix *) data;
+	DfuSeElementPrefix *el;
+	gsize length = g_bytes_get_size (bytes) - offset;
 	guint32 size;
 	g_autoptr(GBytes) contents = NULL;
 
@@ -57,6 +59,7 @@ dfu_element_from_dfuse (const guint8 *data,
 	}
 
 	/* check size */
+	el = (DfuSeElementPrefix *) ((const guint8 *) g_bytes_get_data (bytes, NULL) + offset);
 	size = GUINT32_FROM_LE (el->size);
 	if (size + sizeof(DfuSeElementPrefix) > length) {
 		g_set_error (error,
@@ -71,7 +74,7 @@ dfu_element_from_dfuse (const guint8 *data,
 	/* create new element */
 	element = dfu_element_new ();
 	dfu_element_set_address (element, GUINT32_FROM_LE (el->address));
-	contents = g_bytes_new (data + sizeof(DfuSeElementPrefix), size);
+	contents = g_bytes_new_from_bytes (bytes, offset + sizeof(DfuSeElementPrefix), size);
 	dfu_element_set_contents (element, contents);
 
 	/* return size */
@@ -84,27 +87,23 @@ dfu_element_from_dfuse (const guint8 *data,
 /**
  * dfu_element_to_dfuse: (skip)
  * @element: a #DfuElement
+ * @segments: (element-type GBytes): segments to append to
  *
- * Packs a DfuSe element.
+ * Packs a DfuSe element, referencing rather than copying the contents.
  *
- * Returns: (transfer full): the packed data
+ * Returns: the packed size
  **/
-static GBytes *
-dfu_element_to_dfuse (DfuElement *element)
+static gsize
+dfu_element_to_dfuse (DfuElement *element, GPtrArray *segments)
 {
-	DfuSeElementPrefix *el;
-	const guint8 *data;
-	gsize length;
-	guint8 *buf;
-
-	data = g_bytes_get_data (dfu_element_get_contents (element), &length);
-	buf = g_malloc0 (length + sizeof (DfuSeElementPrefix));
-	el = (DfuSeElementPrefix *) buf;
-	el->address = GUINT32_TO_LE (dfu_element_get_address (element));
-	el->size = GUINT32_TO_LE (length);
-
-	memcpy (buf + sizeof (DfuSeElementPrefix), data, length);
-	return g_bytes_new_take (buf, length + sizeof (DfuSeElementPrefix));
+	GBytes *contents = dfu_element_get_contents (element);
+	DfuSeElementPrefix el = {
+		.address = GUINT32_TO_LE (dfu_element_get_address (element)),
+		.size = GUINT32_TO_LE (g_bytes_get_size (contents)),
+	};
+	g_ptr_array_add (segments, g_bytes_new (&el, sizeof(el)));
+	g_ptr_array_add (segments, g_bytes_ref (contents));
+	return sizeof(el) + g_bytes_get_size (contents);
 }
 
 /* DfuSe image header */
@@ -119,8 +118,8 @@ typedef struct __attribute__((packed)) {
 
 /**
  * dfu_image_from_dfuse: (skip)
- * @data: data buffer
- * @length: length of @data we can access
+ * @bytes: data buffer
+ * @offset: offset into @bytes where the image starts
  * @consumed: (out): the number of bytes we consued
  * @error: a #GError, or %NULL
  *
@@ -129,14 +128,15 @@ typedef struct __attribute__((packed)) {
  * Returns: a #DfuImage, or %NULL for error
  **/
 static DfuImage *
-dfu_image_from_dfuse (const guint8 *data,
-		      guint32 length,
+dfu_image_from_dfuse (GBytes *bytes,
+		      gsize offset,
 		      guint32 *consumed,
 		      GError **error)
 {
 	DfuSeImagePrefix *im;
+	gsize length = g_bytes_get_size (bytes) - offset;
 	guint32 elements;
-	guint32 offset = sizeof(DfuSeImagePrefix);
+	guint32 offset_local = sizeof(DfuSeImagePrefix);
 	g_autoptr(DfuImage) image = NULL;
 
 	g_assert_cmpint(sizeof(DfuSeImagePrefix), ==, 274);
@@ -152,7 +152,7 @@ dfu_image_from_dfuse (const guint8 *data,
 	}
 
 	/* verify image signature */
-	im = (DfuSeImagePrefix *) data;
+	im = (DfuSeImagePrefix *) ((const guint8 *) g_bytes_get_data (bytes, NULL) + offset);
 	if (memcmp (im->sig, "Target", 6) != 0) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
@@ -168,23 +168,21 @@ dfu_image_from_dfuse (const guint8 *data,
 		dfu_image_set_name (image, im->target_name);
 
 	/* parse elements */
-	length -= offset;
 	elements = GUINT32_FROM_LE (im->elements);
 	for (guint j = 0; j < elements; j++) {
 		guint32 consumed_local;
 		g_autoptr(DfuElement) element = NULL;
-		element = dfu_element_from_dfuse (data + offset, length,
+		element = dfu_element_from_dfuse (bytes, offset + offset_local,
 						  &consumed_local, error);
 		if (element == NULL)
 			return NULL;
 		dfu_image_add_element (image, element);
-		offset += consumed_local;
-		length -= consumed_local;
+		offset_local += consumed_local;
 	}
 
 	/* return size */
 	if (consumed != NULL)
-		*consumed = offset;
+		*consumed = offset_local;
 
 	return g_object_ref (image);
 }
@@ -192,33 +190,30 @@ dfu_image_from_dfuse (const guint8 *data,
 /**
  * dfu_image_to_dfuse: (skip)
  * @image: a #DfuImage
+ * @segments: (element-type GBytes): segments to append to
  *
  * Packs a DfuSe image
  *
- * Returns: (transfer full): the packed data
+ * Returns: the packed size
  **/
-static GBytes *
-dfu_image_to_dfuse (DfuImage *image)
+static gsize
+dfu_image_to_dfuse (DfuImage *image, GPtrArray *segments)
 {
 	DfuSeImagePrefix *im;
 	GPtrArray *elements;
 	guint32 length_total = 0;
-	guint32 offset = sizeof (DfuSeImagePrefix);
-	guint8 *buf;
-	g_autoptr(GPtrArray) element_array = NULL;
+	guint idx_prefix = segments->len;
+	g_autofree guint8 *buf = g_malloc0 (sizeof (DfuSeImagePrefix));
 
-	/* get total size */
-	element_array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	/* placeholder for the prefix, as the total size is not known yet */
+	g_ptr_array_add (segments, NULL);
 	elements = dfu_image_get_elements (image);
 	for (guint i = 0; i < elements->len; i++) {
 		DfuElement *element = g_ptr_array_index (elements, i);
-		GBytes *bytes = dfu_element_to_dfuse (element);
-		g_ptr_array_add (element_array, bytes);
-		length_total += (guint32) g_bytes_get_size (bytes);
+		length_total += (guint32) dfu_element_to_dfuse (element, segments);
 	}
 
 	/* add prefix */
-	buf = g_malloc0 (length_total + sizeof (DfuSeImagePrefix));
 	im = (DfuSeImagePrefix *) buf;
 	memcpy (im->sig, "Target", 6);
 	im->alt_setting = dfu_image_get_alt_setting (image);
@@ -228,22 +223,9 @@ dfu_image_to_dfuse (DfuImage *image)
 	}
 	im->target_size = GUINT32_TO_LE (length_total);
 	im->elements = GUINT32_TO_LE (elements->len);
-
-	/* copy data */
-	for (guint i = 0; i < element_array->len; i++) {
-		gsize length;
-		GBytes *bytes = g_ptr_array_index (element_array, i);
-		const guint8 *data = g_bytes_get_data (bytes, &length);
-		g_autoptr(GError) error = NULL;
-		if (!fu_memcpy_safe (buf, length_total + sizeof (DfuSeImagePrefix), offset,	/* dst */
-				     data, length, 0x0,						/* src */
-				     length, &error)) {
-			g_critical ("failed to pack buffer: %s", error->message);
-			continue;
-		}
-		offset += (guint32) length;
-	}
-	return g_bytes_new_take (buf, length_total + sizeof (DfuSeImagePrefix));
+	g_ptr_array_index (segments, idx_prefix) =
+		g_bytes_new_take (g_steal_pointer (&buf), sizeof (DfuSeImagePrefix));
+	return sizeof (DfuSeImagePrefix) + length_total;
 }
 
 /* DfuSe header */
@@ -266,32 +248,12 @@ typedef struct __attribute__((packed)) {
 GBytes *
 dfu_firmware_to_dfuse (DfuFirmware *firmware, GError **error)
 {
-	DfuSePrefix *prefix;
+	DfuSePrefix prefix = { .sig = { 'D', 'f', 'u', 'S', 'e' }, .ver = 0x01 };
 	guint32 image_size_total = 0;
-	guint32 offset = sizeof (DfuSePrefix);
-	g_autofree guint8 *buf = NULL;
-	g_autoptr(GPtrArray) dfuse_images = NULL;
 	g_autoptr(GPtrArray) images = NULL;
+	g_autoptr(GPtrArray) segments = NULL;
 
-	/* get all the image data */
-	dfuse_images = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
 	images = fu_firmware_get_images (FU_FIRMWARE (firmware));
-	for (guint i = 0; i < images->len; i++) {
-		DfuImage *im = g_ptr_array_index (images, i);
-		GBytes *contents;
-		contents = dfu_image_to_dfuse (im);
-		image_size_total += (guint32) g_bytes_get_size (contents);
-		g_ptr_array_add (dfuse_images, contents);
-	}
-	g_debug ("image_size_total: %" G_GUINT32_FORMAT, image_size_total);
-
-	buf = g_malloc0 (sizeof (DfuSePrefix) + image_size_total);
-
-	/* DfuSe header */
-	prefix = (DfuSePrefix *) buf;
-	memcpy (prefix->sig, "DfuSe", 5);
-	prefix->ver = 0x01;
-	prefix->image_size = GUINT32_TO_LE (offset + image_size_total);
 	if (images->len > G_MAXUINT8) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -300,23 +262,23 @@ dfu_firmware_to_dfuse (DfuFirmware *firmware, GError **error)
 			     images->len);
 		return NULL;
 	}
-	prefix->targets = (guint8) images->len;
-
-	/* copy images */
-	for (guint i = 0; i < dfuse_images->len; i++) {
-		GBytes *contents = g_ptr_array_index (dfuse_images, i);
-		gsize length;
-		const guint8 *data;
-		data = g_bytes_get_data (contents, &length);
-		if (!fu_memcpy_safe (buf, sizeof (DfuSePrefix) + image_size_total, offset,	/* dst */
-				     data, length, 0x0,						/* src */
-				     length, error))
-			return NULL;
-		offset += (guint32) length;
+
+	/* get all the image data, with a placeholder for the DfuSe header */
+	segments = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+	g_ptr_array_add (segments, NULL);
+	for (guint i = 0; i < images->len; i++) {
+		DfuImage *im = g_ptr_array_index (images, i);
+		image_size_total += (guint32) dfu_image_to_dfuse (im, segments);
 	}
+	g_debug ("image_size_total: %" G_GUINT32_FORMAT, image_size_total);
+
+	/* DfuSe header */
+	prefix.image_size = GUINT32_TO_LE (sizeof (DfuSePrefix) + image_size_total);
+	prefix.targets = (guint8) images->len;
+	g_ptr_array_index (segments, 0) = g_bytes_new (&prefix, sizeof (prefix));
 
-	/* return blob */
-	return g_bytes_new (buf, sizeof (DfuSePrefix) + image_size_total);
+	/* only copy the element data once */
+	return fu_firmware_segments_join (segments);
 }
 
 /**
@@ -376,17 +338,14 @@ dfu_firmware_from_dfuse (DfuFirmware *firmware,
 	}
 
 	/* parse the image targets */
-	len -= sizeof(DfuSePrefix);
 	for (guint i = 0; i < prefix->targets; i++) {
 		guint consumed;
 		g_autoptr(DfuImage) image = NULL;
-		image = dfu_image_from_dfuse (data + offset, (guint32) len,
-					      &consumed, error);
+		image = dfu_image_from_dfuse (bytes, offset, &consumed, error);
 		if (image == NULL)
 			return FALSE;
 		fu_firmware_add_image (FU_FIRMWARE (firmware), FU_FIRMWARE_IMAGE (image));
 		offset += consumed;
-		len -= consumed;
 	}
 	return TRUE;
 }
@@ -192,10 +192,12 @@ dfu_firmware_dfuse_func (void)
 	const gchar *ci = g_getenv ("CI_NETWORK");
 	g_autofree gchar *filename = NULL;
 	g_autoptr(DfuFirmware) firmware = NULL;
+	g_autoptr(DfuFirmware) firmware_view = NULL;
 	g_autoptr(GBytes) roundtrip_orig = NULL;
 	g_autoptr(GBytes) roundtrip = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GFile) file = NULL;
+	g_autoptr(GPtrArray) images = NULL;
 
 	/* load a DeFUse firmware */
 	g_setenv ("DFU_SELF_TEST_IMAGE_MEMCPY_NAME", "", FALSE);
@@ -234,6 +236,26 @@ dfu_firmware_dfuse_func (void)
 	g_assert_no_error (error);
 	g_assert_true (ret);
 
+	/* element contents should reference the file data, not copies */
+	firmware_view = dfu_firmware_new ();
+	ret = dfu_firmware_parse_data (firmware_view, roundtrip_orig,
+				       FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+	images = fu_firmware_get_images (FU_FIRMWARE (firmware_view));
+	for (guint i = 0; i < images->len; i++) {
+		DfuImage *image = g_ptr_array_index (images, i);
+		GPtrArray *elements = dfu_image_get_elements (image);
+		for (guint j = 0; j < elements->len; j++) {
+			DfuElement *element = g_ptr_array_index (elements, j);
+			GBytes *contents = dfu_element_get_contents (element);
+			const guint8 *buf = g_bytes_get_data (contents, NULL);
+			const guint8 *buf_orig = g_bytes_get_data (roundtrip_orig, NULL);
+			g_assert (buf >= buf_orig);
+			g_assert (buf < buf_orig + g_bytes_get_size (roundtrip_orig));
+		}
+	}
+
 	/* use usual image name copying */
 	g_unsetenv ("DFU_SELF_TEST_IMAGE_MEMCPY_NAME");
 }
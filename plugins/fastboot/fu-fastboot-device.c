@@ -265,7 +265,9 @@ fu_fastboot_device_download (FuDevice *device, GBytes *fw, GError **error)
 	FuFastbootDevice *self = FU_FASTBOOT_DEVICE (device);
 	gsize sz = g_bytes_get_size (fw);
 	g_autofree gchar *tmp = g_strdup_printf ("download:%08x", (guint) sz);
-	g_autoptr(GPtrArray) chunks = NULL;
+	FuChunkIter iter;
+	FuChunk chk;
+	guint32 n_chunks;
 
 	/* tell the client the size of data to expect */
 	if (!fu_fastboot_device_cmd (device, tmp,
@@ -275,15 +277,15 @@ fu_fastboot_device_download (FuDevice *device, GBytes *fw, GError **error)
 
 	/* send the data in chunks */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	chunks = fu_chunk_array_new_from_bytes (fw,
-						0x00,	/* start addr */
-						0x00,	/* page_sz */
-						self->blocksz);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-		if (!fu_fastboot_device_write (device, chk->data, chk->data_sz, error))
+	fu_chunk_iter_init_bytes (&iter, fw,
+				  0x00,	/* start addr */
+				  0x00,	/* page_sz */
+				  self->blocksz);
+	n_chunks = fu_chunk_iter_get_n_chunks (&iter);
+	while (fu_chunk_iter_next (&iter, &chk)) {
+		if (!fu_fastboot_device_write (device, chk.data, chk.data_sz, error))
 			return FALSE;
-		fu_device_set_progress_full (device, (gsize) i, (gsize) chunks->len * 2);
+		fu_device_set_progress_full (device, (gsize) chk.idx, (gsize) n_chunks * 2);
 	}
 	if (!fu_fastboot_device_read (device, NULL,
 				      FU_FASTBOOT_DEVICE_READ_FLAG_STATUS_POLL, error))
@@ -313,7 +313,9 @@ fu_nvme_device_write_firmware (FuDevice *device,
 	FuNvmeDevice *self = FU_NVME_DEVICE (device);
 	g_autoptr(GBytes) fw2 = NULL;
 	g_autoptr(GBytes) fw = NULL;
-	g_autoptr(GPtrArray) chunks = NULL;
+	FuChunkIter iter;
+	FuChunk chk;
+	guint32 n_chunks;
 	guint64 block_size = self->write_block_size > 0 ?
 			     self->write_block_size : 0x1000;
 
@@ -331,24 +333,24 @@ fu_nvme_device_write_firmware (FuDevice *device,
 	}
 
 	/* build packets */
-	chunks = fu_chunk_array_new_from_bytes (fw2,
-						0x00,		/* start_addr */
-						0x00,		/* page_sz */
-						block_size);	/* block size */
+	fu_chunk_iter_init_bytes (&iter, fw2,
+				  0x00,		/* start_addr */
+				  0x00,		/* page_sz */
+				  block_size);	/* block size */
+	n_chunks = fu_chunk_iter_get_n_chunks (&iter);
 
 	/* write each block */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
+	while (fu_chunk_iter_next (&iter, &chk)) {
 		if (!fu_nvme_device_fw_download (self,
-						 chk->address,
-						 chk->data,
-						 chk->data_sz,
+						 chk.address,
+						 chk.data,
+						 chk.data_sz,
 						 error)) {
-			g_prefix_error (error, "failed to write chunk %u: ", i);
+			g_prefix_error (error, "failed to write chunk %u: ", chk.idx);
 			return FALSE;
 		}
-		fu_device_set_progress_full (device, (gsize) i, (gsize) chunks->len + 1);
+		fu_device_set_progress_full (device, (gsize) chk.idx, (gsize) n_chunks + 1);
 	}
 
 	/* commit */
@@ -10,6 +10,7 @@
 #include <glib/gstdio.h>
 #include <string.h>
 
+#include "fu-common.h"
 #include "fu-rom.h"
 
 static void fu_rom_finalize			 (GObject *object);
@@ -71,27 +72,56 @@ fu_rom_kind_to_string (FuRomKind kind)
 	return NULL;
 }
 
+/* the last byte is never part of a match as it is the checksum */
+static gboolean
+fu_rom_pci_get_haystack (FuRomPciHeader *hdr, guint8 **haystack, gsize *haystack_len)
+{
+	if (hdr->rom_data == NULL)
+		return FALSE;
+	if (hdr->data_len >= hdr->rom_len)
+		return FALSE;
+	*haystack = &hdr->rom_data[hdr->data_len];
+	*haystack_len = hdr->rom_len - hdr->data_len - 1;
+	return TRUE;
+}
+
 static guint8 *
 fu_rom_pci_strstr (FuRomPciHeader *hdr, const gchar *needle)
 {
-	gsize needle_len;
-	guint8 *haystack;
-	gsize haystack_len;
+	gsize offset = 0;
+	gsize haystack_len = 0;
+	guint8 *haystack = NULL;
 
 	if (needle == NULL || needle[0] == '\0')
 		return NULL;
-	if (hdr->rom_data == NULL)
+	if (!fu_rom_pci_get_haystack (hdr, &haystack, &haystack_len))
 		return NULL;
-	if (hdr->data_len > hdr->rom_len)
+	if (!fu_memmem_safe (haystack, haystack_len,
+			     (const guint8 *) needle, strlen (needle),
+			     &offset, NULL))
 		return NULL;
-	haystack = &hdr->rom_data[hdr->data_len];
-	haystack_len = hdr->rom_len - hdr->data_len;
-	needle_len = strlen (needle);
-	if (needle_len > haystack_len)
+	return &haystack[offset];
+}
+
+/* searches for all the needles at once, returning the match for the first
+ * needle in @needles that was found, and its index in @idx */
+static guint8 *
+fu_rom_pci_strstr_multi (FuRomPciHeader *hdr, const gchar * const *needles, guint *idx)
+{
+	gsize offsets[8] = { 0x0 };
+	gsize haystack_len = 0;
+	guint8 *haystack = NULL;
+
+	g_return_val_if_fail (g_strv_length ((gchar **) needles) <= G_N_ELEMENTS (offsets), NULL);
+
+	if (!fu_rom_pci_get_haystack (hdr, &haystack, &haystack_len))
 		return NULL;
-	for (guint i = 0; i < haystack_len - needle_len; i++) {
-		if (memcmp (haystack + i, needle, needle_len) == 0)
-			return &haystack[i];
+	fu_memmem_multi (haystack, haystack_len, needles, offsets);
+	for (guint i = 0; needles[i] != NULL; i++) {
+		if (offsets[i] != G_MAXSIZE) {
+			*idx = i;
+			return &haystack[offsets[i]];
+		}
 	}
 	return NULL;
 }
@@ -456,23 +486,21 @@ static gchar *
 fu_rom_find_version_nvidia (FuRomPciHeader *hdr)
 {
 	gchar *str;
+	guint idx = 0;
+	const gchar *needles[] = {
+		"Version ",	/* usual search string */
+		"Vension:",	/* broken */
+		"Version",
+		NULL };
 
 	/* static location for some firmware */
 	if (memcmp (hdr->rom_data + 0x013d, "Version ", 8) == 0)
 		return g_strdup ((gchar *) &hdr->rom_data[0x013d + 8]);
 
-	/* usual search string */
-	str = (gchar *) fu_rom_pci_strstr (hdr, "Version ");
+	/* search strings in order of preference */
+	str = (gchar *) fu_rom_pci_strstr_multi (hdr, needles, &idx);
 	if (str != NULL)
-		return g_strdup (str + 8);
-
-	/* broken */
-	str = (gchar *) fu_rom_pci_strstr (hdr, "Vension:");
-	if (str != NULL)
-		return g_strdup (str + 8);
-	str = (gchar *) fu_rom_pci_strstr (hdr, "Version");
-	if (str != NULL)
-		return g_strdup (str + 7);
+		return g_strdup (str + strlen (needles[idx]));
 
 	/* fallback to VBIOS */
 	if (memcmp (hdr->rom_data + 0xfa, "VBIOS Ver", 9) == 0)
@@ -508,13 +536,13 @@ static gchar *
 fu_rom_find_version_ati (FuRomPciHeader *hdr)
 {
 	gchar *str;
+	guint idx = 0;
+	const gchar *needles[] = {
+		" VER0",
+		" VR",		/* broken */
+		NULL };
 
-	str = (gchar *) fu_rom_pci_strstr (hdr, " VER0");
-	if (str != NULL)
-		return g_strdup (str + 4);
-
-	/* broken */
-	str = (gchar *) fu_rom_pci_strstr (hdr, " VR");
+	str = (gchar *) fu_rom_pci_strstr_multi (hdr, needles, &idx);
 	if (str != NULL)
 		return g_strdup (str + 4);
 	return NULL;
@@ -257,7 +257,9 @@ fu_rts54hid_device_write_firmware (FuDevice *device,
 {
 	FuRts54HidDevice *self = FU_RTS54HID_DEVICE (device);
 	g_autoptr(GBytes) fw = NULL;
-	g_autoptr(GPtrArray) chunks = NULL;
+	FuChunkIter iter;
+	FuChunk chk;
+	guint32 n_chunks;
 
 	/* get default image */
 	fw = fu_firmware_get_image_default_bytes (firmware, error);
@@ -274,26 +276,25 @@ fu_rts54hid_device_write_firmware (FuDevice *device,
 		return FALSE;
 
 	/* build packets */
-	chunks = fu_chunk_array_new_from_bytes (fw,
-						0x00,	/* start addr */
-						0x00,	/* page_sz */
-						FU_RTS54HID_TRANSFER_BLOCK_SIZE);
+	fu_chunk_iter_init_bytes (&iter, fw,
+				  0x00,	/* start addr */
+				  0x00,	/* page_sz */
+				  FU_RTS54HID_TRANSFER_BLOCK_SIZE);
+	n_chunks = fu_chunk_iter_get_n_chunks (&iter);
 
 	/* write each block */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-
+	while (fu_chunk_iter_next (&iter, &chk)) {
 		/* write chunk */
 		if (!fu_rts54hid_device_write_flash (self,
-						     chk->address,
-						     chk->data,
-						     chk->data_sz,
+						     chk.address,
+						     chk.data,
+						     chk.data_sz,
 						     error))
 			return FALSE;
 
 		/* update progress */
-		fu_device_set_progress_full (device, (gsize) i, (gsize) chunks->len * 2);
+		fu_device_set_progress_full (device, (gsize) chk.idx, (gsize) n_chunks * 2);
 	}
 
 	/* get device to authenticate the firmware */
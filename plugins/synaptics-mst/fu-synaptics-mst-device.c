@@ -159,6 +159,32 @@ fu_synaptics_mst_device_get_flash_checksum (FuSynapticsMstDevice *self,
 	return TRUE;
 }
 
+static gchar *
+fu_synaptics_mst_device_checksum_region (FuDevice *device,
+					 guint32 address,
+					 gsize bufsz,
+					 GError **error)
+{
+	FuSynapticsMstDevice *self = FU_SYNAPTICS_MST_DEVICE (device);
+	guint32 checksum = 0;
+	if (!fu_synaptics_mst_device_get_flash_checksum (self, bufsz, address,
+							 &checksum, error))
+		return NULL;
+	return g_strdup_printf ("%08x", checksum);
+}
+
+/* the same simple byte-sum as calculated by UPDC_CAL_EEPROM_CHECKSUM */
+static gchar *
+fu_synaptics_mst_device_checksum_data (FuDevice *device,
+				       const guint8 *buf,
+				       gsize bufsz)
+{
+	guint32 checksum = 0;
+	for (gsize i = 0; i < bufsz; i++)
+		checksum += buf[i];
+	return g_strdup_printf ("%08x", checksum);
+}
+
 static guint16
 fu_synaptics_mst_device_get_crc (guint16 crc, guint8 type, guint32 length, const guint8 *payload_data)
 {
@@ -248,31 +274,29 @@ fu_synaptics_mst_device_update_esm (FuSynapticsMstDevice *self,
 				    const guint8 *payload_data,
 				    GError **error)
 {
-	guint32 checksum = 0;
 	guint32 esm_sz = ESM_CODE_SIZE;
-	guint32 flash_checksum = 0;
 	guint32 unit_sz = BLOCK_UNIT;
 	guint32 write_loops = 0;
 	g_autoptr(FuSynapticsMstConnection) connection = NULL;
+	g_autoptr(GError) error_verify = NULL;
 
 	connection = fu_synaptics_mst_connection_new (fu_udev_device_get_fd (FU_UDEV_DEVICE (self)),
 						      self->layer, self->rad);
 
-	for (guint32 i = 0; i < esm_sz; i++)
-		checksum += *(payload_data + EEPROM_ESM_OFFSET +i);
-	if (!fu_synaptics_mst_device_get_flash_checksum (self,
-						    esm_sz,
-						    EEPROM_ESM_OFFSET,
-						    &flash_checksum, error)) {
-		return FALSE;
-	}
-
 	/* ESM checksum same */
-	if (checksum == flash_checksum) {
+	if (fu_device_verify_region (FU_DEVICE (self),
+				     EEPROM_ESM_OFFSET,
+				     payload_data + EEPROM_ESM_OFFSET,
+				     esm_sz,
+				     &error_verify)) {
 		g_debug ("ESM checksum already matches");
 		return TRUE;
 	}
-	g_debug ("ESM checksum %x doesn't match expected %x", flash_checksum, checksum);
+	if (!g_error_matches (error_verify, G_IO_ERROR, G_IO_ERROR_INVALID_DATA)) {
+		g_propagate_error (error, g_steal_pointer (&error_verify));
+		return FALSE;
+	}
+	g_debug ("ESM %s", error_verify->message);
 
 	/* update ESM firmware */
 	write_loops = esm_sz / unit_sz;
@@ -315,21 +339,18 @@ fu_synaptics_mst_device_update_esm (FuSynapticsMstDevice *self,
 		}
 
 		/* check ESM checksum */
-		checksum = 0;
-		flash_checksum = 0;
-		for (guint32 i = 0; i < esm_sz; i++)
-			checksum += *(payload_data + EEPROM_ESM_OFFSET +i);
-		if (!fu_synaptics_mst_device_get_flash_checksum (self,
-								 esm_sz,
-								 EEPROM_ESM_OFFSET,
-								 &flash_checksum,
-								 error))
-			return FALSE;
-
-		/* ESM update done */
-		if (checksum == flash_checksum)
+		g_clear_error (&error_verify);
+		if (fu_device_verify_region (FU_DEVICE (self),
+					     EEPROM_ESM_OFFSET,
+					     payload_data + EEPROM_ESM_OFFSET,
+					     esm_sz,
+					     &error_verify))
 			break;
-		g_debug ("attempt %u: ESM checksum %x didn't match %x", retries_cnt, flash_checksum, checksum);
+		if (!g_error_matches (error_verify, G_IO_ERROR, G_IO_ERROR_INVALID_DATA)) {
+			g_propagate_error (error, g_steal_pointer (&error_verify));
+			return FALSE;
+		}
+		g_debug ("attempt %u: ESM %s", retries_cnt, error_verify->message);
 
 		/* abort */
 		if (retries_cnt > MAX_RETRY_COUNTS) {
@@ -1183,6 +1204,8 @@ fu_synaptics_mst_device_class_init (FuSynapticsMstDeviceClass *klass)
 	klass_udev_device->to_string = fu_synaptics_mst_device_to_string;
 	klass_device->rescan = fu_synaptics_mst_device_rescan;
 	klass_device->write_firmware = fu_synaptics_mst_device_write_firmware;
+	klass_device->checksum_region = fu_synaptics_mst_device_checksum_region;
+	klass_device->checksum_data = fu_synaptics_mst_device_checksum_data;
 	klass_device->prepare_firmware = fu_synaptics_mst_device_prepare_firmware;
 	klass_udev_device->probe = fu_synaptics_mst_device_probe;
 }
@@ -13,6 +13,7 @@
 #include "fu-common.h"
 #include "fu-synaptics-rmi-common.h"
 #include "fu-synaptics-rmi-firmware.h"
+#include "fu-synaptics-rmi-struct.h"
 
 struct _FuSynapticsRmiFirmware {
 	FuFirmware		 parent_instance;
@@ -40,22 +41,6 @@ G_DEFINE_TYPE (FuSynapticsRmiFirmware, fu_synaptics_rmi_firmware, FU_TYPE_FIRMWA
 
 #define RMI_IMG_V10_CNTR_ADDR_OFFSET		0x0c
 
-typedef struct __attribute__((packed)) {
-	guint32	 content_checksum;
-	guint16	 container_id;
-	guint8	 minor_version;
-	guint8	 major_version;
-	guint8	 reserved_08;
-	guint8	 reserved_09;
-	guint8	 reserved_0a;
-	guint8	 reserved_0b;
-	guint32	 container_option_flags;
-	guint32	 content_options_length;
-	guint32	 content_options_address;
-	guint32	 content_length;
-	guint32	 content_address;
-} RmiFirmwareContainerDescriptor;
-
 typedef enum {
 	RMI_FIRMWARE_CONTAINER_ID_TOP_LEVEL = 0,
 	RMI_FIRMWARE_CONTAINER_ID_UI,
@@ -164,7 +149,6 @@ static gboolean
 fu_synaptics_rmi_firmware_parse_v10 (FuFirmware *firmware, GBytes *fw, GError **error)
 {
 	FuSynapticsRmiFirmware *self = FU_SYNAPTICS_RMI_FIRMWARE (firmware);
-	RmiFirmwareContainerDescriptor desc = { 0x0 };
 	guint16 container_id;
 	guint32 cntrs_len;
 	guint32 offset;
@@ -178,13 +162,11 @@ fu_synaptics_rmi_firmware_parse_v10 (FuFirmware *firmware, GBytes *fw, GError **
 					 error))
 		return FALSE;
 	g_debug ("v10 RmiFirmwareContainerDescriptor at 0x%x", cntr_addr);
-	if (!fu_memcpy_safe ((guint8 *) &desc, sizeof(desc), 0x0,	/* dst */
-			     data, sz, cntr_addr,			/* src */
-			     sizeof(desc), error)) {
+	if (!fu_struct_synaptics_rmi_container_descriptor_validate (data, sz, cntr_addr, error)) {
 		g_prefix_error (error, "RmiFirmwareContainerDescriptor invalid: ");
 		return FALSE;
 	}
-	container_id = GUINT16_FROM_LE(desc.container_id);
+	container_id = fu_struct_synaptics_rmi_container_descriptor_get_container_id (data + cntr_addr);
 	if (container_id != RMI_FIRMWARE_CONTAINER_ID_TOP_LEVEL) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -194,8 +176,8 @@ fu_synaptics_rmi_firmware_parse_v10 (FuFirmware *firmware, GBytes *fw, GError **
 			     (guint) RMI_FIRMWARE_CONTAINER_ID_TOP_LEVEL);
 		return FALSE;
 	}
-	offset = GUINT32_FROM_LE(desc.content_address);
-	if (offset > sz - sizeof(guint32) - sizeof(desc)) {
+	offset = fu_struct_synaptics_rmi_container_descriptor_get_content_address (data + cntr_addr);
+	if (offset > sz - sizeof(guint32) - FU_STRUCT_SYNAPTICS_RMI_CONTAINER_DESCRIPTOR_SIZE) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INVALID_FILE,
@@ -203,7 +185,7 @@ fu_synaptics_rmi_firmware_parse_v10 (FuFirmware *firmware, GBytes *fw, GError **
 			     (guint) offset, (guint) sz);
 		return FALSE;
 	}
-	cntrs_len = GUINT32_FROM_LE(desc.content_length) / 4;
+	cntrs_len = fu_struct_synaptics_rmi_container_descriptor_get_content_length (data + cntr_addr) / 4;
 	g_debug ("offset=0x%x (cntrs_len=%u)", offset, cntrs_len);
 
 	for (guint32 i = 0; i < cntrs_len; i++) {
@@ -214,13 +196,11 @@ fu_synaptics_rmi_firmware_parse_v10 (FuFirmware *firmware, GBytes *fw, GError **
 						 G_LITTLE_ENDIAN, error))
 			return FALSE;
 		g_debug ("parsing RmiFirmwareContainerDescriptor at 0x%x", addr);
-		if (!fu_memcpy_safe ((guint8 *) &desc, sizeof(desc), 0x0,	/* dst */
-				     data, sz, addr,				/* src */
-				     sizeof(desc), error))
+		if (!fu_struct_synaptics_rmi_container_descriptor_validate (data, sz, addr, error))
 			return FALSE;
-		container_id = GUINT16_FROM_LE(desc.container_id);
-		content_addr = GUINT32_FROM_LE(desc.content_address);
-		length = GUINT32_FROM_LE(desc.content_length);
+		container_id = fu_struct_synaptics_rmi_container_descriptor_get_container_id (data + addr);
+		content_addr = fu_struct_synaptics_rmi_container_descriptor_get_content_address (data + addr);
+		length = fu_struct_synaptics_rmi_container_descriptor_get_content_length (data + addr);
 		g_debug ("RmiFirmwareContainerDescriptor 0x%02x @ 0x%x (len 0x%x)",
 			 container_id, content_addr, length);
 		if (length == 0 || length > sz) {
@@ -471,17 +451,8 @@ fu_synaptics_rmi_firmware_generate_v10 (void)
 	GByteArray *buf = g_byte_array_new ();
 	/* header | desc_hdr | offset_table | desc | flash_config |
 	 *        \0x0       \0x20          \0x24  \0x44          |0x48 */
-	RmiFirmwareContainerDescriptor desc_hdr = {
-		.container_id =		GUINT16_TO_LE(RMI_FIRMWARE_CONTAINER_ID_TOP_LEVEL),
-		.content_length =	GUINT32_TO_LE(0x1 * 4),				/* size of offset table in bytes */
-		.content_address =	GUINT32_TO_LE(RMI_IMG_FW_OFFSET + 0x20),	/* offset to table */
-	};
-	guint32 offset_table[] = { RMI_IMG_FW_OFFSET + 0x24 };				/* offset to first RmiFirmwareContainerDescriptor */
-	RmiFirmwareContainerDescriptor desc = {
-		.container_id =		GUINT16_TO_LE(RMI_FIRMWARE_CONTAINER_ID_FLASH_CONFIG),
-		.content_length =	GUINT32_TO_LE(0x4),
-		.content_address =	GUINT32_TO_LE(RMI_IMG_FW_OFFSET + 0x44),
-	};
+	guint8 *desc_hdr;
+	guint8 *desc;
 
 	/* create empty block */
 	fu_byte_array_set_size (buf, RMI_IMG_FW_OFFSET + 0x48);
@@ -496,9 +467,16 @@ fu_synaptics_rmi_firmware_generate_v10 (void)
 	fu_common_write_uint32 (buf->data + RMI_IMG_V10_CNTR_ADDR_OFFSET, RMI_IMG_FW_OFFSET, G_LITTLE_ENDIAN);
 
 	/* hierarchical section */
-	memcpy (buf->data + RMI_IMG_FW_OFFSET + 0x00, &desc_hdr, sizeof(desc_hdr));
-	memcpy (buf->data + RMI_IMG_FW_OFFSET + 0x20, offset_table, sizeof(offset_table));
-	memcpy (buf->data + RMI_IMG_FW_OFFSET + 0x24, &desc, sizeof(desc));
+	desc_hdr = buf->data + RMI_IMG_FW_OFFSET + 0x00;
+	fu_struct_synaptics_rmi_container_descriptor_set_container_id (desc_hdr, RMI_FIRMWARE_CONTAINER_ID_TOP_LEVEL);
+	fu_struct_synaptics_rmi_container_descriptor_set_content_length (desc_hdr, 0x1 * 4);			/* size of offset table in bytes */
+	fu_struct_synaptics_rmi_container_descriptor_set_content_address (desc_hdr, RMI_IMG_FW_OFFSET + 0x20);	/* offset to table */
+	fu_common_write_uint32 (buf->data + RMI_IMG_FW_OFFSET + 0x20,
+				RMI_IMG_FW_OFFSET + 0x24, G_LITTLE_ENDIAN);	/* offset to first RmiFirmwareContainerDescriptor */
+	desc = buf->data + RMI_IMG_FW_OFFSET + 0x24;
+	fu_struct_synaptics_rmi_container_descriptor_set_container_id (desc, RMI_FIRMWARE_CONTAINER_ID_FLASH_CONFIG);
+	fu_struct_synaptics_rmi_container_descriptor_set_content_length (desc, 0x4);
+	fu_struct_synaptics_rmi_container_descriptor_set_content_address (desc, RMI_IMG_FW_OFFSET + 0x44);
 	fu_common_write_uint32 (buf->data + RMI_IMG_FW_OFFSET + 0x44, 0xfeed, G_LITTLE_ENDIAN);	/* flash_config */
 	fu_common_dump_full (G_LOG_DOMAIN, "v10", buf->data, buf->len,
 			     0x20, FU_DUMP_FLAGS_SHOW_ADDRESSES);
@@ -143,13 +143,10 @@ fu_efi_signature_parser_new (const guint8 *buf, gsize bufsz,
 				     (guint) bufsz);
 			return NULL;
 		}
-		for (gsize i = 0; i < bufsz - 5; i++) {
-			if (memcmp (buf + i, "\x26\x16\xc4\xc1\x4c", 5) == 0) {
-				g_debug ("found EFI_SIGNATURE_LIST @0x%x", (guint) i);
-				offset_fs = i;
-				break;
-			}
-		}
+		if (fu_memmem_safe (buf, bufsz,
+				    (const guint8 *) "\x26\x16\xc4\xc1\x4c", 5,
+				    &offset_fs, NULL))
+			g_debug ("found EFI_SIGNATURE_LIST @0x%x", (guint) offset_fs);
 	}
 
 	/* parse each EFI_SIGNATURE_LIST */
@@ -276,6 +276,38 @@ fu_vli_device_spi_read (FuVliDevice *self, guint32 address, gsize bufsz, GError
 	return g_bytes_new_take (g_steal_pointer (&buf), bufsz);
 }
 
+static gboolean
+fu_vli_device_read_region (FuDevice *device,
+			   guint32 address,
+			   guint8 *buf,
+			   gsize bufsz,
+			   GError **error)
+{
+	FuVliDevice *self = FU_VLI_DEVICE (device);
+	FuVliDeviceClass *klass = FU_VLI_DEVICE_GET_CLASS (self);
+	g_autoptr(GPtrArray) chunks = NULL;
+
+	/* not all SPI backends can read */
+	if (klass->spi_read_data == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "SPI read not supported");
+		return FALSE;
+	}
+	chunks = fu_chunk_array_new (buf, bufsz, address, 0x0, FU_VLI_DEVICE_TXSIZE);
+	for (guint i = 0; i < chunks->len; i++) {
+		FuChunk *chk = g_ptr_array_index (chunks, i);
+		if (!fu_vli_device_spi_read_block (self,
+						  chk->address,
+						  (guint8 *) chk->data,
+						  chk->data_sz,
+						  error))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 gboolean
 fu_vli_device_spi_write_block (FuVliDevice *self,
 			       guint32 address,
@@ -706,4 +738,5 @@ fu_vli_device_class_init (FuVliDeviceClass *klass)
 	klass_device->set_quirk_kv = fu_vli_device_set_quirk_kv;
 	klass_device->setup = fu_vli_device_setup;
 	klass_device->report_metadata_pre = fu_vli_device_report_metadata_pre;
+	klass_device->read_region = fu_vli_device_read_region;
 }
@@ -9,6 +9,8 @@
 
 #include <string.h>
 
+#include "fu-chunk.h"
+
 #include "fu-vli-pd-common.h"
 #include "fu-vli-pd-firmware.h"
 
@@ -195,10 +197,10 @@ fu_vli_usbhub_pd_device_write_firmware (FuDevice *device,
 {
 	FuVliUsbhubPdDevice *self = FU_VLI_USBHUB_PD_DEVICE (device);
 	FuVliUsbhubDevice *parent = FU_VLI_USBHUB_DEVICE (fu_device_get_parent (device));
-	gsize bufsz = 0;
-	const guint8 *buf;
 	g_autoptr(FuDeviceLocker) locker = NULL;
 	g_autoptr(GBytes) fw = NULL;
+	g_autoptr(GPtrArray) chunks = NULL;
+	g_autoptr(GPtrArray) chunks_changed = NULL;
 
 	/* simple image */
 	fw = fu_firmware_get_image_default_bytes (firmware, error);
@@ -210,20 +212,29 @@ fu_vli_usbhub_pd_device_write_firmware (FuDevice *device,
 	if (locker == NULL)
 		return FALSE;
 
-	/* erase */
-	fu_device_set_status (device, FWUPD_STATUS_DEVICE_ERASE);
-	buf = g_bytes_get_data (fw, &bufsz);
-	if (!fu_vli_device_spi_erase (FU_VLI_DEVICE (parent),
-				      fu_vli_common_device_kind_get_offset (self->device_kind),
-				      bufsz, error))
+	/* only erase and write the sectors that are different */
+	chunks = fu_chunk_array_new_from_bytes (fw,
+						fu_vli_common_device_kind_get_offset (self->device_kind),
+						0x0, 0x1000);
+	chunks_changed = fu_device_get_changed_chunks (FU_DEVICE (parent), chunks, flags, error);
+	if (chunks_changed == NULL)
 		return FALSE;
 
-	/* write */
-	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	if (!fu_vli_device_spi_write (FU_VLI_DEVICE (parent),
-				      fu_vli_common_device_kind_get_offset (self->device_kind),
-				      buf, bufsz, error))
-		return FALSE;
+	/* the first sector has the CRC block, so write that last */
+	for (guint i = chunks_changed->len; i > 0; i--) {
+		FuChunk *chk = g_ptr_array_index (chunks_changed, i - 1);
+		fu_device_set_status (device, FWUPD_STATUS_DEVICE_ERASE);
+		if (!fu_vli_device_spi_erase (FU_VLI_DEVICE (parent),
+					      chk->address, chk->data_sz,
+					      error))
+			return FALSE;
+		fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
+		if (!fu_vli_device_spi_write (FU_VLI_DEVICE (parent),
+					      chk->address,
+					      chk->data, chk->data_sz,
+					      error))
+			return FALSE;
+	}
 
 	/* success */
 	return TRUE;
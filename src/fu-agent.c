@@ -35,32 +35,34 @@ static gboolean
 fu_util_add_devices_json (FuUtilPrivate *priv, JsonBuilder *builder, GError **error)
 {
 	g_autoptr(GPtrArray) devs = NULL;
+	g_autoptr(GPtrArray) device_ids = g_ptr_array_new ();
+	g_autoptr(GPtrArray) rels_all = NULL;
 
 	/* get results from daemon */
 	devs = fwupd_client_get_devices (priv->client, priv->cancellable, error);
 	if (devs == NULL)
 		return FALSE;
 
+	/* get all releases that could be applied in one go */
+	for (guint i = 0; i < devs->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devs, i);
+		g_ptr_array_add (device_ids, (gpointer) fwupd_device_get_id (dev));
+	}
+	rels_all = fwupd_client_get_releases_batch (priv->client, device_ids,
+						    priv->cancellable, error);
+	if (rels_all == NULL)
+		return FALSE;
+
 	json_builder_set_member_name (builder, "Devices");
 	json_builder_begin_array (builder);
 	for (guint i = 0; i < devs->len; i++) {
 		FwupdDevice *dev = g_ptr_array_index (devs, i);
-		g_autoptr(GPtrArray) rels = NULL;
-		g_autoptr(GError) error_local = NULL;
+		GPtrArray *rels = g_ptr_array_index (rels_all, i);
 
 		/* add all releases that could be applied */
-		rels = fwupd_client_get_releases (priv->client,
-						  fwupd_device_get_id (dev),
-						  priv->cancellable,
-						  &error_local);
-		if (rels == NULL) {
-			g_debug ("not adding releases to device: %s",
-				 error_local->message);
-		} else {
-			for (guint j = 0; j < rels->len; j++) {
-				FwupdRelease *rel = g_ptr_array_index (rels, j);
-				fwupd_device_add_release (dev, rel);
-			}
+		for (guint j = 0; j < rels->len; j++) {
+			FwupdRelease *rel = g_ptr_array_index (rels, j);
+			fwupd_device_add_release (dev, rel);
 		}
 
 		/* add to builder */
@@ -76,28 +78,37 @@ static gboolean
 fu_util_add_updates_json (FuUtilPrivate *priv, JsonBuilder *builder, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_supported = g_ptr_array_new ();
+	g_autoptr(GPtrArray) device_ids = g_ptr_array_new ();
+	g_autoptr(GPtrArray) rels_all = NULL;
 
 	/* get devices from daemon */
 	devices = fwupd_client_get_devices (priv->client, NULL, error);
 	if (devices == NULL)
 		return FALSE;
-	json_builder_set_member_name (builder, "Devices");
-	json_builder_begin_array (builder);
 	for (guint i = 0; i < devices->len; i++) {
 		FwupdDevice *dev = g_ptr_array_index (devices, i);
-		g_autoptr(GPtrArray) rels = NULL;
-		g_autoptr(GError) error_local = NULL;
 
 		/* not going to have results, so save a D-Bus round-trip */
 		if (!fwupd_device_has_flag (dev, FWUPD_DEVICE_FLAG_SUPPORTED))
 			continue;
+		g_ptr_array_add (devices_supported, dev);
+		g_ptr_array_add (device_ids, (gpointer) fwupd_device_get_id (dev));
+	}
+
+	/* get the releases for all devices */
+	rels_all = fwupd_client_get_upgrades_batch (priv->client, device_ids, NULL, error);
+	if (rels_all == NULL)
+		return FALSE;
+
+	json_builder_set_member_name (builder, "Devices");
+	json_builder_begin_array (builder);
+	for (guint i = 0; i < devices_supported->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices_supported, i);
+		GPtrArray *rels = g_ptr_array_index (rels_all, i);
 
-		/* get the releases for this device and filter for validity */
-		rels = fwupd_client_get_upgrades (priv->client,
-						  fwupd_device_get_id (dev),
-						  NULL, &error_local);
-		if (rels == NULL) {
-			g_debug ("no upgrades: %s", error_local->message);
+		if (rels->len == 0) {
+			g_debug ("no upgrades for %s", fwupd_device_get_id (dev));
 			continue;
 		}
 		for (guint j = 0; j < rels->len; j++) {
@@ -813,6 +813,59 @@ fu_device_list_devices_wait_removed (FuDeviceList *self)
 	return cnt;
 }
 
+typedef struct {
+	FuDeviceList		*self;		/* no ref */
+	FuDevice		*device;	/* no ref */
+	GMainLoop		*loop;
+	guint			 timeout_id;
+} FuDeviceListReplugHelper;
+
+/* the device we are waiting for may have been replaced by a new #FuDevice,
+ * so look for it as either the active or the old device in the item */
+static gboolean
+fu_device_list_replug_helper_done (FuDeviceListReplugHelper *helper)
+{
+	FuDeviceItem *item = fu_device_list_find_by_device (helper->self, helper->device);
+	if (item != NULL &&
+	    fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG))
+		return FALSE;
+	return fu_device_list_devices_wait_removed (helper->self) == 0;
+}
+
+static void
+fu_device_list_replug_helper_check (FuDeviceListReplugHelper *helper)
+{
+	if (!fu_device_list_replug_helper_done (helper))
+		return;
+	g_debug ("device replugged, no longer waiting");
+	g_main_loop_quit (helper->loop);
+}
+
+static void
+fu_device_list_replug_changed_cb (FuDeviceList *self,
+				  FuDevice *device,
+				  FuDeviceListReplugHelper *helper)
+{
+	fu_device_list_replug_helper_check (helper);
+}
+
+static void
+fu_device_list_replug_notify_flags_cb (FuDevice *device,
+				       GParamSpec *pspec,
+				       FuDeviceListReplugHelper *helper)
+{
+	fu_device_list_replug_helper_check (helper);
+}
+
+static gboolean
+fu_device_list_replug_timeout_cb (gpointer user_data)
+{
+	FuDeviceListReplugHelper *helper = (FuDeviceListReplugHelper *) user_data;
+	helper->timeout_id = 0;
+	g_main_loop_quit (helper->loop);
+	return G_SOURCE_REMOVE;
+}
+
 /**
  * fu_device_list_wait_for_replug:
  * @self: A #FuDeviceList
@@ -822,6 +875,10 @@ fu_device_list_devices_wait_removed (FuDeviceList *self)
  * Waits for a specific device to replug if %FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG
  * is set.
  *
+ * This function returns as soon as the device has been added back to the list
+ * and no other devices are waiting to be removed; the device remove-delay is
+ * only used as an upper bound.
+ *
  * If the device does not exist this function returns without an error.
  *
  * Returns: %TRUE for success
@@ -832,9 +889,12 @@ gboolean
 fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **error)
 {
 	FuDeviceItem *item;
+	FuDeviceListReplugHelper helper = { NULL };
 	guint remove_delay;
-	guint wait_removed;
-	guint wait_removed_old = 0;
+	gulong changed_id;
+	gulong removed_id;
+	gulong notify_id;
+	g_autoptr(GMainLoop) loop = NULL;
 	g_autoptr(GTimer) timer = g_timer_new ();
 
 	g_return_val_if_fail (FU_IS_DEVICE_LIST (self), FALSE);
@@ -874,26 +934,45 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 			   fu_device_get_id (device),
 			   remove_delay);
 	} else {
-		g_debug ("waiting %ums for replug", remove_delay);
+		g_debug ("waiting up to %ums for replug", remove_delay);
 	}
 
-	/* time to unplug and then re-plug */
-	do {
-		/* count how many devices are in the remove waiting state */
-		wait_removed = fu_device_list_devices_wait_removed (self);
-		if (wait_removed != wait_removed_old) {
-			g_debug ("devices in wait_removed: %u -> %u",
-				 wait_removed_old, wait_removed);
-			wait_removed_old = wait_removed;
-		}
-		g_usleep (1000);
-		g_main_context_iteration (NULL, FALSE);
-		if (!fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
-		    wait_removed == 0)
-			break;
-	} while (g_timer_elapsed (timer, NULL) * 1000.f < remove_delay);
+	/* time to unplug and then re-plug, waking up as soon as the device is
+	 * added back rather than waiting for the whole remove-delay */
+	loop = g_main_loop_new (NULL, FALSE);
+	helper.self = self;
+	helper.device = device;
+	helper.loop = loop;
+	changed_id = g_signal_connect (self, "changed",
+				       G_CALLBACK (fu_device_list_replug_changed_cb),
+				       &helper);
+	removed_id = g_signal_connect (self, "removed",
+				       G_CALLBACK (fu_device_list_replug_changed_cb),
+				       &helper);
+	notify_id = g_signal_connect (device, "notify::flags",
+				      G_CALLBACK (fu_device_list_replug_notify_flags_cb),
+				      &helper);
+	helper.timeout_id = g_timeout_add (remove_delay,
+					   fu_device_list_replug_timeout_cb,
+					   &helper);
+	if (!fu_device_list_replug_helper_done (&helper))
+		g_main_loop_run (loop);
+	if (helper.timeout_id != 0)
+		g_source_remove (helper.timeout_id);
+	g_signal_handler_disconnect (self, changed_id);
+	g_signal_handler_disconnect (self, removed_id);
+	g_signal_handler_disconnect (device, notify_id);
 
 	/* device was not added back to the device list */
+	item = fu_device_list_find_by_device (self, device);
+	if (item == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "device %s was removed",
+			     fu_device_get_id (device));
+		return FALSE;
+	}
 	if (fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -915,7 +994,7 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 	}
 
 	/* the loop was quit without the timer */
-	g_debug ("waited for replug");
+	g_debug ("waited %.0fms for replug", g_timer_elapsed (timer, NULL) * 1000.f);
 	return TRUE;
 }
 
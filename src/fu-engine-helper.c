@@ -9,6 +9,7 @@
 #include "config.h"
 
 #include <glib/gi18n.h>
+#include <string.h>
 
 #include "fu-engine.h"
 #include "fu-engine-helper.h"
@@ -81,3 +82,298 @@ fu_engine_update_motd (FuEngine *self, GError **error)
 	return g_file_set_contents (target, str->str, str->len, error);
 }
 
+
+/**
+ * fu_engine_metadata_decompress:
+ * @blob: metadata, which may be gzip compressed
+ * @size_max: the maximum size of the decompressed metadata
+ * @error: A #GError, or %NULL
+ *
+ * Decompresses metadata if it has the gzip header, otherwise returns @blob.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ **/
+GBytes *
+fu_engine_metadata_decompress (GBytes *blob, gsize size_max, GError **error)
+{
+	const guint8 *buf;
+	gsize bufsz = 0;
+	gsize tmpsz = 32 * 1024;
+	g_autofree guint8 *tmp = NULL;
+	g_autoptr(GByteArray) buf_out = g_byte_array_new ();
+	g_autoptr(GConverter) conv = NULL;
+	g_autoptr(GInputStream) istream = NULL;
+	g_autoptr(GInputStream) istream_raw = NULL;
+
+	buf = g_bytes_get_data (blob, &bufsz);
+	if (bufsz < 2 || buf[0] != 0x1f || buf[1] != 0x8b)
+		return g_bytes_ref (blob);
+	istream_raw = g_memory_input_stream_new_from_bytes (blob);
+	conv = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+	istream = g_converter_input_stream_new (istream_raw, conv);
+
+	/* do not trust the size in the gzip trailer */
+	tmp = g_malloc (tmpsz);
+	while (TRUE) {
+		gssize sz = g_input_stream_read (istream, tmp, tmpsz, NULL, error);
+		if (sz < 0) {
+			g_prefix_error (error, "failed to decompress metadata: ");
+			return NULL;
+		}
+		if (sz == 0)
+			break;
+		if ((gsize) sz > size_max - buf_out->len) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "decompressed metadata larger than 0x%x bytes",
+				     (guint) size_max);
+			return NULL;
+		}
+		g_byte_array_append (buf_out, tmp, sz);
+	}
+	return g_byte_array_free_to_bytes (g_steal_pointer (&buf_out));
+}
+
+/**
+ * fu_engine_metadata_compress:
+ * @blob: uncompressed metadata
+ * @error: A #GError, or %NULL
+ *
+ * Compresses metadata using gzip.
+ *
+ * Returns: (transfer full): a #GBytes, or %NULL on error
+ **/
+GBytes *
+fu_engine_metadata_compress (GBytes *blob, GError **error)
+{
+	g_autoptr(GConverter) conv = NULL;
+	g_autoptr(GInputStream) istream = NULL;
+	g_autoptr(GOutputStream) ostream = NULL;
+	g_autoptr(GOutputStream) ostream_raw = NULL;
+
+	istream = g_memory_input_stream_new_from_bytes (blob);
+	conv = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+	ostream_raw = g_memory_output_stream_new_resizable ();
+	ostream = g_converter_output_stream_new (ostream_raw, conv);
+	if (g_output_stream_splice (ostream, istream,
+				    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+				    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				    NULL, error) < 0) {
+		g_prefix_error (error, "failed to compress metadata: ");
+		return NULL;
+	}
+	return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream_raw));
+}
+
+static void
+fu_engine_metadata_root_start_cb (GMarkupParseContext *context,
+				  const gchar *element_name,
+				  const gchar **attribute_names,
+				  const gchar **attribute_values,
+				  gpointer user_data,
+				  GError **error)
+{
+	gboolean *is_delta = (gboolean *) user_data;
+	if (g_strcmp0 (element_name, "delta") == 0) {
+		for (guint i = 0; attribute_names[i] != NULL; i++) {
+			if (g_strcmp0 (attribute_names[i], "base") == 0 &&
+			    strlen (attribute_values[i]) == 64) {
+				*is_delta = TRUE;
+				break;
+			}
+		}
+	}
+
+	/* only the root element is interesting */
+	g_set_error_literal (error,
+			     G_MARKUP_ERROR,
+			     G_MARKUP_ERROR_INVALID_CONTENT,
+			     "root element parsed");
+}
+
+/**
+ * fu_engine_metadata_is_delta:
+ * @blob: metadata
+ *
+ * Checks if the metadata is a delta rather than a complete document, i.e. it is
+ * uncompressed XML where the root element is `<delta>` with a SHA256 `base`
+ * attribute. Parsing stops after the root element.
+ *
+ * Returns: %TRUE if a delta
+ **/
+gboolean
+fu_engine_metadata_is_delta (GBytes *blob)
+{
+	GMarkupParser parser = { fu_engine_metadata_root_start_cb, NULL, NULL, NULL, NULL };
+	gboolean is_delta = FALSE;
+	gsize bufsz = 0;
+	const gchar *buf = g_bytes_get_data (blob, &bufsz);
+	g_autoptr(GMarkupParseContext) ctx = NULL;
+
+	ctx = g_markup_parse_context_new (&parser, 0, &is_delta, NULL);
+	if (!g_markup_parse_context_parse (ctx, buf, bufsz, NULL))
+		return is_delta;
+	return FALSE;
+}
+
+/* finds the next <component> element, ignoring <components> */
+static gboolean
+fu_engine_metadata_find_component (const gchar *buf,
+				   gsize bufsz,
+				   gsize offset,
+				   gsize *start,
+				   gsize *end)
+{
+	while (offset < bufsz) {
+		const gchar *tmp;
+		const gchar *tmp_end;
+
+		tmp = g_strstr_len (buf + offset, bufsz - offset, "<component");
+		if (tmp == NULL)
+			return FALSE;
+		offset = (tmp - buf) + strlen ("<component");
+		if (offset >= bufsz)
+			return FALSE;
+		if (buf[offset] != ' ' && buf[offset] != '>')
+			continue;
+		tmp_end = g_strstr_len (buf + offset, bufsz - offset, "</component>");
+		if (tmp_end == NULL)
+			return FALSE;
+		*start = tmp - buf;
+		*end = (tmp_end - buf) + strlen ("</component>");
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static gchar *
+fu_engine_metadata_find_text (const gchar *buf,
+			      gsize bufsz,
+			      gsize *offset,
+			      const gchar *prefix,
+			      const gchar *suffix)
+{
+	const gchar *start;
+	const gchar *end;
+
+	start = g_strstr_len (buf + *offset, bufsz - *offset, prefix);
+	if (start == NULL)
+		return NULL;
+	start += strlen (prefix);
+	end = g_strstr_len (start, bufsz - (start - buf), suffix);
+	if (end == NULL)
+		return NULL;
+	*offset = (end - buf) + strlen (suffix);
+	return g_strndup (start, end - start);
+}
+
+/**
+ * fu_engine_metadata_apply_delta:
+ * @metadata: the existing uncompressed metadata
+ * @delta: the delta document
+ * @error: A #GError, or %NULL
+ *
+ * Applies a delta published by the remote to the existing metadata.
+ *
+ * The delta has a `base` attribute with the SHA256 checksum of the document it
+ * applies to, zero or more `<remove>` elements with the ID of a component to
+ * remove, and zero or more complete `<component>` elements to add. Remaining
+ * components keep their order and the new components are appended, separated
+ * by the whitespace that followed the first component in the existing
+ * metadata, so that the result is identical to the document the remote
+ * signed.
+ *
+ * Returns: (transfer full): the new uncompressed metadata, or %NULL on error
+ **/
+GBytes *
+fu_engine_metadata_apply_delta (GBytes *metadata, GBytes *delta, GError **error)
+{
+	const gchar *buf;
+	const gchar *dbuf;
+	const gchar *sep = "\n";
+	gboolean first = TRUE;
+	gsize bufsz = 0;
+	gsize dbufsz = 0;
+	gsize end = 0;
+	gsize last_end = 0;
+	gsize offset = 0;
+	gsize sepsz = 1;
+	gsize start = 0;
+	gchar *id_tmp;
+	g_autofree gchar *base = NULL;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(GHashTable) removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	buf = g_bytes_get_data (metadata, &bufsz);
+	dbuf = g_bytes_get_data (delta, &dbufsz);
+
+	/* check this applies to the metadata we have */
+	base = fu_engine_metadata_find_text (dbuf, dbufsz, &offset, "base=\"", "\"");
+	if (base == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "delta has no base checksum");
+		return NULL;
+	}
+	checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, metadata);
+	if (g_strcmp0 (base, checksum) != 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "delta base %s does not match %s",
+			     base, checksum);
+		return NULL;
+	}
+
+	/* get the IDs of the removed components */
+	while ((id_tmp = fu_engine_metadata_find_text (dbuf, dbufsz, &offset,
+						       "<remove>", "</remove>")) != NULL)
+		g_hash_table_add (removed, id_tmp);
+
+	/* keep the header, and use the same separator between components */
+	if (!fu_engine_metadata_find_component (buf, bufsz, 0, &start, &end)) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "metadata has no components");
+		return NULL;
+	}
+	g_string_append_len (str, buf, start);
+	offset = end;
+	if (fu_engine_metadata_find_component (buf, bufsz, end, &start, &end)) {
+		sep = buf + offset;
+		sepsz = start - offset;
+	}
+
+	/* existing components */
+	offset = 0;
+	while (fu_engine_metadata_find_component (buf, bufsz, offset, &start, &end)) {
+		gsize id_offset = start;
+		g_autofree gchar *id = NULL;
+		offset = last_end = end;
+		id = fu_engine_metadata_find_text (buf, end, &id_offset, "<id>", "</id>");
+		if (id != NULL && g_hash_table_contains (removed, id))
+			continue;
+		if (!first)
+			g_string_append_len (str, sep, sepsz);
+		g_string_append_len (str, buf + start, end - start);
+		first = FALSE;
+	}
+
+	/* new components */
+	offset = 0;
+	while (fu_engine_metadata_find_component (dbuf, dbufsz, offset, &start, &end)) {
+		offset = end;
+		if (!first)
+			g_string_append_len (str, sep, sepsz);
+		g_string_append_len (str, dbuf + start, end - start);
+		first = FALSE;
+	}
+
+	/* footer */
+	g_string_append_len (str, buf + last_end, bufsz - last_end);
+	return g_string_free_to_bytes (g_steal_pointer (&str));
+}
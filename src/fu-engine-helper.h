@@ -7,5 +7,17 @@
 
 #include "fu-engine.h"
 
-gboolean	fu_engine_update_motd		(FuEngine	*self,
+/* the LVFS metadata is currently ~15MB when decompressed */
+#define FU_ENGINE_METADATA_SIZE_MAX			(128 * 1024 * 1024)
+
+gboolean	 fu_engine_update_motd		(FuEngine	*self,
+						 GError		**error);
+GBytes		*fu_engine_metadata_decompress	(GBytes		*blob,
+						 gsize		 size_max,
+						 GError		**error);
+GBytes		*fu_engine_metadata_compress	(GBytes		*blob,
+						 GError		**error);
+gboolean	 fu_engine_metadata_is_delta	(GBytes		*blob);
+GBytes		*fu_engine_metadata_apply_delta	(GBytes		*metadata,
+						 GBytes		*delta,
 						 GError		**error);
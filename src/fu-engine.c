@@ -105,6 +105,7 @@ struct _FuEngine
 	GHashTable		*approved_firmware;	/* (nullable) */
 	GHashTable		*blocked_firmware;	/* (nullable) */
 	GHashTable		*firmware_gtypes;
+	GHashTable		*firmware_cache;	/* key:FuFirmware */
 	gchar			*host_machine_id;
 	JcatContext		*jcat_context;
 	gboolean		 loaded;
@@ -1811,6 +1812,7 @@ fu_engine_install_tasks (FuEngine *self,
 		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
 		if (!fu_engine_install (self, task, blob_cab, flags, error)) {
 			g_autoptr(GError) error_local = NULL;
+			g_hash_table_remove_all (self->firmware_cache);
 			if (!fu_engine_composite_cleanup (self, devices, &error_local)) {
 				g_warning ("failed to cleanup failed composite action: %s",
 					   error_local->message);
@@ -1819,6 +1821,9 @@ fu_engine_install_tasks (FuEngine *self,
 		}
 	}
 
+	/* the prepared firmware is shared by all the devices in this batch */
+	g_hash_table_remove_all (self->firmware_cache);
+
 	/* set all the device statuses back to unknown */
 	for (guint i = 0; i < install_tasks->len; i++) {
 		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
@@ -2065,6 +2070,73 @@ fu_engine_schedule_update (FuEngine *self,
 	return fu_engine_offline_setup (error);
 }
 
+/* reads the firmware from the device, and patches it to the new version */
+static GBytes *
+fu_engine_apply_firmware_delta (FuEngine *self,
+				FuDevice *device,
+				XbNode *rel,
+				GBytes *blob_delta,
+				FwupdInstallFlags flags,
+				GError **error)
+{
+	const gchar *csum_src;
+	const gchar *csum_dst;
+	g_autofree gchar *checksum = NULL;
+	g_autoptr(GBytes) blob_old = NULL;
+	g_autoptr(GBytes) blob_new = NULL;
+	g_autoptr(GChecksum) csum = NULL;
+	g_autoptr(GOutputStream) ostream = g_memory_output_stream_new_resizable ();
+
+	/* verified as present in FuCabinet */
+	csum_src = xb_node_query_attr (rel, "delta", "source", NULL);
+	csum_dst = xb_node_query_text (rel, "checksum[@target='content']", NULL);
+	if (csum_src == NULL || csum_dst == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "delta has no source or content checksum");
+		return NULL;
+	}
+
+	/* the delta only applies to one specific version */
+	csum = g_checksum_new (fwupd_checksum_guess_kind (csum_src));
+	if (!fu_engine_firmware_dump (self, device, ostream, csum, flags, error)) {
+		g_prefix_error (error, "failed to read firmware for delta: ");
+		return NULL;
+	}
+	if (!g_output_stream_close (ostream, NULL, error))
+		return NULL;
+	if (g_strcmp0 (g_checksum_get_string (csum), csum_src) != 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "delta requires device firmware %s, got %s",
+			     csum_src, g_checksum_get_string (csum));
+		return NULL;
+	}
+	blob_old = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+	blob_new = fu_common_bytes_patch (blob_old, blob_delta, error);
+	if (blob_new == NULL) {
+		g_prefix_error (error, "failed to apply delta: ");
+		return NULL;
+	}
+
+	/* check we got exactly what was signed */
+	checksum = g_compute_checksum_for_bytes (fwupd_checksum_guess_kind (csum_dst),
+						 blob_new);
+	if (g_strcmp0 (checksum, csum_dst) != 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "reconstructed checksum invalid, expected %s, got %s",
+			     csum_dst, checksum);
+		return NULL;
+	}
+	g_debug ("reconstructed %" G_GSIZE_FORMAT " bytes from %" G_GSIZE_FORMAT " byte delta",
+		 g_bytes_get_size (blob_new), g_bytes_get_size (blob_delta));
+	return g_steal_pointer (&blob_new);
+}
+
 static gboolean
 fu_engine_install_release (FuEngine *self,
 			   FuDevice *device_orig,
@@ -2082,16 +2154,26 @@ fu_engine_install_release (FuEngine *self,
 	g_autoptr(FuDevice) device_tmp = NULL;
 	g_autoptr(FuDevice) device = g_object_ref (device_orig);
 	g_autoptr(GBytes) blob_fw2 = NULL;
+	g_autoptr(GBytes) blob_fw_delta = NULL;
 	g_autoptr(GError) error_local = NULL;
 
-	/* get per-release firmware blob */
+	/* get per-release firmware blob, or reconstruct it from a delta */
 	blob_fw = xb_node_get_data (rel, "fwupd::FirmwareBlob");
 	if (blob_fw == NULL) {
-		g_set_error_literal (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INTERNAL,
-				     "Failed to get firmware blob from release");
-		return FALSE;
+		GBytes *blob_delta = xb_node_get_data (rel, "fwupd::FirmwareDelta");
+		if (blob_delta == NULL) {
+			g_set_error_literal (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INTERNAL,
+					     "Failed to get firmware blob from release");
+			return FALSE;
+		}
+		blob_fw_delta = fu_engine_apply_firmware_delta (self, device, rel,
+								 blob_delta, flags,
+								 error);
+		if (blob_fw_delta == NULL)
+			return FALSE;
+		blob_fw = blob_fw_delta;
 	}
 
 	/* use a bubblewrap helper script to build the firmware */
@@ -2770,9 +2852,11 @@ fu_engine_update (FuEngine *self,
 	return TRUE;
 }
 
-GBytes *
+gboolean
 fu_engine_firmware_dump (FuEngine *self,
 			 FuDevice *device,
+			 GOutputStream *stream,
+			 GChecksum *checksum,
 			 FwupdInstallFlags flags,
 			 GError **error)
 {
@@ -2782,9 +2866,9 @@ fu_engine_firmware_dump (FuEngine *self,
 	locker = fu_device_locker_new (device, error);
 	if (locker == NULL) {
 		g_prefix_error (error, "failed to open device for firmware read: ");
-		return NULL;
+		return FALSE;
 	}
-	return fu_device_dump_firmware (device, error);
+	return fu_device_dump_firmware_to_stream (device, stream, checksum, error);
 }
 
 gboolean
@@ -3450,6 +3534,20 @@ fu_engine_get_system_jcat_result (FuEngine *self, FwupdRemote *remote, GError **
 	jcat_item = jcat_file_get_item_default (jcat_file, error);
 	if (jcat_item == NULL)
 		return NULL;
+
+	/* metadata reconstructed from a delta is saved compressed, but the
+	 * signature covers the uncompressed document */
+	if (g_str_has_suffix (fwupd_remote_get_filename_cache (remote), ".gz") &&
+	    !g_str_has_suffix (jcat_item_get_id (jcat_item), ".gz")) {
+		GBytes *blob_tmp;
+		blob_tmp = fu_engine_metadata_decompress (blob,
+							  FU_ENGINE_METADATA_SIZE_MAX,
+							  error);
+		if (blob_tmp == NULL)
+			return NULL;
+		g_bytes_unref (blob);
+		blob = blob_tmp;
+	}
 	results = jcat_context_verify_item (self->jcat_context,
 					    blob, jcat_item,
 					    JCAT_VERIFY_FLAG_REQUIRE_CHECKSUM |
@@ -3507,6 +3605,10 @@ fu_engine_validate_result_timestamp (JcatResult *jcat_result,
  *
  * Updates the metadata for a specific remote.
  *
+ * If @bytes_raw is a delta then it is applied to the existing metadata for the
+ * remote and @bytes_sig has to be a Jcat file signing the reconstructed
+ * uncompressed metadata.
+ *
  * Returns: %TRUE for success
  **/
 gboolean
@@ -3516,6 +3618,8 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 	FwupdKeyringKind keyring_kind;
 	FwupdRemote *remote;
 	JcatVerifyFlags jcat_flags = JCAT_VERIFY_FLAG_REQUIRE_SIGNATURE;
+	g_autoptr(GBytes) bytes_md = g_bytes_ref (bytes_raw);
+	g_autoptr(GBytes) bytes_verify = g_bytes_ref (bytes_raw);
 	g_autoptr(JcatFile) jcat_file = jcat_file_new ();
 
 	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
@@ -3565,6 +3669,49 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 		jcat_file_add_item (jcat_file, jcat_item);
 	}
 
+	/* reconstruct the new metadata from the existing metadata and a delta */
+	if (fu_engine_metadata_is_delta (bytes_raw)) {
+		const gchar *fn_cache = fwupd_remote_get_filename_cache (remote);
+		g_autoptr(GBytes) blob_old = NULL;
+		g_autoptr(GBytes) blob_old_uncompressed = NULL;
+		g_autoptr(GBytes) blob_new = NULL;
+
+		if (keyring_kind != FWUPD_KEYRING_KIND_JCAT) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "metadata delta requires a jcat keyring for %s",
+				     remote_id);
+			return FALSE;
+		}
+		blob_old = fu_common_get_contents_bytes (fn_cache, error);
+		if (blob_old == NULL)
+			return FALSE;
+		blob_old_uncompressed = fu_engine_metadata_decompress (blob_old,
+								       FU_ENGINE_METADATA_SIZE_MAX,
+								       error);
+		if (blob_old_uncompressed == NULL)
+			return FALSE;
+		blob_new = fu_engine_metadata_apply_delta (blob_old_uncompressed,
+							   bytes_raw, error);
+		if (blob_new == NULL) {
+			g_prefix_error (error, "failed to apply delta for %s: ", remote_id);
+			return FALSE;
+		}
+
+		/* the signature covers the uncompressed document */
+		g_bytes_unref (bytes_verify);
+		bytes_verify = g_bytes_ref (blob_new);
+		g_bytes_unref (bytes_md);
+		if (g_str_has_suffix (fn_cache, ".gz")) {
+			bytes_md = fu_engine_metadata_compress (blob_new, error);
+			if (bytes_md == NULL)
+				return FALSE;
+		} else {
+			bytes_md = g_steal_pointer (&blob_new);
+		}
+	}
+
 	/* verify file */
 	if (keyring_kind != FWUPD_KEYRING_KIND_NONE) {
 		g_autoptr(GError) error_local = NULL;
@@ -3578,7 +3725,7 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 		if (jcat_item == NULL)
 			return FALSE;
 		results = jcat_context_verify_item (self->jcat_context,
-						    bytes_raw, jcat_item,
+						    bytes_verify, jcat_item,
 						    jcat_flags, error);
 		if (results == NULL)
 			return FALSE;
@@ -3611,7 +3758,7 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 
 	/* save XML and signature to remotes.d */
 	if (!fu_common_set_contents_bytes (fwupd_remote_get_filename_cache (remote),
-					   bytes_raw, error))
+					   bytes_md, error))
 		return FALSE;
 	if (keyring_kind != FWUPD_KEYRING_KIND_NONE) {
 		if (!fu_common_set_contents_bytes (fwupd_remote_get_filename_cache_sig (remote),
@@ -5278,6 +5425,9 @@ fu_engine_add_device (FuEngine *self, FuDevice *device)
 		}
 	}
 
+	/* cache prepared firmware for the duration of a write */
+	fu_device_set_firmware_cache (device, self->firmware_cache);
+
 	/* adopt any required children, which may or may not already exist */
 	fu_engine_adopt_children (self, device);
 
@@ -6582,6 +6732,8 @@ fu_engine_init (FuEngine *self)
 	self->runtime_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->compile_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->firmware_gtypes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->firmware_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+						      g_free, (GDestroyNotify) g_object_unref);
 
 	g_signal_connect (self->config, "changed",
 			  G_CALLBACK (fu_engine_config_changed_cb),
@@ -6673,6 +6825,7 @@ fu_engine_finalize (GObject *obj)
 	g_hash_table_unref (self->runtime_versions);
 	g_hash_table_unref (self->compile_versions);
 	g_hash_table_unref (self->firmware_gtypes);
+	g_hash_table_unref (self->firmware_cache);
 	g_object_unref (self->plugin_list);
 
 	G_OBJECT_CLASS (fu_engine_parent_class)->finalize (obj);
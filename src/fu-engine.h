@@ -118,8 +118,10 @@ gboolean	 fu_engine_verify			(FuEngine	*self,
 gboolean	 fu_engine_verify_update		(FuEngine	*self,
 							 const gchar	*device_id,
 							 GError		**error);
-GBytes		*fu_engine_firmware_dump		(FuEngine	*self,
+gboolean	 fu_engine_firmware_dump		(FuEngine	*self,
 							 FuDevice	*device,
+							 GOutputStream	*stream,
+							 GChecksum	*checksum,
 							 FwupdInstallFlags flags,
 							 GError		**error);
 gboolean	 fu_engine_modify_remote		(FuEngine	*self,
@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#include "config.h"
+
+#include <glib/gi18n.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fu-engine.h"
+
+typedef struct {
+	gboolean	 verbose;
+	gint		 duration;	/* ms */
+	gint		 size;		/* KiB */
+	gchar		*type;
+	GPtrArray	*inputs;	/* element-type FuFirmwareBenchInput */
+	FuEngine	*engine;
+} FuUtil;
+
+typedef struct {
+	gchar		*name;
+	GBytes		*blob;
+} FuFirmwareBenchInput;
+
+typedef struct {
+	guint		 iterations;
+	gdouble		 elapsed;	/* s */
+	gsize		 bufsz;		/* bytes processed per iteration */
+	guint		 allocs;
+	gsize		 alloc_sz;
+	guint64		 peak_rss;	/* KiB */
+} FuFirmwareBenchResult;
+
+typedef gboolean (*FuFirmwareBenchFunc)	(GType		 gtype,
+					 GBytes		*blob,
+					 FuFirmware	*firmware,
+					 gsize		*bufsz,
+					 GError		**error);
+
+#define FU_FIRMWARE_BENCH_PARSE_FLAGS	(FWUPD_INSTALL_FLAG_NO_SEARCH | \
+					 FWUPD_INSTALL_FLAG_IGNORE_VID_PID | \
+					 FWUPD_INSTALL_FLAG_IGNORE_CHECKSUM)
+
+/* count every allocation made by the parsers, including the ones made
+ * inside GLib, by interposing the libc allocator for this binary only */
+#if defined(HAVE_LIBC_MALLOC) && !defined(__SANITIZE_ADDRESS__)
+static gint fu_firmware_bench_allocs = 0;
+static gsize fu_firmware_bench_alloc_sz = 0;
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+	g_atomic_int_inc (&fu_firmware_bench_allocs);
+	__atomic_fetch_add (&fu_firmware_bench_alloc_sz, size, __ATOMIC_RELAXED);
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	g_atomic_int_inc (&fu_firmware_bench_allocs);
+	__atomic_fetch_add (&fu_firmware_bench_alloc_sz, nmemb * size, __ATOMIC_RELAXED);
+	return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	g_atomic_int_inc (&fu_firmware_bench_allocs);
+	__atomic_fetch_add (&fu_firmware_bench_alloc_sz, size, __ATOMIC_RELAXED);
+	return __libc_realloc (ptr, size);
+}
+
+static void
+fu_firmware_bench_get_allocs (guint *allocs, gsize *alloc_sz)
+{
+	*allocs = (guint) g_atomic_int_get (&fu_firmware_bench_allocs);
+	*alloc_sz = __atomic_load_n (&fu_firmware_bench_alloc_sz, __ATOMIC_RELAXED);
+}
+#else
+static void
+fu_firmware_bench_get_allocs (guint *allocs, gsize *alloc_sz)
+{
+	*allocs = 0;
+	*alloc_sz = 0;
+}
+#endif
+
+static void
+fu_firmware_bench_reset_peak_rss (void)
+{
+	/* writing 5 resets VmHWM, only supported on Linux 4.0+ */
+	FILE *fp = fopen ("/proc/self/clear_refs", "w");
+	if (fp == NULL)
+		return;
+	fputs ("5", fp);
+	fclose (fp);
+}
+
+static guint64
+fu_firmware_bench_get_peak_rss (void)
+{
+	g_autofree gchar *buf = NULL;
+	g_auto(GStrv) lines = NULL;
+
+	if (!g_file_get_contents ("/proc/self/status", &buf, NULL, NULL))
+		return 0;
+	lines = g_strsplit (buf, "\n", -1);
+	for (guint i = 0; lines[i] != NULL; i++) {
+		if (g_str_has_prefix (lines[i], "VmHWM:"))
+			return g_ascii_strtoull (lines[i] + 6, NULL, 10);
+	}
+	return 0;
+}
+
+static gboolean
+fu_firmware_bench_parse_cb (GType gtype, GBytes *blob, FuFirmware *firmware,
+			    gsize *bufsz, GError **error)
+{
+	g_autoptr(FuFirmware) firmware_new = g_object_new (gtype, NULL);
+	*bufsz = g_bytes_get_size (blob);
+	return fu_firmware_parse (firmware_new, blob, FU_FIRMWARE_BENCH_PARSE_FLAGS, error);
+}
+
+static gboolean
+fu_firmware_bench_write_cb (GType gtype, GBytes *blob, FuFirmware *firmware,
+			    gsize *bufsz, GError **error)
+{
+	g_autoptr(GBytes) blob_new = fu_firmware_write (firmware, error);
+	if (blob_new == NULL)
+		return FALSE;
+	*bufsz = g_bytes_get_size (blob_new);
+	return TRUE;
+}
+
+static gboolean
+fu_firmware_bench_roundtrip_cb (GType gtype, GBytes *blob, FuFirmware *firmware,
+				gsize *bufsz, GError **error)
+{
+	g_autoptr(FuFirmware) firmware_new = g_object_new (gtype, NULL);
+	g_autoptr(GBytes) blob_new = fu_firmware_write (firmware, error);
+	if (blob_new == NULL)
+		return FALSE;
+	*bufsz = g_bytes_get_size (blob_new);
+	return fu_firmware_parse (firmware_new, blob_new, FU_FIRMWARE_BENCH_PARSE_FLAGS, error);
+}
+
+static gboolean
+fu_firmware_bench_run (FuUtil *self,
+		       FuFirmwareBenchFunc func,
+		       GType gtype,
+		       GBytes *blob,
+		       FuFirmware *firmware,
+		       FuFirmwareBenchResult *result,
+		       GError **error)
+{
+	guint allocs_start = 0;
+	guint allocs_end = 0;
+	gsize alloc_sz_start = 0;
+	gsize alloc_sz_end = 0;
+	g_autoptr(GTimer) timer = NULL;
+
+	/* run at least once, and then until the duration is used up */
+	fu_firmware_bench_reset_peak_rss ();
+	timer = g_timer_new ();
+	fu_firmware_bench_get_allocs (&allocs_start, &alloc_sz_start);
+	do {
+		if (!func (gtype, blob, firmware, &result->bufsz, error))
+			return FALSE;
+		result->iterations++;
+	} while (g_timer_elapsed (timer, NULL) * 1000.f < self->duration);
+	fu_firmware_bench_get_allocs (&allocs_end, &alloc_sz_end);
+	result->elapsed = g_timer_elapsed (timer, NULL);
+	result->allocs = (allocs_end - allocs_start) / result->iterations;
+	result->alloc_sz = (alloc_sz_end - alloc_sz_start) / result->iterations;
+	result->peak_rss = fu_firmware_bench_get_peak_rss ();
+	return TRUE;
+}
+
+static void
+fu_firmware_bench_print (const gchar *id,
+			 const gchar *name,
+			 const gchar *action,
+			 FuFirmwareBenchResult *result)
+{
+	gdouble mbs = 0.f;
+	if (result->elapsed > 0.f) {
+		mbs = (gdouble) result->bufsz * result->iterations /
+			(result->elapsed * 1024 * 1024);
+	}
+	g_print ("%-16s %-28s %-10s %10.1fMB/s %10u allocs %10.1fKB alloc %8" G_GUINT64_FORMAT "KB peak-rss\n",
+		 id, name, action, mbs, result->allocs,
+		 (gdouble) result->alloc_sz / 1024, result->peak_rss);
+}
+
+static GBytes *
+fu_firmware_bench_build_synthetic (FuUtil *self, GType gtype, GError **error)
+{
+	gsize bufsz = (gsize) self->size * 1024;
+	guint32 seed = 0x12345678;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autoptr(FuFirmware) firmware = g_object_new (gtype, NULL);
+	g_autoptr(FuFirmwareImage) img = NULL;
+	g_autoptr(GBytes) payload = NULL;
+
+	/* deterministic so that runs are comparable */
+	for (gsize i = 0; i < bufsz; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 24;
+	}
+	payload = g_bytes_new_take (g_steal_pointer (&buf), bufsz);
+	img = fu_firmware_image_new (payload);
+	fu_firmware_image_set_id (img, FU_FIRMWARE_IMAGE_ID_PAYLOAD);
+	fu_firmware_add_image (firmware, img);
+	return fu_firmware_write (firmware, error);
+}
+
+static void
+fu_firmware_bench_input (FuUtil *self, const gchar *id, GType gtype,
+			 const gchar *name, GBytes *blob)
+{
+	struct {
+		const gchar		*action;
+		FuFirmwareBenchFunc	 func;
+	} actions[] = {
+		{ "parse",	fu_firmware_bench_parse_cb },
+		{ "write",	fu_firmware_bench_write_cb },
+		{ "roundtrip",	fu_firmware_bench_roundtrip_cb },
+		{ NULL,		NULL }
+	};
+	g_autoptr(FuFirmware) firmware = g_object_new (gtype, NULL);
+	g_autoptr(GError) error_local = NULL;
+
+	/* most of the corpus is not valid for most of the types */
+	if (!fu_firmware_parse (firmware, blob, FU_FIRMWARE_BENCH_PARSE_FLAGS, &error_local)) {
+		g_debug ("ignoring %s for %s: %s", name, id, error_local->message);
+		return;
+	}
+	for (guint i = 0; actions[i].action != NULL; i++) {
+		FuFirmwareBenchResult result = { 0 };
+		g_autoptr(GError) error = NULL;
+		if (!fu_firmware_bench_run (self, actions[i].func, gtype, blob,
+					    firmware, &result, &error)) {
+			g_debug ("cannot %s %s for %s: %s",
+				 actions[i].action, name, id, error->message);
+			continue;
+		}
+		fu_firmware_bench_print (id, name, actions[i].action, &result);
+	}
+}
+
+static gint
+fu_firmware_bench_sort_cb (gconstpointer a, gconstpointer b)
+{
+	const gchar *stra = *((const gchar **) a);
+	const gchar *strb = *((const gchar **) b);
+	return g_strcmp0 (stra, strb);
+}
+
+static gboolean
+fu_firmware_bench_add_input (FuUtil *self, const gchar *fn, GError **error)
+{
+	FuFirmwareBenchInput *input;
+	GBytes *blob;
+
+	/* a corpus directory */
+	if (g_file_test (fn, G_FILE_TEST_IS_DIR)) {
+		const gchar *tmp;
+		g_autoptr(GDir) dir = g_dir_open (fn, 0, error);
+		g_autoptr(GPtrArray) fns = g_ptr_array_new_with_free_func (g_free);
+		if (dir == NULL)
+			return FALSE;
+		while ((tmp = g_dir_read_name (dir)) != NULL)
+			g_ptr_array_add (fns, g_build_filename (fn, tmp, NULL));
+		g_ptr_array_sort (fns, fu_firmware_bench_sort_cb);
+		for (guint i = 0; i < fns->len; i++) {
+			const gchar *fn_tmp = g_ptr_array_index (fns, i);
+			if (!fu_firmware_bench_add_input (self, fn_tmp, error))
+				return FALSE;
+		}
+		return TRUE;
+	}
+
+	blob = fu_common_get_contents_bytes (fn, error);
+	if (blob == NULL)
+		return FALSE;
+	input = g_new0 (FuFirmwareBenchInput, 1);
+	input->name = g_path_get_basename (fn);
+	input->blob = blob;
+	g_ptr_array_add (self->inputs, input);
+	return TRUE;
+}
+
+static void
+fu_firmware_bench_input_free (FuFirmwareBenchInput *input)
+{
+	g_free (input->name);
+	g_bytes_unref (input->blob);
+	g_free (input);
+}
+
+static void
+fu_firmware_bench_log_cb (const gchar *log_domain,
+			  GLogLevelFlags log_level,
+			  const gchar *message,
+			  gpointer user_data)
+{
+	FuUtil *self = (FuUtil *) user_data;
+	if (log_level == G_LOG_LEVEL_CRITICAL) {
+		g_printerr ("CRITICAL: %s\n", message);
+		g_assert_not_reached ();
+	}
+	if (self->verbose)
+		g_printerr ("DEBUG: %s\n", message);
+}
+
+static void
+fu_util_private_free (FuUtil *self)
+{
+	if (self->inputs != NULL)
+		g_ptr_array_unref (self->inputs);
+	if (self->engine != NULL)
+		g_object_unref (self->engine);
+	g_free (self->type);
+	g_free (self);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuUtil, fu_util_private_free)
+#pragma clang diagnostic pop
+
+int
+main (int argc, char **argv)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) firmware_types = NULL;
+	g_autoptr(GOptionContext) context = NULL;
+	g_autoptr(FuUtil) self = g_new0 (FuUtil, 1);
+	const GOptionEntry options[] = {
+		{ "verbose", 'v', 0, G_OPTION_ARG_NONE, &self->verbose,
+			/* TRANSLATORS: command line option */
+			_("Show extra debugging information"), NULL },
+		{ "duration", 'd', 0, G_OPTION_ARG_INT, &self->duration,
+			/* TRANSLATORS: command line option */
+			_("Minimum time in milliseconds for each measurement"), NULL },
+		{ "size", 's', 0, G_OPTION_ARG_INT, &self->size,
+			/* TRANSLATORS: command line option */
+			_("Size in KiB of the synthetic payload, or 0 to disable"), NULL },
+		{ "type", 't', 0, G_OPTION_ARG_STRING, &self->type,
+			/* TRANSLATORS: command line option */
+			_("Only benchmark this firmware type, e.g. ihex"), NULL },
+		{ NULL}
+	};
+
+	setlocale (LC_ALL, "");
+
+	bindtextdomain (GETTEXT_PACKAGE, FWUPD_LOCALEDIR);
+	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+	textdomain (GETTEXT_PACKAGE);
+
+	/* defaults */
+	self->duration = 200;
+	self->size = 1024;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, options, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		/* TRANSLATORS: the user didn't read the man page */
+		g_printerr ("%s: %s\n", _("Failed to parse arguments"),
+			    error->message);
+		return EXIT_FAILURE;
+	}
+
+	/* args */
+	if (self->verbose) {
+		g_setenv ("G_MESSAGES_DEBUG", "all", FALSE);
+		g_setenv ("FWUPD_VERBOSE", "1", FALSE);
+	}
+	g_log_set_default_handler (fu_firmware_bench_log_cb, self);
+
+	/* realistic inputs, either files or corpus directories */
+	self->inputs = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_firmware_bench_input_free);
+	for (gint i = 1; i < argc; i++) {
+		if (!fu_firmware_bench_add_input (self, argv[i], &error)) {
+			g_printerr ("failed to load %s: %s\n", argv[i], error->message);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/* load engine */
+	self->engine = fu_engine_new (FU_APP_FLAGS_NO_IDLE_SOURCES);
+	if (!fu_engine_load (self->engine, FU_ENGINE_LOAD_FLAG_READONLY, &error)) {
+		g_printerr ("Failed to load engine: %s\n", error->message);
+		return EXIT_FAILURE;
+	}
+
+	/* every parser registered by the engine and the plugins */
+	firmware_types = fu_engine_get_firmware_gtype_ids (self->engine);
+	for (guint i = 0; i < firmware_types->len; i++) {
+		const gchar *id = g_ptr_array_index (firmware_types, i);
+		GType gtype = fu_engine_get_firmware_gtype_by_id (self->engine, id);
+
+		if (self->type != NULL && g_strcmp0 (self->type, id) != 0)
+			continue;
+		for (guint j = 0; j < self->inputs->len; j++) {
+			FuFirmwareBenchInput *input = g_ptr_array_index (self->inputs, j);
+			fu_firmware_bench_input (self, id, gtype, input->name, input->blob);
+		}
+
+		/* a large input created by the type itself, if it can write */
+		if (self->size > 0) {
+			g_autoptr(GBytes) blob = NULL;
+			g_autoptr(GError) error_local = NULL;
+			g_autofree gchar *name = g_strdup_printf ("synthetic-%iKiB", self->size);
+			blob = fu_firmware_bench_build_synthetic (self, gtype, &error_local);
+			if (blob == NULL) {
+				g_debug ("no synthetic input for %s: %s",
+					 id, error_local->message);
+				continue;
+			}
+			fu_firmware_bench_input (self, id, gtype, name, blob);
+		}
+	}
+	return EXIT_SUCCESS;
+}
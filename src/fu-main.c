@@ -9,6 +9,8 @@
 #include "config.h"
 
 #include <xmlb.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <fwupd.h>
 #include <gio/gunixfdlist.h>
 #include <glib/gi18n.h>
@@ -22,6 +24,8 @@
 #endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <jcat.h>
 
 #include "fwupd-device-private.h"
@@ -951,6 +955,88 @@ fu_main_device_id_valid (const gchar *device_id, GError **error)
 	return FALSE;
 }
 
+/* large replies are sent as a sealed memfd so they are not copied by the bus */
+static void
+fu_main_invocation_return_value (GDBusMethodInvocation *invocation,
+				 const gchar *method_name,
+				 GVariant *val)
+{
+#ifdef HAVE_MEMFD_CREATE
+	const guint8 *buf;
+	gint fd;
+	gint idx;
+	gsize bufsz;
+	gsize offset = 0;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GUnixFDList) fd_list = NULL;
+	g_autoptr(GVariant) val_sunk = NULL;
+#endif
+
+	if (!g_str_has_suffix (method_name, "Fd")) {
+		g_dbus_method_invocation_return_value (invocation, val);
+		return;
+	}
+#ifdef HAVE_MEMFD_CREATE
+	val_sunk = g_variant_ref_sink (val);
+	buf = g_variant_get_data (val_sunk);
+	bufsz = g_variant_get_size (val_sunk);
+	fd = memfd_create ("fwupd-reply", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) {
+		g_dbus_method_invocation_return_error (invocation,
+						       FWUPD_ERROR,
+						       FWUPD_ERROR_INTERNAL,
+						       "failed to create memfd: %s",
+						       g_strerror (errno));
+		return;
+	}
+	while (offset < bufsz) {
+		gssize rc = write (fd, buf + offset, bufsz - offset);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			g_dbus_method_invocation_return_error (invocation,
+							       FWUPD_ERROR,
+							       FWUPD_ERROR_INTERNAL,
+							       "failed to write memfd: %s",
+							       g_strerror (errno));
+			close (fd);
+			return;
+		}
+		offset += rc;
+	}
+
+	/* the client maps this, so it must never change */
+	if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+				    F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+		g_dbus_method_invocation_return_error (invocation,
+						       FWUPD_ERROR,
+						       FWUPD_ERROR_INTERNAL,
+						       "failed to seal memfd: %s",
+						       g_strerror (errno));
+		close (fd);
+		return;
+	}
+	fd_list = g_unix_fd_list_new ();
+	idx = g_unix_fd_list_append (fd_list, fd, &error);
+	close (fd);
+	if (idx < 0) {
+		g_dbus_method_invocation_return_gerror (invocation, error);
+		return;
+	}
+	g_dbus_method_invocation_return_value_with_unix_fd_list (invocation,
+								 g_variant_new ("(h)", idx),
+								 fd_list);
+#else
+	/* the client falls back to the method without the suffix */
+	g_variant_unref (g_variant_ref_sink (val));
+	g_dbus_method_invocation_return_error (invocation,
+					       G_DBUS_ERROR,
+					       G_DBUS_ERROR_UNKNOWN_METHOD,
+					       "%s not supported without memfd_create()",
+					       method_name);
+#endif
+}
+
 static void
 fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			    const gchar *object_path, const gchar *interface_name,
@@ -994,7 +1080,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
-	if (g_strcmp0 (method_name, "GetReleases") == 0) {
+	if (g_strcmp0 (method_name, "GetReleases") == 0 ||
+	    g_strcmp0 (method_name, "GetReleasesFd") == 0) {
 		const gchar *device_id;
 		g_autoptr(GPtrArray) releases = NULL;
 		g_variant_get (parameters, "(&s)", &device_id);
@@ -1009,7 +1096,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_release_array_to_variant (releases);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, method_name, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetApprovedFirmware") == 0) {
@@ -1038,7 +1125,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 						       g_variant_new_tuple (&val, 1));
 		return;
 	}
-	if (g_strcmp0 (method_name, "GetReportMetadata") == 0) {
+	if (g_strcmp0 (method_name, "GetReportMetadata") == 0 ||
+	    g_strcmp0 (method_name, "GetReportMetadataFd") == 0) {
 		GHashTableIter iter;
 		GVariantBuilder builder;
 		const gchar *key;
@@ -1059,8 +1147,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 						     g_variant_new ("{ss}", key, value));
 		}
 		val = g_variant_builder_end (&builder);
-		g_dbus_method_invocation_return_value (invocation,
-						       g_variant_new_tuple (&val, 1));
+		fu_main_invocation_return_value (invocation, method_name,
+						 g_variant_new_tuple (&val, 1));
 		return;
 	}
 	if (g_strcmp0 (method_name, "SetApprovedFirmware") == 0) {
@@ -1226,7 +1314,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
-	if (g_strcmp0 (method_name, "GetHistory") == 0) {
+	if (g_strcmp0 (method_name, "GetHistory") == 0 ||
+	    g_strcmp0 (method_name, "GetHistoryFd") == 0) {
 		g_autoptr(GPtrArray) devices = NULL;
 		g_debug ("Called %s()", method_name);
 		devices = fu_engine_get_history (priv->engine, &error);
@@ -1239,7 +1328,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			g_dbus_method_invocation_return_gerror (invocation, error);
 			return;
 		}
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, method_name, val);
 		return;
 	}
 	if (g_strcmp0 (method_name, "GetHostSecurityAttrs") == 0) {
@@ -1643,7 +1732,8 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		/* async return */
 		return;
 	}
-	if (g_strcmp0 (method_name, "GetDetails") == 0) {
+	if (g_strcmp0 (method_name, "GetDetails") == 0 ||
+	    g_strcmp0 (method_name, "GetDetailsFd") == 0) {
 		GDBusMessage *message;
 		GUnixFDList *fd_list;
 		gint32 fd_handle = 0;
@@ -1678,7 +1768,7 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 		val = fu_main_result_array_to_variant (results);
-		g_dbus_method_invocation_return_value (invocation, val);
+		fu_main_invocation_return_value (invocation, method_name, val);
 		return;
 	}
 	g_set_error (&error,
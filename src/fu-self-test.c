@@ -19,6 +19,7 @@
 #include "fu-device-list.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
+#include "fu-engine-helper.h"
 #include "fu-history.h"
 #include "fu-install-task.h"
 #include "fu-plugin-private.h"
@@ -1090,6 +1091,80 @@ fu_engine_device_parent_func (gconstpointer user_data)
 	g_assert_cmpint (fu_device_get_order (device3), ==, -1);
 }
 
+static void
+fu_engine_metadata_delta_func (gconstpointer user_data)
+{
+	const gchar *xml =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<components origin=\"lvfs\" version=\"0.9\">\n"
+		"  <component type=\"firmware\"><id>a</id></component>\n"
+		"  <component type=\"firmware\"><id>b</id></component>\n"
+		"  <component type=\"firmware\"><id>c</id></component>\n"
+		"</components>\n";
+	const gchar *xml_comment =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<!-- <delta base=\"\"> -->\n"
+		"<components origin=\"lvfs\" version=\"0.9\"/>\n";
+	g_autofree gchar *checksum = NULL;
+	g_autofree gchar *delta_str = NULL;
+	g_autoptr(GBytes) blob = g_bytes_new_static (xml, strlen (xml));
+	g_autoptr(GBytes) blob_comment = NULL;
+	g_autoptr(GBytes) blob_compressed = NULL;
+	g_autoptr(GBytes) blob_delta = NULL;
+	g_autoptr(GBytes) blob_large = NULL;
+	g_autoptr(GBytes) blob_new = NULL;
+	g_autoptr(GBytes) blob_uncompressed = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* round trip */
+	blob_compressed = fu_engine_metadata_compress (blob, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_compressed);
+	g_assert_false (fu_engine_metadata_is_delta (blob_compressed));
+	blob_uncompressed = fu_engine_metadata_decompress (blob_compressed,
+							   FU_ENGINE_METADATA_SIZE_MAX,
+							   &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_uncompressed);
+	g_assert_true (g_bytes_equal (blob, blob_uncompressed));
+	g_assert_false (fu_engine_metadata_is_delta (blob_uncompressed));
+
+	/* too large when decompressed */
+	blob_large = fu_engine_metadata_decompress (blob_compressed, 0x10, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_large);
+	g_clear_error (&error);
+
+	/* only the root element counts */
+	blob_comment = g_bytes_new_static (xml_comment, strlen (xml_comment));
+	g_assert_false (fu_engine_metadata_is_delta (blob_comment));
+
+	/* remove one component and add another */
+	checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, blob);
+	delta_str = g_strdup_printf ("<delta base=\"%s\">\n"
+				     "  <remove>b</remove>\n"
+				     "  <component type=\"firmware\"><id>d</id></component>\n"
+				     "</delta>\n", checksum);
+	blob_delta = g_bytes_new (delta_str, strlen (delta_str));
+	g_assert_true (fu_engine_metadata_is_delta (blob_delta));
+	blob_new = fu_engine_metadata_apply_delta (blob, blob_delta, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_new);
+	g_assert_cmpstr (g_bytes_get_data (blob_new, NULL), ==,
+			 "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			 "<components origin=\"lvfs\" version=\"0.9\">\n"
+			 "  <component type=\"firmware\"><id>a</id></component>\n"
+			 "  <component type=\"firmware\"><id>c</id></component>\n"
+			 "  <component type=\"firmware\"><id>d</id></component>\n"
+			 "</components>\n");
+
+	/* the delta does not apply to different metadata */
+	g_clear_pointer (&blob_new, g_bytes_unref);
+	blob_new = fu_engine_metadata_apply_delta (blob_delta, blob_delta, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INVALID_FILE);
+	g_assert_null (blob_new);
+}
+
 static void
 fu_engine_partial_hash_func (gconstpointer user_data)
 {
@@ -2098,6 +2173,7 @@ fu_device_list_replug_user_func (gconstpointer user_data)
 	g_autoptr(FuDevice) device2 = fu_device_new ();
 	g_autoptr(FuDeviceList) device_list = fu_device_list_new ();
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GTimer) timer = NULL;
 	FuDeviceListReplugHelper helper;
 
 	/* fake devices */
@@ -2134,10 +2210,14 @@ fu_device_list_replug_user_func (gconstpointer user_data)
 	g_timeout_add (100, fu_device_list_remove_cb, &helper);
 	g_timeout_add (200, fu_device_list_add_cb, &helper);
 	fu_device_add_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+	timer = g_timer_new ();
 	ret = fu_device_list_wait_for_replug (device_list, device1, &error);
 	g_assert_no_error (error);
 	g_assert (ret);
 	g_assert_false (fu_device_has_flag (device1, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG));
+
+	/* woken by the replug, not by the remove-delay */
+	g_assert_cmpfloat (g_timer_elapsed (timer, NULL) * 1000.f, <, FU_DEVICE_REMOVE_DELAY_USER_REPLUG / 4);
 }
 
 static void
@@ -2961,6 +3041,139 @@ fu_plugin_composite_func (gconstpointer user_data)
 	}
 }
 
+#define FU_TYPE_TEST_DELTA_DEVICE (fu_test_delta_device_get_type ())
+G_DECLARE_FINAL_TYPE (FuTestDeltaDevice, fu_test_delta_device, FU, TEST_DELTA_DEVICE, FuDevice)
+
+struct _FuTestDeltaDevice {
+	FuDevice		 parent_instance;
+};
+
+G_DEFINE_TYPE (FuTestDeltaDevice, fu_test_delta_device, FU_TYPE_DEVICE)
+
+/* the test plugin sets the device version from the payload */
+static GBytes *
+fu_test_delta_device_dump_firmware (FuDevice *device, GError **error)
+{
+	return g_bytes_new_static ("16908290", 8);
+}
+
+static void
+fu_test_delta_device_init (FuTestDeltaDevice *self)
+{
+}
+
+static void
+fu_test_delta_device_class_init (FuTestDeltaDeviceClass *klass)
+{
+	FuDeviceClass *klass_device = FU_DEVICE_CLASS (klass);
+	klass_device->dump_firmware = fu_test_delta_device_dump_firmware;
+}
+
+static GBytes *
+_build_cab_delta (const gchar *metainfo, const guint8 *delta, gsize deltasz)
+{
+	gboolean ret;
+	const gchar *fns[] = { "acme.metainfo.xml", "firmware.bin.delta", NULL };
+	g_autoptr(GBytes) blob_metainfo = g_bytes_new_static (metainfo, strlen (metainfo));
+	g_autoptr(GBytes) blob_delta = g_bytes_new_static (delta, deltasz);
+	GBytes *blobs[] = { blob_metainfo, blob_delta, NULL };
+	g_autoptr(GCabCabinet) cabinet = gcab_cabinet_new ();
+	g_autoptr(GCabFolder) cabfolder = gcab_folder_new (GCAB_COMPRESSION_NONE);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GOutputStream) op = g_memory_output_stream_new_resizable ();
+
+	ret = gcab_cabinet_add_folder (cabinet, cabfolder, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	for (guint i = 0; fns[i] != NULL; i++) {
+		g_autoptr(GCabFile) cabfile = gcab_file_new_with_bytes (fns[i], blobs[i]);
+		ret = gcab_folder_add_file (cabfolder, cabfile, FALSE, NULL, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+	}
+	ret = gcab_cabinet_write_simple (cabinet, op, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_output_stream_close (op, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (op));
+}
+
+static void
+fu_engine_install_delta_func (gconstpointer user_data)
+{
+	FuTest *self = (FuTest *) user_data;
+	gboolean ret;
+	const guint8 delta[] = {
+		'F', 'U', 'D', 'E', 'L', 'T', 'A', '1',
+		0x08, 0x00, 0x00, 0x00,			/* size of new image */
+		0x01,					/* copy */
+		0x00, 0x00, 0x00, 0x00,			/* offset */
+		0x07, 0x00, 0x00, 0x00,			/* length */
+		0x02,					/* insert */
+		0x01, 0x00, 0x00, 0x00,			/* length */
+		'1' };
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuDevice) device = g_object_new (FU_TYPE_TEST_DELTA_DEVICE, NULL);
+	g_autoptr(FuInstallTask) task = NULL;
+	g_autoptr(GBytes) blob_cab = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbNode) component = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	g_unsetenv ("FWUPD_PLUGIN_TEST");
+	fu_engine_add_plugin (engine, self->plugin);
+
+	/* the firmware on the device is "16908290", i.e. 1.2.2 */
+	fu_device_set_version_format (device, FWUPD_VERSION_FORMAT_TRIPLET);
+	fu_device_set_version (device, "1.2.2");
+	fu_device_set_id (device, "test_device");
+	fu_device_set_vendor_id (device, "USB:FFFF");
+	fu_device_set_protocol (device, "com.acme");
+	fu_device_set_name (device, "Test Device");
+	fu_device_set_plugin (device, "test");
+	fu_device_add_guid (device, "12345678-1234-1234-1234-123456789012");
+	fu_device_add_flag (device, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fu_engine_add_device (engine, device);
+
+	/* only the delta to "16908291" is in the archive */
+	blob_cab = _build_cab_delta (
+	"<component type=\"firmware\">\n"
+	"  <id>com.acme.example.firmware</id>\n"
+	"  <provides>\n"
+	"    <firmware type=\"flashed\">12345678-1234-1234-1234-123456789012</firmware>\n"
+	"  </provides>\n"
+	"  <releases>\n"
+	"    <release version=\"1.2.3\">\n"
+	"      <checksum filename=\"firmware.bin\" target=\"content\" type=\"sha1\">3d68bc69e85d7f655e12bbe226faa20b7c25887a</checksum>\n"
+	"      <delta source=\"acc59a3b43d1182a9412024dbdfb7983a7c222e247cb6721c27f96bcf058f887\" filename=\"firmware.bin.delta\"/>\n"
+	"    </release>\n"
+	"  </releases>\n"
+	"  <custom>\n"
+	"    <value key=\"LVFS::VersionFormat\">triplet</value>\n"
+	"  </custom>\n"
+	"</component>",
+						delta, sizeof(delta));
+	silo = fu_engine_get_silo_from_blob (engine, blob_cab, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo);
+	component = xb_silo_query_first (silo, "components/component/id[text()='com.acme.example.firmware']/..", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (component);
+
+	/* the reconstructed image is what the plugin writes */
+	task = fu_install_task_new (device, component);
+	ret = fu_engine_install (engine, task, blob_cab,
+				 FWUPD_INSTALL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpstr (fu_device_get_version (device), ==, "1.2.3");
+}
+
 static void
 fu_security_attr_func (gconstpointer user_data)
 {
@@ -3183,6 +3396,8 @@ main (int argc, char **argv)
 			      fu_engine_history_inherit);
 	g_test_add_data_func ("/fwupd/engine{partial-hash}", self,
 			      fu_engine_partial_hash_func);
+	g_test_add_data_func ("/fwupd/engine{metadata-delta}", self,
+			      fu_engine_metadata_delta_func);
 	g_test_add_data_func ("/fwupd/engine{downgrade}", self,
 			      fu_engine_downgrade_func);
 	g_test_add_data_func ("/fwupd/engine{requirements-success}", self,
@@ -3225,6 +3440,8 @@ main (int argc, char **argv)
 			      fu_engine_requirements_other_device_func);
 	g_test_add_data_func ("/fwupd/plugin{composite}", self,
 			      fu_plugin_composite_func);
+	g_test_add_data_func ("/fwupd/engine{install-delta}", self,
+			      fu_engine_install_delta_func);
 	g_test_add_data_func ("/fwupd/history", self,
 			      fu_history_func);
 	g_test_add_data_func ("/fwupd/history{migrate}", self,
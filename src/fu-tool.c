@@ -839,8 +839,9 @@ static gboolean
 fu_util_firmware_dump (FuUtilPrivate *priv, gchar **values, GError **error)
 {
 	g_autoptr(FuDevice) device = NULL;
-	g_autoptr(GBytes) blob_empty = g_bytes_new (NULL, 0);
-	g_autoptr(GBytes) blob_fw = NULL;
+	g_autoptr(GChecksum) checksum = g_checksum_new (G_CHECKSUM_SHA256);
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileOutputStream) stream = NULL;
 
 	/* invalid args */
 	if (g_strv_length (values) == 0) {
@@ -861,9 +862,11 @@ fu_util_firmware_dump (FuUtilPrivate *priv, gchar **values, GError **error)
 		return FALSE;
 	}
 
-	/* write a zero length file to ensure the destination is writable to
-	 * avoid failing at the end of a potentially lengthy operation */
-	if (!fu_common_set_contents_bytes (values[0], blob_empty, error))
+	/* open the destination now to ensure it is writable to avoid failing
+	 * at the end of a potentially lengthy operation */
+	file = g_file_new_for_path (values[0]);
+	stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+	if (stream == NULL)
 		return FALSE;
 
 	/* load engine */
@@ -884,11 +887,17 @@ fu_util_firmware_dump (FuUtilPrivate *priv, gchar **values, GError **error)
 	g_signal_connect (priv->engine, "device-changed",
 			  G_CALLBACK (fu_util_update_device_changed_cb), priv);
 
-	/* dump firmware */
-	blob_fw = fu_engine_firmware_dump (priv->engine, device, priv->flags, error);
-	if (blob_fw == NULL)
+	/* dump firmware, writing each block as it is read */
+	if (!fu_engine_firmware_dump (priv->engine, device,
+				      G_OUTPUT_STREAM (stream), checksum,
+				      priv->flags, error))
+		return FALSE;
+	if (!g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error))
 		return FALSE;
-	return fu_common_set_contents_bytes (values[0], blob_fw, error);
+
+	/* in the same format as sha256sum so it can be checked later */
+	g_print ("%s  %s\n", g_checksum_get_string (checksum), values[0]);
+	return TRUE;
 }
 
 static gint
@@ -1785,6 +1794,72 @@ fu_util_monitor (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_util_get_memory_usage (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	guint unique = 0;
+	guint64 shared = 0;
+	guint64 saved = 0;
+	g_autofree gchar *status = NULL;
+	g_autofree gchar *saved_str = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+	/* load engine */
+	if (!fu_util_start_engine (priv,
+				   FU_ENGINE_LOAD_FLAG_COLDPLUG |
+				   FU_ENGINE_LOAD_FLAG_HWINFO |
+				   FU_ENGINE_LOAD_FLAG_REMOTES,
+				   error))
+		return FALSE;
+
+	/* create all the releases too, as these are the bulk of the objects, and
+	 * keep them alive as the shared strings are freed with the last user */
+	devices = fu_engine_get_devices (priv->engine, error);
+	if (devices == NULL)
+		return FALSE;
+	for (guint i = 0; i < devices->len; i++) {
+		FwupdDevice *dev = g_ptr_array_index (devices, i);
+		g_autoptr(GPtrArray) rels = NULL;
+		g_autoptr(GError) error_local = NULL;
+
+		if (!fwupd_device_has_flag (dev, FWUPD_DEVICE_FLAG_UPDATABLE))
+			continue;
+		rels = fu_engine_get_releases (priv->engine,
+					       priv->request,
+					       fwupd_device_get_id (dev),
+					       &error_local);
+		if (rels == NULL) {
+			g_debug ("ignoring %s: %s",
+				 fwupd_device_get_id (dev),
+				 error_local->message);
+			continue;
+		}
+		for (guint j = 0; j < rels->len; j++)
+			g_ptr_array_add (releases, g_object_ref (g_ptr_array_index (rels, j)));
+	}
+
+	/* interned strings */
+	fwupd_intern_string_get_stats (&unique, &shared, &saved);
+	saved_str = g_format_size (saved);
+	g_print ("Devices:           %u\n", devices->len);
+	g_print ("Releases:          %u\n", releases->len);
+	g_print ("Interned strings:  %u\n", unique);
+	g_print ("Interned reused:   %" G_GUINT64_FORMAT "\n", shared);
+	g_print ("Interned saved:    %s\n", saved_str);
+
+	/* process totals, where available */
+	if (g_file_get_contents ("/proc/self/status", &status, NULL, NULL)) {
+		g_auto(GStrv) lines = g_strsplit (status, "\n", -1);
+		for (guint i = 0; lines[i] != NULL; i++) {
+			if (g_str_has_prefix (lines[i], "VmRSS:") ||
+			    g_str_has_prefix (lines[i], "VmHWM:"))
+				g_print ("%s\n", lines[i]);
+		}
+	}
+	return TRUE;
+}
+
 static gboolean
 fu_util_get_firmware_types (FuUtilPrivate *priv, gchar **values, GError **error)
 {
@@ -1839,8 +1914,9 @@ static gboolean
 fu_util_firmware_parse (FuUtilPrivate *priv, gchar **values, GError **error)
 {
 	GType gtype;
-	g_autoptr(GBytes) blob = NULL;
 	g_autoptr(FuFirmware) firmware = NULL;
+	g_autoptr(GFile) file = NULL;
+	g_autoptr(GFileInputStream) stream = NULL;
 	g_autofree gchar *firmware_type = NULL;
 	g_autofree gchar *str = NULL;
 
@@ -1856,9 +1932,10 @@ fu_util_firmware_parse (FuUtilPrivate *priv, gchar **values, GError **error)
 	if (g_strv_length (values) == 2)
 		firmware_type = g_strdup (values[1]);
 
-	/* load file */
-	blob = fu_common_get_contents_bytes (values[0], error);
-	if (blob == NULL)
+	/* only the headers are read if the format supports it */
+	file = g_file_new_for_path (values[0]);
+	stream = g_file_read (file, priv->cancellable, error);
+	if (stream == NULL)
 		return FALSE;
 
 	/* load engine */
@@ -1879,7 +1956,7 @@ fu_util_firmware_parse (FuUtilPrivate *priv, gchar **values, GError **error)
 		return FALSE;
 	}
 	firmware = g_object_new (gtype, NULL);
-	if (!fu_firmware_parse (firmware, blob, priv->flags, error))
+	if (!fu_firmware_parse_stream (firmware, G_INPUT_STREAM (stream), priv->flags, error))
 		return FALSE;
 	str = fu_firmware_to_string (firmware);
 	g_print ("%s", str);
@@ -2069,8 +2146,8 @@ fu_util_firmware_convert (FuUtilPrivate *priv, gchar **values, GError **error)
 	g_autofree gchar *str_src = NULL;
 	g_autoptr(FuFirmware) firmware_dst = NULL;
 	g_autoptr(FuFirmware) firmware_src = NULL;
-	g_autoptr(GBytes) blob_dst = NULL;
 	g_autoptr(GBytes) blob_src = NULL;
+	g_autoptr(GFile) file_dst = NULL;
 	g_autoptr(GPtrArray) images = NULL;
 
 	/* check args */
@@ -2135,11 +2212,11 @@ fu_util_firmware_convert (FuUtilPrivate *priv, gchar **values, GError **error)
 		fu_firmware_add_image (firmware_dst, img);
 	}
 
-	/* write new file */
-	blob_dst = fu_firmware_write (firmware_dst, error);
-	if (blob_dst == NULL)
+	/* write new file, streaming the segments rather than joining them */
+	file_dst = g_file_new_for_path (values[1]);
+	if (!fu_common_mkdir_parent (values[1], error))
 		return FALSE;
-	if (!fu_common_set_contents_bytes (values[1], blob_dst, error))
+	if (!fu_firmware_write_file (firmware_dst, file_dst, error))
 		return FALSE;
 	str_dst = fu_firmware_to_string (firmware_dst);
 	g_print ("%s", str_dst);
@@ -2952,6 +3029,12 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: command description */
 		     _("List the available firmware types"),
 		     fu_util_get_firmware_types);
+	fu_util_cmd_array_add (cmd_array,
+		     "get-memory-usage",
+		     NULL,
+		     /* TRANSLATORS: command description */
+		     _("Show how much memory is used by devices and releases"),
+		     fu_util_get_memory_usage);
 	fu_util_cmd_array_add (cmd_array,
 		     "get-remotes",
 		     NULL,
@@ -1094,6 +1094,7 @@ fu_util_download_metadata (FuUtilPrivate *priv, GError **error)
 	guint devices_supported_cnt = 0;
 	g_autoptr(GPtrArray) devs = NULL;
 	g_autoptr(GPtrArray) remotes = NULL;
+	g_autoptr(GPtrArray) remotes_download = NULL;
 	g_autoptr(GString) str = g_string_new (NULL);
 
 	/* metadata refreshed recently */
@@ -1119,6 +1120,7 @@ fu_util_download_metadata (FuUtilPrivate *priv, GError **error)
 	remotes = fwupd_client_get_remotes (priv->client, NULL, error);
 	if (remotes == NULL)
 		return FALSE;
+	remotes_download = g_ptr_array_new ();
 	for (guint i = 0; i < remotes->len; i++) {
 		FwupdRemote *remote = g_ptr_array_index (remotes, i);
 		if (!fwupd_remote_get_enabled (remote))
@@ -1127,10 +1129,11 @@ fu_util_download_metadata (FuUtilPrivate *priv, GError **error)
 			continue;
 		download_remote_enabled = TRUE;
 		g_print ("%s %s\n", _("Updating"), fwupd_remote_get_id (remote));
-		if (!fwupd_client_refresh_remote (priv->client, remote,
-						  priv->cancellable, error))
-			return FALSE;
+		g_ptr_array_add (remotes_download, remote);
 	}
+	if (!fwupd_client_refresh_remotes (priv->client, remotes_download,
+					   priv->cancellable, error))
+		return FALSE;
 
 	/* no web remote is declared; try to enable LVFS */
 	if (!download_remote_enabled) {